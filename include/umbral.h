@@ -136,6 +136,7 @@ class umb_scope_arena {
 
 UMB_CONTAINER_DEF(str);
 UMB_CONTAINER_DEF(byte);
+UMB_CONTAINER_DEF(u32);
 
 #pragma endregion
 
@@ -184,4 +185,14 @@ void umb_shutdown();
 
 #pragma region io
 umb_array_byte umb_read_file_binary(umb_arena arena, str filename);
+
+// The whole file mapped into memory. Pages are copy-on-write: writes through `data` stay private
+// to the process and never reach the file.
+struct umb_mapped_file {
+  byte* data;
+  u64   size;
+};
+
+b32  umb_map_file(str filename, umb_mapped_file* out_file);
+void umb_unmap_file(umb_mapped_file* file);
 #pragma endregion
@@ -0,0 +1,70 @@
+#include <chrono>
+#include <core/umb_job.h>
+#include <gfx/umb_image.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <thread>
+#include <umbral.h>
+
+// Decodes a set of images on the job system with a growing number of threads and reports the
+// throughput for each. Every decode writes level 0 into memory of its own, as the loader does
+// with staging memory, and leaves the mip chain to the GPU.
+//
+//   umbral-bench-decode [image ...]
+
+static constexpr u32 N_DECODES = 32;
+
+static str DEFAULT_IMAGE = "res/images/lost_empire-RGBA.png";
+
+static void bench_decode_job(void* data) {
+  umb_image_decode* decode = (umb_image_decode*)data;
+  decode->dst              = (u8*)malloc(umb_image_level_size(decode->width, decode->height, 0));
+  umb_image_decode_job(decode);
+  free(decode->dst);
+}
+
+static void bench_threads(umb_image_decode* decodes, u32 n_threads) {
+  umb_job_system_init(n_threads - 1);
+
+  auto            start   = std::chrono::high_resolution_clock::now();
+  umb_job_counter counter = {};
+  for (u32 i = 0; i < N_DECODES; ++i) umb_job_run(bench_decode_job, &decodes[i], &counter);
+  umb_job_wait(&counter);
+  auto end = std::chrono::high_resolution_clock::now();
+
+  umb_job_system_shutdown();
+
+  f64 mpixels = 0.0;
+  for (u32 i = 0; i < N_DECODES; ++i) mpixels += (f64)decodes[i].width * decodes[i].height / 1e6;
+
+  f64 s = std::chrono::duration<f64>(end - start).count();
+  printf(
+      "%3u threads  %8.3f s  %8.2f images/s  %8.1f MP/s\n",
+      n_threads,
+      s,
+      N_DECODES / s,
+      mpixels / s);
+}
+
+int main(int argc, char** argv) {
+  u32 n_files = argc > 1 ? (u32)argc - 1 : 1;
+  str file    = argc > 1 ? argv[1] : DEFAULT_IMAGE;
+
+  umb_image_decode decodes[N_DECODES] = {};
+  for (u32 i = 0; i < N_DECODES; ++i) {
+    decodes[i].file     = argc > 1 ? argv[1 + i % n_files] : file;
+    decodes[i].n_levels = 1;
+    umb_image_info_job(&decodes[i]);
+    if (!decodes[i].ok) {
+      fprintf(stderr, "umbral-bench-decode: could not read %s\n", decodes[i].file);
+      return 1;
+    }
+  }
+
+  u32 n_cores = std::thread::hardware_concurrency();
+  n_cores     = n_cores < 1 ? 1 : n_cores > UMB_JOB_MAX_WORKERS ? UMB_JOB_MAX_WORKERS : n_cores;
+  for (u32 n_threads = 1; n_threads < n_cores; n_threads *= 2) bench_threads(decodes, n_threads);
+  bench_threads(decodes, n_cores);
+
+  return 0;
+}
@@ -0,0 +1,185 @@
+#include <chrono>
+#include <core/umb_math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <umbral.h>
+
+#define GLM_FORCE_RADIANS
+#include <glm/glm.hpp>
+
+// Runs each batched math kernel at every instruction set level the CPU supports and the
+// equivalent loop over glm types, and reports the time per element.
+//
+//   umbral-bench-math [elements]
+
+static constexpr u32 DEFAULT_ELEMENTS = 1 << 16;
+static constexpr u32 REPEATS          = 64;
+
+// keeps the compiler from dropping the glm loops
+static volatile f32 sink;
+
+struct bench_data {
+  u32        n;
+  glm::mat4* a;
+  glm::mat4* b;
+  glm::mat4* out;
+  glm::vec4* vecs;
+  glm::vec4* out_vecs;
+  glm::vec4* out_max;
+  f32*       soa[6];
+  f32*       out_soa[6];
+};
+
+static f32 bench_random() {
+  return (f32)rand() / (f32)RAND_MAX * 2.f - 1.f;
+}
+
+template <typename F> static f64 bench_time(F f) {
+  f();
+  auto start = std::chrono::high_resolution_clock::now();
+  for (u32 r = 0; r < REPEATS; ++r) f();
+  auto end = std::chrono::high_resolution_clock::now();
+  return std::chrono::duration<f64, std::nano>(end - start).count() / REPEATS;
+}
+
+static void bench_report(str kernel, str variant, f64 ns, u32 n, f64 glm_ns) {
+  printf(
+      "%-16s %-8s %8.2f ns/element  %6.2fx glm\n",
+      kernel,
+      variant,
+      ns / n,
+      glm_ns > 0.0 ? glm_ns / ns : 1.0);
+}
+
+static void bench_glm(bench_data* d, f64 glm_ns[4]) {
+  u32 n = d->n;
+
+  glm_ns[0] = bench_time([&] {
+    for (u32 i = 0; i < n; ++i) d->out[i] = d->a[i] * d->b[i];
+    sink = d->out[n - 1][3][3];
+  });
+  bench_report("mat4 * mat4", "glm", glm_ns[0], n, 0.0);
+
+  glm_ns[1] = bench_time([&] {
+    glm::mat4 m = d->a[0];
+    for (u32 i = 0; i < n; ++i) d->out_vecs[i] = m * d->vecs[i];
+    sink = d->out_vecs[n - 1].w;
+  });
+  bench_report("mat4 * vec4", "glm", glm_ns[1], n, 0.0);
+
+  glm_ns[2] = bench_time([&] {
+    for (u32 i = 0; i < n; ++i) {
+      const glm::mat4& m      = d->a[i];
+      glm::vec3        lo     = glm::vec3(d->soa[0][i], d->soa[1][i], d->soa[2][i]);
+      glm::vec3        hi     = glm::vec3(d->soa[3][i], d->soa[4][i], d->soa[5][i]);
+      glm::vec3        e      = (hi - lo) * 0.5f;
+      glm::vec3        center = glm::vec3(m * glm::vec4((lo + hi) * 0.5f, 1.f));
+      glm::vec3        extent = glm::abs(glm::vec3(m[0])) * e.x;
+      extent += glm::abs(glm::vec3(m[1])) * e.y;
+      extent += glm::abs(glm::vec3(m[2])) * e.z;
+
+      d->out_vecs[i] = glm::vec4(center - extent, 0.f);
+      d->out_max[i]  = glm::vec4(center + extent, 0.f);
+    }
+    sink = d->out_vecs[n - 1].x + d->out_max[n - 1].x;
+  });
+  bench_report("aabb transform", "glm", glm_ns[2], n, 0.0);
+
+  glm_ns[3] = bench_time([&] {
+    for (u32 i = 0; i < n; ++i) {
+      const glm::mat4& m     = d->a[i];
+      f32              scale = glm::max(
+          glm::length(glm::vec3(m[0])),
+          glm::max(glm::length(glm::vec3(m[1])), glm::length(glm::vec3(m[2]))));
+      glm::vec4 center = m * glm::vec4(d->soa[0][i], d->soa[1][i], d->soa[2][i], 1.f);
+      d->out_vecs[i]   = glm::vec4(glm::vec3(center), d->soa[3][i] * scale);
+    }
+    sink = d->out_vecs[n - 1].w;
+  });
+  bench_report("sphere transform", "glm", glm_ns[3], n, 0.0);
+}
+
+static void bench_kernels(bench_data* d, str variant, const f64 glm_ns[4]) {
+  u32        n        = d->n;
+  const f32* matrices = (const f32*)d->a;
+
+  f64 ns = bench_time([&] { umb_mat4_mul_batch(matrices, (f32*)d->b, (f32*)d->out, n); });
+  bench_report("mat4 * mat4", variant, ns, n, glm_ns[0]);
+
+  umb_vec4_soa vec_in  = {d->soa[0], d->soa[1], d->soa[2], d->soa[3]};
+  umb_vec4_soa vec_out = {d->out_soa[0], d->out_soa[1], d->out_soa[2], d->out_soa[3]};
+  ns = bench_time([&] { umb_mat4_transform_vec4(matrices, 0, &vec_in, &vec_out, n); });
+  bench_report("mat4 * vec4", variant, ns, n, glm_ns[1]);
+
+  umb_aabb_soa aabb_in  = {d->soa[0], d->soa[1], d->soa[2], d->soa[3], d->soa[4], d->soa[5]};
+  umb_aabb_soa aabb_out = {
+      d->out_soa[0],
+      d->out_soa[1],
+      d->out_soa[2],
+      d->out_soa[3],
+      d->out_soa[4],
+      d->out_soa[5],
+  };
+  ns = bench_time([&] { umb_mat4_transform_aabbs(matrices, 16, &aabb_in, &aabb_out, n); });
+  bench_report("aabb transform", variant, ns, n, glm_ns[2]);
+
+  umb_sphere_soa sphere_in  = {d->soa[0], d->soa[1], d->soa[2], d->soa[3]};
+  umb_sphere_soa sphere_out = {d->out_soa[0], d->out_soa[1], d->out_soa[2], d->out_soa[3]};
+  ns = bench_time([&] { umb_mat4_transform_spheres(matrices, 16, &sphere_in, &sphere_out, n); });
+  bench_report("sphere transform", variant, ns, n, glm_ns[3]);
+}
+
+int main(int argc, char** argv) {
+  bench_data d = {};
+  d.n          = argc > 1 ? (u32)atoi(argv[1]) : DEFAULT_ELEMENTS;
+  if (d.n == 0) {
+    fprintf(stderr, "usage: umbral-bench-math [elements]\n");
+    return 1;
+  }
+
+  d.a        = (glm::mat4*)malloc(d.n * sizeof(glm::mat4));
+  d.b        = (glm::mat4*)malloc(d.n * sizeof(glm::mat4));
+  d.out      = (glm::mat4*)malloc(d.n * sizeof(glm::mat4));
+  d.vecs     = (glm::vec4*)malloc(d.n * sizeof(glm::vec4));
+  d.out_vecs = (glm::vec4*)malloc(d.n * sizeof(glm::vec4));
+  d.out_max  = (glm::vec4*)malloc(d.n * sizeof(glm::vec4));
+  for (u32 i = 0; i < d.n; ++i) {
+    for (u32 k = 0; k < 16; ++k) {
+      d.a[i][k / 4][k % 4] = bench_random();
+      d.b[i][k / 4][k % 4] = bench_random();
+    }
+    d.vecs[i] = glm::vec4(bench_random(), bench_random(), bench_random(), 1.f);
+  }
+  for (u32 k = 0; k < UMB_ARRAY_COUNT(d.soa, f32*); ++k) {
+    d.soa[k]     = (f32*)malloc(d.n * sizeof(f32));
+    d.out_soa[k] = (f32*)malloc(d.n * sizeof(f32));
+    for (u32 i = 0; i < d.n; ++i) d.soa[k][i] = bench_random();
+  }
+  // boxes need min <= max
+  for (u32 k = 0; k < 3; ++k) {
+    for (u32 i = 0; i < d.n; ++i) d.soa[k + 3][i] = d.soa[k][i] + 1.f;
+  }
+
+  printf("%u elements, %u repeats\n", d.n, REPEATS);
+  f64 glm_ns[4];
+  bench_glm(&d, glm_ns);
+
+  umb_math_isa best = umb_math_get_isa();
+  for (u32 isa = 0; isa <= best; ++isa) {
+    if (umb_math_set_isa((umb_math_isa)isa) != isa) continue;
+    bench_kernels(&d, umb_math_isa_name((umb_math_isa)isa), glm_ns);
+  }
+  umb_math_set_isa(best);
+
+  free(d.a);
+  free(d.b);
+  free(d.out);
+  free(d.vecs);
+  free(d.out_vecs);
+  free(d.out_max);
+  for (u32 k = 0; k < UMB_ARRAY_COUNT(d.soa, f32*); ++k) {
+    free(d.soa[k]);
+    free(d.out_soa[k]);
+  }
+  return 0;
+}
@@ -0,0 +1,101 @@
+#define SDL_MAIN_HANDLED
+#include <SDL.h>
+#include <chrono>
+#include <gfx/umb_gfx.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <umbral.h>
+
+// Registers the same vertex-heavy meshes through the staged path (direct budget 0) and through
+// direct writes into host visible device local memory, and reports the time until the GPU can
+// draw them. The meshes have a single triangle so that LOD and meshlet building stay out of the
+// measurement.
+
+static constexpr u32 N_MESHES          = 8;
+static constexpr u32 VERTICES_PER_MESH = 1 << 16;
+static constexpr u32 N_ROUNDS          = 8;
+
+static umb_mesh meshes[N_MESHES];
+static char     names[N_MESHES][32];
+
+void log_proc(umb_log_message_type log_type, void* user_data, const char* fmt, ...) {
+  va_list args;
+  va_start(args, fmt);
+  vprintf(fmt, args);
+  printf("\n");
+  va_end(args);
+}
+
+static void bench_create_meshes() {
+  for (u32 m = 0; m < N_MESHES; ++m) {
+    meshes[m] = umb_mesh_create_indexed(VERTICES_PER_MESH, 3);
+    for (u32 v = 0; v < VERTICES_PER_MESH; ++v) {
+      f32 x = (f32)(v % 256);
+      f32 y = (f32)(v / 256);
+      umb_mesh_push_vertex(
+          meshes[m],
+          {
+              .position = {x, y, (f32)m},
+              .normal   = {0.f, 0.f, 1.f},
+              .color    = {x / 256.f, y / 256.f, 0.f},
+              .uv       = {x / 256.f, y / 256.f},
+          });
+    }
+    umb_mesh_push_index(meshes[m], 0);
+    umb_mesh_push_index(meshes[m], 1);
+    umb_mesh_push_index(meshes[m], 256);
+    snprintf(names[m], sizeof(names[m]), "bench_mesh_%u", m);
+  }
+}
+
+static void bench_path(str label, u64 direct_budget) {
+  umb_gfx_set_direct_upload_budget(direct_budget);
+
+  f64 best_ms  = 1e30;
+  f64 total_ms = 0.0;
+  for (u32 r = 0; r < N_ROUNDS; ++r) {
+    // recreates the geometry buffers under the current budget and releases the last round
+    umb_gfx_defragment_geometry();
+
+    auto start = std::chrono::high_resolution_clock::now();
+    umb_gfx_upload_batch_begin();
+    for (u32 m = 0; m < N_MESHES; ++m) umb_gfx_register_mesh(names[m], meshes[m]);
+    umb_gfx_upload_wait(umb_gfx_upload_batch_end());
+    auto end = std::chrono::high_resolution_clock::now();
+
+    f64 ms  = std::chrono::duration<f64, std::milli>(end - start).count();
+    best_ms = ms < best_ms ? ms : best_ms;
+    total_ms += ms;
+
+    for (u32 m = 0; m < N_MESHES; ++m) umb_gfx_unregister_mesh(names[m]);
+  }
+
+  f64 mb = (f64)N_MESHES * VERTICES_PER_MESH * sizeof(umb_mesh_vertex) / (1024.0 * 1024.0);
+  printf(
+      "%-8s %8.2f MB  best %8.3f ms  avg %8.3f ms  %8.1f MB/s\n",
+      label,
+      mb,
+      best_ms,
+      total_ms / N_ROUNDS,
+      mb / (best_ms / 1000.0));
+}
+
+void start(umb_app* app) {
+  bench_create_meshes();
+  bench_path("staged", 0);
+  bench_path("direct", UMB_MEGABYTES(512));
+  app->running = false;
+}
+
+int main(void) {
+  umb_init_info init_info {.log_proc = log_proc};
+  umb_init(&init_info);
+
+  umb_app app;
+  umb_app_init(&app, "[umbral] upload bench", 640, 480, start, NULL, NULL);
+  umb_app_run(&app);
+
+  umb_shutdown();
+
+  return 0;
+}
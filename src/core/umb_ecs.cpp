@@ -0,0 +1,378 @@
+#include <core/umb_ecs.h>
+#include <core/umb_job.h>
+#include <stdlib.h>
+#include <string.h>
+
+// entities are a record index with a generation in the top bits, so stale handles are detected
+static constexpr u32 ENTITY_INDEX_BITS  = 24;
+static constexpr u32 ENTITY_INDEX_MASK  = (1u << ENTITY_INDEX_BITS) - 1;
+static constexpr u32 GENERATION_MASK    = ~0u >> ENTITY_INDEX_BITS;
+static constexpr u32 CHUNK_ALIGN        = 64;
+static constexpr u32 FREE_RECORD        = ~0u;
+static constexpr u32 MISSING_COMPONENT  = ~0u;
+static constexpr u32 MIN_ARRAY_CAPACITY = 16;
+
+template <typename T> static void umb_ecs_grow(T** data, u32* capacity, u32 needed) {
+  if (needed <= *capacity) return;
+  u32 new_capacity = *capacity ? *capacity : MIN_ARRAY_CAPACITY;
+  while (new_capacity < needed) new_capacity *= 2;
+  *data = (T*)realloc(*data, (u64)new_capacity * sizeof(T));
+  UMB_ASSERT(*data);
+  *capacity = new_capacity;
+}
+
+static byte* umb_ecs_chunk_alloc() {
+#if defined(_MSC_VER)
+  byte* chunk = (byte*)_aligned_malloc(UMB_ECS_CHUNK_SIZE, CHUNK_ALIGN);
+#else
+  byte* chunk = (byte*)aligned_alloc(CHUNK_ALIGN, UMB_ECS_CHUNK_SIZE);
+#endif
+  UMB_ASSERT(chunk);
+  return chunk;
+}
+
+static void umb_ecs_chunk_free(byte* chunk) {
+#if defined(_MSC_VER)
+  _aligned_free(chunk);
+#else
+  free(chunk);
+#endif
+}
+
+static u32 umb_ecs_align(u32 offset, u32 align) {
+  return (offset + align - 1) & ~(align - 1);
+}
+
+umb_ecs_world umb_ecs_world_create() {
+  return {};
+}
+
+void umb_ecs_world_destroy(umb_ecs_world* world) {
+  for (u32 a = 0; a < world->n_archetypes; ++a) {
+    umb_ecs_archetype* archetype = &world->archetypes[a];
+    for (u32 c = 0; c < archetype->n_chunks; ++c) umb_ecs_chunk_free(archetype->chunks[c]);
+    free(archetype->chunks);
+  }
+  free(world->archetypes);
+  free(world->records);
+  free(world->free_records);
+  *world = {};
+}
+
+umb_component umb_ecs_register_component(umb_ecs_world* world, u32 size, u32 align) {
+  UMB_ASSERT(world->n_components < UMB_ECS_MAX_COMPONENTS);
+  UMB_ASSERT(align > 0 && align <= CHUNK_ALIGN && (align & (align - 1)) == 0);
+  umb_component component            = world->n_components++;
+  world->component_sizes[component]  = size;
+  world->component_aligns[component] = align;
+  return component;
+}
+
+// lays out the entity ids and one array per component, taking as many rows as fit in a chunk
+static void umb_ecs_archetype_layout(const umb_ecs_world* world, umb_ecs_archetype* archetype) {
+  u32 row_size = sizeof(umb_entity);
+  for (u32 c = 0; c < world->n_components; ++c) {
+    if (archetype->mask & UMB_COMPONENT_BIT(c)) row_size += world->component_sizes[c];
+  }
+
+  u32 capacity = UMB_ECS_CHUNK_SIZE / row_size;
+  for (;; --capacity) {
+    UMB_ASSERT(capacity > 0);
+    u32 offset = capacity * sizeof(umb_entity);
+    for (u32 c = 0; c < UMB_ECS_MAX_COMPONENTS; ++c) {
+      if (!(archetype->mask & UMB_COMPONENT_BIT(c))) {
+        archetype->offsets[c] = MISSING_COMPONENT;
+        continue;
+      }
+      offset                = umb_ecs_align(offset, world->component_aligns[c]);
+      archetype->offsets[c] = offset;
+      offset += capacity * world->component_sizes[c];
+    }
+    if (offset <= UMB_ECS_CHUNK_SIZE) break;
+  }
+  archetype->chunk_capacity = capacity;
+}
+
+// scenes hold few distinct archetypes, a scan finds them
+static u32 umb_ecs_archetype_get(umb_ecs_world* world, umb_component_mask mask) {
+  for (u32 a = 0; a < world->n_archetypes; ++a) {
+    if (world->archetypes[a].mask == mask) return a;
+  }
+  umb_ecs_grow(&world->archetypes, &world->archetypes_cap, world->n_archetypes + 1);
+
+  u32                a         = world->n_archetypes++;
+  umb_ecs_archetype* archetype = &world->archetypes[a];
+  *archetype                   = {.mask = mask};
+  umb_ecs_archetype_layout(world, archetype);
+  return a;
+}
+
+static byte* umb_ecs_component_ptr(const umb_ecs_world* world, u32 archetype_idx, u32 row, u32 c) {
+  const umb_ecs_archetype* archetype = &world->archetypes[archetype_idx];
+  byte*                    chunk     = archetype->chunks[row / archetype->chunk_capacity];
+  u64                      index     = row % archetype->chunk_capacity;
+  return chunk + archetype->offsets[c] + index * world->component_sizes[c];
+}
+
+static umb_entity* umb_ecs_entity_ptr(const umb_ecs_world* world, u32 archetype_idx, u32 row) {
+  const umb_ecs_archetype* archetype = &world->archetypes[archetype_idx];
+  byte*                    chunk     = archetype->chunks[row / archetype->chunk_capacity];
+  return (umb_entity*)chunk + row % archetype->chunk_capacity;
+}
+
+// appends a zeroed row for the entity
+static u32 umb_ecs_row_push(umb_ecs_world* world, u32 archetype_idx, umb_entity entity) {
+  umb_ecs_archetype* archetype = &world->archetypes[archetype_idx];
+  if (archetype->n_entities == archetype->n_chunks * archetype->chunk_capacity) {
+    umb_ecs_grow(&archetype->chunks, &archetype->chunks_cap, archetype->n_chunks + 1);
+    archetype->chunks[archetype->n_chunks++] = umb_ecs_chunk_alloc();
+  }
+
+  u32 row                                        = archetype->n_entities++;
+  *umb_ecs_entity_ptr(world, archetype_idx, row) = entity;
+  for (u32 c = 0; c < world->n_components; ++c) {
+    if (!(archetype->mask & UMB_COMPONENT_BIT(c))) continue;
+    memset(umb_ecs_component_ptr(world, archetype_idx, row, c), 0, world->component_sizes[c]);
+  }
+  return row;
+}
+
+// the archetype's last row fills the hole, an emptied last chunk is released
+static void umb_ecs_row_remove(umb_ecs_world* world, u32 archetype_idx, u32 row) {
+  umb_ecs_archetype* archetype = &world->archetypes[archetype_idx];
+  u32                last      = --archetype->n_entities;
+  if (row != last) {
+    umb_entity* hole  = umb_ecs_entity_ptr(world, archetype_idx, row);
+    umb_entity  moved = *umb_ecs_entity_ptr(world, archetype_idx, last);
+    *hole             = moved;
+    for (u32 c = 0; c < world->n_components; ++c) {
+      if (!(archetype->mask & UMB_COMPONENT_BIT(c))) continue;
+      memcpy(
+          umb_ecs_component_ptr(world, archetype_idx, row, c),
+          umb_ecs_component_ptr(world, archetype_idx, last, c),
+          world->component_sizes[c]);
+    }
+    world->records[moved & ENTITY_INDEX_MASK].row = row;
+  }
+  if (archetype->n_entities <= (archetype->n_chunks - 1) * archetype->chunk_capacity) {
+    umb_ecs_chunk_free(archetype->chunks[--archetype->n_chunks]);
+  }
+}
+
+umb_entity umb_ecs_create(umb_ecs_world* world, umb_component_mask components) {
+  u32 index;
+  if (world->n_free_records > 0) {
+    index = world->free_records[--world->n_free_records];
+  } else {
+    // the highest index is left out, UMB_ENTITY_NONE would be one of its handles
+    UMB_ASSERT(world->n_records < ENTITY_INDEX_MASK);
+    if (world->n_records == world->records_cap) {
+      umb_ecs_grow(&world->records, &world->records_cap, world->n_records + 1);
+      world->free_records = (u32*)realloc(world->free_records, world->records_cap * sizeof(u32));
+      UMB_ASSERT(world->free_records);
+    }
+    index                            = world->n_records++;
+    world->records[index].generation = 0;
+  }
+
+  umb_ecs_record* record = &world->records[index];
+  umb_entity      entity = (record->generation << ENTITY_INDEX_BITS) | index;
+  record->archetype      = umb_ecs_archetype_get(world, components);
+  record->row            = umb_ecs_row_push(world, record->archetype, entity);
+  return entity;
+}
+
+b32 umb_ecs_alive(const umb_ecs_world* world, umb_entity entity) {
+  u32 index = entity & ENTITY_INDEX_MASK;
+  if (entity == UMB_ENTITY_NONE || index >= world->n_records) return false;
+  const umb_ecs_record* record = &world->records[index];
+  return record->archetype != FREE_RECORD && record->generation == entity >> ENTITY_INDEX_BITS;
+}
+
+void umb_ecs_destroy(umb_ecs_world* world, umb_entity entity) {
+  UMB_ASSERT(umb_ecs_alive(world, entity));
+  u32             index  = entity & ENTITY_INDEX_MASK;
+  umb_ecs_record* record = &world->records[index];
+  umb_ecs_row_remove(world, record->archetype, record->row);
+
+  record->archetype                            = FREE_RECORD;
+  record->generation                           = (record->generation + 1) & GENERATION_MASK;
+  world->free_records[world->n_free_records++] = index;
+}
+
+void* umb_ecs_get(const umb_ecs_world* world, umb_entity entity, umb_component component) {
+  UMB_ASSERT(umb_ecs_alive(world, entity));
+  const umb_ecs_record* record = &world->records[entity & ENTITY_INDEX_MASK];
+  if (!(world->archetypes[record->archetype].mask & UMB_COMPONENT_BIT(component))) return NULL;
+  return umb_ecs_component_ptr(world, record->archetype, record->row, component);
+}
+
+void umb_ecs_set(
+    umb_ecs_world* world,
+    umb_entity     entity,
+    umb_component  component,
+    const void*    value) {
+  void* dst = umb_ecs_get(world, entity, component);
+  UMB_ASSERT(dst);
+  memcpy(dst, value, world->component_sizes[component]);
+}
+
+// copies the components both archetypes have, the others start zeroed
+static void umb_ecs_move(umb_ecs_world* world, umb_entity entity, umb_component_mask mask) {
+  umb_ecs_record* record = &world->records[entity & ENTITY_INDEX_MASK];
+  u32             from   = record->archetype;
+  u32             row    = record->row;
+  u32             to     = umb_ecs_archetype_get(world, mask);
+  u32             to_row = umb_ecs_row_push(world, to, entity);
+
+  umb_component_mask shared = world->archetypes[from].mask & mask;
+  for (u32 c = 0; c < world->n_components; ++c) {
+    if (!(shared & UMB_COMPONENT_BIT(c))) continue;
+    memcpy(
+        umb_ecs_component_ptr(world, to, to_row, c),
+        umb_ecs_component_ptr(world, from, row, c),
+        world->component_sizes[c]);
+  }
+  umb_ecs_row_remove(world, from, row);
+  record->archetype = to;
+  record->row       = to_row;
+}
+
+void umb_ecs_add(umb_ecs_world* world, umb_entity entity, umb_component component) {
+  UMB_ASSERT(umb_ecs_alive(world, entity));
+  u32                archetype = world->records[entity & ENTITY_INDEX_MASK].archetype;
+  umb_component_mask mask      = world->archetypes[archetype].mask;
+  if (mask & UMB_COMPONENT_BIT(component)) return;
+  umb_ecs_move(world, entity, mask | UMB_COMPONENT_BIT(component));
+}
+
+void umb_ecs_remove(umb_ecs_world* world, umb_entity entity, umb_component component) {
+  UMB_ASSERT(umb_ecs_alive(world, entity));
+  u32                archetype = world->records[entity & ENTITY_INDEX_MASK].archetype;
+  umb_component_mask mask      = world->archetypes[archetype].mask;
+  if (!(mask & UMB_COMPONENT_BIT(component))) return;
+  umb_ecs_move(world, entity, mask & ~UMB_COMPONENT_BIT(component));
+}
+
+umb_ecs_query umb_ecs_query_create(umb_component_mask all, umb_component_mask none) {
+  return {.all = all, .none = none};
+}
+
+void umb_ecs_query_destroy(umb_ecs_query* query) {
+  free(query->archetypes);
+  free(query->chunks);
+  free(query->jobs);
+  *query = {};
+}
+
+static void umb_ecs_query_refresh(umb_ecs_world* world, umb_ecs_query* query) {
+  for (; query->n_checked < world->n_archetypes; ++query->n_checked) {
+    umb_component_mask mask = world->archetypes[query->n_checked].mask;
+    if ((mask & query->all) != query->all || (mask & query->none)) continue;
+    umb_ecs_grow(&query->archetypes, &query->archetypes_cap, query->n_archetypes + 1);
+    query->archetypes[query->n_archetypes++] = query->n_checked;
+  }
+}
+
+u32 umb_ecs_query_count(umb_ecs_world* world, umb_ecs_query* query) {
+  umb_ecs_query_refresh(world, query);
+  u32 n = 0;
+  for (u32 a = 0; a < query->n_archetypes; ++a) {
+    n += world->archetypes[query->archetypes[a]].n_entities;
+  }
+  return n;
+}
+
+u32 umb_ecs_query_chunk_count(umb_ecs_world* world, umb_ecs_query* query) {
+  umb_ecs_query_refresh(world, query);
+  u32 n = 0;
+  for (u32 a = 0; a < query->n_archetypes; ++a) {
+    n += world->archetypes[query->archetypes[a]].n_chunks;
+  }
+  return n;
+}
+
+umb_ecs_iter umb_ecs_query_iter(umb_ecs_world* world, umb_ecs_query* query) {
+  umb_ecs_query_refresh(world, query);
+  return {.world = world, .query = query};
+}
+
+b32 umb_ecs_iter_next(umb_ecs_iter* iter, umb_ecs_chunk* out_chunk) {
+  for (; iter->archetype < iter->query->n_archetypes; ++iter->archetype, iter->chunk = 0) {
+    const umb_ecs_archetype* archetype =
+        &iter->world->archetypes[iter->query->archetypes[iter->archetype]];
+    if (iter->chunk >= archetype->n_chunks) continue;
+
+    u32 n = archetype->n_entities - iter->chunk * archetype->chunk_capacity;
+    n     = n < archetype->chunk_capacity ? n : archetype->chunk_capacity;
+
+    byte* data = archetype->chunks[iter->chunk++];
+    *out_chunk = {
+        .archetype = archetype,
+        .data      = data,
+        .entities  = (const umb_entity*)data,
+        .n         = n,
+        .first     = iter->first,
+        .index     = iter->index++,
+    };
+    iter->first += n;
+    return true;
+  }
+  return false;
+}
+
+void umb_ecs_query_run(
+    umb_ecs_world*     world,
+    umb_ecs_query*     query,
+    umb_ecs_chunk_proc proc,
+    void*              data) {
+  umb_ecs_chunk chunk;
+  for (umb_ecs_iter it = umb_ecs_query_iter(world, query); umb_ecs_iter_next(&it, &chunk);) {
+    proc(&chunk, data);
+  }
+}
+
+static void umb_ecs_query_job_proc(void* data) {
+  umb_ecs_query_job* job = (umb_ecs_query_job*)data;
+  for (u32 i = 0; i < job->n_chunks; ++i) job->proc(&job->chunks[i], job->data);
+}
+
+void umb_ecs_query_run_parallel(
+    umb_ecs_world*     world,
+    umb_ecs_query*     query,
+    umb_ecs_chunk_proc proc,
+    void*              data,
+    u32                min_job_entities) {
+  u32 n_chunks = umb_ecs_query_chunk_count(world, query);
+  if (n_chunks == 0) return;
+  umb_ecs_grow(&query->chunks, &query->chunks_cap, n_chunks);
+  umb_ecs_grow(&query->jobs, &query->jobs_cap, n_chunks);
+
+  // chunks are never empty, so every chunk either starts a job or joins the one before it
+  u32           n_jobs    = 0;
+  u32           n_batched = 0;
+  umb_ecs_chunk chunk;
+  for (umb_ecs_iter it = umb_ecs_query_iter(world, query); umb_ecs_iter_next(&it, &chunk);) {
+    query->chunks[chunk.index] = chunk;
+    if (n_batched == 0) {
+      query->jobs[n_jobs++] = {
+          .chunks = &query->chunks[chunk.index],
+          .proc   = proc,
+          .data   = data,
+      };
+    }
+    query->jobs[n_jobs - 1].n_chunks++;
+    n_batched += chunk.n;
+    if (n_batched >= min_job_entities) n_batched = 0;
+  }
+
+  umb_job_counter counter = {};
+  for (u32 j = 1; j < n_jobs; ++j) umb_job_run(umb_ecs_query_job_proc, &query->jobs[j], &counter);
+  umb_ecs_query_job_proc(&query->jobs[0]);
+  umb_job_wait(&counter);
+}
+
+void* umb_ecs_chunk_column(const umb_ecs_chunk* chunk, umb_component component) {
+  u32 offset = chunk->archetype->offsets[component];
+  return offset == MISSING_COMPONENT ? NULL : chunk->data + offset;
+}
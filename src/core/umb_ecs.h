@@ -0,0 +1,157 @@
+#pragma once
+
+#include <core/umb_common.h>
+
+// Archetype based entity storage. Entities with the same set of components share an archetype,
+// which keeps them in fixed size chunks, each component as its own array inside the chunk. Rows
+// stay dense: destroying an entity moves the archetype's last one into its place, and adding or
+// removing a component moves the entity to the matching archetype. Queries match archetypes by
+// their components and hand out whole chunks, so systems walk plain arrays, and chunks can be
+// processed in parallel on the job system. The world must not change structurally while a query
+// runs.
+
+typedef u32 umb_entity;
+typedef u32 umb_component;
+typedef u64 umb_component_mask;
+
+static constexpr umb_entity UMB_ENTITY_NONE        = ~0u;
+static constexpr u32        UMB_ECS_MAX_COMPONENTS = 64;
+static constexpr u32        UMB_ECS_CHUNK_SIZE     = 16 * 1024;
+
+#define UMB_COMPONENT_BIT(c) ((umb_component_mask)1 << (c))
+
+struct umb_ecs_archetype {
+  umb_component_mask mask;
+  // byte offset of each component's array in a chunk, ~0u for components it lacks
+  u32                offsets[UMB_ECS_MAX_COMPONENTS];
+  u32                chunk_capacity;
+  byte**             chunks;
+  u32                n_chunks;
+  u32                chunks_cap;
+  // every chunk but the last is full
+  u32                n_entities;
+};
+
+struct umb_ecs_record {
+  u32 archetype;
+  u32 row;
+  u32 generation;
+};
+
+struct umb_ecs_world {
+  u32 component_sizes[UMB_ECS_MAX_COMPONENTS];
+  u32 component_aligns[UMB_ECS_MAX_COMPONENTS];
+  u32 n_components;
+
+  umb_ecs_archetype* archetypes;
+  u32                n_archetypes;
+  u32                archetypes_cap;
+
+  umb_ecs_record* records;
+  u32*            free_records;
+  u32             n_records;
+  u32             n_free_records;
+  u32             records_cap;
+};
+
+// a run of entities of one archetype
+struct umb_ecs_chunk {
+  const umb_ecs_archetype* archetype;
+  byte*                    data;
+  const umb_entity*        entities;
+  u32                      n;
+  // position of the chunk's first entity and of the chunk itself among everything the query
+  // matched, for systems writing into flat per-entity or per-chunk arrays
+  u32                      first;
+  u32                      index;
+};
+
+typedef void (*umb_ecs_chunk_proc)(const umb_ecs_chunk* chunk, void* data);
+
+// a run of consecutive chunks handled by one job
+struct umb_ecs_query_job {
+  const umb_ecs_chunk* chunks;
+  u32                  n_chunks;
+  umb_ecs_chunk_proc   proc;
+  void*                data;
+};
+
+// the matching archetypes are cached, archetypes created since the last run are checked on the
+// next one
+struct umb_ecs_query {
+  umb_component_mask all;
+  umb_component_mask none;
+  u32*               archetypes;
+  u32                n_archetypes;
+  u32                archetypes_cap;
+  u32                n_checked;
+
+  umb_ecs_chunk*     chunks;
+  u32                chunks_cap;
+  umb_ecs_query_job* jobs;
+  u32                jobs_cap;
+};
+
+struct umb_ecs_iter {
+  umb_ecs_world* world;
+  umb_ecs_query* query;
+  u32            archetype;
+  u32            chunk;
+  u32            first;
+  u32            index;
+};
+
+umb_ecs_world umb_ecs_world_create();
+void          umb_ecs_world_destroy(umb_ecs_world* world);
+
+// align may be at most 64. components of size 0 are tags, they take no storage.
+umb_component umb_ecs_register_component(umb_ecs_world* world, u32 size, u32 align);
+
+// the components start out zeroed
+umb_entity umb_ecs_create(umb_ecs_world* world, umb_component_mask components);
+void       umb_ecs_destroy(umb_ecs_world* world, umb_entity entity);
+b32        umb_ecs_alive(const umb_ecs_world* world, umb_entity entity);
+
+// NULL when the entity lacks the component. valid until the world changes structurally.
+void* umb_ecs_get(const umb_ecs_world* world, umb_entity entity, umb_component component);
+void  umb_ecs_set(
+    umb_ecs_world* world,
+    umb_entity     entity,
+    umb_component  component,
+    const void*    value);
+// adding a component the entity has, or removing one it lacks, does nothing
+void umb_ecs_add(umb_ecs_world* world, umb_entity entity, umb_component component);
+void umb_ecs_remove(umb_ecs_world* world, umb_entity entity, umb_component component);
+
+// entities with every component of `all` and none of `none`
+umb_ecs_query umb_ecs_query_create(umb_component_mask all, umb_component_mask none);
+void          umb_ecs_query_destroy(umb_ecs_query* query);
+
+u32 umb_ecs_query_count(umb_ecs_world* world, umb_ecs_query* query);
+u32 umb_ecs_query_chunk_count(umb_ecs_world* world, umb_ecs_query* query);
+
+// for (umb_ecs_iter it = umb_ecs_query_iter(world, query); umb_ecs_iter_next(&it, &chunk);)
+umb_ecs_iter umb_ecs_query_iter(umb_ecs_world* world, umb_ecs_query* query);
+b32          umb_ecs_iter_next(umb_ecs_iter* iter, umb_ecs_chunk* out_chunk);
+
+void umb_ecs_query_run(
+    umb_ecs_world*     world,
+    umb_ecs_query*     query,
+    umb_ecs_chunk_proc proc,
+    void*              data);
+// consecutive chunks are batched into jobs of at least `min_job_entities` entities, the first
+// batch runs on the calling thread. returns when all of them have finished. `proc` must only
+// write to its own chunk or to ranges derived from the chunk's position.
+void umb_ecs_query_run_parallel(
+    umb_ecs_world*     world,
+    umb_ecs_query*     query,
+    umb_ecs_chunk_proc proc,
+    void*              data,
+    u32                min_job_entities);
+
+// the chunk's array of `component`, NULL when its archetype lacks it
+void* umb_ecs_chunk_column(const umb_ecs_chunk* chunk, umb_component component);
+
+template <typename T> T* umb_ecs_column(const umb_ecs_chunk* chunk, umb_component component) {
+  return (T*)umb_ecs_chunk_column(chunk, component);
+}
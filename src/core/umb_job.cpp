@@ -0,0 +1,114 @@
+#include <condition_variable>
+#include <core/umb_job.h>
+#include <mutex>
+#include <thread>
+
+struct umb_job {
+  umb_job_proc     proc;
+  void*            data;
+  umb_job_counter* counter;
+};
+
+struct umb_job_system {
+  std::thread workers[UMB_JOB_MAX_WORKERS];
+  u32         n_workers;
+
+  // guarded by mutex. `queued` wakes workers, `finished` wakes threads waiting on a counter.
+  std::mutex              mutex;
+  std::condition_variable queued;
+  std::condition_variable finished;
+  b32                     quit;
+  umb_job                 jobs[UMB_JOB_MAX_QUEUED];
+  u32                     head;
+  u32                     n_jobs;
+};
+
+static umb_job_system _jobs;
+
+static umb_job umb_job_pop() {
+  umb_job job = _jobs.jobs[_jobs.head];
+  _jobs.head  = (_jobs.head + 1) % UMB_JOB_MAX_QUEUED;
+  _jobs.n_jobs--;
+  return job;
+}
+
+static void umb_job_execute(umb_job job) {
+  job.proc(job.data);
+  if (job.counter->pending.fetch_sub(1) == 1) {
+    // notified under the lock so a waiter cannot check the counter and then miss the wakeup
+    std::lock_guard<std::mutex> lock(_jobs.mutex);
+    _jobs.finished.notify_all();
+  }
+}
+
+static void umb_job_worker_main() {
+  for (;;) {
+    umb_job job;
+    {
+      std::unique_lock<std::mutex> lock(_jobs.mutex);
+      _jobs.queued.wait(lock, [] { return _jobs.quit || _jobs.n_jobs > 0; });
+      if (_jobs.n_jobs == 0) return;
+      job = umb_job_pop();
+    }
+    umb_job_execute(job);
+  }
+}
+
+void umb_job_system_init(u32 n_workers) {
+  n_workers       = n_workers > UMB_JOB_MAX_WORKERS ? UMB_JOB_MAX_WORKERS : n_workers;
+  _jobs.n_workers = n_workers;
+  _jobs.quit      = false;
+  for (u32 i = 0; i < n_workers; ++i) _jobs.workers[i] = std::thread(umb_job_worker_main);
+}
+
+// queued jobs are drained before the workers exit
+void umb_job_system_shutdown() {
+  {
+    std::lock_guard<std::mutex> lock(_jobs.mutex);
+    _jobs.quit = true;
+  }
+  _jobs.queued.notify_all();
+  for (u32 i = 0; i < _jobs.n_workers; ++i) _jobs.workers[i].join();
+  _jobs.n_workers = 0;
+}
+
+u32 umb_job_system_worker_count() {
+  return _jobs.n_workers;
+}
+
+u32 umb_job_system_default_worker_count() {
+  u32 n_cores = std::thread::hardware_concurrency();
+  return n_cores > 1 ? n_cores - 1 : 0;
+}
+
+void umb_job_run(umb_job_proc proc, void* data, umb_job_counter* counter) {
+  umb_job job = {.proc = proc, .data = data, .counter = counter};
+  counter->pending.fetch_add(1);
+  {
+    std::lock_guard<std::mutex> lock(_jobs.mutex);
+    if (_jobs.n_jobs < UMB_JOB_MAX_QUEUED) {
+      _jobs.jobs[(_jobs.head + _jobs.n_jobs) % UMB_JOB_MAX_QUEUED] = job;
+      _jobs.n_jobs++;
+      job.proc = NULL;
+    }
+  }
+  if (job.proc) {
+    umb_job_execute(job);
+  } else {
+    _jobs.queued.notify_one();
+  }
+}
+
+void umb_job_wait(umb_job_counter* counter) {
+  while (counter->pending.load() > 0) {
+    umb_job job;
+    {
+      std::unique_lock<std::mutex> lock(_jobs.mutex);
+      _jobs.finished.wait(lock, [=] { return counter->pending.load() == 0 || _jobs.n_jobs > 0; });
+      if (counter->pending.load() == 0) return;
+      job = umb_job_pop();
+    }
+    // may belong to another group, it still has to run before the queue gets to ours
+    umb_job_execute(job);
+  }
+}
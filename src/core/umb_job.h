@@ -0,0 +1,30 @@
+#pragma once
+
+#include <atomic>
+#include <core/umb_common.h>
+
+// Fixed pool of worker threads pulling jobs from one shared queue. A job is a function and a
+// pointer, grouped under a counter that a waiting thread can block on. Waiting threads run queued
+// jobs themselves, so everything completes even with no workers at all.
+
+static constexpr u32 UMB_JOB_MAX_WORKERS = 64;
+static constexpr u32 UMB_JOB_MAX_QUEUED  = 4096;
+
+typedef void (*umb_job_proc)(void* data);
+
+// number of jobs of a group that have not finished yet
+struct umb_job_counter {
+  std::atomic<u32> pending;
+};
+
+void umb_job_system_init(u32 n_workers);
+void umb_job_system_shutdown();
+u32  umb_job_system_worker_count();
+
+// one worker per core, the thread that waits on the jobs covers the last one
+u32 umb_job_system_default_worker_count();
+
+// a full queue runs the job on the calling thread instead
+void umb_job_run(umb_job_proc proc, void* data, umb_job_counter* counter);
+// runs queued jobs on the calling thread until every job counted by `counter` has finished
+void umb_job_wait(umb_job_counter* counter);
@@ -0,0 +1,865 @@
+#include <core/umb_math.h>
+#include <math.h>
+#include <string.h>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+// every level is compiled regardless of the target flags and used when the CPU reports it
+#define UMB_MATH_X86 1
+#define UMB_MATH_SSE4_FN __attribute__((target("sse4.1")))
+#define UMB_MATH_AVX2_FN __attribute__((target("avx2,fma")))
+#define UMB_MATH_AVX512_FN __attribute__((target("avx512f")))
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define UMB_MATH_ARM_NEON 1
+#endif
+
+struct umb_math_kernels {
+  umb_math_isa isa;
+  void (*mat4_mul)(const f32* a, const f32* b, f32* out, u32 n);
+  void (*transform_vec4)(
+      const f32*          matrices,
+      u32                 stride,
+      const umb_vec4_soa* in,
+      umb_vec4_soa*       out,
+      u32                 first,
+      u32                 end);
+  void (*transform_aabbs)(
+      const f32*          matrices,
+      u32                 stride,
+      const umb_aabb_soa* in,
+      umb_aabb_soa*       out,
+      u32                 first,
+      u32                 end);
+  void (*transform_spheres)(
+      const f32*            matrices,
+      u32                   stride,
+      const umb_sphere_soa* in,
+      umb_sphere_soa*       out,
+      u32                   first,
+      u32                   end);
+  u32 (*cull_spheres)(
+      const umb_frustum_soa* frustum,
+      const umb_sphere_soa*  spheres,
+      u32                    first,
+      u32                    end,
+      u32*                   out_visible);
+};
+
+static void umb_mat4_mul_scalar(const f32* a, const f32* b, f32* out, u32 n) {
+  for (u32 i = 0; i < n; ++i, a += 16, b += 16, out += 16) {
+    for (u32 c = 0; c < 4; ++c) {
+      // read before writing, out may be b
+      f32 col[4];
+      memcpy(col, b + c * 4, sizeof(col));
+      for (u32 r = 0; r < 4; ++r) {
+        out[c * 4 + r] = a[r] * col[0] + a[4 + r] * col[1] + a[8 + r] * col[2] + a[12 + r] * col[3];
+      }
+    }
+  }
+}
+
+static void umb_transform_vec4_scalar(
+    const f32*          matrices,
+    u32                 stride,
+    const umb_vec4_soa* in,
+    umb_vec4_soa*       out,
+    u32                 first,
+    u32                 end) {
+  for (u32 i = first; i < end; ++i) {
+    const f32* m = matrices + (u64)i * stride;
+    f32        x = in->x[i], y = in->y[i], z = in->z[i], w = in->w[i];
+    out->x[i]    = m[0] * x + m[4] * y + m[8] * z + m[12] * w;
+    out->y[i]    = m[1] * x + m[5] * y + m[9] * z + m[13] * w;
+    out->z[i]    = m[2] * x + m[6] * y + m[10] * z + m[14] * w;
+    out->w[i]    = m[3] * x + m[7] * y + m[11] * z + m[15] * w;
+  }
+}
+
+// transforms the center and sums the extents projected onto each axis
+static void umb_transform_aabbs_scalar(
+    const f32*          matrices,
+    u32                 stride,
+    const umb_aabb_soa* in,
+    umb_aabb_soa*       out,
+    u32                 first,
+    u32                 end) {
+  for (u32 i = first; i < end; ++i) {
+    const f32* m = matrices + (u64)i * stride;
+    f32        c[3], e[3];
+    c[0] = (in->min_x[i] + in->max_x[i]) * 0.5f;
+    c[1] = (in->min_y[i] + in->max_y[i]) * 0.5f;
+    c[2] = (in->min_z[i] + in->max_z[i]) * 0.5f;
+    e[0] = (in->max_x[i] - in->min_x[i]) * 0.5f;
+    e[1] = (in->max_y[i] - in->min_y[i]) * 0.5f;
+    e[2] = (in->max_z[i] - in->min_z[i]) * 0.5f;
+
+    f32 wc[3], we[3];
+    for (u32 j = 0; j < 3; ++j) {
+      wc[j] = m[j] * c[0] + m[4 + j] * c[1] + m[8 + j] * c[2] + m[12 + j];
+      we[j] = fabsf(m[j]) * e[0] + fabsf(m[4 + j]) * e[1] + fabsf(m[8 + j]) * e[2];
+    }
+    out->min_x[i] = wc[0] - we[0];
+    out->min_y[i] = wc[1] - we[1];
+    out->min_z[i] = wc[2] - we[2];
+    out->max_x[i] = wc[0] + we[0];
+    out->max_y[i] = wc[1] + we[1];
+    out->max_z[i] = wc[2] + we[2];
+  }
+}
+
+static void umb_transform_spheres_scalar(
+    const f32*            matrices,
+    u32                   stride,
+    const umb_sphere_soa* in,
+    umb_sphere_soa*       out,
+    u32                   first,
+    u32                   end) {
+  for (u32 i = first; i < end; ++i) {
+    const f32* m  = matrices + (u64)i * stride;
+    f32        x  = in->x[i], y = in->y[i], z = in->z[i];
+    f32        s0 = m[0] * m[0] + m[1] * m[1] + m[2] * m[2];
+    f32        s1 = m[4] * m[4] + m[5] * m[5] + m[6] * m[6];
+    f32        s2 = m[8] * m[8] + m[9] * m[9] + m[10] * m[10];
+    f32        s  = s0 > s1 ? s0 : s1;
+    s             = s > s2 ? s : s2;
+
+    out->x[i] = m[0] * x + m[4] * y + m[8] * z + m[12];
+    out->y[i] = m[1] * x + m[5] * y + m[9] * z + m[13];
+    out->z[i] = m[2] * x + m[6] * y + m[10] * z + m[14];
+    out->r[i] = in->r[i] * sqrtf(s);
+  }
+}
+
+static u32 umb_cull_spheres_scalar(
+    const umb_frustum_soa* f,
+    const umb_sphere_soa*  s,
+    u32                    first,
+    u32                    end,
+    u32*                   out_visible) {
+  u32 n_visible = 0;
+  for (u32 i = first; i < end; ++i) {
+    b32 visible = true;
+    for (u32 p = 0; p < UMB_FRUSTUM_PLANES; ++p) {
+      f32 dist = f->nx[p] * s->x[i] + f->ny[p] * s->y[i] + f->nz[p] * s->z[i] + f->d[p];
+      visible  = visible && dist > -s->r[i];
+    }
+    out_visible[n_visible] = i;
+    n_visible += visible ? 1 : 0;
+  }
+  return n_visible;
+}
+
+#if UMB_MATH_X86
+// the products go one matrix at a time, the SoA kernels one element per lane. a lane's matrix is
+// gathered, or broadcast once when every element shares it.
+
+UMB_MATH_SSE4_FN static void umb_mat4_mul_sse4(const f32* a, const f32* b, f32* out, u32 n) {
+  for (u32 i = 0; i < n; ++i, a += 16, b += 16, out += 16) {
+    __m128 a0 = _mm_loadu_ps(a + 0);
+    __m128 a1 = _mm_loadu_ps(a + 4);
+    __m128 a2 = _mm_loadu_ps(a + 8);
+    __m128 a3 = _mm_loadu_ps(a + 12);
+    for (u32 c = 0; c < 4; ++c) {
+      __m128 col = _mm_loadu_ps(b + c * 4);
+      __m128 r   = _mm_mul_ps(a0, _mm_shuffle_ps(col, col, 0x00));
+      r          = _mm_add_ps(r, _mm_mul_ps(a1, _mm_shuffle_ps(col, col, 0x55)));
+      r          = _mm_add_ps(r, _mm_mul_ps(a2, _mm_shuffle_ps(col, col, 0xAA)));
+      r          = _mm_add_ps(r, _mm_mul_ps(a3, _mm_shuffle_ps(col, col, 0xFF)));
+      _mm_storeu_ps(out + c * 4, r);
+    }
+  }
+}
+
+UMB_MATH_SSE4_FN static void umb_mat4_load_sse4(const f32* m, u32 stride, __m128 out[16]) {
+  for (u32 k = 0; k < 16; ++k) {
+    out[k] = _mm_setr_ps(m[k], m[stride + k], m[stride * 2 + k], m[stride * 3 + k]);
+  }
+}
+
+UMB_MATH_SSE4_FN static void umb_transform_vec4_sse4(
+    const f32*          matrices,
+    u32                 stride,
+    const umb_vec4_soa* in,
+    umb_vec4_soa*       out,
+    u32                 first,
+    u32                 end) {
+  __m128 m[16];
+  u32    i = first;
+  for (; i + 4 <= end; i += 4) {
+    if (stride || i == first) umb_mat4_load_sse4(matrices + (u64)i * stride, stride, m);
+    __m128 x      = _mm_loadu_ps(in->x + i);
+    __m128 y      = _mm_loadu_ps(in->y + i);
+    __m128 z      = _mm_loadu_ps(in->z + i);
+    __m128 w      = _mm_loadu_ps(in->w + i);
+    f32*   dst[4] = {out->x, out->y, out->z, out->w};
+    for (u32 j = 0; j < 4; ++j) {
+      __m128 r = _mm_add_ps(
+          _mm_add_ps(_mm_mul_ps(m[j], x), _mm_mul_ps(m[4 + j], y)),
+          _mm_add_ps(_mm_mul_ps(m[8 + j], z), _mm_mul_ps(m[12 + j], w)));
+      _mm_storeu_ps(dst[j] + i, r);
+    }
+  }
+  umb_transform_vec4_scalar(matrices, stride, in, out, i, end);
+}
+
+UMB_MATH_SSE4_FN static void umb_transform_aabbs_sse4(
+    const f32*          matrices,
+    u32                 stride,
+    const umb_aabb_soa* in,
+    umb_aabb_soa*       out,
+    u32                 first,
+    u32                 end) {
+  __m128 m[16];
+  __m128 half = _mm_set1_ps(0.5f);
+  __m128 sign = _mm_set1_ps(-0.f);
+  u32    i    = first;
+  for (; i + 4 <= end; i += 4) {
+    if (stride || i == first) umb_mat4_load_sse4(matrices + (u64)i * stride, stride, m);
+    __m128 lo[3] = {
+        _mm_loadu_ps(in->min_x + i),
+        _mm_loadu_ps(in->min_y + i),
+        _mm_loadu_ps(in->min_z + i),
+    };
+    __m128 hi[3] = {
+        _mm_loadu_ps(in->max_x + i),
+        _mm_loadu_ps(in->max_y + i),
+        _mm_loadu_ps(in->max_z + i),
+    };
+    __m128 c[3], e[3];
+    for (u32 k = 0; k < 3; ++k) {
+      c[k] = _mm_mul_ps(_mm_add_ps(lo[k], hi[k]), half);
+      e[k] = _mm_mul_ps(_mm_sub_ps(hi[k], lo[k]), half);
+    }
+
+    f32* out_min[3] = {out->min_x, out->min_y, out->min_z};
+    f32* out_max[3] = {out->max_x, out->max_y, out->max_z};
+    for (u32 j = 0; j < 3; ++j) {
+      __m128 wc = _mm_add_ps(
+          _mm_add_ps(_mm_mul_ps(m[j], c[0]), _mm_mul_ps(m[4 + j], c[1])),
+          _mm_add_ps(_mm_mul_ps(m[8 + j], c[2]), m[12 + j]));
+      __m128 we = _mm_add_ps(
+          _mm_add_ps(
+              _mm_mul_ps(_mm_andnot_ps(sign, m[j]), e[0]),
+              _mm_mul_ps(_mm_andnot_ps(sign, m[4 + j]), e[1])),
+          _mm_mul_ps(_mm_andnot_ps(sign, m[8 + j]), e[2]));
+      _mm_storeu_ps(out_min[j] + i, _mm_sub_ps(wc, we));
+      _mm_storeu_ps(out_max[j] + i, _mm_add_ps(wc, we));
+    }
+  }
+  umb_transform_aabbs_scalar(matrices, stride, in, out, i, end);
+}
+
+UMB_MATH_SSE4_FN static void umb_transform_spheres_sse4(
+    const f32*            matrices,
+    u32                   stride,
+    const umb_sphere_soa* in,
+    umb_sphere_soa*       out,
+    u32                   first,
+    u32                   end) {
+  __m128 m[16];
+  u32    i = first;
+  for (; i + 4 <= end; i += 4) {
+    if (stride || i == first) umb_mat4_load_sse4(matrices + (u64)i * stride, stride, m);
+    __m128 x = _mm_loadu_ps(in->x + i);
+    __m128 y = _mm_loadu_ps(in->y + i);
+    __m128 z = _mm_loadu_ps(in->z + i);
+    __m128 r = _mm_loadu_ps(in->r + i);
+
+    __m128 s[3];
+    for (u32 k = 0; k < 3; ++k) {
+      s[k] = _mm_add_ps(
+          _mm_add_ps(_mm_mul_ps(m[k * 4], m[k * 4]), _mm_mul_ps(m[k * 4 + 1], m[k * 4 + 1])),
+          _mm_mul_ps(m[k * 4 + 2], m[k * 4 + 2]));
+    }
+    __m128 scale = _mm_sqrt_ps(_mm_max_ps(_mm_max_ps(s[0], s[1]), s[2]));
+
+    f32* dst[3] = {out->x, out->y, out->z};
+    for (u32 j = 0; j < 3; ++j) {
+      __m128 wc = _mm_add_ps(
+          _mm_add_ps(_mm_mul_ps(m[j], x), _mm_mul_ps(m[4 + j], y)),
+          _mm_add_ps(_mm_mul_ps(m[8 + j], z), m[12 + j]));
+      _mm_storeu_ps(dst[j] + i, wc);
+    }
+    _mm_storeu_ps(out->r + i, _mm_mul_ps(r, scale));
+  }
+  umb_transform_spheres_scalar(matrices, stride, in, out, i, end);
+}
+
+UMB_MATH_SSE4_FN static u32 umb_cull_spheres_sse4(
+    const umb_frustum_soa* f,
+    const umb_sphere_soa*  s,
+    u32                    first,
+    u32                    end,
+    u32*                   out_visible) {
+  u32    n_visible = 0;
+  u32    i         = first;
+  __m128 zero      = _mm_setzero_ps();
+  for (; i + 4 <= end; i += 4) {
+    __m128 x     = _mm_loadu_ps(s->x + i);
+    __m128 y     = _mm_loadu_ps(s->y + i);
+    __m128 z     = _mm_loadu_ps(s->z + i);
+    __m128 neg_r = _mm_sub_ps(zero, _mm_loadu_ps(s->r + i));
+
+    __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+    for (u32 p = 0; p < UMB_FRUSTUM_PLANES; ++p) {
+      __m128 dist = _mm_add_ps(
+          _mm_add_ps(_mm_mul_ps(_mm_set1_ps(f->nx[p]), x), _mm_mul_ps(_mm_set1_ps(f->ny[p]), y)),
+          _mm_add_ps(_mm_mul_ps(_mm_set1_ps(f->nz[p]), z), _mm_set1_ps(f->d[p])));
+      inside = _mm_and_ps(inside, _mm_cmpgt_ps(dist, neg_r));
+    }
+
+    u32 mask = (u32)_mm_movemask_ps(inside);
+    for (u32 lane = 0; lane < 4; ++lane) {
+      out_visible[n_visible] = i + lane;
+      n_visible += (mask >> lane) & 1;
+    }
+  }
+  return n_visible + umb_cull_spheres_scalar(f, s, i, end, out_visible + n_visible);
+}
+
+// two columns per register
+UMB_MATH_AVX2_FN static void umb_mat4_mul_avx2(const f32* a, const f32* b, f32* out, u32 n) {
+  for (u32 i = 0; i < n; ++i, a += 16, b += 16, out += 16) {
+    __m256 a0  = _mm256_broadcast_ps((const __m128*)(a + 0));
+    __m256 a1  = _mm256_broadcast_ps((const __m128*)(a + 4));
+    __m256 a2  = _mm256_broadcast_ps((const __m128*)(a + 8));
+    __m256 a3  = _mm256_broadcast_ps((const __m128*)(a + 12));
+    __m256 b01 = _mm256_loadu_ps(b);
+    __m256 b23 = _mm256_loadu_ps(b + 8);
+
+    __m256 r01 = _mm256_mul_ps(a0, _mm256_shuffle_ps(b01, b01, 0x00));
+    r01        = _mm256_fmadd_ps(a1, _mm256_shuffle_ps(b01, b01, 0x55), r01);
+    r01        = _mm256_fmadd_ps(a2, _mm256_shuffle_ps(b01, b01, 0xAA), r01);
+    r01        = _mm256_fmadd_ps(a3, _mm256_shuffle_ps(b01, b01, 0xFF), r01);
+    __m256 r23 = _mm256_mul_ps(a0, _mm256_shuffle_ps(b23, b23, 0x00));
+    r23        = _mm256_fmadd_ps(a1, _mm256_shuffle_ps(b23, b23, 0x55), r23);
+    r23        = _mm256_fmadd_ps(a2, _mm256_shuffle_ps(b23, b23, 0xAA), r23);
+    r23        = _mm256_fmadd_ps(a3, _mm256_shuffle_ps(b23, b23, 0xFF), r23);
+    _mm256_storeu_ps(out, r01);
+    _mm256_storeu_ps(out + 8, r23);
+  }
+}
+
+UMB_MATH_AVX2_FN static void umb_mat4_load_avx2(const f32* m, u32 stride, __m256 out[16]) {
+  if (stride == 0) {
+    for (u32 k = 0; k < 16; ++k) out[k] = _mm256_set1_ps(m[k]);
+    return;
+  }
+  __m256i idx = _mm256_mullo_epi32(
+      _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7),
+      _mm256_set1_epi32((i32)stride));
+  for (u32 k = 0; k < 16; ++k) out[k] = _mm256_i32gather_ps(m + k, idx, 4);
+}
+
+UMB_MATH_AVX2_FN static void umb_transform_vec4_avx2(
+    const f32*          matrices,
+    u32                 stride,
+    const umb_vec4_soa* in,
+    umb_vec4_soa*       out,
+    u32                 first,
+    u32                 end) {
+  __m256 m[16];
+  u32    i = first;
+  for (; i + 8 <= end; i += 8) {
+    if (stride || i == first) umb_mat4_load_avx2(matrices + (u64)i * stride, stride, m);
+    __m256 x      = _mm256_loadu_ps(in->x + i);
+    __m256 y      = _mm256_loadu_ps(in->y + i);
+    __m256 z      = _mm256_loadu_ps(in->z + i);
+    __m256 w      = _mm256_loadu_ps(in->w + i);
+    f32*   dst[4] = {out->x, out->y, out->z, out->w};
+    for (u32 j = 0; j < 4; ++j) {
+      __m256 r = _mm256_mul_ps(m[12 + j], w);
+      r        = _mm256_fmadd_ps(m[8 + j], z, r);
+      r        = _mm256_fmadd_ps(m[4 + j], y, r);
+      r        = _mm256_fmadd_ps(m[j], x, r);
+      _mm256_storeu_ps(dst[j] + i, r);
+    }
+  }
+  umb_transform_vec4_scalar(matrices, stride, in, out, i, end);
+}
+
+UMB_MATH_AVX2_FN static void umb_transform_aabbs_avx2(
+    const f32*          matrices,
+    u32                 stride,
+    const umb_aabb_soa* in,
+    umb_aabb_soa*       out,
+    u32                 first,
+    u32                 end) {
+  __m256 m[16];
+  __m256 half = _mm256_set1_ps(0.5f);
+  __m256 sign = _mm256_set1_ps(-0.f);
+  u32    i    = first;
+  for (; i + 8 <= end; i += 8) {
+    if (stride || i == first) umb_mat4_load_avx2(matrices + (u64)i * stride, stride, m);
+    __m256 lo[3] = {
+        _mm256_loadu_ps(in->min_x + i),
+        _mm256_loadu_ps(in->min_y + i),
+        _mm256_loadu_ps(in->min_z + i),
+    };
+    __m256 hi[3] = {
+        _mm256_loadu_ps(in->max_x + i),
+        _mm256_loadu_ps(in->max_y + i),
+        _mm256_loadu_ps(in->max_z + i),
+    };
+    __m256 c[3], e[3];
+    for (u32 k = 0; k < 3; ++k) {
+      c[k] = _mm256_mul_ps(_mm256_add_ps(lo[k], hi[k]), half);
+      e[k] = _mm256_mul_ps(_mm256_sub_ps(hi[k], lo[k]), half);
+    }
+
+    f32* out_min[3] = {out->min_x, out->min_y, out->min_z};
+    f32* out_max[3] = {out->max_x, out->max_y, out->max_z};
+    for (u32 j = 0; j < 3; ++j) {
+      __m256 wc = _mm256_fmadd_ps(m[8 + j], c[2], m[12 + j]);
+      wc        = _mm256_fmadd_ps(m[4 + j], c[1], wc);
+      wc        = _mm256_fmadd_ps(m[j], c[0], wc);
+      __m256 we = _mm256_mul_ps(_mm256_andnot_ps(sign, m[8 + j]), e[2]);
+      we        = _mm256_fmadd_ps(_mm256_andnot_ps(sign, m[4 + j]), e[1], we);
+      we        = _mm256_fmadd_ps(_mm256_andnot_ps(sign, m[j]), e[0], we);
+      _mm256_storeu_ps(out_min[j] + i, _mm256_sub_ps(wc, we));
+      _mm256_storeu_ps(out_max[j] + i, _mm256_add_ps(wc, we));
+    }
+  }
+  umb_transform_aabbs_scalar(matrices, stride, in, out, i, end);
+}
+
+UMB_MATH_AVX2_FN static void umb_transform_spheres_avx2(
+    const f32*            matrices,
+    u32                   stride,
+    const umb_sphere_soa* in,
+    umb_sphere_soa*       out,
+    u32                   first,
+    u32                   end) {
+  __m256 m[16];
+  u32    i = first;
+  for (; i + 8 <= end; i += 8) {
+    if (stride || i == first) umb_mat4_load_avx2(matrices + (u64)i * stride, stride, m);
+    __m256 x = _mm256_loadu_ps(in->x + i);
+    __m256 y = _mm256_loadu_ps(in->y + i);
+    __m256 z = _mm256_loadu_ps(in->z + i);
+    __m256 r = _mm256_loadu_ps(in->r + i);
+
+    __m256 s[3];
+    for (u32 k = 0; k < 3; ++k) {
+      s[k] = _mm256_mul_ps(m[k * 4 + 2], m[k * 4 + 2]);
+      s[k] = _mm256_fmadd_ps(m[k * 4 + 1], m[k * 4 + 1], s[k]);
+      s[k] = _mm256_fmadd_ps(m[k * 4], m[k * 4], s[k]);
+    }
+    __m256 scale = _mm256_sqrt_ps(_mm256_max_ps(_mm256_max_ps(s[0], s[1]), s[2]));
+
+    f32* dst[3] = {out->x, out->y, out->z};
+    for (u32 j = 0; j < 3; ++j) {
+      __m256 wc = _mm256_fmadd_ps(m[8 + j], z, m[12 + j]);
+      wc        = _mm256_fmadd_ps(m[4 + j], y, wc);
+      wc        = _mm256_fmadd_ps(m[j], x, wc);
+      _mm256_storeu_ps(dst[j] + i, wc);
+    }
+    _mm256_storeu_ps(out->r + i, _mm256_mul_ps(r, scale));
+  }
+  umb_transform_spheres_scalar(matrices, stride, in, out, i, end);
+}
+
+UMB_MATH_AVX2_FN static u32 umb_cull_spheres_avx2(
+    const umb_frustum_soa* f,
+    const umb_sphere_soa*  s,
+    u32                    first,
+    u32                    end,
+    u32*                   out_visible) {
+  __m256 nx[UMB_FRUSTUM_PLANES], ny[UMB_FRUSTUM_PLANES], nz[UMB_FRUSTUM_PLANES];
+  __m256 d[UMB_FRUSTUM_PLANES];
+  for (u32 p = 0; p < UMB_FRUSTUM_PLANES; ++p) {
+    nx[p] = _mm256_set1_ps(f->nx[p]);
+    ny[p] = _mm256_set1_ps(f->ny[p]);
+    nz[p] = _mm256_set1_ps(f->nz[p]);
+    d[p]  = _mm256_set1_ps(f->d[p]);
+  }
+
+  u32    n_visible = 0;
+  u32    i         = first;
+  __m256 zero      = _mm256_setzero_ps();
+  for (; i + 8 <= end; i += 8) {
+    __m256 x     = _mm256_loadu_ps(s->x + i);
+    __m256 y     = _mm256_loadu_ps(s->y + i);
+    __m256 z     = _mm256_loadu_ps(s->z + i);
+    __m256 neg_r = _mm256_sub_ps(zero, _mm256_loadu_ps(s->r + i));
+
+    __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+    for (u32 p = 0; p < UMB_FRUSTUM_PLANES; ++p) {
+      __m256 dist = _mm256_add_ps(
+          _mm256_add_ps(_mm256_mul_ps(nx[p], x), _mm256_mul_ps(ny[p], y)),
+          _mm256_add_ps(_mm256_mul_ps(nz[p], z), d[p]));
+      inside = _mm256_and_ps(inside, _mm256_cmp_ps(dist, neg_r, _CMP_GT_OQ));
+    }
+
+    u32 mask = (u32)_mm256_movemask_ps(inside);
+    while (mask) {
+      out_visible[n_visible++] = i + __builtin_ctz(mask);
+      mask &= mask - 1;
+    }
+  }
+  return n_visible + umb_cull_spheres_scalar(f, s, i, end, out_visible + n_visible);
+}
+
+// a whole matrix per register
+UMB_MATH_AVX512_FN static void umb_mat4_mul_avx512(const f32* a, const f32* b, f32* out, u32 n) {
+  for (u32 i = 0; i < n; ++i, a += 16, b += 16, out += 16) {
+    __m512 a0 = _mm512_broadcast_f32x4(_mm_loadu_ps(a + 0));
+    __m512 a1 = _mm512_broadcast_f32x4(_mm_loadu_ps(a + 4));
+    __m512 a2 = _mm512_broadcast_f32x4(_mm_loadu_ps(a + 8));
+    __m512 a3 = _mm512_broadcast_f32x4(_mm_loadu_ps(a + 12));
+    __m512 bv = _mm512_loadu_ps(b);
+
+    __m512 r = _mm512_mul_ps(a0, _mm512_permute_ps(bv, 0x00));
+    r        = _mm512_fmadd_ps(a1, _mm512_permute_ps(bv, 0x55), r);
+    r        = _mm512_fmadd_ps(a2, _mm512_permute_ps(bv, 0xAA), r);
+    r        = _mm512_fmadd_ps(a3, _mm512_permute_ps(bv, 0xFF), r);
+    _mm512_storeu_ps(out, r);
+  }
+}
+
+UMB_MATH_AVX512_FN static void umb_mat4_load_avx512(const f32* m, u32 stride, __m512 out[16]) {
+  if (stride == 0) {
+    for (u32 k = 0; k < 16; ++k) out[k] = _mm512_set1_ps(m[k]);
+    return;
+  }
+  __m512i idx = _mm512_mullo_epi32(
+      _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15),
+      _mm512_set1_epi32((i32)stride));
+  for (u32 k = 0; k < 16; ++k) out[k] = _mm512_i32gather_ps(idx, m + k, 4);
+}
+
+UMB_MATH_AVX512_FN static void umb_transform_vec4_avx512(
+    const f32*          matrices,
+    u32                 stride,
+    const umb_vec4_soa* in,
+    umb_vec4_soa*       out,
+    u32                 first,
+    u32                 end) {
+  __m512 m[16];
+  u32    i = first;
+  for (; i + 16 <= end; i += 16) {
+    if (stride || i == first) umb_mat4_load_avx512(matrices + (u64)i * stride, stride, m);
+    __m512 x      = _mm512_loadu_ps(in->x + i);
+    __m512 y      = _mm512_loadu_ps(in->y + i);
+    __m512 z      = _mm512_loadu_ps(in->z + i);
+    __m512 w      = _mm512_loadu_ps(in->w + i);
+    f32*   dst[4] = {out->x, out->y, out->z, out->w};
+    for (u32 j = 0; j < 4; ++j) {
+      __m512 r = _mm512_mul_ps(m[12 + j], w);
+      r        = _mm512_fmadd_ps(m[8 + j], z, r);
+      r        = _mm512_fmadd_ps(m[4 + j], y, r);
+      r        = _mm512_fmadd_ps(m[j], x, r);
+      _mm512_storeu_ps(dst[j] + i, r);
+    }
+  }
+  umb_transform_vec4_scalar(matrices, stride, in, out, i, end);
+}
+
+UMB_MATH_AVX512_FN static void umb_transform_aabbs_avx512(
+    const f32*          matrices,
+    u32                 stride,
+    const umb_aabb_soa* in,
+    umb_aabb_soa*       out,
+    u32                 first,
+    u32                 end) {
+  __m512 m[16];
+  __m512 half = _mm512_set1_ps(0.5f);
+  u32    i    = first;
+  for (; i + 16 <= end; i += 16) {
+    if (stride || i == first) umb_mat4_load_avx512(matrices + (u64)i * stride, stride, m);
+    __m512 lo[3] = {
+        _mm512_loadu_ps(in->min_x + i),
+        _mm512_loadu_ps(in->min_y + i),
+        _mm512_loadu_ps(in->min_z + i),
+    };
+    __m512 hi[3] = {
+        _mm512_loadu_ps(in->max_x + i),
+        _mm512_loadu_ps(in->max_y + i),
+        _mm512_loadu_ps(in->max_z + i),
+    };
+    __m512 c[3], e[3];
+    for (u32 k = 0; k < 3; ++k) {
+      c[k] = _mm512_mul_ps(_mm512_add_ps(lo[k], hi[k]), half);
+      e[k] = _mm512_mul_ps(_mm512_sub_ps(hi[k], lo[k]), half);
+    }
+
+    f32* out_min[3] = {out->min_x, out->min_y, out->min_z};
+    f32* out_max[3] = {out->max_x, out->max_y, out->max_z};
+    for (u32 j = 0; j < 3; ++j) {
+      __m512 wc = _mm512_fmadd_ps(m[8 + j], c[2], m[12 + j]);
+      wc        = _mm512_fmadd_ps(m[4 + j], c[1], wc);
+      wc        = _mm512_fmadd_ps(m[j], c[0], wc);
+      __m512 we = _mm512_mul_ps(_mm512_abs_ps(m[8 + j]), e[2]);
+      we        = _mm512_fmadd_ps(_mm512_abs_ps(m[4 + j]), e[1], we);
+      we        = _mm512_fmadd_ps(_mm512_abs_ps(m[j]), e[0], we);
+      _mm512_storeu_ps(out_min[j] + i, _mm512_sub_ps(wc, we));
+      _mm512_storeu_ps(out_max[j] + i, _mm512_add_ps(wc, we));
+    }
+  }
+  umb_transform_aabbs_scalar(matrices, stride, in, out, i, end);
+}
+
+UMB_MATH_AVX512_FN static void umb_transform_spheres_avx512(
+    const f32*            matrices,
+    u32                   stride,
+    const umb_sphere_soa* in,
+    umb_sphere_soa*       out,
+    u32                   first,
+    u32                   end) {
+  __m512 m[16];
+  u32    i = first;
+  for (; i + 16 <= end; i += 16) {
+    if (stride || i == first) umb_mat4_load_avx512(matrices + (u64)i * stride, stride, m);
+    __m512 x = _mm512_loadu_ps(in->x + i);
+    __m512 y = _mm512_loadu_ps(in->y + i);
+    __m512 z = _mm512_loadu_ps(in->z + i);
+    __m512 r = _mm512_loadu_ps(in->r + i);
+
+    __m512 s[3];
+    for (u32 k = 0; k < 3; ++k) {
+      s[k] = _mm512_mul_ps(m[k * 4 + 2], m[k * 4 + 2]);
+      s[k] = _mm512_fmadd_ps(m[k * 4 + 1], m[k * 4 + 1], s[k]);
+      s[k] = _mm512_fmadd_ps(m[k * 4], m[k * 4], s[k]);
+    }
+    __m512 scale = _mm512_sqrt_ps(_mm512_max_ps(_mm512_max_ps(s[0], s[1]), s[2]));
+
+    f32* dst[3] = {out->x, out->y, out->z};
+    for (u32 j = 0; j < 3; ++j) {
+      __m512 wc = _mm512_fmadd_ps(m[8 + j], z, m[12 + j]);
+      wc        = _mm512_fmadd_ps(m[4 + j], y, wc);
+      wc        = _mm512_fmadd_ps(m[j], x, wc);
+      _mm512_storeu_ps(dst[j] + i, wc);
+    }
+    _mm512_storeu_ps(out->r + i, _mm512_mul_ps(r, scale));
+  }
+  umb_transform_spheres_scalar(matrices, stride, in, out, i, end);
+}
+
+UMB_MATH_AVX512_FN static u32 umb_cull_spheres_avx512(
+    const umb_frustum_soa* f,
+    const umb_sphere_soa*  s,
+    u32                    first,
+    u32                    end,
+    u32*                   out_visible) {
+  __m512 nx[UMB_FRUSTUM_PLANES], ny[UMB_FRUSTUM_PLANES], nz[UMB_FRUSTUM_PLANES];
+  __m512 d[UMB_FRUSTUM_PLANES];
+  for (u32 p = 0; p < UMB_FRUSTUM_PLANES; ++p) {
+    nx[p] = _mm512_set1_ps(f->nx[p]);
+    ny[p] = _mm512_set1_ps(f->ny[p]);
+    nz[p] = _mm512_set1_ps(f->nz[p]);
+    d[p]  = _mm512_set1_ps(f->d[p]);
+  }
+
+  u32    n_visible = 0;
+  u32    i         = first;
+  __m512 zero      = _mm512_setzero_ps();
+  for (; i + 16 <= end; i += 16) {
+    __m512 x     = _mm512_loadu_ps(s->x + i);
+    __m512 y     = _mm512_loadu_ps(s->y + i);
+    __m512 z     = _mm512_loadu_ps(s->z + i);
+    __m512 neg_r = _mm512_sub_ps(zero, _mm512_loadu_ps(s->r + i));
+
+    __mmask16 inside = 0xffff;
+    for (u32 p = 0; p < UMB_FRUSTUM_PLANES; ++p) {
+      __m512 dist = _mm512_add_ps(
+          _mm512_add_ps(_mm512_mul_ps(nx[p], x), _mm512_mul_ps(ny[p], y)),
+          _mm512_add_ps(_mm512_mul_ps(nz[p], z), d[p]));
+      inside = _mm512_mask_cmp_ps_mask(inside, dist, neg_r, _CMP_GT_OQ);
+    }
+
+    u32 mask = (u32)inside;
+    while (mask) {
+      out_visible[n_visible++] = i + __builtin_ctz(mask);
+      mask &= mask - 1;
+    }
+  }
+  return n_visible + umb_cull_spheres_scalar(f, s, i, end, out_visible + n_visible);
+}
+#endif
+
+#if UMB_MATH_ARM_NEON
+static void umb_mat4_mul_neon(const f32* a, const f32* b, f32* out, u32 n) {
+  for (u32 i = 0; i < n; ++i, a += 16, b += 16, out += 16) {
+    float32x4_t a0 = vld1q_f32(a + 0);
+    float32x4_t a1 = vld1q_f32(a + 4);
+    float32x4_t a2 = vld1q_f32(a + 8);
+    float32x4_t a3 = vld1q_f32(a + 12);
+    for (u32 c = 0; c < 4; ++c) {
+      float32x4_t col = vld1q_f32(b + c * 4);
+      float32x4_t r   = vmulq_n_f32(a0, vgetq_lane_f32(col, 0));
+      r               = vmlaq_n_f32(r, a1, vgetq_lane_f32(col, 1));
+      r               = vmlaq_n_f32(r, a2, vgetq_lane_f32(col, 2));
+      r               = vmlaq_n_f32(r, a3, vgetq_lane_f32(col, 3));
+      vst1q_f32(out + c * 4, r);
+    }
+  }
+}
+
+static u32 umb_cull_spheres_neon(
+    const umb_frustum_soa* f,
+    const umb_sphere_soa*  s,
+    u32                    first,
+    u32                    end,
+    u32*                   out_visible) {
+  u32 n_visible = 0;
+  u32 i         = first;
+  for (; i + 4 <= end; i += 4) {
+    float32x4_t x     = vld1q_f32(s->x + i);
+    float32x4_t y     = vld1q_f32(s->y + i);
+    float32x4_t z     = vld1q_f32(s->z + i);
+    float32x4_t neg_r = vnegq_f32(vld1q_f32(s->r + i));
+
+    uint32x4_t inside = vdupq_n_u32(~0u);
+    for (u32 p = 0; p < UMB_FRUSTUM_PLANES; ++p) {
+      float32x4_t dist = vmlaq_n_f32(vdupq_n_f32(f->d[p]), x, f->nx[p]);
+      dist             = vmlaq_n_f32(dist, y, f->ny[p]);
+      dist             = vmlaq_n_f32(dist, z, f->nz[p]);
+      inside           = vandq_u32(inside, vcgtq_f32(dist, neg_r));
+    }
+
+    u32 lanes[4];
+    vst1q_u32(lanes, inside);
+    for (u32 lane = 0; lane < 4; ++lane) {
+      out_visible[n_visible] = i + lane;
+      n_visible += lanes[lane] & 1;
+    }
+  }
+  return n_visible + umb_cull_spheres_scalar(f, s, i, end, out_visible + n_visible);
+}
+#endif
+
+static b32 umb_math_isa_available(umb_math_isa isa) {
+  switch (isa) {
+  case UMB_MATH_SCALAR: return true;
+#if UMB_MATH_X86
+  case UMB_MATH_SSE4: return __builtin_cpu_supports("sse4.1");
+  case UMB_MATH_AVX2: return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+  case UMB_MATH_AVX512: return __builtin_cpu_supports("avx512f");
+#elif UMB_MATH_ARM_NEON
+  case UMB_MATH_NEON: return true;
+#endif
+  default: return false;
+  }
+}
+
+static umb_math_kernels umb_math_kernels_for(umb_math_isa isa) {
+  umb_math_kernels kernels = {
+      .isa               = UMB_MATH_SCALAR,
+      .mat4_mul          = umb_mat4_mul_scalar,
+      .transform_vec4    = umb_transform_vec4_scalar,
+      .transform_aabbs   = umb_transform_aabbs_scalar,
+      .transform_spheres = umb_transform_spheres_scalar,
+      .cull_spheres      = umb_cull_spheres_scalar,
+  };
+  switch (isa) {
+#if UMB_MATH_X86
+  case UMB_MATH_SSE4: {
+    kernels = {
+        .isa               = UMB_MATH_SSE4,
+        .mat4_mul          = umb_mat4_mul_sse4,
+        .transform_vec4    = umb_transform_vec4_sse4,
+        .transform_aabbs   = umb_transform_aabbs_sse4,
+        .transform_spheres = umb_transform_spheres_sse4,
+        .cull_spheres      = umb_cull_spheres_sse4,
+    };
+  } break;
+  case UMB_MATH_AVX2: {
+    kernels = {
+        .isa               = UMB_MATH_AVX2,
+        .mat4_mul          = umb_mat4_mul_avx2,
+        .transform_vec4    = umb_transform_vec4_avx2,
+        .transform_aabbs   = umb_transform_aabbs_avx2,
+        .transform_spheres = umb_transform_spheres_avx2,
+        .cull_spheres      = umb_cull_spheres_avx2,
+    };
+  } break;
+  case UMB_MATH_AVX512: {
+    kernels = {
+        .isa               = UMB_MATH_AVX512,
+        .mat4_mul          = umb_mat4_mul_avx512,
+        .transform_vec4    = umb_transform_vec4_avx512,
+        .transform_aabbs   = umb_transform_aabbs_avx512,
+        .transform_spheres = umb_transform_spheres_avx512,
+        .cull_spheres      = umb_cull_spheres_avx512,
+    };
+  } break;
+#elif UMB_MATH_ARM_NEON
+  // the transform kernels stay scalar
+  case UMB_MATH_NEON: {
+    kernels.isa          = UMB_MATH_NEON;
+    kernels.mat4_mul     = umb_mat4_mul_neon;
+    kernels.cull_spheres = umb_cull_spheres_neon;
+  } break;
+#endif
+  default: break;
+  }
+  return kernels;
+}
+
+// the first level at or below `isa` the CPU supports
+static umb_math_isa umb_math_isa_clamp(umb_math_isa isa) {
+  u32 level = isa < UMB_MATH_ISA_COUNT ? isa : UMB_MATH_ISA_COUNT - 1;
+  while (!umb_math_isa_available((umb_math_isa)level)) level--;
+  return (umb_math_isa)level;
+}
+
+static umb_math_kernels* umb_math_active() {
+  static umb_math_kernels kernels =
+      umb_math_kernels_for(umb_math_isa_clamp((umb_math_isa)(UMB_MATH_ISA_COUNT - 1)));
+  return &kernels;
+}
+
+umb_math_isa umb_math_get_isa() {
+  return umb_math_active()->isa;
+}
+
+umb_math_isa umb_math_set_isa(umb_math_isa isa) {
+  *umb_math_active() = umb_math_kernels_for(umb_math_isa_clamp(isa));
+  return umb_math_active()->isa;
+}
+
+str umb_math_isa_name(umb_math_isa isa) {
+  static str names[UMB_MATH_ISA_COUNT] = {"scalar", "neon", "sse4.1", "avx2", "avx-512"};
+  return isa < UMB_MATH_ISA_COUNT ? names[isa] : "unknown";
+}
+
+void umb_mat4_mul_batch(const f32* a, const f32* b, f32* out, u32 n) {
+  umb_math_active()->mat4_mul(a, b, out, n);
+}
+
+void umb_mat4_transform_vec4(
+    const f32*          matrices,
+    u32                 stride,
+    const umb_vec4_soa* in,
+    umb_vec4_soa*       out,
+    u32                 n) {
+  umb_math_active()->transform_vec4(matrices, stride, in, out, 0, n);
+}
+
+void umb_mat4_transform_aabbs(
+    const f32*          matrices,
+    u32                 stride,
+    const umb_aabb_soa* in,
+    umb_aabb_soa*       out,
+    u32                 n) {
+  umb_math_active()->transform_aabbs(matrices, stride, in, out, 0, n);
+}
+
+void umb_mat4_transform_spheres(
+    const f32*            matrices,
+    u32                   stride,
+    const umb_sphere_soa* in,
+    umb_sphere_soa*       out,
+    u32                   n) {
+  umb_math_active()->transform_spheres(matrices, stride, in, out, 0, n);
+}
+
+u32 umb_spheres_cull_frustum(
+    const umb_frustum_soa* frustum,
+    const umb_sphere_soa*  spheres,
+    u32                    first,
+    u32                    n,
+    u32*                   out_visible) {
+  return umb_math_active()->cull_spheres(frustum, spheres, first, first + n, out_visible);
+}
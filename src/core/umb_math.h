@@ -0,0 +1,95 @@
+#pragma once
+
+#include <core/umb_common.h>
+
+// Batched math kernels. Matrices are column-major 4x4, 16 floats laid out like glm::mat4, and
+// vectors and bounds are stored as structure of arrays, so each SIMD lane handles one element.
+// The kernels for the widest instruction set the CPU supports are picked on first use: AVX-512,
+// AVX2 with FMA or SSE4.1 on x86, NEON for the matrix products and the frustum test on ARM, plain
+// loops elsewhere.
+//
+// Kernels taking `matrices` and `stride` read element i's matrix from matrices + i * stride floats,
+// so a stride of 16 walks an array of matrices, a stride of 0 applies one matrix to every element
+// and any other stride reads matrices embedded in an array of structs.
+
+enum umb_math_isa {
+  UMB_MATH_SCALAR,
+  UMB_MATH_NEON,
+  UMB_MATH_SSE4,
+  UMB_MATH_AVX2,
+  UMB_MATH_AVX512,
+  UMB_MATH_ISA_COUNT,
+};
+
+struct umb_vec4_soa {
+  f32* x;
+  f32* y;
+  f32* z;
+  f32* w;
+};
+
+struct umb_aabb_soa {
+  f32* min_x;
+  f32* min_y;
+  f32* min_z;
+  f32* max_x;
+  f32* max_y;
+  f32* max_z;
+};
+
+struct umb_sphere_soa {
+  f32* x;
+  f32* y;
+  f32* z;
+  f32* r;
+};
+
+static constexpr u32 UMB_FRUSTUM_PLANES = 6;
+
+// planes pointing inwards, split into their components so each is broadcast once per batch
+struct umb_frustum_soa {
+  f32 nx[UMB_FRUSTUM_PLANES];
+  f32 ny[UMB_FRUSTUM_PLANES];
+  f32 nz[UMB_FRUSTUM_PLANES];
+  f32 d[UMB_FRUSTUM_PLANES];
+};
+
+umb_math_isa umb_math_get_isa();
+// limits the kernels to `isa` or the best level below it the CPU supports, returns the level in
+// use. meant for benchmarks and for comparing results across levels.
+umb_math_isa umb_math_set_isa(umb_math_isa isa);
+str          umb_math_isa_name(umb_math_isa isa);
+
+// out[i] = a[i] * b[i] over n matrices. out may be b but not a.
+void umb_mat4_mul_batch(const f32* a, const f32* b, f32* out, u32 n);
+
+// out may be in for all of the below
+void umb_mat4_transform_vec4(
+    const f32*          matrices,
+    u32                 stride,
+    const umb_vec4_soa* in,
+    umb_vec4_soa*       out,
+    u32                 n);
+// the box enclosing each transformed box
+void umb_mat4_transform_aabbs(
+    const f32*          matrices,
+    u32                 stride,
+    const umb_aabb_soa* in,
+    umb_aabb_soa*       out,
+    u32                 n);
+// radii grow by the largest axis scale of the matrix
+void umb_mat4_transform_spheres(
+    const f32*            matrices,
+    u32                   stride,
+    const umb_sphere_soa* in,
+    umb_sphere_soa*       out,
+    u32                   n);
+
+// writes the indices of the spheres in [first, first + n) that are not fully outside any plane to
+// out_visible in ascending order, returns how many were written. out_visible holds up to n.
+u32 umb_spheres_cull_frustum(
+    const umb_frustum_soa* frustum,
+    const umb_sphere_soa*  spheres,
+    u32                    first,
+    u32                    n,
+    u32*                   out_visible);
@@ -0,0 +1,277 @@
+#include <core/umb_offset_alloc.h>
+#include <stdlib.h>
+
+static constexpr u32 MANTISSA_BITS  = 3;
+static constexpr u32 MANTISSA_VALUE = 1 << MANTISSA_BITS;
+static constexpr u32 MANTISSA_MASK  = MANTISSA_VALUE - 1;
+static constexpr u32 TOP_BINS_SHIFT = 3;
+static constexpr u32 LEAF_BINS_MASK = UMB_OFFSET_ALLOC_BINS_PER_LEAF - 1;
+static constexpr u32 UNUSED         = ~0u;
+
+static u32 umb_lzcnt_nonzero(u32 v) {
+#if defined(_MSC_VER)
+  unsigned long idx;
+  _BitScanReverse(&idx, v);
+  return 31 - idx;
+#else
+  return __builtin_clz(v);
+#endif
+}
+
+static u32 umb_tzcnt_nonzero(u32 v) {
+#if defined(_MSC_VER)
+  unsigned long idx;
+  _BitScanForward(&idx, v);
+  return idx;
+#else
+  return __builtin_ctz(v);
+#endif
+}
+
+// sizes below MANTISSA_VALUE are stored exactly ("denormals"), larger sizes keep the three bits
+// below their leading one
+static u32 umb_size_to_bin_round_up(u32 size) {
+  u32 exp      = 0;
+  u32 mantissa = 0;
+  if (size < MANTISSA_VALUE) {
+    mantissa = size;
+  } else {
+    u32 highest_bit    = 31 - umb_lzcnt_nonzero(size);
+    u32 mantissa_start = highest_bit - MANTISSA_BITS;
+    exp                = mantissa_start + 1;
+    mantissa           = (size >> mantissa_start) & MANTISSA_MASK;
+
+    // a carry out of the mantissa bumps the exponent, which the sum below handles
+    u32 low_bits_mask = (1u << mantissa_start) - 1;
+    if (size & low_bits_mask) mantissa++;
+  }
+  return (exp << MANTISSA_BITS) + mantissa;
+}
+
+static u32 umb_size_to_bin_round_down(u32 size) {
+  u32 exp      = 0;
+  u32 mantissa = 0;
+  if (size < MANTISSA_VALUE) {
+    mantissa = size;
+  } else {
+    u32 highest_bit    = 31 - umb_lzcnt_nonzero(size);
+    u32 mantissa_start = highest_bit - MANTISSA_BITS;
+    exp                = mantissa_start + 1;
+    mantissa           = (size >> mantissa_start) & MANTISSA_MASK;
+  }
+  return (exp << MANTISSA_BITS) | mantissa;
+}
+
+static u32 umb_bin_to_size(u32 bin) {
+  u32 exp      = bin >> MANTISSA_BITS;
+  u32 mantissa = bin & MANTISSA_MASK;
+  if (exp == 0) return mantissa;
+  return (mantissa | MANTISSA_VALUE) << (exp - 1);
+}
+
+static u32 umb_lowest_set_bit_after(u32 mask, u32 start) {
+  if (start >= 32) return UMB_OFFSET_ALLOC_NO_SPACE;
+  u32 masked = mask & ~((1u << start) - 1);
+  if (masked == 0) return UMB_OFFSET_ALLOC_NO_SPACE;
+  return umb_tzcnt_nonzero(masked);
+}
+
+static u32 umb_offset_insert_node(umb_offset_allocator* a, u32 offset, u32 size) {
+  u32 bin  = umb_size_to_bin_round_down(size);
+  u32 top  = bin >> TOP_BINS_SHIFT;
+  u32 leaf = bin & LEAF_BINS_MASK;
+
+  if (a->bin_heads[bin] == UNUSED) {
+    a->used_bins[top] |= 1 << leaf;
+    a->used_bins_top |= 1u << top;
+  }
+
+  UMB_ASSERT(a->free_offset > 0);
+  u32 head = a->bin_heads[bin];
+  u32 idx  = a->free_nodes[--a->free_offset];
+
+  a->nodes[idx] = {
+      .offset        = offset,
+      .size          = size,
+      .bin_prev      = UNUSED,
+      .bin_next      = head,
+      .neighbor_prev = UNUSED,
+      .neighbor_next = UNUSED,
+      .used          = false,
+  };
+  if (head != UNUSED) a->nodes[head].bin_prev = idx;
+  a->bin_heads[bin] = idx;
+
+  a->free_storage += size;
+  return idx;
+}
+
+static void umb_offset_remove_node(umb_offset_allocator* a, u32 idx) {
+  umb_offset_alloc_node* node = &a->nodes[idx];
+
+  if (node->bin_prev != UNUSED) {
+    a->nodes[node->bin_prev].bin_next = node->bin_next;
+    if (node->bin_next != UNUSED) a->nodes[node->bin_next].bin_prev = node->bin_prev;
+  } else {
+    u32 bin  = umb_size_to_bin_round_down(node->size);
+    u32 top  = bin >> TOP_BINS_SHIFT;
+    u32 leaf = bin & LEAF_BINS_MASK;
+
+    a->bin_heads[bin] = node->bin_next;
+    if (node->bin_next != UNUSED) a->nodes[node->bin_next].bin_prev = UNUSED;
+
+    if (a->bin_heads[bin] == UNUSED) {
+      a->used_bins[top] &= ~(1 << leaf);
+      if (a->used_bins[top] == 0) a->used_bins_top &= ~(1u << top);
+    }
+  }
+
+  a->free_nodes[a->free_offset++] = idx;
+  a->free_storage -= node->size;
+}
+
+umb_offset_allocator umb_offset_allocator_create(u32 size, u32 max_allocs) {
+  umb_offset_allocator allocator = {
+      .size       = size,
+      .max_allocs = max_allocs,
+      .nodes      = (umb_offset_alloc_node*)malloc(sizeof(umb_offset_alloc_node) * max_allocs),
+      .free_nodes = (u32*)malloc(sizeof(u32) * max_allocs),
+  };
+  umb_offset_allocator_reset(&allocator);
+  return allocator;
+}
+
+void umb_offset_allocator_destroy(umb_offset_allocator* allocator) {
+  free(allocator->nodes);
+  free(allocator->free_nodes);
+  allocator->nodes      = NULL;
+  allocator->free_nodes = NULL;
+}
+
+void umb_offset_allocator_reset(umb_offset_allocator* allocator) {
+  allocator->free_storage  = 0;
+  allocator->used_bins_top = 0;
+  for (u32 i = 0; i < UMB_OFFSET_ALLOC_NUM_TOP_BINS; ++i) allocator->used_bins[i] = 0;
+  for (u32 i = 0; i < UMB_OFFSET_ALLOC_NUM_LEAF_BINS; ++i) allocator->bin_heads[i] = UNUSED;
+
+  // node indices are popped from the back, so hand out low indices first
+  for (u32 i = 0; i < allocator->max_allocs; ++i) {
+    allocator->free_nodes[i] = allocator->max_allocs - i - 1;
+  }
+  allocator->free_offset = allocator->max_allocs;
+
+  umb_offset_insert_node(allocator, 0, allocator->size);
+}
+
+umb_offset_allocation umb_offset_alloc(umb_offset_allocator* allocator, u32 size) {
+  umb_offset_allocation result = {UMB_OFFSET_ALLOC_NO_SPACE, UMB_OFFSET_ALLOC_NO_SPACE};
+  // empty requests get no range instead of a zero sized node
+  if (size == 0) return result;
+  // a split needs a spare node for the remainder
+  if (allocator->free_offset == 0) return result;
+
+  // round up so that any node in the chosen bin fits the request
+  u32 min_bin  = umb_size_to_bin_round_up(size);
+  u32 min_top  = min_bin >> TOP_BINS_SHIFT;
+  u32 min_leaf = min_bin & LEAF_BINS_MASK;
+  if (min_top >= UMB_OFFSET_ALLOC_NUM_TOP_BINS) return result;
+
+  u32 top  = min_top;
+  u32 leaf = UMB_OFFSET_ALLOC_NO_SPACE;
+  if (allocator->used_bins_top & (1u << top)) {
+    leaf = umb_lowest_set_bit_after(allocator->used_bins[top], min_leaf);
+  }
+  if (leaf == UMB_OFFSET_ALLOC_NO_SPACE) {
+    top = umb_lowest_set_bit_after(allocator->used_bins_top, min_top + 1);
+    if (top == UMB_OFFSET_ALLOC_NO_SPACE) return result;
+    leaf = umb_tzcnt_nonzero(allocator->used_bins[top]);
+  }
+
+  u32 bin = (top << TOP_BINS_SHIFT) | leaf;
+  u32 idx = allocator->bin_heads[bin];
+
+  umb_offset_alloc_node* node       = &allocator->nodes[idx];
+  u32                    total_size = node->size;
+  node->size                        = size;
+  node->used                        = true;
+
+  allocator->bin_heads[bin] = node->bin_next;
+  if (node->bin_next != UNUSED) allocator->nodes[node->bin_next].bin_prev = UNUSED;
+  allocator->free_storage -= total_size;
+
+  if (allocator->bin_heads[bin] == UNUSED) {
+    allocator->used_bins[top] &= ~(1 << leaf);
+    if (allocator->used_bins[top] == 0) allocator->used_bins_top &= ~(1u << top);
+  }
+
+  u32 remainder = total_size - size;
+  if (remainder > 0) {
+    u32 new_idx = umb_offset_insert_node(allocator, node->offset + size, remainder);
+    if (node->neighbor_next != UNUSED) {
+      allocator->nodes[node->neighbor_next].neighbor_prev = new_idx;
+    }
+    allocator->nodes[new_idx].neighbor_prev = idx;
+    allocator->nodes[new_idx].neighbor_next = node->neighbor_next;
+    node->neighbor_next                     = new_idx;
+  }
+
+  result.offset = node->offset;
+  result.node   = idx;
+  return result;
+}
+
+void umb_offset_free(umb_offset_allocator* allocator, umb_offset_allocation alloc) {
+  if (alloc.node == UMB_OFFSET_ALLOC_NO_SPACE) return;
+
+  umb_offset_alloc_node* node = &allocator->nodes[alloc.node];
+  UMB_ASSERT(node->used);
+
+  u32 offset = node->offset;
+  u32 size   = node->size;
+
+  if (node->neighbor_prev != UNUSED && !allocator->nodes[node->neighbor_prev].used) {
+    umb_offset_alloc_node* prev = &allocator->nodes[node->neighbor_prev];
+    offset                      = prev->offset;
+    size += prev->size;
+
+    umb_offset_remove_node(allocator, node->neighbor_prev);
+    UMB_ASSERT(prev->neighbor_next == alloc.node);
+    node->neighbor_prev = prev->neighbor_prev;
+  }
+
+  if (node->neighbor_next != UNUSED && !allocator->nodes[node->neighbor_next].used) {
+    umb_offset_alloc_node* next = &allocator->nodes[node->neighbor_next];
+    size += next->size;
+
+    umb_offset_remove_node(allocator, node->neighbor_next);
+    UMB_ASSERT(next->neighbor_prev == alloc.node);
+    node->neighbor_next = next->neighbor_next;
+  }
+
+  u32 neighbor_prev = node->neighbor_prev;
+  u32 neighbor_next = node->neighbor_next;
+
+  allocator->free_nodes[allocator->free_offset++] = alloc.node;
+
+  u32 combined = umb_offset_insert_node(allocator, offset, size);
+  if (neighbor_next != UNUSED) {
+    allocator->nodes[combined].neighbor_next      = neighbor_next;
+    allocator->nodes[neighbor_next].neighbor_prev = combined;
+  }
+  if (neighbor_prev != UNUSED) {
+    allocator->nodes[combined].neighbor_prev      = neighbor_prev;
+    allocator->nodes[neighbor_prev].neighbor_next = combined;
+  }
+}
+
+u32 umb_offset_allocation_size(const umb_offset_allocator* allocator, umb_offset_allocation alloc) {
+  if (alloc.node == UMB_OFFSET_ALLOC_NO_SPACE) return 0;
+  return allocator->nodes[alloc.node].size;
+}
+
+u32 umb_offset_allocator_largest_free(const umb_offset_allocator* allocator) {
+  if (allocator->used_bins_top == 0) return 0;
+  u32 top  = 31 - umb_lzcnt_nonzero(allocator->used_bins_top);
+  u32 leaf = 31 - umb_lzcnt_nonzero(allocator->used_bins[top]);
+  return umb_bin_to_size((top << TOP_BINS_SHIFT) | leaf);
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <core/umb_common.h>
+
+// Two-level segregated fit allocator that hands out offsets into an externally owned range,
+// e.g. a GPU buffer. Sizes are binned with a 5-bit exponent / 3-bit mantissa float, so
+// allocation and free are O(1) and the worst-case internal waste is 1/8 of the request.
+// Freed ranges merge with free neighbours immediately.
+
+static constexpr u32 UMB_OFFSET_ALLOC_NUM_TOP_BINS  = 32;
+static constexpr u32 UMB_OFFSET_ALLOC_BINS_PER_LEAF = 8;
+static constexpr u32 UMB_OFFSET_ALLOC_NUM_LEAF_BINS =
+    UMB_OFFSET_ALLOC_NUM_TOP_BINS * UMB_OFFSET_ALLOC_BINS_PER_LEAF;
+static constexpr u32 UMB_OFFSET_ALLOC_NO_SPACE = ~0u;
+
+struct umb_offset_allocation {
+  u32 offset;
+  u32 node;
+};
+
+struct umb_offset_alloc_node {
+  u32 offset;
+  u32 size;
+  u32 bin_prev;
+  u32 bin_next;
+  u32 neighbor_prev;
+  u32 neighbor_next;
+  b32 used;
+};
+
+struct umb_offset_allocator {
+  u32 size;
+  u32 max_allocs;
+  u32 free_storage;
+
+  u32 used_bins_top;
+  u8  used_bins[UMB_OFFSET_ALLOC_NUM_TOP_BINS];
+  u32 bin_heads[UMB_OFFSET_ALLOC_NUM_LEAF_BINS];
+
+  umb_offset_alloc_node* nodes;
+  u32*                   free_nodes;
+  u32                    free_offset;
+};
+
+umb_offset_allocator umb_offset_allocator_create(u32 size, u32 max_allocs);
+void                 umb_offset_allocator_destroy(umb_offset_allocator* allocator);
+void                 umb_offset_allocator_reset(umb_offset_allocator* allocator);
+
+// offset is UMB_OFFSET_ALLOC_NO_SPACE when no free range can hold `size`, and for a size of 0.
+// freeing such an allocation does nothing.
+umb_offset_allocation umb_offset_alloc(umb_offset_allocator* allocator, u32 size);
+void                  umb_offset_free(umb_offset_allocator* allocator, umb_offset_allocation alloc);
+u32 umb_offset_allocation_size(const umb_offset_allocator* allocator, umb_offset_allocation alloc);
+
+// largest request that is guaranteed to succeed, rounded down to its bin
+u32 umb_offset_allocator_largest_free(const umb_offset_allocator* allocator);
@@ -0,0 +1,58 @@
+#include <core/umb_radix_sort.h>
+#include <string.h>
+
+static constexpr u32 RADIX_BITS   = 8;
+static constexpr u32 RADIX_SIZE   = 1 << RADIX_BITS;
+static constexpr u32 RADIX_MASK   = RADIX_SIZE - 1;
+static constexpr u32 RADIX_PASSES = 64 / RADIX_BITS;
+
+void umb_radix_sort_u64(u64* keys, u32* values, u64* scratch_keys, u32* scratch_values, u32 n) {
+  if (n < 2) return;
+
+  u32 counts[RADIX_PASSES][RADIX_SIZE];
+  memset(counts, 0, sizeof(counts));
+  for (u32 i = 0; i < n; ++i) {
+    u64 key = keys[i];
+    for (u32 pass = 0; pass < RADIX_PASSES; ++pass) {
+      counts[pass][(key >> (pass * RADIX_BITS)) & RADIX_MASK]++;
+    }
+  }
+
+  u64* src_keys   = keys;
+  u32* src_values = values;
+  u64* dst_keys   = scratch_keys;
+  u32* dst_values = scratch_values;
+  for (u32 pass = 0; pass < RADIX_PASSES; ++pass) {
+    u32  shift  = pass * RADIX_BITS;
+    u32* count  = counts[pass];
+    u32  digit0 = (src_keys[0] >> shift) & RADIX_MASK;
+    if (count[digit0] == n) continue;
+
+    // exclusive prefix sum turns the counts into each digit's first slot
+    u32 offset = 0;
+    for (u32 d = 0; d < RADIX_SIZE; ++d) {
+      u32 c    = count[d];
+      count[d] = offset;
+      offset += c;
+    }
+
+    for (u32 i = 0; i < n; ++i) {
+      u64 key          = src_keys[i];
+      u32 slot         = count[(key >> shift) & RADIX_MASK]++;
+      dst_keys[slot]   = key;
+      dst_values[slot] = src_values[i];
+    }
+
+    u64* tmp_keys   = src_keys;
+    u32* tmp_values = src_values;
+    src_keys        = dst_keys;
+    src_values      = dst_values;
+    dst_keys        = tmp_keys;
+    dst_values      = tmp_values;
+  }
+
+  if (src_keys != keys) {
+    memcpy(keys, src_keys, sizeof(u64) * n);
+    memcpy(values, src_values, sizeof(u32) * n);
+  }
+}
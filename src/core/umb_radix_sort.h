@@ -0,0 +1,11 @@
+#pragma once
+
+#include <core/umb_common.h>
+
+// Least significant digit radix sort of 64 bit keys carrying a 32 bit value each, eight passes of
+// eight bits. The histograms of every digit are counted in a single read of the keys, and digits
+// that are the same for all keys are skipped, so narrow or clustered keys take fewer passes.
+
+// sorts keys ascending and moves values along, stable. the scratch arrays hold `n` entries each,
+// the result is in `keys` and `values`.
+void umb_radix_sort_u64(u64* keys, u32* values, u64* scratch_keys, u32* scratch_values, u32 n);
@@ -0,0 +1,370 @@
+#include <core/umb_job.h>
+#include <core/umb_math.h>
+#include <core/umb_transform.h>
+#include <stdlib.h>
+#include <string.h>
+
+// levels with fewer dirty nodes than this are updated on the calling thread
+static constexpr u32 UPDATE_JOB_SIZE    = 1024;
+static constexpr u32 MAX_UPDATE_JOBS    = 64;
+static constexpr u32 MIN_LEVEL_CAPACITY = 64;
+static constexpr u32 MUL_BATCH_SIZE     = 32;
+
+struct umb_transform_update_job {
+  umb_transform_hierarchy* hierarchy;
+  u32                      depth;
+  u32                      first;
+  u32                      end;
+};
+
+template <typename T> static void umb_transform_grow(T** data, u32 capacity) {
+  *data = (T*)realloc(*data, (u64)capacity * sizeof(T));
+  UMB_ASSERT(*data);
+}
+
+static void umb_transform_level_reserve(umb_transform_level* level, u32 capacity) {
+  if (capacity <= level->capacity) return;
+  u32 new_capacity = level->capacity ? level->capacity : MIN_LEVEL_CAPACITY;
+  while (new_capacity < capacity) new_capacity *= 2;
+
+  umb_transform_grow(&level->px, new_capacity);
+  umb_transform_grow(&level->py, new_capacity);
+  umb_transform_grow(&level->pz, new_capacity);
+  umb_transform_grow(&level->qx, new_capacity);
+  umb_transform_grow(&level->qy, new_capacity);
+  umb_transform_grow(&level->qz, new_capacity);
+  umb_transform_grow(&level->qw, new_capacity);
+  umb_transform_grow(&level->sx, new_capacity);
+  umb_transform_grow(&level->sy, new_capacity);
+  umb_transform_grow(&level->sz, new_capacity);
+  umb_transform_grow(&level->world, new_capacity * 16);
+  umb_transform_grow(&level->handles, new_capacity);
+  level->capacity = new_capacity;
+}
+
+static void umb_transform_level_free(umb_transform_level* level) {
+  free(level->px);
+  free(level->py);
+  free(level->pz);
+  free(level->qx);
+  free(level->qy);
+  free(level->qz);
+  free(level->qw);
+  free(level->sx);
+  free(level->sy);
+  free(level->sz);
+  free(level->world);
+  free(level->handles);
+  *level = {};
+}
+
+static void umb_transform_handles_reserve(umb_transform_hierarchy* h, u32 capacity) {
+  if (capacity <= h->handle_capacity) return;
+  u32 new_capacity = h->handle_capacity ? h->handle_capacity : MIN_LEVEL_CAPACITY;
+  while (new_capacity < capacity) new_capacity *= 2;
+
+  umb_transform_grow(&h->nodes, new_capacity);
+  umb_transform_grow(&h->free_handles, new_capacity);
+  umb_transform_grow(&h->dirty, new_capacity);
+  umb_transform_grow(&h->changed, new_capacity);
+  h->handle_capacity = new_capacity;
+}
+
+umb_transform_hierarchy umb_transform_hierarchy_create(u32 capacity) {
+  umb_transform_hierarchy hierarchy = {};
+  umb_transform_handles_reserve(&hierarchy, capacity);
+  return hierarchy;
+}
+
+void umb_transform_hierarchy_destroy(umb_transform_hierarchy* hierarchy) {
+  // levels emptied by destroy keep their arrays
+  for (u32 d = 0; d < UMB_TRANSFORM_MAX_DEPTH; ++d) umb_transform_level_free(&hierarchy->levels[d]);
+  free(hierarchy->nodes);
+  free(hierarchy->free_handles);
+  free(hierarchy->dirty);
+  free(hierarchy->changed);
+  *hierarchy = {};
+}
+
+static void umb_transform_mark_dirty(umb_transform_hierarchy* h, umb_transform transform) {
+  umb_transform_node* node = &h->nodes[transform];
+  if (node->queued) return;
+  node->queued           = true;
+  h->dirty[h->n_dirty++] = transform;
+}
+
+umb_transform umb_transform_create(umb_transform_hierarchy* hierarchy, umb_transform parent) {
+  umb_transform_hierarchy* h = hierarchy;
+
+  u32 depth = 0;
+  if (parent != UMB_TRANSFORM_NONE) {
+    UMB_ASSERT(parent < h->n_handles && h->nodes[parent].depth != UMB_TRANSFORM_NONE);
+    depth = h->nodes[parent].depth + 1;
+  }
+  UMB_ASSERT(depth < UMB_TRANSFORM_MAX_DEPTH);
+
+  umb_transform transform;
+  if (h->n_free_handles > 0) {
+    transform = h->free_handles[--h->n_free_handles];
+  } else {
+    umb_transform_handles_reserve(h, h->n_handles + 1);
+    transform                  = h->n_handles++;
+    h->nodes[transform].queued = false;
+  }
+
+  umb_transform_level* level = &h->levels[depth];
+  umb_transform_level_reserve(level, level->n_nodes + 1);
+  if (depth >= h->n_levels) h->n_levels = depth + 1;
+
+  u32 index             = level->n_nodes++;
+  level->px[index]      = 0.f;
+  level->py[index]      = 0.f;
+  level->pz[index]      = 0.f;
+  level->qx[index]      = 0.f;
+  level->qy[index]      = 0.f;
+  level->qz[index]      = 0.f;
+  level->qw[index]      = 1.f;
+  level->sx[index]      = 1.f;
+  level->sy[index]      = 1.f;
+  level->sz[index]      = 1.f;
+  level->handles[index] = transform;
+
+  umb_transform_node* node = &h->nodes[transform];
+  node->depth              = depth;
+  node->index              = index;
+  node->parent             = parent;
+  node->first_child        = UMB_TRANSFORM_NONE;
+  node->prev_sibling       = UMB_TRANSFORM_NONE;
+  node->next_sibling       = UMB_TRANSFORM_NONE;
+  if (parent != UMB_TRANSFORM_NONE) {
+    umb_transform_node* parent_node = &h->nodes[parent];
+    node->next_sibling              = parent_node->first_child;
+    if (parent_node->first_child != UMB_TRANSFORM_NONE) {
+      h->nodes[parent_node->first_child].prev_sibling = transform;
+    }
+    parent_node->first_child = transform;
+  }
+
+  // a handle freed while dirty is still in the dirty list and covers its reuse
+  umb_transform_mark_dirty(h, transform);
+  return transform;
+}
+
+void umb_transform_destroy(umb_transform_hierarchy* hierarchy, umb_transform transform) {
+  umb_transform_hierarchy* h    = hierarchy;
+  umb_transform_node*      node = &h->nodes[transform];
+  UMB_ASSERT(node->depth != UMB_TRANSFORM_NONE);
+  UMB_ASSERT(node->first_child == UMB_TRANSFORM_NONE);
+
+  if (node->prev_sibling != UMB_TRANSFORM_NONE) {
+    h->nodes[node->prev_sibling].next_sibling = node->next_sibling;
+  } else if (node->parent != UMB_TRANSFORM_NONE) {
+    h->nodes[node->parent].first_child = node->next_sibling;
+  }
+  if (node->next_sibling != UMB_TRANSFORM_NONE) {
+    h->nodes[node->next_sibling].prev_sibling = node->prev_sibling;
+  }
+
+  // the last node of the level takes the freed slot, children refer to it by handle
+  umb_transform_level* level = &h->levels[node->depth];
+  u32                  index = node->index;
+  u32                  last  = --level->n_nodes;
+  if (index != last) {
+    level->px[index]      = level->px[last];
+    level->py[index]      = level->py[last];
+    level->pz[index]      = level->pz[last];
+    level->qx[index]      = level->qx[last];
+    level->qy[index]      = level->qy[last];
+    level->qz[index]      = level->qz[last];
+    level->qw[index]      = level->qw[last];
+    level->sx[index]      = level->sx[last];
+    level->sy[index]      = level->sy[last];
+    level->sz[index]      = level->sz[last];
+    level->handles[index] = level->handles[last];
+    memcpy(level->world + index * 16, level->world + last * 16, 16 * sizeof(f32));
+    h->nodes[level->handles[index]].index = index;
+  }
+  while (h->n_levels > 0 && h->levels[h->n_levels - 1].n_nodes == 0) h->n_levels--;
+
+  node->depth                          = UMB_TRANSFORM_NONE;
+  h->free_handles[h->n_free_handles++] = transform;
+}
+
+void umb_transform_set_position(
+    umb_transform_hierarchy* hierarchy,
+    umb_transform            transform,
+    f32                      x,
+    f32                      y,
+    f32                      z) {
+  umb_transform_node*  node  = &hierarchy->nodes[transform];
+  umb_transform_level* level = &hierarchy->levels[node->depth];
+  level->px[node->index]     = x;
+  level->py[node->index]     = y;
+  level->pz[node->index]     = z;
+  umb_transform_mark_dirty(hierarchy, transform);
+}
+
+void umb_transform_set_rotation(
+    umb_transform_hierarchy* hierarchy,
+    umb_transform            transform,
+    f32                      x,
+    f32                      y,
+    f32                      z,
+    f32                      w) {
+  umb_transform_node*  node  = &hierarchy->nodes[transform];
+  umb_transform_level* level = &hierarchy->levels[node->depth];
+  level->qx[node->index]     = x;
+  level->qy[node->index]     = y;
+  level->qz[node->index]     = z;
+  level->qw[node->index]     = w;
+  umb_transform_mark_dirty(hierarchy, transform);
+}
+
+void umb_transform_set_scale(
+    umb_transform_hierarchy* hierarchy,
+    umb_transform            transform,
+    f32                      x,
+    f32                      y,
+    f32                      z) {
+  umb_transform_node*  node  = &hierarchy->nodes[transform];
+  umb_transform_level* level = &hierarchy->levels[node->depth];
+  level->sx[node->index]     = x;
+  level->sy[node->index]     = y;
+  level->sz[node->index]     = z;
+  umb_transform_mark_dirty(hierarchy, transform);
+}
+
+// translation * rotation * scale
+static void umb_transform_local_matrix(const umb_transform_level* level, u32 i, f32* out) {
+  f32 x = level->qx[i], y = level->qy[i], z = level->qz[i], w = level->qw[i];
+  f32 sx = level->sx[i], sy = level->sy[i], sz = level->sz[i];
+
+  out[0]  = (1.f - 2.f * (y * y + z * z)) * sx;
+  out[1]  = 2.f * (x * y + w * z) * sx;
+  out[2]  = 2.f * (x * z - w * y) * sx;
+  out[3]  = 0.f;
+  out[4]  = 2.f * (x * y - w * z) * sy;
+  out[5]  = (1.f - 2.f * (x * x + z * z)) * sy;
+  out[6]  = 2.f * (y * z + w * x) * sy;
+  out[7]  = 0.f;
+  out[8]  = 2.f * (x * z + w * y) * sz;
+  out[9]  = 2.f * (y * z - w * x) * sz;
+  out[10] = (1.f - 2.f * (x * x + y * y)) * sz;
+  out[11] = 0.f;
+  out[12] = level->px[i];
+  out[13] = level->py[i];
+  out[14] = level->pz[i];
+  out[15] = 1.f;
+}
+
+// the level above is complete, so nodes of one level only read shared data. local matrices are
+// built a batch at a time and multiplied with their gathered parents in one kernel call.
+static void umb_transform_update_range(
+    umb_transform_hierarchy* h,
+    u32                      depth,
+    u32                      first,
+    u32                      end) {
+  umb_transform_level*       level        = &h->levels[depth];
+  const umb_transform_level* parent_level = depth > 0 ? &h->levels[depth - 1] : NULL;
+
+  f32 local[MUL_BATCH_SIZE * 16];
+  f32 parents[MUL_BATCH_SIZE * 16];
+  for (u32 batch = first; batch < end; batch += MUL_BATCH_SIZE) {
+    u32 n = end - batch < MUL_BATCH_SIZE ? end - batch : MUL_BATCH_SIZE;
+    for (u32 i = 0; i < n; ++i) {
+      const umb_transform_node* node = &h->nodes[h->changed[batch + i]];
+      umb_transform_local_matrix(level, node->index, local + i * 16);
+      if (!parent_level) continue;
+      u32 parent_index = h->nodes[node->parent].index;
+      memcpy(parents + i * 16, parent_level->world + parent_index * 16, 16 * sizeof(f32));
+    }
+    if (parent_level) umb_mat4_mul_batch(parents, local, local, n);
+    for (u32 i = 0; i < n; ++i) {
+      u32 index = h->nodes[h->changed[batch + i]].index;
+      memcpy(level->world + index * 16, local + i * 16, 16 * sizeof(f32));
+    }
+  }
+}
+
+static void umb_transform_update_job_proc(void* data) {
+  umb_transform_update_job* job = (umb_transform_update_job*)data;
+  umb_transform_update_range(job->hierarchy, job->depth, job->first, job->end);
+}
+
+void umb_transform_hierarchy_update(umb_transform_hierarchy* hierarchy) {
+  umb_transform_hierarchy* h = hierarchy;
+  h->n_changed               = 0;
+  if (h->n_dirty == 0) return;
+
+  // drop handles destroyed while dirty, then order the rest by depth
+  u32 level_counts[UMB_TRANSFORM_MAX_DEPTH] = {};
+  u32 n_dirty                               = 0;
+  for (u32 i = 0; i < h->n_dirty; ++i) {
+    umb_transform_node* node = &h->nodes[h->dirty[i]];
+    if (node->depth == UMB_TRANSFORM_NONE) {
+      node->queued = false;
+      continue;
+    }
+    h->dirty[n_dirty++] = h->dirty[i];
+    level_counts[node->depth]++;
+  }
+  u32 level_offsets[UMB_TRANSFORM_MAX_DEPTH];
+  u32 offset = 0;
+  for (u32 d = 0; d < h->n_levels; ++d) {
+    level_offsets[d] = offset;
+    offset += level_counts[d];
+  }
+  for (u32 i = 0; i < n_dirty; ++i) {
+    u32 depth                          = h->nodes[h->dirty[i]].depth;
+    h->changed[level_offsets[depth]++] = h->dirty[i];
+  }
+  memcpy(h->dirty, h->changed, n_dirty * sizeof(umb_transform));
+  h->n_dirty = 0;
+
+  // each level gets its own dirty nodes and the children of the level above's, which is all the
+  // work there is: untouched subtrees are never visited
+  u32 next_dirty  = 0;
+  u32 level_first = 0;
+  for (u32 d = 0; d < h->n_levels; ++d) {
+    u32 level_end = h->n_changed;
+    for (u32 i = 0; i < level_counts[d]; ++i) h->changed[h->n_changed++] = h->dirty[next_dirty++];
+    for (u32 i = level_first; i < level_end; ++i) {
+      umb_transform child = h->nodes[h->changed[i]].first_child;
+      for (; child != UMB_TRANSFORM_NONE; child = h->nodes[child].next_sibling) {
+        if (h->nodes[child].queued) continue;
+        h->nodes[child].queued     = true;
+        h->changed[h->n_changed++] = child;
+      }
+    }
+    level_first = level_end;
+
+    u32 first = level_end;
+    u32 n     = h->n_changed - first;
+    if (n < UPDATE_JOB_SIZE * 2) {
+      umb_transform_update_range(h, d, first, h->n_changed);
+      continue;
+    }
+
+    u32 n_jobs = (n + UPDATE_JOB_SIZE - 1) / UPDATE_JOB_SIZE;
+    n_jobs     = n_jobs > MAX_UPDATE_JOBS ? MAX_UPDATE_JOBS : n_jobs;
+    u32 per    = (n + n_jobs - 1) / n_jobs;
+    n_jobs     = (n + per - 1) / per;
+
+    umb_transform_update_job jobs[MAX_UPDATE_JOBS];
+    umb_job_counter          counter = {};
+    for (u32 j = 0; j < n_jobs; ++j) {
+      u32 job_first = first + j * per;
+      u32 job_end   = job_first + per < h->n_changed ? job_first + per : h->n_changed;
+      jobs[j]       = {.hierarchy = h, .depth = d, .first = job_first, .end = job_end};
+      umb_job_run(umb_transform_update_job_proc, &jobs[j], &counter);
+    }
+    umb_job_wait(&counter);
+  }
+
+  for (u32 i = 0; i < h->n_changed; ++i) h->nodes[h->changed[i]].queued = false;
+}
+
+const f32* umb_transform_world(const umb_transform_hierarchy* hierarchy, umb_transform transform) {
+  const umb_transform_node* node = &hierarchy->nodes[transform];
+  return hierarchy->levels[node->depth].world + node->index * 16;
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <core/umb_common.h>
+
+// Scene transform hierarchy. Nodes hold a local translation, rotation and scale and are stored per
+// depth, each level as structure of arrays, so a level only reads the finished world matrices of
+// the one above it. Changing a node marks it dirty; an update walks the dirty nodes and their
+// subtrees level by level, recomputing only those world matrices and splitting large levels across
+// the job system. Matrices are column-major 4x4, laid out like glm::mat4.
+
+typedef u32 umb_transform;
+
+static constexpr umb_transform UMB_TRANSFORM_NONE      = ~0u;
+static constexpr u32           UMB_TRANSFORM_MAX_DEPTH = 32;
+
+struct umb_transform_level {
+  // local translation, rotation as a unit quaternion, and scale
+  f32* px;
+  f32* py;
+  f32* pz;
+  f32* qx;
+  f32* qy;
+  f32* qz;
+  f32* qw;
+  f32* sx;
+  f32* sy;
+  f32* sz;
+  // 16 floats per node
+  f32*           world;
+  umb_transform* handles;
+  u32            n_nodes;
+  u32            capacity;
+};
+
+// links and placement of a handle, the hierarchy is walked through these
+struct umb_transform_node {
+  u32           depth;
+  u32           index;
+  umb_transform parent;
+  umb_transform first_child;
+  umb_transform next_sibling;
+  umb_transform prev_sibling;
+  // set while the node is dirty or queued for the running update
+  b32           queued;
+};
+
+struct umb_transform_hierarchy {
+  umb_transform_level levels[UMB_TRANSFORM_MAX_DEPTH];
+  u32                 n_levels;
+
+  umb_transform_node* nodes;
+  umb_transform*      free_handles;
+  u32                 n_free_handles;
+  u32                 n_handles;
+  u32                 handle_capacity;
+
+  // nodes changed since the last update
+  umb_transform* dirty;
+  u32            n_dirty;
+
+  // nodes whose world matrix the last update recomputed, ordered by depth
+  umb_transform* changed;
+  u32            n_changed;
+};
+
+umb_transform_hierarchy umb_transform_hierarchy_create(u32 capacity);
+void                    umb_transform_hierarchy_destroy(umb_transform_hierarchy* hierarchy);
+
+// a node with an identity local transform, below `parent` or a root for UMB_TRANSFORM_NONE
+umb_transform umb_transform_create(umb_transform_hierarchy* hierarchy, umb_transform parent);
+// the node must not have children
+void          umb_transform_destroy(umb_transform_hierarchy* hierarchy, umb_transform transform);
+
+void umb_transform_set_position(
+    umb_transform_hierarchy* hierarchy,
+    umb_transform            transform,
+    f32                      x,
+    f32                      y,
+    f32                      z);
+void umb_transform_set_rotation(
+    umb_transform_hierarchy* hierarchy,
+    umb_transform            transform,
+    f32                      x,
+    f32                      y,
+    f32                      z,
+    f32                      w);
+void umb_transform_set_scale(
+    umb_transform_hierarchy* hierarchy,
+    umb_transform            transform,
+    f32                      x,
+    f32                      y,
+    f32                      z);
+
+// recomputes the world matrices of the dirty nodes and everything below them
+void umb_transform_hierarchy_update(umb_transform_hierarchy* hierarchy);
+
+// valid until the node is destroyed or the hierarchy grows
+const f32* umb_transform_world(const umb_transform_hierarchy* hierarchy, umb_transform transform);
@@ -1,7 +1,9 @@
 #version 460
+#extension GL_EXT_nonuniform_qualifier : require
 
 layout(location = 0) in vec3 in_col;
 layout(location = 1) in vec2 in_texcoord;
+layout(location = 2) flat in uint in_material;
 
 layout(location = 0) out vec4 out_col;
 
@@ -13,7 +15,25 @@ layout(set = 0, binding = 1) uniform SceneData {
   vec4 sunlight_color;
 } scene_data;
 
+struct MaterialData {
+  vec4 base_color;
+  uint albedo_texture;
+  uint sampler_index;
+};
+
+layout(std140, set = 2, binding = 0) readonly buffer MaterialBuffer {
+  MaterialData materials[];
+} material_buffer;
+
+layout(set = 2, binding = 1) uniform sampler samplers[3];
+layout(set = 2, binding = 2) uniform texture2D textures[];
 
 void main() {
-  out_col = vec4(in_texcoord.x, in_texcoord.y, 0.5f, 1.0f);
+  MaterialData material = material_buffer.materials[nonuniformEXT(in_material)];
+  vec4 albedo = texture(
+    sampler2D(
+      textures[nonuniformEXT(material.albedo_texture)],
+      samplers[nonuniformEXT(material.sampler_index)]),
+    in_texcoord);
+  out_col = albedo * material.base_color;
 }
@@ -7,6 +7,7 @@ layout(location = 3) in vec2 in_texcoord;
 
 layout(location = 0) out vec3 out_col;
 layout(location = 1) out vec2 out_tecoord;
+layout(location = 2) flat out uint out_material;
 
 layout(set = 0, binding = 0) uniform CameraBuffer {
   mat4 view;
@@ -16,6 +17,7 @@ layout(set = 0, binding = 0) uniform CameraBuffer {
 
 struct ObjectData {
   mat4 model;
+  uint material_index;
 };
 
 layout(std140, set = 1, binding = 0) readonly buffer ObjectBuffer{
@@ -28,10 +30,12 @@ layout( push_constant )  uniform PushConstants {
 } push_constants;
 
 void main() {
-  mat4 model_matrix = object_buffer.objects[gl_BaseInstance].model;
+  // firstInstance is the first object slot of the draw, each instance reads the next one
+  mat4 model_matrix = object_buffer.objects[gl_InstanceIndex].model;
   mat4 transform_matrix = (camera_data.viewproj * model_matrix);
   gl_Position =  transform_matrix * vec4(in_pos, 1.0);
   out_col = in_col;
   out_tecoord = in_texcoord;
+  out_material = object_buffer.objects[gl_InstanceIndex].material_index;
 }
 
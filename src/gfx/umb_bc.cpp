@@ -0,0 +1,367 @@
+#include <gfx/umb_bc.h>
+#include <math.h>
+#include <string.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#include <emmintrin.h>
+#define UMB_BC_SSE2 1
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define UMB_BC_NEON 1
+#endif
+
+static constexpr u32 POWER_ITERATIONS = 8;
+static constexpr f32 MIN_AXIS_LENGTH  = 1e-6f;
+
+// BC7 interpolation weights of the 4 bit index modes, out of 64
+static constexpr u32 BC7_WEIGHTS_4[16] = {
+    0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64,
+};
+
+// texels split into channels, so the kernels below work on 4 texels of one channel at a time
+struct umb_bc_block {
+  alignas(16) f32 c[4][UMB_BC_BLOCK_TEXELS];
+};
+
+struct umb_bc_bit_writer {
+  u8* data;
+  u32 pos;
+};
+
+static void umb_bc_load_block(const u8* rgba, umb_bc_block* out_block) {
+  for (u32 i = 0; i < UMB_BC_BLOCK_TEXELS; ++i) {
+    for (u32 c = 0; c < 4; ++c) out_block->c[c][i] = (f32)rgba[i * 4 + c];
+  }
+}
+
+static void umb_bc_write_bits(umb_bc_bit_writer* w, u32 value, u32 n_bits) {
+  for (u32 i = 0; i < n_bits; ++i, ++w->pos) {
+    if (value & (1u << i)) w->data[w->pos / 8] |= (u8)(1u << (w->pos % 8));
+  }
+}
+
+// projects every texel onto the segment e0 -> e1 of channels [first, first + n) and rounds to one
+// of `levels` evenly spaced positions, 0 at e0
+static void umb_bc_fit_positions(
+    const umb_bc_block* block,
+    u32                 first,
+    u32                 n,
+    const f32*          e0,
+    const f32*          e1,
+    u32                 levels,
+    u8*                 out_positions) {
+  f32 axis[4];
+  f32 len2 = 0.f;
+  for (u32 c = 0; c < n; ++c) {
+    axis[c] = e1[c] - e0[c];
+    len2 += axis[c] * axis[c];
+  }
+  if (len2 < MIN_AXIS_LENGTH) {
+    memset(out_positions, 0, UMB_BC_BLOCK_TEXELS);
+    return;
+  }
+  f32 scale    = (f32)(levels - 1) / len2;
+  f32 max_step = (f32)(levels - 1);
+
+#if defined(UMB_BC_SSE2)
+  for (u32 i = 0; i < UMB_BC_BLOCK_TEXELS; i += 4) {
+    __m128 t = _mm_setzero_ps();
+    for (u32 c = 0; c < n; ++c) {
+      __m128 d = _mm_sub_ps(_mm_load_ps(&block->c[first + c][i]), _mm_set1_ps(e0[c]));
+      t        = _mm_add_ps(t, _mm_mul_ps(d, _mm_set1_ps(axis[c])));
+    }
+    t = _mm_add_ps(_mm_mul_ps(t, _mm_set1_ps(scale)), _mm_set1_ps(0.5f));
+    t = _mm_min_ps(_mm_max_ps(t, _mm_setzero_ps()), _mm_set1_ps(max_step));
+
+    alignas(16) i32 steps[4];
+    _mm_store_si128((__m128i*)steps, _mm_cvttps_epi32(t));
+    for (u32 k = 0; k < 4; ++k) out_positions[i + k] = (u8)steps[k];
+  }
+#elif defined(UMB_BC_NEON)
+  for (u32 i = 0; i < UMB_BC_BLOCK_TEXELS; i += 4) {
+    float32x4_t t = vdupq_n_f32(0.f);
+    for (u32 c = 0; c < n; ++c) {
+      float32x4_t d = vsubq_f32(vld1q_f32(&block->c[first + c][i]), vdupq_n_f32(e0[c]));
+      t             = vmlaq_f32(t, d, vdupq_n_f32(axis[c]));
+    }
+    t = vmlaq_f32(vdupq_n_f32(0.5f), t, vdupq_n_f32(scale));
+    t = vminq_f32(vmaxq_f32(t, vdupq_n_f32(0.f)), vdupq_n_f32(max_step));
+
+    u32 steps[4];
+    vst1q_u32(steps, vcvtq_u32_f32(t));
+    for (u32 k = 0; k < 4; ++k) out_positions[i + k] = (u8)steps[k];
+  }
+#else
+  for (u32 i = 0; i < UMB_BC_BLOCK_TEXELS; ++i) {
+    f32 t = 0.f;
+    for (u32 c = 0; c < n; ++c) t += (block->c[first + c][i] - e0[c]) * axis[c];
+    t                = t * scale + 0.5f;
+    t                = t < 0.f ? 0.f : t > max_step ? max_step : t;
+    out_positions[i] = (u8)t;
+  }
+#endif
+}
+
+// endpoints along the principal axis of the texel colors, spanning their projections
+static void umb_bc_principal_endpoints(const umb_bc_block* block, u32 n, f32* e0, f32* e1) {
+  f32 mean[4] = {};
+  for (u32 c = 0; c < n; ++c) {
+    for (u32 i = 0; i < UMB_BC_BLOCK_TEXELS; ++i) mean[c] += block->c[c][i];
+    mean[c] /= UMB_BC_BLOCK_TEXELS;
+  }
+
+  f32 cov[4][4] = {};
+  for (u32 i = 0; i < UMB_BC_BLOCK_TEXELS; ++i) {
+    for (u32 a = 0; a < n; ++a) {
+      for (u32 b = a; b < n; ++b) {
+        cov[a][b] += (block->c[a][i] - mean[a]) * (block->c[b][i] - mean[b]);
+      }
+    }
+  }
+  for (u32 a = 0; a < n; ++a) {
+    for (u32 b = 0; b < a; ++b) cov[a][b] = cov[b][a];
+  }
+
+  f32 axis[4] = {1.f, 1.f, 1.f, 1.f};
+  for (u32 iter = 0; iter < POWER_ITERATIONS; ++iter) {
+    f32 next[4] = {};
+    f32 len2    = 0.f;
+    for (u32 a = 0; a < n; ++a) {
+      for (u32 b = 0; b < n; ++b) next[a] += cov[a][b] * axis[b];
+      len2 += next[a] * next[a];
+    }
+    if (len2 < MIN_AXIS_LENGTH) break;
+    f32 inv_len = 1.f / sqrtf(len2);
+    for (u32 a = 0; a < n; ++a) axis[a] = next[a] * inv_len;
+  }
+
+  f32 t_min = 0.f;
+  f32 t_max = 0.f;
+  for (u32 i = 0; i < UMB_BC_BLOCK_TEXELS; ++i) {
+    f32 t = 0.f;
+    for (u32 c = 0; c < n; ++c) t += (block->c[c][i] - mean[c]) * axis[c];
+    t_min = t < t_min ? t : t_min;
+    t_max = t > t_max ? t : t_max;
+  }
+  for (u32 c = 0; c < n; ++c) {
+    e0[c] = mean[c] + axis[c] * t_min;
+    e1[c] = mean[c] + axis[c] * t_max;
+  }
+}
+
+// least squares endpoints for fixed positions, texel ~ (1 - w) * e0 + w * e1
+static void umb_bc_refine_endpoints(
+    const umb_bc_block* block,
+    u32                 n,
+    const u8*           positions,
+    u32                 levels,
+    f32*                e0,
+    f32*                e1) {
+  f32 aa = 0.f, ab = 0.f, bb = 0.f;
+  f32 xa[4] = {}, xb[4] = {};
+  for (u32 i = 0; i < UMB_BC_BLOCK_TEXELS; ++i) {
+    f32 w = (f32)positions[i] / (f32)(levels - 1);
+    aa += (1.f - w) * (1.f - w);
+    ab += (1.f - w) * w;
+    bb += w * w;
+    for (u32 c = 0; c < n; ++c) {
+      xa[c] += (1.f - w) * block->c[c][i];
+      xb[c] += w * block->c[c][i];
+    }
+  }
+
+  f32 det = aa * bb - ab * ab;
+  if (fabsf(det) < MIN_AXIS_LENGTH) return;
+  for (u32 c = 0; c < n; ++c) {
+    f32 a = (bb * xa[c] - ab * xb[c]) / det;
+    f32 b = (aa * xb[c] - ab * xa[c]) / det;
+    e0[c] = a < 0.f ? 0.f : a > 255.f ? 255.f : a;
+    e1[c] = b < 0.f ? 0.f : b > 255.f ? 255.f : b;
+  }
+}
+
+static u16 umb_bc_pack_565(const f32* c, f32* out_expanded) {
+  u32 r = (u32)(c[0] * 31.f / 255.f + 0.5f);
+  u32 g = (u32)(c[1] * 63.f / 255.f + 0.5f);
+  u32 b = (u32)(c[2] * 31.f / 255.f + 0.5f);
+
+  out_expanded[0] = (f32)((r << 3) | (r >> 2));
+  out_expanded[1] = (f32)((g << 2) | (g >> 4));
+  out_expanded[2] = (f32)((b << 3) | (b >> 2));
+  return (u16)((r << 11) | (g << 5) | b);
+}
+
+static void umb_bc1_encode_color(const umb_bc_block* block, u8* out_block) {
+  f32 e0[3], e1[3];
+  u8  positions[UMB_BC_BLOCK_TEXELS];
+  umb_bc_principal_endpoints(block, 3, e0, e1);
+  umb_bc_fit_positions(block, 0, 3, e0, e1, 4, positions);
+  umb_bc_refine_endpoints(block, 3, positions, 4, e0, e1);
+
+  f32 q0[3], q1[3];
+  u16 c0 = umb_bc_pack_565(e0, q0);
+  u16 c1 = umb_bc_pack_565(e1, q1);
+
+  // c0 > c1 selects the four color mode
+  u32 indices = 0;
+  if (c0 != c1) {
+    if (c0 < c1) {
+      u16 c = c0;
+      c0    = c1;
+      c1    = c;
+      for (u32 k = 0; k < 3; ++k) {
+        f32 q = q0[k];
+        q0[k] = q1[k];
+        q1[k] = q;
+      }
+    }
+
+    // palette order is c0, c1, 2/3 c0 + 1/3 c1, 1/3 c0 + 2/3 c1
+    static constexpr u32 POSITION_TO_INDEX[4] = {0, 2, 3, 1};
+    umb_bc_fit_positions(block, 0, 3, q0, q1, 4, positions);
+    for (u32 i = 0; i < UMB_BC_BLOCK_TEXELS; ++i) {
+      indices |= POSITION_TO_INDEX[positions[i]] << (i * 2);
+    }
+  }
+
+  out_block[0] = (u8)(c0 & 0xff);
+  out_block[1] = (u8)(c0 >> 8);
+  out_block[2] = (u8)(c1 & 0xff);
+  out_block[3] = (u8)(c1 >> 8);
+  memcpy(out_block + 4, &indices, sizeof(u32));
+}
+
+static void umb_bc4_encode_channel(const umb_bc_block* block, u32 channel, u8* out_block) {
+  f32 lo = 255.f, hi = 0.f;
+  for (u32 i = 0; i < UMB_BC_BLOCK_TEXELS; ++i) {
+    lo = block->c[channel][i] < lo ? block->c[channel][i] : lo;
+    hi = block->c[channel][i] > hi ? block->c[channel][i] : hi;
+  }
+
+  // a0 > a1 selects the eight value mode: a0, a1, then six steps from a0 to a1
+  static constexpr u32 POSITION_TO_INDEX[8] = {0, 2, 3, 4, 5, 6, 7, 1};
+  u8                   positions[UMB_BC_BLOCK_TEXELS];
+  umb_bc_fit_positions(block, channel, 1, &hi, &lo, 8, positions);
+
+  u64 indices = 0;
+  for (u32 i = 0; i < UMB_BC_BLOCK_TEXELS; ++i) {
+    indices |= (u64)(hi > lo ? POSITION_TO_INDEX[positions[i]] : 0) << (i * 3);
+  }
+
+  out_block[0] = (u8)hi;
+  out_block[1] = (u8)lo;
+  for (u32 b = 0; b < 6; ++b) out_block[2 + b] = (u8)(indices >> (b * 8));
+}
+
+u32 umb_bc_block_size(umb_bc_format format) {
+  return format == UMB_BC1 ? 8 : 16;
+}
+
+void umb_bc1_encode_block(const u8* rgba, u8* out_block) {
+  umb_bc_block block;
+  umb_bc_load_block(rgba, &block);
+  umb_bc1_encode_color(&block, out_block);
+}
+
+void umb_bc3_encode_block(const u8* rgba, u8* out_block) {
+  umb_bc_block block;
+  umb_bc_load_block(rgba, &block);
+  umb_bc4_encode_channel(&block, 3, out_block);
+  umb_bc1_encode_color(&block, out_block + 8);
+}
+
+void umb_bc4_encode_block(const u8* rgba, u32 channel, u8* out_block) {
+  umb_bc_block block;
+  umb_bc_load_block(rgba, &block);
+  umb_bc4_encode_channel(&block, channel, out_block);
+}
+
+void umb_bc5_encode_block(const u8* rgba, u8* out_block) {
+  umb_bc_block block;
+  umb_bc_load_block(rgba, &block);
+  umb_bc4_encode_channel(&block, 0, out_block);
+  umb_bc4_encode_channel(&block, 1, out_block + 8);
+}
+
+void umb_bc7_encode_block(const u8* rgba, u8* out_block) {
+  umb_bc_block block;
+  umb_bc_load_block(rgba, &block);
+
+  f32 e0[4], e1[4];
+  u8  positions[UMB_BC_BLOCK_TEXELS];
+  umb_bc_principal_endpoints(&block, 4, e0, e1);
+  umb_bc_fit_positions(&block, 0, 4, e0, e1, 16, positions);
+  umb_bc_refine_endpoints(&block, 4, positions, 16, e0, e1);
+
+  // endpoints are 7 bits per channel plus a p-bit shared by the channels of each endpoint, the
+  // combination with the lowest error wins
+  u32 best_error = ~0u;
+  u32 best_q[2][4];
+  u32 best_p[2];
+  u8  best_positions[UMB_BC_BLOCK_TEXELS];
+  for (u32 pbits = 0; pbits < 4; ++pbits) {
+    u32 p[2] = {pbits & 1, pbits >> 1};
+    u32 q[2][4];
+    u32 endpoints[2][4];
+    f32 expanded[2][4];
+    for (u32 c = 0; c < 4; ++c) {
+      for (u32 e = 0; e < 2; ++e) {
+        f32 v           = ((e == 0 ? e0[c] : e1[c]) - (f32)p[e]) * 0.5f + 0.5f;
+        q[e][c]         = v < 0.f ? 0 : v > 127.f ? 127 : (u32)v;
+        endpoints[e][c] = (q[e][c] << 1) | p[e];
+        expanded[e][c]  = (f32)endpoints[e][c];
+      }
+    }
+    umb_bc_fit_positions(&block, 0, 4, expanded[0], expanded[1], 16, positions);
+
+    u32 error = 0;
+    for (u32 i = 0; i < UMB_BC_BLOCK_TEXELS; ++i) {
+      u32 w = BC7_WEIGHTS_4[positions[i]];
+      for (u32 c = 0; c < 4; ++c) {
+        i32 value = (i32)((endpoints[0][c] * (64 - w) + endpoints[1][c] * w + 32) >> 6);
+        i32 d     = value - (i32)rgba[i * 4 + c];
+        error += (u32)(d * d);
+      }
+    }
+    if (error < best_error) {
+      best_error = error;
+      memcpy(best_q, q, sizeof(q));
+      memcpy(best_p, p, sizeof(p));
+      memcpy(best_positions, positions, sizeof(positions));
+    }
+  }
+
+  // the first index is stored without its top bit, which must therefore be 0
+  if (best_positions[0] >= 8) {
+    for (u32 c = 0; c < 4; ++c) {
+      u32 q        = best_q[0][c];
+      best_q[0][c] = best_q[1][c];
+      best_q[1][c] = q;
+    }
+    u32 p     = best_p[0];
+    best_p[0] = best_p[1];
+    best_p[1] = p;
+    for (u32 i = 0; i < UMB_BC_BLOCK_TEXELS; ++i) best_positions[i] = 15 - best_positions[i];
+  }
+
+  memset(out_block, 0, 16);
+  umb_bc_bit_writer w = {.data = out_block};
+  umb_bc_write_bits(&w, 1 << 6, 7);
+  for (u32 c = 0; c < 4; ++c) {
+    umb_bc_write_bits(&w, best_q[0][c], 7);
+    umb_bc_write_bits(&w, best_q[1][c], 7);
+  }
+  umb_bc_write_bits(&w, best_p[0], 1);
+  umb_bc_write_bits(&w, best_p[1], 1);
+  umb_bc_write_bits(&w, best_positions[0], 3);
+  for (u32 i = 1; i < UMB_BC_BLOCK_TEXELS; ++i) umb_bc_write_bits(&w, best_positions[i], 4);
+}
+
+void umb_bc_encode_block(umb_bc_format format, const u8* rgba, u8* out_block) {
+  switch (format) {
+  case UMB_BC1: umb_bc1_encode_block(rgba, out_block); break;
+  case UMB_BC3: umb_bc3_encode_block(rgba, out_block); break;
+  case UMB_BC5: umb_bc5_encode_block(rgba, out_block); break;
+  case UMB_BC7: umb_bc7_encode_block(rgba, out_block); break;
+  }
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <core/umb_common.h>
+
+// Block compression encoders. Each takes one 4x4 block of RGBA8 texels in row-major order and
+// writes one compressed block: 8 bytes for BC1 and BC4, 16 bytes for BC3, BC5 and BC7.
+
+static constexpr u32 UMB_BC_BLOCK_TEXELS = 16;
+
+enum umb_bc_format {
+  UMB_BC1,
+  UMB_BC3,
+  UMB_BC5,
+  UMB_BC7,
+};
+
+u32 umb_bc_block_size(umb_bc_format format);
+
+// opaque color, alpha is ignored
+void umb_bc1_encode_block(const u8* rgba, u8* out_block);
+// BC1 color followed by BC4 alpha
+void umb_bc3_encode_block(const u8* rgba, u8* out_block);
+// single channel `channel` of the texels
+void umb_bc4_encode_block(const u8* rgba, u32 channel, u8* out_block);
+// BC4 red followed by BC4 green, for two channel data such as tangent space normals
+void umb_bc5_encode_block(const u8* rgba, u8* out_block);
+// mode 6: one RGBA subset with 7 bit endpoints, per-endpoint p-bits and 4 bit indices
+void umb_bc7_encode_block(const u8* rgba, u8* out_block);
+
+void umb_bc_encode_block(umb_bc_format format, const u8* rgba, u8* out_block);
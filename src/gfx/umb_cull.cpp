@@ -0,0 +1,21 @@
+#include <gfx/umb_cull.h>
+
+umb_cull_frustum umb_cull_frustum_create(const f32 planes[UMB_CULL_PLANES][4]) {
+  umb_cull_frustum frustum;
+  for (u32 p = 0; p < UMB_CULL_PLANES; ++p) {
+    frustum.nx[p] = planes[p][0];
+    frustum.ny[p] = planes[p][1];
+    frustum.nz[p] = planes[p][2];
+    frustum.d[p]  = planes[p][3];
+  }
+  return frustum;
+}
+
+u32 umb_cull_spheres_frustum(
+    const umb_cull_frustum* frustum,
+    const umb_cull_spheres* spheres,
+    u32                     first,
+    u32                     n,
+    u32*                    out_visible) {
+  return umb_spheres_cull_frustum(frustum, spheres, first, n, out_visible);
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <core/umb_common.h>
+#include <core/umb_math.h>
+
+// Frustum culling of bounding spheres stored as structure of arrays. The spheres are tested by the
+// umb_math kernels, so the instruction set is the one the rest of the batched math runs on. The
+// result is the compacted list of the visible indices.
+
+static constexpr u32 UMB_CULL_PLANES = UMB_FRUSTUM_PLANES;
+
+typedef umb_frustum_soa umb_cull_frustum;
+// world space spheres, one entry per object
+typedef umb_sphere_soa umb_cull_spheres;
+
+// planes are (nx, ny, nz, d) with unit normals
+umb_cull_frustum umb_cull_frustum_create(const f32 planes[UMB_CULL_PLANES][4]);
+
+// tests spheres [first, first + n) and writes the indices of those not fully outside any plane to
+// out_visible in ascending order, returns how many were written. out_visible holds up to n.
+u32 umb_cull_spheres_frustum(
+    const umb_cull_frustum* frustum,
+    const umb_cull_spheres* spheres,
+    u32                     first,
+    u32                     n,
+    u32*                    out_visible);
@@ -1,6 +1,8 @@
 #pragma once
 
 #include <SDL_vulkan.h>
+#include <core/umb_ecs.h>
+#include <core/umb_transform.h>
 #include <umbral.h>
 #include <vulkan/vulkan.h>
 #include <vulkan/vulkan_core.h>
@@ -26,42 +28,167 @@ UMB_CONTAINER_DEF(umb_text_mesh_vertex);
 
 typedef struct umb_mesh_t*      umb_mesh;
 typedef struct umb_text_mesh_t* umb_text_mesh;
+typedef struct umb_model_t*     umb_model;
+typedef struct umb_image_t*     umb_image;
+typedef struct umb_texture_t*   umb_texture;
+typedef u32                     umb_instance;
+typedef u32                     umb_static_object;
+
+// returned for static objects drawn as regular render objects on devices that cannot replay them
+static constexpr umb_static_object UMB_INVALID_STATIC_OBJECT = ~0u;
 
 struct umb_pipeline {
   VkPipeline       pipeline;
   VkPipelineLayout pipeline_layout;
 };
 
+enum umb_sampler {
+  UMB_SAMPLER_LINEAR_REPEAT,
+  UMB_SAMPLER_LINEAR_CLAMP,
+  UMB_SAMPLER_NEAREST_REPEAT,
+  UMB_SAMPLER_COUNT,
+};
+
+// materials sharing a pipeline draw in one batch, their data is indexed per draw on the GPU. set
+// the fields before registering, registration copies them into the material buffer.
 struct umb_material {
   umb_pipeline pipeline;
+  // NULL samples white
+  umb_texture  albedo;
+  umb_sampler  sampler;
+  glm::vec4    base_color = glm::vec4(1.0f);
+  // slot in the material buffer, assigned on registration
+  u32          index;
 };
 
 struct umb_render_object {
   umb_mesh      mesh;
   umb_material* material;
   glm::mat4     transform;
+  // drives the streaming of the texture's levels, may be NULL
+  umb_texture   texture;
 };
 
-typedef struct umb_image_t*   umb_image;
-typedef struct umb_texture_t* umb_texture;
-
 UMB_CONTAINER_DEF(umb_render_object);
 
+// renderables are entities of the renderer's scene world with at least a mesh, material,
+// transform and bounds, a sphere in mesh space. culling and draw building walk them chunk by chunk.
+// callers may give them components of their own and run their own queries on the scene, but not
+// while a frame is being drawn.
+struct umb_gfx_components {
+  umb_component mesh;      // umb_mesh
+  umb_component material;  // umb_material*
+  umb_component transform; // glm::mat4
+  umb_component bounds;    // glm::vec4
+  // umb_texture, optional, drives the streaming of the texture's levels
+  umb_component texture;
+  // umb_transform, optional, the node of umb_gfx_transforms() the transform is taken from
+  umb_component node;
+};
+
 void umb_gfx_init(umb_window* window);
 void umb_gfx_draw_frame();
-void umb_gfx_draw_object(umb_render_object* o);
+
+umb_ecs_world*            umb_gfx_scene();
+const umb_gfx_components* umb_gfx_scene_components();
+// the bounds are copied from the mesh, set them again after changing the mesh component. texture
+// may be NULL.
+umb_entity umb_gfx_create_renderable(
+    umb_mesh         mesh,
+    umb_material*    material,
+    const glm::mat4& transform,
+    umb_texture      texture);
+void       umb_gfx_set_renderable_transform(umb_entity entity, const glm::mat4& transform);
+void       umb_gfx_destroy_renderable(umb_entity entity);
+// the renderer updates the hierarchy every frame and copies the world matrix of every node that
+// changed into the transform of its renderable. a node drives at most one renderable, destroy the
+// renderable before its node.
+umb_transform_hierarchy* umb_gfx_transforms();
+void                     umb_gfx_attach_transform(umb_entity entity, umb_transform node);
+// creates a renderable from a copy of the object, later changes to `o` are not seen
+umb_entity umb_gfx_draw_object(umb_render_object* o);
+// static objects are drawn from command buffers recorded once and replayed every frame, only their
+// culling and LOD selection run per frame. they skip meshlet culling. after changing an object's
+// transform in place call umb_gfx_static_object_moved, which copies only that object's data to
+// the GPU. any other change needs umb_gfx_static_objects_changed, which rebuilds them all.
+umb_static_object umb_gfx_draw_static_object(umb_render_object* o);
+void              umb_gfx_static_object_moved(umb_static_object object);
+void              umb_gfx_static_objects_changed();
 void umb_gfx_shutdown();
 void umb_gfx_framebuffer_resized();
 
+// mesh and image uploads issued between begin and end share one command buffer and one submit,
+// which happens at the outermost end. without an open batch every upload submits on its own.
+// the copies run on a transfer queue; end returns the batch's upload value, meshes are drawn from
+// the first frame after it completes.
+void umb_gfx_upload_batch_begin();
+u64  umb_gfx_upload_batch_end();
+// blocks until every upload up to and including `value` has executed
+void umb_gfx_upload_wait(u64 value);
+
 void umb_gfx_register_mesh(str name, umb_mesh mesh);
+// the mesh's geometry is released once the frames in flight no longer reference it. its instances
+// must be removed first, and static objects, which stay for good, must not use it.
+void umb_gfx_unregister_mesh(str name);
+// packs all registered meshes to the front of the shared geometry buffers. stalls the GPU.
+void umb_gfx_defragment_geometry();
 void umb_gfx_register_material(str name, umb_material* mat);
+// the texture takes a slot in the bindless texture array and samples white until the image's
+// upload is visible
+void umb_gfx_register_texture(str name, umb_image image);
 
+// .ktx2 files written by umbral-texc hold block-compressed levels that are uploaded as they are,
+// any other image is decoded to RGBA8 and gets its mip chain generated on upload
 b32 umb_gfx_load_image_from_file(str file, umb_image image);
+// decodes the images concurrently on the job system and uploads them in as few batches as the
+// staging ring allows, false if any of them failed to load
+b32 umb_gfx_load_images_from_files(const str* files, umb_image* images, u32 n_images);
+
+// a .ktx2 texture of which only the levels of 128 texels and smaller are loaded up front. finer
+// levels stream in as usage reports ask for them, and are dropped again, least recently used
+// first, when the texture budget or the device local heap budget runs out. NULL when the file
+// cannot be loaded.
+umb_texture umb_gfx_load_streamed_texture(str file);
+// the size, in pixels, the texture covers on screen this frame. render objects with a texture
+// report it every frame they are drawn.
+void        umb_gfx_report_texture_usage(umb_texture texture, f32 screen_size);
+// bytes of device memory all streamed textures may occupy together
+void        umb_gfx_set_texture_budget(u64 bytes);
 
 // TODO(bryson): change to out pointer API
 umb_mesh      umb_gfx_get_mesh(str name);
 umb_material* umb_gfx_get_material(str name);
+umb_texture   umb_gfx_get_texture(str name);
+
+// instances are drawn without any per-object work on the CPU: a compute pass culls them, selects
+// their LOD and writes the indirect draws. only added, moved and removed instances cost CPU time,
+// their data is copied to the GPU on the next frame. remove a mesh's instances before
+// unregistering it.
+umb_instance umb_gfx_add_instance(
+    umb_mesh         mesh,
+    umb_material*    material,
+    const glm::mat4& transform);
+void umb_gfx_set_instance_transform(umb_instance instance, const glm::mat4& transform);
+void umb_gfx_remove_instance(umb_instance instance);
+
+// screen-space error, in pixels, a mesh LOD may introduce before a finer one is selected
+void umb_gfx_set_lod_error_threshold(f32 pixels);
+// bytes of host visible device local memory (resizable BAR, unified memory) that geometry and
+// per-frame buffers may occupy. data placed there is written in place without a staging copy.
+// applies to buffers created afterwards, the geometry buffers are recreated on defragmentation.
+void umb_gfx_set_direct_upload_budget(u64 bytes);
 
 umb_mesh umb_mesh_create(u32 n_vertices);
+umb_mesh umb_mesh_create_indexed(u32 n_vertices, u32 n_indices);
 umb_mesh umb_mesh_load_from_obj(str filename);
+
+// loads the default scene of a .gltf or .glb file. every triangle primitive is registered as a
+// mesh named "<name>/<mesh>/<primitive>" and every node instancing it becomes a render object with
+// the default material and the node's world transform. materials are not imported. returns NULL
+// when the file cannot be read.
+umb_model umb_gfx_load_model(str filename, str name);
+// unregisters the model's meshes and releases its file
+void                        umb_gfx_unload_model(umb_model model);
+umb_slice_umb_render_object umb_model_get_objects(umb_model model);
 void     umb_mesh_push_vertex(umb_mesh mesh, umb_mesh_vertex vertex);
+void     umb_mesh_push_index(umb_mesh mesh, u32 index);
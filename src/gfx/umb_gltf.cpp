@@ -0,0 +1,715 @@
+#include <gfx/umb_gltf.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+static constexpr u32 GLB_MAGIC          = 0x46546C67;  // "glTF"
+static constexpr u32 GLB_CHUNK_JSON     = 0x4E4F534A;  // "JSON"
+static constexpr u32 GLB_CHUNK_BIN      = 0x004E4942;  // "BIN\0"
+static constexpr u32 GLB_HEADER_SIZE    = 12;
+static constexpr u32 GLB_CHUNK_HEADER   = 8;
+static constexpr u32 JSON_MAX_DEPTH     = 64;
+static constexpr u32 MAX_PATH_LENGTH    = 1024;
+static constexpr u32 INVALID_TOKEN      = ~0u;
+static constexpr u32 JSON_MIN_TOKEN_CAP = 256;
+
+enum umb_json_type : u8 {
+  UMB_JSON_NULL,
+  UMB_JSON_BOOL,
+  UMB_JSON_NUMBER,
+  UMB_JSON_STRING,
+  UMB_JSON_ARRAY,
+  UMB_JSON_OBJECT,
+};
+
+// flat token tree: children follow their parent, object members are a key token followed by the
+// value's subtree, `next` is the index one past the token's subtree
+struct umb_json_token {
+  umb_json_type type;
+  u32           start;
+  u32           end;
+  u32           size;
+  u32           next;
+};
+
+struct umb_json {
+  const byte*     text;
+  u32             len;
+  u32             pos;
+  umb_json_token* tokens;
+  u32             n_tokens;
+  u32             cap;
+};
+
+struct umb_gltf_buffer_view {
+  const byte* data;
+  u64         size;
+  u32         stride;
+};
+
+static u32 umb_json_push(umb_json* json, umb_json_type type, u32 start) {
+  if (json->n_tokens == json->cap) {
+    json->cap    = json->cap ? json->cap * 2 : JSON_MIN_TOKEN_CAP;
+    json->tokens = (umb_json_token*)realloc(json->tokens, sizeof(umb_json_token) * json->cap);
+  }
+  json->tokens[json->n_tokens] = {.type = type, .start = start, .end = start};
+  return json->n_tokens++;
+}
+
+static void umb_json_skip_whitespace(umb_json* json) {
+  while (json->pos < json->len) {
+    byte c = json->text[json->pos];
+    if (c != ' ' && c != '\t' && c != '\n' && c != '\r') break;
+    json->pos++;
+  }
+}
+
+static b32 umb_json_parse_string(umb_json* json) {
+  u32 tok = umb_json_push(json, UMB_JSON_STRING, ++json->pos);
+  while (json->pos < json->len && json->text[json->pos] != '"') {
+    // escapes are kept verbatim, only the quote they may hide matters here
+    json->pos += json->text[json->pos] == '\\' ? 2 : 1;
+  }
+  if (json->pos >= json->len) return false;
+
+  json->tokens[tok].end  = json->pos++;
+  json->tokens[tok].next = json->n_tokens;
+  return true;
+}
+
+static b32 umb_json_parse_value(umb_json* json, u32 depth) {
+  umb_json_skip_whitespace(json);
+  if (json->pos >= json->len || depth > JSON_MAX_DEPTH) return false;
+
+  byte c = json->text[json->pos];
+  if (c == '"') return umb_json_parse_string(json);
+
+  if (c == '{' || c == '[') {
+    b32 object = c == '{';
+    u32 tok    = umb_json_push(json, object ? UMB_JSON_OBJECT : UMB_JSON_ARRAY, json->pos++);
+    for (;;) {
+      umb_json_skip_whitespace(json);
+      if (json->pos >= json->len) return false;
+      if (json->text[json->pos] == (object ? '}' : ']')) break;
+
+      if (json->tokens[tok].size > 0) {
+        if (json->text[json->pos] != ',') return false;
+        json->pos++;
+        umb_json_skip_whitespace(json);
+      }
+
+      if (object) {
+        if (json->pos >= json->len || json->text[json->pos] != '"') return false;
+        if (!umb_json_parse_string(json)) return false;
+        umb_json_skip_whitespace(json);
+        if (json->pos >= json->len || json->text[json->pos] != ':') return false;
+        json->pos++;
+      }
+      if (!umb_json_parse_value(json, depth + 1)) return false;
+      json->tokens[tok].size++;
+    }
+    json->tokens[tok].end  = ++json->pos;
+    json->tokens[tok].next = json->n_tokens;
+    return true;
+  }
+
+  umb_json_type type  = UMB_JSON_NUMBER;
+  u32           start = json->pos;
+  if (c == 't' || c == 'f' || c == 'n') type = c == 'n' ? UMB_JSON_NULL : UMB_JSON_BOOL;
+  while (json->pos < json->len) {
+    c = json->text[json->pos];
+    if (c == ',' || c == '}' || c == ']' || c == ' ' || c == '\t' || c == '\n' || c == '\r') break;
+    json->pos++;
+  }
+  if (json->pos == start) return false;
+
+  u32 tok                = umb_json_push(json, type, start);
+  json->tokens[tok].end  = json->pos;
+  json->tokens[tok].next = json->n_tokens;
+  return true;
+}
+
+static b32 umb_json_equals(const umb_json* json, u32 tok, str s) {
+  const umb_json_token* t   = &json->tokens[tok];
+  u32                   len = t->end - t->start;
+  return strlen(s) == len && memcmp(json->text + t->start, s, len) == 0;
+}
+
+static u32 umb_json_find(const umb_json* json, u32 object, str key) {
+  if (object == INVALID_TOKEN || json->tokens[object].type != UMB_JSON_OBJECT) {
+    return INVALID_TOKEN;
+  }
+  u32 tok = object + 1;
+  for (u32 i = 0; i < json->tokens[object].size; ++i) {
+    if (umb_json_equals(json, tok, key)) return tok + 1;
+    tok = json->tokens[tok + 1].next;
+  }
+  return INVALID_TOKEN;
+}
+
+static u32 umb_json_count(const umb_json* json, u32 array) {
+  if (array == INVALID_TOKEN || json->tokens[array].type != UMB_JSON_ARRAY) return 0;
+  return json->tokens[array].size;
+}
+
+// walk with `tok = umb_json_first(array)`, `tok = json->tokens[tok].next`
+static u32 umb_json_first(u32 array) {
+  return array + 1;
+}
+
+static f64 umb_json_number(const umb_json* json, u32 tok, f64 fallback) {
+  if (tok == INVALID_TOKEN || json->tokens[tok].type != UMB_JSON_NUMBER) return fallback;
+
+  // the text is not terminated, a GLB's binary chunk may follow it directly
+  char buffer[64];
+  u32  len = json->tokens[tok].end - json->tokens[tok].start;
+  if (len >= sizeof(buffer)) return fallback;
+  memcpy(buffer, json->text + json->tokens[tok].start, len);
+  buffer[len] = 0;
+  return strtod(buffer, NULL);
+}
+
+static i32 umb_json_int(const umb_json* json, u32 object, str key, i32 fallback) {
+  return (i32)umb_json_number(json, umb_json_find(json, object, key), fallback);
+}
+
+static b32 umb_json_bool(const umb_json* json, u32 object, str key) {
+  u32 tok = umb_json_find(json, object, key);
+  return tok != INVALID_TOKEN && json->tokens[tok].type == UMB_JSON_BOOL &&
+         umb_json_equals(json, tok, "true");
+}
+
+// names are substrings of the JSON text, so a copy of its size holds all of them
+static str umb_gltf_copy_string(const umb_json* json, u32 tok, byte** strings) {
+  if (tok == INVALID_TOKEN || json->tokens[tok].type != UMB_JSON_STRING) return "";
+  u32  len    = json->tokens[tok].end - json->tokens[tok].start;
+  str  result = *strings;
+  memcpy(*strings, json->text + json->tokens[tok].start, len);
+  (*strings)[len] = 0;
+  *strings += len + 1;
+  return result;
+}
+
+static i32 umb_base64_value(byte c) {
+  if (c >= 'A' && c <= 'Z') return c - 'A';
+  if (c >= 'a' && c <= 'z') return c - 'a' + 26;
+  if (c >= '0' && c <= '9') return c - '0' + 52;
+  if (c == '+' || c == '-') return 62;
+  if (c == '/' || c == '_') return 63;
+  return -1;
+}
+
+static byte* umb_base64_decode(const byte* src, u32 len, u64 size) {
+  byte* dst   = (byte*)calloc(size ? size : 1, 1);
+  u64   n_out = 0;
+  u32   bits  = 0;
+  u32   n     = 0;
+  for (u32 i = 0; i < len && n_out < size; ++i) {
+    i32 v = umb_base64_value(src[i]);
+    if (v < 0) continue;
+    bits = (bits << 6) | (u32)v;
+    n += 6;
+    if (n >= 8) {
+      n -= 8;
+      dst[n_out++] = (byte)((bits >> n) & 0xff);
+    }
+  }
+  return dst;
+}
+
+static i32 umb_hex_value(byte c) {
+  if (c >= '0' && c <= '9') return c - '0';
+  if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+  return -1;
+}
+
+// resolves a relative, percent-encoded uri against the directory of the .gltf file
+static b32 umb_gltf_buffer_path(
+    str         gltf_path,
+    const byte* uri,
+    u32         uri_len,
+    char*       out_path) {
+  str dir_end = strrchr(gltf_path, '/');
+  str bsl_end = strrchr(gltf_path, '\\');
+  if (bsl_end > dir_end) dir_end = bsl_end;
+
+  u32 n = dir_end ? (u32)(dir_end - gltf_path) + 1 : 0;
+  if (n >= MAX_PATH_LENGTH) return false;
+  memcpy(out_path, gltf_path, n);
+
+  for (u32 i = 0; i < uri_len; ++i) {
+    if (n + 1 >= MAX_PATH_LENGTH) return false;
+    byte c = uri[i];
+    if (c == '%' && i + 2 < uri_len && umb_hex_value(uri[i + 1]) >= 0 &&
+        umb_hex_value(uri[i + 2]) >= 0) {
+      c = (byte)(umb_hex_value(uri[i + 1]) * 16 + umb_hex_value(uri[i + 2]));
+      i += 2;
+    }
+    out_path[n++] = c;
+  }
+  out_path[n] = 0;
+  return true;
+}
+
+static void umb_gltf_matrix_from_trs(f32* m, const f32* t, const f32* r, const f32* s) {
+  f32 x = r[0], y = r[1], z = r[2], w = r[3];
+
+  m[0]  = (1.f - 2.f * (y * y + z * z)) * s[0];
+  m[1]  = (2.f * (x * y + z * w)) * s[0];
+  m[2]  = (2.f * (x * z - y * w)) * s[0];
+  m[3]  = 0.f;
+  m[4]  = (2.f * (x * y - z * w)) * s[1];
+  m[5]  = (1.f - 2.f * (x * x + z * z)) * s[1];
+  m[6]  = (2.f * (y * z + x * w)) * s[1];
+  m[7]  = 0.f;
+  m[8]  = (2.f * (x * z + y * w)) * s[2];
+  m[9]  = (2.f * (y * z - x * w)) * s[2];
+  m[10] = (1.f - 2.f * (x * x + y * y)) * s[2];
+  m[11] = 0.f;
+  m[12] = t[0];
+  m[13] = t[1];
+  m[14] = t[2];
+  m[15] = 1.f;
+}
+
+static void umb_gltf_read_vector(const umb_json* json, u32 object, str key, f32* out, u32 n) {
+  u32 array = umb_json_find(json, object, key);
+  if (umb_json_count(json, array) != n) return;
+  u32 tok = umb_json_first(array);
+  for (u32 i = 0; i < n; ++i, tok = json->tokens[tok].next) {
+    out[i] = (f32)umb_json_number(json, tok, out[i]);
+  }
+}
+
+static u32 umb_gltf_type_components(const umb_json* json, u32 tok) {
+  static const struct {
+    str name;
+    u32 n;
+  } types[] = {
+      {"SCALAR", 1},
+      {"VEC2", 2},
+      {"VEC3", 3},
+      {"VEC4", 4},
+      {"MAT2", 4},
+      {"MAT3", 9},
+      {"MAT4", 16},
+  };
+  for (u32 i = 0; i < UMB_ARRAY_COUNT(types, types[0]); ++i) {
+    if (umb_json_equals(json, tok, types[i].name)) return types[i].n;
+  }
+  return 0;
+}
+
+u32 umb_gltf_component_size(u32 component_type) {
+  switch (component_type) {
+  case UMB_GLTF_BYTE:
+  case UMB_GLTF_UNSIGNED_BYTE: return 1;
+  case UMB_GLTF_SHORT:
+  case UMB_GLTF_UNSIGNED_SHORT: return 2;
+  case UMB_GLTF_UNSIGNED_INT:
+  case UMB_GLTF_FLOAT: return 4;
+  }
+  return 0;
+}
+
+static b32 umb_gltf_load_buffers(
+    umb_gltf*             gltf,
+    const umb_json*       json,
+    str                   filename,
+    const byte*           glb_bin,
+    u64                   glb_bin_size,
+    umb_gltf_buffer_view* buffers) {
+  u32 array       = umb_json_find(json, 0, "buffers");
+  gltf->n_buffers = umb_json_count(json, array);
+  gltf->buffer_files    = (umb_mapped_file*)calloc(gltf->n_buffers + 1, sizeof(umb_mapped_file));
+  gltf->decoded_buffers = (byte**)calloc(gltf->n_buffers + 1, sizeof(byte*));
+
+  u32 tok = umb_json_first(array);
+  for (u32 i = 0; i < gltf->n_buffers; ++i, tok = json->tokens[tok].next) {
+    u64 size = (u64)umb_json_number(json, umb_json_find(json, tok, "byteLength"), 0);
+    u32 uri  = umb_json_find(json, tok, "uri");
+
+    if (uri == INVALID_TOKEN) {
+      // the binary chunk of a .glb
+      if (i != 0 || !glb_bin || glb_bin_size < size) {
+        UMBI_LOG_ERROR("gltf: buffer %u has no data", i);
+        return false;
+      }
+      buffers[i] = {.data = glb_bin, .size = size};
+      continue;
+    }
+
+    const byte* uri_text = json->text + json->tokens[uri].start;
+    u32         uri_len  = json->tokens[uri].end - json->tokens[uri].start;
+    if (uri_len > 5 && memcmp(uri_text, "data:", 5) == 0) {
+      const byte* comma = (const byte*)memchr(uri_text, ',', uri_len);
+      if (!comma) {
+        UMBI_LOG_ERROR("gltf: malformed data uri in buffer %u", i);
+        return false;
+      }
+      u32 header_len = (u32)(comma - uri_text) + 1;
+      gltf->decoded_buffers[i] = umb_base64_decode(comma + 1, uri_len - header_len, size);
+      buffers[i]               = {.data = gltf->decoded_buffers[i], .size = size};
+      continue;
+    }
+
+    char path[MAX_PATH_LENGTH];
+    if (!umb_gltf_buffer_path(filename, uri_text, uri_len, path) ||
+        !umb_map_file(path, &gltf->buffer_files[i]) || gltf->buffer_files[i].size < size) {
+      UMBI_LOG_ERROR("gltf: could not map buffer %u", i);
+      return false;
+    }
+    buffers[i] = {.data = gltf->buffer_files[i].data, .size = size};
+  }
+  return true;
+}
+
+static b32 umb_gltf_load_accessors(
+    umb_gltf*                   gltf,
+    const umb_json*             json,
+    const umb_gltf_buffer_view* buffers) {
+  u32                   views_array = umb_json_find(json, 0, "bufferViews");
+  u32                   n_views     = umb_json_count(json, views_array);
+  umb_gltf_buffer_view* views =
+      (umb_gltf_buffer_view*)calloc(n_views + 1, sizeof(umb_gltf_buffer_view));
+
+  b32 ok  = true;
+  u32 tok = umb_json_first(views_array);
+  for (u32 i = 0; i < n_views && ok; ++i, tok = json->tokens[tok].next) {
+    i32 buffer = umb_json_int(json, tok, "buffer", -1);
+    u64 offset = (u64)umb_json_number(json, umb_json_find(json, tok, "byteOffset"), 0);
+    u64 length = (u64)umb_json_number(json, umb_json_find(json, tok, "byteLength"), 0);
+    ok = buffer >= 0 && (u32)buffer < gltf->n_buffers && offset + length <= buffers[buffer].size;
+    if (ok) {
+      views[i] = {
+          .data   = buffers[buffer].data + offset,
+          .size   = length,
+          .stride = (u32)umb_json_int(json, tok, "byteStride", 0),
+      };
+    } else {
+      UMBI_LOG_ERROR("gltf: buffer view %u is out of bounds", i);
+    }
+  }
+
+  u32 array         = umb_json_find(json, 0, "accessors");
+  gltf->n_accessors = umb_json_count(json, array);
+  gltf->accessors =
+      (umb_gltf_accessor*)calloc(gltf->n_accessors + 1, sizeof(umb_gltf_accessor));
+
+  tok = umb_json_first(array);
+  for (u32 i = 0; i < gltf->n_accessors && ok; ++i, tok = json->tokens[tok].next) {
+    umb_gltf_accessor* accessor = &gltf->accessors[i];
+    accessor->count             = (u32)umb_json_int(json, tok, "count", 0);
+    accessor->component_type    = (u32)umb_json_int(json, tok, "componentType", 0);
+    accessor->n_components = umb_gltf_type_components(json, umb_json_find(json, tok, "type"));
+    accessor->normalized   = umb_json_bool(json, tok, "normalized");
+
+    u32 elem_size = umb_gltf_component_size(accessor->component_type) * accessor->n_components;
+    if (elem_size == 0) {
+      UMBI_LOG_ERROR("gltf: accessor %u has an unknown type", i);
+      ok = false;
+      break;
+    }
+    if (umb_json_find(json, tok, "sparse") != INVALID_TOKEN) {
+      UMBI_LOG_WARN("gltf: sparse accessor %u is read without its sparse values", i);
+    }
+
+    i32 view = umb_json_int(json, tok, "bufferView", -1);
+    if (view < 0) continue;
+    if ((u32)view >= n_views) {
+      UMBI_LOG_ERROR("gltf: accessor %u references a missing buffer view", i);
+      ok = false;
+      break;
+    }
+
+    u64 offset       = (u64)umb_json_number(json, umb_json_find(json, tok, "byteOffset"), 0);
+    accessor->stride = views[view].stride ? views[view].stride : elem_size;
+    u64 extent =
+        accessor->count ? offset + (u64)accessor->stride * (accessor->count - 1) + elem_size : 0;
+    if (extent > views[view].size) {
+      UMBI_LOG_ERROR("gltf: accessor %u is out of bounds", i);
+      ok = false;
+      break;
+    }
+    accessor->data = views[view].data + offset;
+  }
+
+  free(views);
+  return ok;
+}
+
+static i32 umb_gltf_accessor_index(const umb_gltf* gltf, i32 accessor) {
+  return accessor >= 0 && (u32)accessor < gltf->n_accessors ? accessor : -1;
+}
+
+static void umb_gltf_load_meshes(umb_gltf* gltf, const umb_json* json, byte** strings) {
+  u32 array      = umb_json_find(json, 0, "meshes");
+  gltf->n_meshes = umb_json_count(json, array);
+  gltf->meshes   = (umb_gltf_mesh*)calloc(gltf->n_meshes + 1, sizeof(umb_gltf_mesh));
+
+  u32 n_primitives = 0;
+  u32 tok          = umb_json_first(array);
+  for (u32 i = 0; i < gltf->n_meshes; ++i, tok = json->tokens[tok].next) {
+    n_primitives += umb_json_count(json, umb_json_find(json, tok, "primitives"));
+  }
+  gltf->primitives =
+      (umb_gltf_primitive*)calloc(n_primitives + 1, sizeof(umb_gltf_primitive));
+
+  tok = umb_json_first(array);
+  for (u32 i = 0; i < gltf->n_meshes; ++i, tok = json->tokens[tok].next) {
+    umb_gltf_mesh* mesh   = &gltf->meshes[i];
+    mesh->name            = umb_gltf_copy_string(json, umb_json_find(json, tok, "name"), strings);
+    mesh->first_primitive = gltf->n_primitives;
+
+    u32 prims = umb_json_find(json, tok, "primitives");
+    u32 prim  = umb_json_first(prims);
+    for (u32 p = 0; p < umb_json_count(json, prims); ++p, prim = json->tokens[prim].next) {
+      u32 attributes = umb_json_find(json, prim, "attributes");
+      gltf->primitives[gltf->n_primitives++] = {
+          .position =
+              umb_gltf_accessor_index(gltf, umb_json_int(json, attributes, "POSITION", -1)),
+          .normal = umb_gltf_accessor_index(gltf, umb_json_int(json, attributes, "NORMAL", -1)),
+          .color  = umb_gltf_accessor_index(gltf, umb_json_int(json, attributes, "COLOR_0", -1)),
+          .uv = umb_gltf_accessor_index(gltf, umb_json_int(json, attributes, "TEXCOORD_0", -1)),
+          .indices = umb_gltf_accessor_index(gltf, umb_json_int(json, prim, "indices", -1)),
+          .mode    = (u32)umb_json_int(json, prim, "mode", UMB_GLTF_MODE_TRIANGLES),
+      };
+      mesh->n_primitives++;
+    }
+  }
+}
+
+static void umb_gltf_load_nodes(umb_gltf* gltf, const umb_json* json, byte** strings) {
+  u32 array   = umb_json_find(json, 0, "nodes");
+  u32 n_nodes = umb_json_count(json, array);
+
+  u32* node_tokens = (u32*)malloc(sizeof(u32) * (n_nodes + 1));
+  i32* parents     = (i32*)malloc(sizeof(i32) * (n_nodes + 1));
+  u32* order       = (u32*)malloc(sizeof(u32) * (n_nodes + 1));
+  i32* remap       = (i32*)malloc(sizeof(i32) * (n_nodes + 1));
+
+  u32 tok = umb_json_first(array);
+  for (u32 i = 0; i < n_nodes; ++i, tok = json->tokens[tok].next) {
+    node_tokens[i] = tok;
+    parents[i]     = -1;
+    remap[i]       = -1;
+  }
+  for (u32 i = 0; i < n_nodes; ++i) {
+    u32 children = umb_json_find(json, node_tokens[i], "children");
+    u32 child    = umb_json_first(children);
+    for (u32 c = 0; c < umb_json_count(json, children); ++c, child = json->tokens[child].next) {
+      i32 idx = (i32)umb_json_number(json, child, -1);
+      if (idx >= 0 && (u32)idx < n_nodes && parents[idx] < 0) parents[idx] = (i32)i;
+    }
+  }
+
+  // breadth first from the default scene's roots, so parents land before their children. every
+  // node is visited at most once, which also breaks malformed cycles.
+  u32 n_order = 0;
+  u32 scenes  = umb_json_find(json, 0, "scenes");
+  i32 scene   = umb_json_int(json, 0, "scene", 0);
+  if (scene >= 0 && (u32)scene < umb_json_count(json, scenes)) {
+    u32 scene_tok = umb_json_first(scenes);
+    for (i32 s = 0; s < scene; ++s) scene_tok = json->tokens[scene_tok].next;
+
+    u32 roots = umb_json_find(json, scene_tok, "nodes");
+    u32 root  = umb_json_first(roots);
+    for (u32 r = 0; r < umb_json_count(json, roots); ++r, root = json->tokens[root].next) {
+      i32 idx = (i32)umb_json_number(json, root, -1);
+      if (idx < 0 || (u32)idx >= n_nodes || remap[idx] >= 0) continue;
+      remap[idx]       = (i32)n_order;
+      order[n_order++] = (u32)idx;
+    }
+  } else {
+    for (u32 i = 0; i < n_nodes; ++i) {
+      if (parents[i] >= 0) continue;
+      remap[i]         = (i32)n_order;
+      order[n_order++] = i;
+    }
+  }
+
+  for (u32 head = 0; head < n_order; ++head) {
+    u32 children = umb_json_find(json, node_tokens[order[head]], "children");
+    u32 child    = umb_json_first(children);
+    for (u32 c = 0; c < umb_json_count(json, children); ++c, child = json->tokens[child].next) {
+      i32 idx = (i32)umb_json_number(json, child, -1);
+      if (idx < 0 || (u32)idx >= n_nodes || remap[idx] >= 0) continue;
+      remap[idx]       = (i32)n_order;
+      order[n_order++] = (u32)idx;
+    }
+  }
+
+  gltf->n_nodes = n_order;
+  gltf->nodes   = (umb_gltf_node*)calloc(n_order + 1, sizeof(umb_gltf_node));
+  for (u32 i = 0; i < n_order; ++i) {
+    u32            src      = order[i];
+    u32            node_tok = node_tokens[src];
+    umb_gltf_node* node     = &gltf->nodes[i];
+
+    node->name   = umb_gltf_copy_string(json, umb_json_find(json, node_tok, "name"), strings);
+    node->parent = parents[src] >= 0 ? remap[parents[src]] : -1;
+    node->mesh   = umb_json_int(json, node_tok, "mesh", -1);
+    if (node->mesh >= 0 && (u32)node->mesh >= gltf->n_meshes) node->mesh = -1;
+
+    f32 t[3] = {0.f, 0.f, 0.f};
+    f32 r[4] = {0.f, 0.f, 0.f, 1.f};
+    f32 s[3] = {1.f, 1.f, 1.f};
+    umb_gltf_read_vector(json, node_tok, "translation", t, 3);
+    umb_gltf_read_vector(json, node_tok, "rotation", r, 4);
+    umb_gltf_read_vector(json, node_tok, "scale", s, 3);
+    umb_gltf_matrix_from_trs(node->matrix, t, r, s);
+    umb_gltf_read_vector(json, node_tok, "matrix", node->matrix, 16);
+  }
+
+  free(node_tokens);
+  free(parents);
+  free(order);
+  free(remap);
+}
+
+b32 umb_gltf_load(str filename, umb_gltf* out_gltf) {
+  umb_gltf* gltf = out_gltf;
+  *gltf          = {};
+
+  if (!umb_map_file(filename, &gltf->file)) {
+    UMBI_LOG_ERROR("gltf: could not open %s", filename);
+    return false;
+  }
+
+  const byte* text         = gltf->file.data;
+  u64         text_len     = gltf->file.size;
+  const byte* glb_bin      = NULL;
+  u64         glb_bin_size = 0;
+
+  u32 magic = 0;
+  if (gltf->file.size >= GLB_HEADER_SIZE) memcpy(&magic, gltf->file.data, sizeof(u32));
+  if (magic == GLB_MAGIC) {
+    // header, then a JSON chunk and an optional BIN chunk, each with a length and type word
+    u32 json_header[2] = {};
+    if (gltf->file.size >= GLB_HEADER_SIZE + GLB_CHUNK_HEADER) {
+      memcpy(json_header, gltf->file.data + GLB_HEADER_SIZE, sizeof(json_header));
+    }
+    u64 json_start = GLB_HEADER_SIZE + GLB_CHUNK_HEADER;
+    if (json_header[1] != GLB_CHUNK_JSON || json_start + json_header[0] > gltf->file.size) {
+      UMBI_LOG_ERROR("gltf: %s is not a valid .glb", filename);
+      umb_gltf_free(gltf);
+      return false;
+    }
+    text     = gltf->file.data + json_start;
+    text_len = json_header[0];
+
+    u64 bin_header_start = json_start + json_header[0];
+    u32 bin_header[2]    = {};
+    if (bin_header_start + GLB_CHUNK_HEADER <= gltf->file.size) {
+      memcpy(bin_header, gltf->file.data + bin_header_start, sizeof(bin_header));
+      u64 bin_start = bin_header_start + GLB_CHUNK_HEADER;
+      if (bin_header[1] == GLB_CHUNK_BIN && bin_start + bin_header[0] <= gltf->file.size) {
+        glb_bin      = gltf->file.data + bin_start;
+        glb_bin_size = bin_header[0];
+      }
+    }
+  }
+
+  umb_json json = {.text = text, .len = (u32)text_len};
+  if (!umb_json_parse_value(&json, 0) || json.tokens[0].type != UMB_JSON_OBJECT) {
+    UMBI_LOG_ERROR("gltf: could not parse the JSON of %s", filename);
+    free(json.tokens);
+    umb_gltf_free(gltf);
+    return false;
+  }
+
+  gltf->strings = (byte*)malloc(text_len + 1);
+  byte* strings = gltf->strings;
+
+  u32                   n_buffers = umb_json_count(&json, umb_json_find(&json, 0, "buffers"));
+  umb_gltf_buffer_view* buffers =
+      (umb_gltf_buffer_view*)calloc(n_buffers + 1, sizeof(umb_gltf_buffer_view));
+
+  b32 ok = umb_gltf_load_buffers(gltf, &json, filename, glb_bin, glb_bin_size, buffers) &&
+           umb_gltf_load_accessors(gltf, &json, buffers);
+  if (ok) {
+    umb_gltf_load_meshes(gltf, &json, &strings);
+    umb_gltf_load_nodes(gltf, &json, &strings);
+  }
+
+  free(buffers);
+  free(json.tokens);
+  if (!ok) umb_gltf_free(gltf);
+  return ok;
+}
+
+void umb_gltf_free(umb_gltf* gltf) {
+  for (u32 i = 0; i < gltf->n_buffers; ++i) {
+    if (gltf->buffer_files) umb_unmap_file(&gltf->buffer_files[i]);
+    if (gltf->decoded_buffers) free(gltf->decoded_buffers[i]);
+  }
+  umb_unmap_file(&gltf->file);
+
+  free(gltf->buffer_files);
+  free(gltf->decoded_buffers);
+  free(gltf->accessors);
+  free(gltf->primitives);
+  free(gltf->meshes);
+  free(gltf->nodes);
+  free(gltf->strings);
+  *gltf = {};
+}
+
+void umb_gltf_read_floats(const umb_gltf_accessor* accessor, u32 i, f32* out, u32 n) {
+  for (u32 c = 0; c < n; ++c) out[c] = 0.f;
+  if (!accessor->data || i >= accessor->count) return;
+
+  const byte* elem = accessor->data + (u64)accessor->stride * i;
+  u32         m    = n < accessor->n_components ? n : accessor->n_components;
+  for (u32 c = 0; c < m; ++c) {
+    switch (accessor->component_type) {
+    case UMB_GLTF_FLOAT: {
+      memcpy(&out[c], elem + c * 4, sizeof(f32));
+    } break;
+    case UMB_GLTF_UNSIGNED_BYTE: {
+      u8 v   = (u8)elem[c];
+      out[c] = accessor->normalized ? v / 255.f : (f32)v;
+    } break;
+    case UMB_GLTF_BYTE: {
+      i8 v   = (i8)elem[c];
+      out[c] = accessor->normalized ? fmaxf(v / 127.f, -1.f) : (f32)v;
+    } break;
+    case UMB_GLTF_UNSIGNED_SHORT: {
+      u16 v;
+      memcpy(&v, elem + c * 2, sizeof(u16));
+      out[c] = accessor->normalized ? v / 65535.f : (f32)v;
+    } break;
+    case UMB_GLTF_SHORT: {
+      i16 v;
+      memcpy(&v, elem + c * 2, sizeof(i16));
+      out[c] = accessor->normalized ? fmaxf(v / 32767.f, -1.f) : (f32)v;
+    } break;
+    case UMB_GLTF_UNSIGNED_INT: {
+      u32 v;
+      memcpy(&v, elem + c * 4, sizeof(u32));
+      out[c] = (f32)v;
+    } break;
+    }
+  }
+}
+
+u32 umb_gltf_read_index(const umb_gltf_accessor* accessor, u32 i) {
+  if (!accessor->data || i >= accessor->count) return 0;
+
+  const byte* elem = accessor->data + (u64)accessor->stride * i;
+  switch (accessor->component_type) {
+  case UMB_GLTF_UNSIGNED_BYTE: return (u8)elem[0];
+  case UMB_GLTF_UNSIGNED_SHORT: {
+    u16 v;
+    memcpy(&v, elem, sizeof(u16));
+    return v;
+  }
+  case UMB_GLTF_UNSIGNED_INT: {
+    u32 v;
+    memcpy(&v, elem, sizeof(u32));
+    return v;
+  }
+  }
+  return 0;
+}
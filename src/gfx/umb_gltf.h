@@ -0,0 +1,80 @@
+#pragma once
+
+#include <umbral.h>
+
+// Reader for glTF 2.0 scenes, either .gltf JSON with external or base64 embedded buffers or
+// binary .glb. External buffers and .glb files are memory mapped, so accessors point straight
+// into the file and data whose layout already matches needs no conversion.
+
+enum umb_gltf_component_type {
+  UMB_GLTF_BYTE           = 5120,
+  UMB_GLTF_UNSIGNED_BYTE  = 5121,
+  UMB_GLTF_SHORT          = 5122,
+  UMB_GLTF_UNSIGNED_SHORT = 5123,
+  UMB_GLTF_UNSIGNED_INT   = 5125,
+  UMB_GLTF_FLOAT          = 5126,
+};
+
+static constexpr u32 UMB_GLTF_MODE_TRIANGLES = 4;
+
+// an accessor without a buffer view has a NULL `data` and reads as zeros
+struct umb_gltf_accessor {
+  const byte* data;
+  u32         count;
+  u32         stride;
+  u32         component_type;
+  u32         n_components;
+  b32         normalized;
+};
+
+// attributes and indices are accessor indices, -1 when absent
+struct umb_gltf_primitive {
+  i32 position;
+  i32 normal;
+  i32 color;
+  i32 uv;
+  i32 indices;
+  u32 mode;
+};
+
+struct umb_gltf_mesh {
+  str name;
+  u32 first_primitive;
+  u32 n_primitives;
+};
+
+// nodes are ordered so that every parent precedes its children. only nodes reachable from the
+// default scene are kept.
+struct umb_gltf_node {
+  str name;
+  i32 parent;
+  i32 mesh;
+  // local transform, column major
+  f32 matrix[16];
+};
+
+struct umb_gltf {
+  umb_gltf_accessor*  accessors;
+  u32                 n_accessors;
+  umb_gltf_primitive* primitives;
+  u32                 n_primitives;
+  umb_gltf_mesh*      meshes;
+  u32                 n_meshes;
+  umb_gltf_node*      nodes;
+  u32                 n_nodes;
+
+  // backing storage for the accessors
+  umb_mapped_file  file;
+  umb_mapped_file* buffer_files;
+  byte**           decoded_buffers;
+  u32              n_buffers;
+  byte*            strings;
+};
+
+b32  umb_gltf_load(str filename, umb_gltf* out_gltf);
+void umb_gltf_free(umb_gltf* gltf);
+
+u32 umb_gltf_component_size(u32 component_type);
+// reads up to n components of element i as floats, normalized integers map to [0, 1] / [-1, 1]
+void umb_gltf_read_floats(const umb_gltf_accessor* accessor, u32 i, f32* out, u32 n);
+u32  umb_gltf_read_index(const umb_gltf_accessor* accessor, u32 i);
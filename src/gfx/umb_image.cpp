@@ -0,0 +1,88 @@
+#include <gfx/umb_image.h>
+#include <stdlib.h>
+#include <string.h>
+#include <umbral.h>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include <gfx/stb_image.h>
+
+u32 umb_image_mip_count(u32 width, u32 height) {
+  u32 n_mips = 1;
+  for (u32 size = width > height ? width : height; size > 1; size /= 2) n_mips++;
+  return n_mips;
+}
+
+u64 umb_image_level_size(u32 width, u32 height, u32 level) {
+  u32 level_width  = width >> level ? width >> level : 1;
+  u32 level_height = height >> level ? height >> level : 1;
+  return (u64)level_width * level_height * 4;
+}
+
+void umb_image_downsample_rgba8(const u8* src, u32 width, u32 height, u8* dst) {
+  u32 dst_width  = width > 1 ? width / 2 : 1;
+  u32 dst_height = height > 1 ? height / 2 : 1;
+  for (u32 y = 0; y < dst_height; ++y) {
+    u32 y0 = y * 2 < height ? y * 2 : height - 1;
+    u32 y1 = y * 2 + 1 < height ? y * 2 + 1 : height - 1;
+    for (u32 x = 0; x < dst_width; ++x) {
+      u32 x0 = x * 2 < width ? x * 2 : width - 1;
+      u32 x1 = x * 2 + 1 < width ? x * 2 + 1 : width - 1;
+      for (u32 c = 0; c < 4; ++c) {
+        u32 sum = src[((u64)y0 * width + x0) * 4 + c] + src[((u64)y0 * width + x1) * 4 + c] +
+                  src[((u64)y1 * width + x0) * 4 + c] + src[((u64)y1 * width + x1) * 4 + c];
+        dst[((u64)y * dst_width + x) * 4 + c] = (u8)((sum + 2) / 4);
+      }
+    }
+  }
+}
+
+void umb_image_info_job(void* data) {
+  umb_image_decode* decode = (umb_image_decode*)data;
+
+  int width, height, channels;
+  decode->ok     = stbi_info(decode->file, &width, &height, &channels) && width > 0 && height > 0;
+  decode->width  = decode->ok ? (u32)width : 0;
+  decode->height = decode->ok ? (u32)height : 0;
+  if (!decode->ok) UMBI_LOG_ERROR("Failed to load texture from file: %s", decode->file);
+}
+
+void umb_image_decode_job(void* data) {
+  umb_image_decode* decode = (umb_image_decode*)data;
+
+  int      width, height, channels;
+  stbi_uc* pixels = stbi_load(decode->file, &width, &height, &channels, STBI_rgb_alpha);
+  if (!pixels || (u32)width != decode->width || (u32)height != decode->height) {
+    UMBI_LOG_ERROR("Failed to load texture from file: %s", decode->file);
+    stbi_image_free(pixels);
+    decode->ok = false;
+    return;
+  }
+
+  // stb_image only decodes into memory of its own, so level 0 takes one copy into `dst`
+  u64 level0_size = umb_image_level_size(decode->width, decode->height, 0);
+  memcpy(decode->dst, pixels, level0_size);
+
+  if (decode->n_levels > 1) {
+    // `dst` may be write-combined, the chain is filtered in cached memory and copied once
+    u64 chain_size = 0;
+    for (u32 level = 1; level < decode->n_levels; ++level) {
+      chain_size += umb_image_level_size(decode->width, decode->height, level);
+    }
+
+    u8*       chain  = (u8*)malloc(chain_size);
+    const u8* src    = pixels;
+    u64       offset = 0;
+    for (u32 level = 1; level < decode->n_levels; ++level) {
+      u32 src_width  = decode->width >> (level - 1) ? decode->width >> (level - 1) : 1;
+      u32 src_height = decode->height >> (level - 1) ? decode->height >> (level - 1) : 1;
+      umb_image_downsample_rgba8(src, src_width, src_height, chain + offset);
+      src = chain + offset;
+      offset += umb_image_level_size(decode->width, decode->height, level);
+    }
+    memcpy(decode->dst + level0_size, chain, chain_size);
+    free(chain);
+  }
+
+  stbi_image_free(pixels);
+  decode->ok = true;
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <core/umb_common.h>
+
+// Image decoding for the texture loading pipeline, split into job procs so that many images
+// decode at once. The info job reads only the header, which tells the loader how much staging
+// memory to set aside. The decode job then writes RGBA8 levels straight into that memory.
+
+struct umb_image_decode {
+  str file;
+  // set by the info job and checked again by the decode job
+  u32 width;
+  u32 height;
+  // levels written to `dst` back to back and tightly packed, the first being the image itself
+  // and the rest its box filtered mip chain
+  u32 n_levels;
+  u8* dst;
+  b32 ok;
+};
+
+u32  umb_image_mip_count(u32 width, u32 height);
+u64  umb_image_level_size(u32 width, u32 height, u32 level);
+// 2x2 box filter of an RGBA8 level into the next one, odd edges repeat their last texel
+void umb_image_downsample_rgba8(const u8* src, u32 width, u32 height, u8* dst);
+
+// umb_job_proc signatures, `data` is a umb_image_decode
+void umb_image_info_job(void* data);
+void umb_image_decode_job(void* data);
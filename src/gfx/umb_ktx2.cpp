@@ -0,0 +1,249 @@
+#include <gfx/umb_ktx2.h>
+#include <stdio.h>
+#include <string.h>
+#include <vulkan/vulkan_core.h>
+
+static constexpr u8 KTX2_IDENTIFIER[12] = {
+    0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A,
+};
+static constexpr u32 KTX2_HEADER_SIZE      = 80;
+static constexpr u32 KTX2_LEVEL_INDEX_SIZE = 24;
+// total size word, the 24 byte basic block header and 16 bytes for each of up to two samples
+static constexpr u32 MAX_DFD_WORDS = 1 + 6 + 4 * 2;
+
+// khr_df.h values used by the basic data format descriptor
+static constexpr u32 KHR_DF_VERSION           = 2;
+static constexpr u32 KHR_DF_PRIMARIES_BT709   = 1;
+static constexpr u32 KHR_DF_TRANSFER_LINEAR   = 1;
+static constexpr u32 KHR_DF_TRANSFER_SRGB     = 2;
+static constexpr u32 KHR_DF_MODEL_BC1A        = 128;
+static constexpr u32 KHR_DF_MODEL_BC3         = 130;
+static constexpr u32 KHR_DF_MODEL_BC5         = 132;
+static constexpr u32 KHR_DF_MODEL_BC7         = 134;
+static constexpr u32 KHR_DF_CHANNEL_COLOR     = 0;
+static constexpr u32 KHR_DF_CHANNEL_GREEN     = 1;
+static constexpr u32 KHR_DF_CHANNEL_BC3_ALPHA = 15;
+
+// the header of the file, without the identifier. the 64 bit fields sit at 4 byte offsets.
+#pragma pack(push, 4)
+struct umb_ktx2_header {
+  u32 vk_format;
+  u32 type_size;
+  u32 pixel_width;
+  u32 pixel_height;
+  u32 pixel_depth;
+  u32 layer_count;
+  u32 face_count;
+  u32 level_count;
+  u32 supercompression_scheme;
+  u32 dfd_offset;
+  u32 dfd_length;
+  u32 kvd_offset;
+  u32 kvd_length;
+  u64 sgd_offset;
+  u64 sgd_length;
+};
+#pragma pack(pop)
+static_assert(sizeof(KTX2_IDENTIFIER) + sizeof(umb_ktx2_header) == KTX2_HEADER_SIZE);
+
+struct umb_ktx2_level_index {
+  u64 offset;
+  u64 length;
+  u64 uncompressed_length;
+};
+
+// one sample per 64 bit half of a block
+struct umb_ktx2_format_info {
+  u32 vk_format;
+  u32 block_size;
+  u32 color_model;
+  b32 srgb;
+  u32 n_samples;
+  u32 channels[2];
+};
+
+static const umb_ktx2_format_info KTX2_FORMATS[] = {
+    {VK_FORMAT_BC1_RGB_UNORM_BLOCK, 8, KHR_DF_MODEL_BC1A, false, 1, {KHR_DF_CHANNEL_COLOR}},
+    {VK_FORMAT_BC1_RGB_SRGB_BLOCK, 8, KHR_DF_MODEL_BC1A, true, 1, {KHR_DF_CHANNEL_COLOR}},
+    {VK_FORMAT_BC3_UNORM_BLOCK,
+     16,
+     KHR_DF_MODEL_BC3,
+     false,
+     2,
+     {KHR_DF_CHANNEL_BC3_ALPHA, KHR_DF_CHANNEL_COLOR}},
+    {VK_FORMAT_BC3_SRGB_BLOCK,
+     16,
+     KHR_DF_MODEL_BC3,
+     true,
+     2,
+     {KHR_DF_CHANNEL_BC3_ALPHA, KHR_DF_CHANNEL_COLOR}},
+    {VK_FORMAT_BC5_UNORM_BLOCK,
+     16,
+     KHR_DF_MODEL_BC5,
+     false,
+     2,
+     {KHR_DF_CHANNEL_COLOR, KHR_DF_CHANNEL_GREEN}},
+    {VK_FORMAT_BC7_UNORM_BLOCK, 16, KHR_DF_MODEL_BC7, false, 1, {KHR_DF_CHANNEL_COLOR}},
+    {VK_FORMAT_BC7_SRGB_BLOCK, 16, KHR_DF_MODEL_BC7, true, 1, {KHR_DF_CHANNEL_COLOR}},
+};
+
+static const umb_ktx2_format_info* umb_ktx2_format(u32 vk_format) {
+  for (u32 i = 0; i < UMB_ARRAY_COUNT(KTX2_FORMATS, umb_ktx2_format_info); ++i) {
+    if (KTX2_FORMATS[i].vk_format == vk_format) return &KTX2_FORMATS[i];
+  }
+  return NULL;
+}
+
+u32 umb_ktx2_block_size(u32 vk_format) {
+  const umb_ktx2_format_info* info = umb_ktx2_format(vk_format);
+  return info ? info->block_size : 0;
+}
+
+u64 umb_ktx2_level_size(u32 vk_format, u32 width, u32 height) {
+  return (u64)((width + 3) / 4) * ((height + 3) / 4) * umb_ktx2_block_size(vk_format);
+}
+
+b32 umb_ktx2_load(str filename, umb_ktx2* out_ktx2) {
+  umb_ktx2* ktx2 = out_ktx2;
+  *ktx2          = {};
+
+  if (!umb_map_file(filename, &ktx2->file)) {
+    UMBI_LOG_ERROR("ktx2: could not open %s", filename);
+    return false;
+  }
+
+  umb_ktx2_header header = {};
+  if (ktx2->file.size < KTX2_HEADER_SIZE ||
+      memcmp(ktx2->file.data, KTX2_IDENTIFIER, sizeof(KTX2_IDENTIFIER)) != 0) {
+    UMBI_LOG_ERROR("ktx2: %s is not a KTX2 file", filename);
+    umb_ktx2_free(ktx2);
+    return false;
+  }
+  memcpy(&header, ktx2->file.data + sizeof(KTX2_IDENTIFIER), sizeof(header));
+
+  // a full chain ends at 1x1, more levels than that would size past the image
+  u32 n_levels   = header.level_count ? header.level_count : 1;
+  u32 max_levels = 1;
+  u32 max_extent = header.pixel_width > header.pixel_height ? header.pixel_width
+                                                            : header.pixel_height;
+  while (max_levels < 32 && max_extent >> max_levels) max_levels++;
+
+  if (!umb_ktx2_format(header.vk_format) || header.pixel_width == 0 ||
+      header.pixel_height == 0 || header.pixel_depth > 0 || header.layer_count > 1 ||
+      header.face_count != 1 || header.supercompression_scheme != 0 || n_levels > max_levels ||
+      n_levels > UMB_KTX2_MAX_LEVELS ||
+      KTX2_HEADER_SIZE + (u64)n_levels * KTX2_LEVEL_INDEX_SIZE > ktx2->file.size) {
+    UMBI_LOG_ERROR("ktx2: %s is not a supported block-compressed 2D texture", filename);
+    umb_ktx2_free(ktx2);
+    return false;
+  }
+
+  ktx2->vk_format = header.vk_format;
+  ktx2->width     = header.pixel_width;
+  ktx2->height    = header.pixel_height;
+  ktx2->n_levels  = n_levels;
+
+  for (u32 level = 0; level < n_levels; ++level) {
+    umb_ktx2_level_index index;
+    memcpy(
+        &index,
+        ktx2->file.data + KTX2_HEADER_SIZE + (u64)level * KTX2_LEVEL_INDEX_SIZE,
+        sizeof(index));
+
+    u32 width  = ktx2->width >> level ? ktx2->width >> level : 1;
+    u32 height = ktx2->height >> level ? ktx2->height >> level : 1;
+    u64 size   = umb_ktx2_level_size(ktx2->vk_format, width, height);
+    if (index.length < size || index.offset > ktx2->file.size ||
+        index.length > ktx2->file.size - index.offset) {
+      UMBI_LOG_ERROR("ktx2: level %u of %s is out of bounds", level, filename);
+      umb_ktx2_free(ktx2);
+      return false;
+    }
+    ktx2->levels[level] = {.data = ktx2->file.data + index.offset, .size = size};
+  }
+  return true;
+}
+
+void umb_ktx2_free(umb_ktx2* ktx2) {
+  umb_unmap_file(&ktx2->file);
+  *ktx2 = {};
+}
+
+b32 umb_ktx2_write(
+    str                   filename,
+    u32                   vk_format,
+    u32                   width,
+    u32                   height,
+    const umb_ktx2_level* levels,
+    u32                   n_levels) {
+  const umb_ktx2_format_info* info = umb_ktx2_format(vk_format);
+  if (!info || n_levels == 0 || n_levels > UMB_KTX2_MAX_LEVELS) return false;
+
+  // basic descriptor block for 4x4 blocks: vendor and type 0, color model, primaries, transfer
+  // function, block dimensions minus one, bytes per block, then one sample per channel
+  u32 block_size  = 24 + 16 * info->n_samples;
+  u32 transfer    = info->srgb ? KHR_DF_TRANSFER_SRGB : KHR_DF_TRANSFER_LINEAR;
+  u32 n_dfd_words = 0;
+
+  u32 dfd[MAX_DFD_WORDS] = {};
+  dfd[n_dfd_words++]     = 4 + block_size;
+  dfd[n_dfd_words++]     = 0;
+  dfd[n_dfd_words++]     = KHR_DF_VERSION | (block_size << 16);
+  dfd[n_dfd_words++]     = info->color_model | (KHR_DF_PRIMARIES_BT709 << 8) | (transfer << 16);
+  dfd[n_dfd_words++]     = 3 | (3 << 8);
+  dfd[n_dfd_words++]     = info->block_size;
+  dfd[n_dfd_words++]     = 0;
+  for (u32 s = 0; s < info->n_samples; ++s) {
+    u32 bit_length     = info->block_size * 8 / info->n_samples;
+    dfd[n_dfd_words++] = (s * bit_length) | ((bit_length - 1) << 16) | (info->channels[s] << 24);
+    dfd[n_dfd_words++] = 0;
+    dfd[n_dfd_words++] = 0;
+    dfd[n_dfd_words++] = 0xFFFFFFFF;
+  }
+
+  u64 dfd_offset = KTX2_HEADER_SIZE + (u64)n_levels * KTX2_LEVEL_INDEX_SIZE;
+  u64 dfd_length = n_dfd_words * sizeof(u32);
+
+  // level data is stored smallest first, each level aligned to the block size
+  umb_ktx2_level_index index[UMB_KTX2_MAX_LEVELS];
+  u64                  offset = dfd_offset + dfd_length;
+  for (u32 level = n_levels; level-- > 0;) {
+    offset       = (offset + info->block_size - 1) / info->block_size * info->block_size;
+    index[level] = {
+        .offset              = offset,
+        .length              = levels[level].size,
+        .uncompressed_length = levels[level].size,
+    };
+    offset += levels[level].size;
+  }
+
+  umb_ktx2_header header = {
+      .vk_format    = vk_format,
+      .type_size    = 1,
+      .pixel_width  = width,
+      .pixel_height = height,
+      .face_count   = 1,
+      .level_count  = n_levels,
+      .dfd_offset   = (u32)dfd_offset,
+      .dfd_length   = (u32)dfd_length,
+  };
+
+  FILE* fp = fopen(filename, "wb");
+  if (!fp) return false;
+
+  b32 ok = fwrite(KTX2_IDENTIFIER, sizeof(KTX2_IDENTIFIER), 1, fp) == 1 &&
+           fwrite(&header, sizeof(header), 1, fp) == 1 &&
+           fwrite(index, KTX2_LEVEL_INDEX_SIZE, n_levels, fp) == n_levels &&
+           fwrite(dfd, dfd_length, 1, fp) == 1;
+
+  u64 pos = dfd_offset + dfd_length;
+  for (u32 level = n_levels; ok && level-- > 0;) {
+    static const u8 padding[16] = {};
+    ok  = fwrite(padding, 1, index[level].offset - pos, fp) == index[level].offset - pos &&
+          fwrite(levels[level].data, 1, levels[level].size, fp) == levels[level].size;
+    pos = index[level].offset + levels[level].size;
+  }
+
+  ok = fclose(fp) == 0 && ok;
+  return ok;
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <umbral.h>
+
+// Minimal KTX2 container support for block-compressed 2D textures: one face, one layer, no
+// supercompression. Levels are ordered from the full size image down, as in the level index.
+
+static constexpr u32 UMB_KTX2_MAX_LEVELS = 32;
+
+struct umb_ktx2_level {
+  const byte* data;
+  u64         size;
+};
+
+struct umb_ktx2 {
+  u32            vk_format;
+  u32            width;
+  u32            height;
+  u32            n_levels;
+  umb_ktx2_level levels[UMB_KTX2_MAX_LEVELS];
+
+  // the levels point into the mapped file
+  umb_mapped_file file;
+};
+
+// bytes per 4x4 block of a format the container supports, 0 for any other format
+u32 umb_ktx2_block_size(u32 vk_format);
+// bytes of a level of `width` x `height` texels, padded to whole blocks
+u64 umb_ktx2_level_size(u32 vk_format, u32 width, u32 height);
+
+b32  umb_ktx2_load(str filename, umb_ktx2* out_ktx2);
+void umb_ktx2_free(umb_ktx2* ktx2);
+
+// writes `n_levels` levels, level 0 being `width` x `height`, with a data format descriptor
+// matching `vk_format`
+b32 umb_ktx2_write(
+    str                   filename,
+    u32                   vk_format,
+    u32                   width,
+    u32                   height,
+    const umb_ktx2_level* levels,
+    u32                   n_levels);
@@ -0,0 +1,339 @@
+#include <gfx/umb_mesh_lod.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+static constexpr u32 MAX_SIMPLIFY_PASSES = 64;
+static constexpr u32 INVALID_INDEX       = ~0u;
+static constexpr u64 INVALID_EDGE        = ~0ull;
+
+struct umb_quadric {
+  f64 a00, a01, a02, a11, a12, a22;
+  f64 b0, b1, b2;
+  f64 c;
+  f64 w;
+};
+
+struct umb_collapse {
+  u32 from;
+  u32 to;
+  f32 error;
+};
+
+static const f32* umb_vertex_position(const f32* positions, u32 stride, u32 v) {
+  return (const f32*)((const byte*)positions + (u64)v * stride);
+}
+
+static void umb_quadric_add(umb_quadric* q, const umb_quadric* o) {
+  q->a00 += o->a00;
+  q->a01 += o->a01;
+  q->a02 += o->a02;
+  q->a11 += o->a11;
+  q->a12 += o->a12;
+  q->a22 += o->a22;
+  q->b0 += o->b0;
+  q->b1 += o->b1;
+  q->b2 += o->b2;
+  q->c += o->c;
+  q->w += o->w;
+}
+
+static void umb_quadric_from_plane(umb_quadric* q, f64 nx, f64 ny, f64 nz, f64 d, f64 w) {
+  q->a00 = w * nx * nx;
+  q->a01 = w * nx * ny;
+  q->a02 = w * nx * nz;
+  q->a11 = w * ny * ny;
+  q->a12 = w * ny * nz;
+  q->a22 = w * nz * nz;
+  q->b0  = w * nx * d;
+  q->b1  = w * ny * d;
+  q->b2  = w * nz * d;
+  q->c   = w * d * d;
+  q->w   = w;
+}
+
+// area weighted RMS distance from p to the planes accumulated in q
+static f32 umb_quadric_error(const umb_quadric* q, const f32* p) {
+  f64 x = p[0], y = p[1], z = p[2];
+  f64 r = q->a00 * x * x + q->a11 * y * y + q->a22 * z * z +
+          2 * (q->a01 * x * y + q->a02 * x * z + q->a12 * y * z) +
+          2 * (q->b0 * x + q->b1 * y + q->b2 * z) + q->c;
+  if (r < 0 || q->w <= 0) return 0.f;
+  return (f32)sqrt(r / q->w);
+}
+
+static void umb_triangle_normal(const f32* a, const f32* b, const f32* c, f32* n) {
+  f32 e0[3] = {b[0] - a[0], b[1] - a[1], b[2] - a[2]};
+  f32 e1[3] = {c[0] - a[0], c[1] - a[1], c[2] - a[2]};
+  n[0]      = e0[1] * e1[2] - e0[2] * e1[1];
+  n[1]      = e0[2] * e1[0] - e0[0] * e1[2];
+  n[2]      = e0[0] * e1[1] - e0[1] * e1[0];
+}
+
+static u32 umb_next_pow2(u32 v) {
+  u32 r = 1;
+  while (r < v) r <<= 1;
+  return r;
+}
+
+static u32 umb_hash_position(const f32* p) {
+  u32 h[3];
+  memcpy(h, p, sizeof(h));
+  return (h[0] * 73856093u) ^ (h[1] * 19349663u) ^ (h[2] * 83492791u);
+}
+
+static u64 umb_hash_edge(u64 key) {
+  return (key * 0x9E3779B97F4A7C15ull) >> 32;
+}
+
+// maps every vertex to the first vertex sharing its exact position so attribute seams collapse
+// as a single point
+static void umb_build_position_remap(u32* remap, const f32* positions, u32 n_vertices, u32 stride) {
+  u32  table_size = umb_next_pow2(n_vertices * 2);
+  u32  mask       = table_size - 1;
+  u32* table      = (u32*)malloc(sizeof(u32) * table_size);
+  memset(table, 0xff, sizeof(u32) * table_size);
+
+  for (u32 v = 0; v < n_vertices; ++v) {
+    const f32* p    = umb_vertex_position(positions, stride, v);
+    u32        slot = umb_hash_position(p) & mask;
+    remap[v]        = v;
+    while (table[slot] != INVALID_INDEX) {
+      if (memcmp(umb_vertex_position(positions, stride, table[slot]), p, sizeof(f32) * 3) == 0) {
+        remap[v] = table[slot];
+        break;
+      }
+      slot = (slot + 1) & mask;
+    }
+    if (remap[v] == v) table[slot] = v;
+  }
+
+  free(table);
+}
+
+// locks every vertex on an open edge, i.e. a directed edge without its opposite twin
+static void umb_lock_boundary(u8* locked, const u32* tris, u32 n_tris) {
+  u32  table_size = umb_next_pow2(n_tris * 6);
+  u32  mask       = table_size - 1;
+  u64* table      = (u64*)malloc(sizeof(u64) * table_size);
+  memset(table, 0xff, sizeof(u64) * table_size);
+
+  for (u32 i = 0; i < n_tris * 3; ++i) {
+    u32 a    = tris[i];
+    u32 b    = tris[i % 3 == 2 ? i - 2 : i + 1];
+    u64 key  = ((u64)a << 32) | b;
+    u32 slot = umb_hash_edge(key) & mask;
+    while (table[slot] != INVALID_EDGE && table[slot] != key) slot = (slot + 1) & mask;
+    table[slot] = key;
+  }
+
+  for (u32 i = 0; i < n_tris * 3; ++i) {
+    u32 a     = tris[i];
+    u32 b     = tris[i % 3 == 2 ? i - 2 : i + 1];
+    u64 twin  = ((u64)b << 32) | a;
+    u32 slot  = umb_hash_edge(twin) & mask;
+    b32 found = false;
+    while (table[slot] != INVALID_EDGE) {
+      if (table[slot] == twin) {
+        found = true;
+        break;
+      }
+      slot = (slot + 1) & mask;
+    }
+    if (!found) locked[a] = locked[b] = 1;
+  }
+
+  free(table);
+}
+
+static int umb_collapse_compare(const void* a, const void* b) {
+  f32 ea = ((const umb_collapse*)a)->error;
+  f32 eb = ((const umb_collapse*)b)->error;
+  return (ea > eb) - (ea < eb);
+}
+
+static b32 umb_collapse_flips(
+    const u32* tris,
+    const u32* adj_offsets,
+    const u32* adj_tris,
+    const f32* positions,
+    u32        stride,
+    u32        from,
+    u32        to) {
+  const f32* p_to = umb_vertex_position(positions, stride, to);
+
+  for (u32 k = adj_offsets[from]; k < adj_offsets[from + 1]; ++k) {
+    const u32* r = &tris[adj_tris[k] * 3];
+    if (r[0] == to || r[1] == to || r[2] == to) continue;
+
+    const f32* p[3] = {
+        umb_vertex_position(positions, stride, r[0]),
+        umb_vertex_position(positions, stride, r[1]),
+        umb_vertex_position(positions, stride, r[2]),
+    };
+    f32 n_old[3], n_new[3];
+    umb_triangle_normal(p[0], p[1], p[2], n_old);
+    for (u32 c = 0; c < 3; ++c) {
+      if (r[c] == from) p[c] = p_to;
+    }
+    umb_triangle_normal(p[0], p[1], p[2], n_new);
+
+    f32 d       = n_old[0] * n_new[0] + n_old[1] * n_new[1] + n_old[2] * n_new[2];
+    f32 len_old = sqrtf(n_old[0] * n_old[0] + n_old[1] * n_old[1] + n_old[2] * n_old[2]);
+    f32 len_new = sqrtf(n_new[0] * n_new[0] + n_new[1] * n_new[1] + n_new[2] * n_new[2]);
+    if (d < 0.25f * len_old * len_new) return true;
+  }
+
+  return false;
+}
+
+u32 umb_mesh_simplify(
+    u32*       dst,
+    const u32* indices,
+    u32        n_indices,
+    const f32* positions,
+    u32        n_vertices,
+    u32        stride,
+    u32        target_n_indices,
+    f32        target_error,
+    f32*       out_error) {
+  UMB_ASSERT(n_indices % 3 == 0);
+
+  u32*          remap       = (u32*)malloc(sizeof(u32) * n_vertices);
+  u32*          collapse_to = (u32*)malloc(sizeof(u32) * n_vertices);
+  u32*          adj_offsets = (u32*)malloc(sizeof(u32) * (n_vertices + 1));
+  u8*           locked      = (u8*)calloc(n_vertices, 1);
+  u8*           touched     = (u8*)malloc(n_vertices);
+  umb_quadric*  quadrics    = (umb_quadric*)calloc(n_vertices, sizeof(umb_quadric));
+  u32*          wedges      = (u32*)malloc(sizeof(u32) * n_indices);
+  u32*          tris        = (u32*)malloc(sizeof(u32) * n_indices);
+  u32*          adj_tris    = (u32*)malloc(sizeof(u32) * n_indices);
+  umb_collapse* candidates  = (umb_collapse*)malloc(sizeof(umb_collapse) * n_indices);
+
+  umb_build_position_remap(remap, positions, n_vertices, stride);
+
+  // drop triangles that are already degenerate once positions are welded
+  u32 n_tris = 0;
+  for (u32 i = 0; i < n_indices; i += 3) {
+    u32 r0 = remap[indices[i + 0]], r1 = remap[indices[i + 1]], r2 = remap[indices[i + 2]];
+    if (r0 == r1 || r1 == r2 || r0 == r2) continue;
+    wedges[n_tris * 3 + 0] = indices[i + 0];
+    wedges[n_tris * 3 + 1] = indices[i + 1];
+    wedges[n_tris * 3 + 2] = indices[i + 2];
+    tris[n_tris * 3 + 0]   = r0;
+    tris[n_tris * 3 + 1]   = r1;
+    tris[n_tris * 3 + 2]   = r2;
+    n_tris++;
+  }
+
+  for (u32 t = 0; t < n_tris; ++t) {
+    const f32* p0 = umb_vertex_position(positions, stride, tris[t * 3 + 0]);
+    const f32* p1 = umb_vertex_position(positions, stride, tris[t * 3 + 1]);
+    const f32* p2 = umb_vertex_position(positions, stride, tris[t * 3 + 2]);
+
+    f32 n[3];
+    umb_triangle_normal(p0, p1, p2, n);
+    f32 len = sqrtf(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+    if (len == 0.f) continue;
+    n[0] /= len;
+    n[1] /= len;
+    n[2] /= len;
+
+    umb_quadric q;
+    f32         d = -(n[0] * p0[0] + n[1] * p0[1] + n[2] * p0[2]);
+    umb_quadric_from_plane(&q, n[0], n[1], n[2], d, len * 0.5f);
+    for (u32 c = 0; c < 3; ++c) umb_quadric_add(&quadrics[tris[t * 3 + c]], &q);
+  }
+
+  umb_lock_boundary(locked, tris, n_tris);
+
+  f32 result_error = 0.f;
+  u32 target_tris  = target_n_indices / 3;
+  for (u32 pass = 0; pass < MAX_SIMPLIFY_PASSES && n_tris > target_tris; ++pass) {
+    // vertex -> triangle adjacency
+    memset(adj_offsets, 0, sizeof(u32) * (n_vertices + 1));
+    for (u32 i = 0; i < n_tris * 3; ++i) adj_offsets[tris[i] + 1]++;
+    for (u32 v = 0; v < n_vertices; ++v) adj_offsets[v + 1] += adj_offsets[v];
+    memcpy(collapse_to, adj_offsets, sizeof(u32) * n_vertices);
+    for (u32 i = 0; i < n_tris * 3; ++i) adj_tris[collapse_to[tris[i]]++] = i / 3;
+
+    u32 n_candidates = 0;
+    for (u32 i = 0; i < n_tris * 3; ++i) {
+      u32 a = tris[i];
+      u32 b = tris[i % 3 == 2 ? i - 2 : i + 1];
+      if (a > b || (locked[a] && locked[b])) continue;
+
+      umb_quadric q = quadrics[a];
+      umb_quadric_add(&q, &quadrics[b]);
+
+      f32 a_to_b = locked[a] ? INFINITY
+                             : umb_quadric_error(&q, umb_vertex_position(positions, stride, b));
+      f32 b_to_a = locked[b] ? INFINITY
+                             : umb_quadric_error(&q, umb_vertex_position(positions, stride, a));
+
+      candidates[n_candidates++] = a_to_b <= b_to_a ? umb_collapse {a, b, a_to_b}
+                                                    : umb_collapse {b, a, b_to_a};
+    }
+    qsort(candidates, n_candidates, sizeof(umb_collapse), umb_collapse_compare);
+
+    for (u32 v = 0; v < n_vertices; ++v) collapse_to[v] = v;
+    memset(touched, 0, n_vertices);
+
+    u32 n_collapses  = 0;
+    u32 tris_removed = 0;
+    for (u32 i = 0; i < n_candidates && n_tris - tris_removed > target_tris; ++i) {
+      umb_collapse c = candidates[i];
+      if (c.error > target_error) break;
+      if (touched[c.from] || touched[c.to]) continue;
+      if (umb_collapse_flips(tris, adj_offsets, adj_tris, positions, stride, c.from, c.to))
+        continue;
+
+      collapse_to[c.from] = c.to;
+      umb_quadric_add(&quadrics[c.to], &quadrics[c.from]);
+
+      for (u32 k = adj_offsets[c.from]; k < adj_offsets[c.from + 1]; ++k) {
+        const u32* tri = &tris[adj_tris[k] * 3];
+        if (tri[0] == c.to || tri[1] == c.to || tri[2] == c.to) tris_removed++;
+        touched[tri[0]] = touched[tri[1]] = touched[tri[2]] = 1;
+      }
+
+      result_error = c.error > result_error ? c.error : result_error;
+      n_collapses++;
+    }
+
+    if (n_collapses == 0) break;
+
+    u32 n_kept = 0;
+    for (u32 t = 0; t < n_tris; ++t) {
+      u32 r[3], w[3];
+      for (u32 c = 0; c < 3; ++c) {
+        u32 rep = tris[t * 3 + c];
+        r[c]    = collapse_to[rep];
+        w[c]    = r[c] == rep ? wedges[t * 3 + c] : r[c];
+      }
+      if (r[0] == r[1] || r[1] == r[2] || r[0] == r[2]) continue;
+      for (u32 c = 0; c < 3; ++c) {
+        tris[n_kept * 3 + c]   = r[c];
+        wedges[n_kept * 3 + c] = w[c];
+      }
+      n_kept++;
+    }
+    n_tris = n_kept;
+  }
+
+  memcpy(dst, wedges, sizeof(u32) * n_tris * 3);
+  if (out_error) *out_error = result_error;
+
+  free(candidates);
+  free(adj_tris);
+  free(tris);
+  free(wedges);
+  free(quadrics);
+  free(touched);
+  free(locked);
+  free(adj_offsets);
+  free(collapse_to);
+  free(remap);
+
+  return n_tris * 3;
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <core/umb_common.h>
+
+// Quadric error metric edge-collapse simplification over an indexed triangle list.
+// Positions are read from `positions` with a byte stride, so interleaved vertex data can be
+// passed directly. Writes at most n_indices indices to dst and returns the written count.
+// out_error receives the largest collapse error, in the same units as the positions.
+u32 umb_mesh_simplify(
+    u32*       dst,
+    const u32* indices,
+    u32        n_indices,
+    const f32* positions,
+    u32        n_vertices,
+    u32        stride,
+    u32        target_n_indices,
+    f32        target_error,
+    f32*       out_error);
@@ -0,0 +1,193 @@
+#include <gfx/umb_meshlet.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+static constexpr u32 INVALID_INDEX = ~0u;
+
+static const f32* umb_vertex_position(const f32* positions, u32 stride, u32 v) {
+  return (const f32*)((const byte*)positions + (u64)v * stride);
+}
+
+u32 umb_meshlet_count_bound(u32 n_indices, u32 max_vertices, u32 max_triangles) {
+  // a cluster is only closed once the next triangle would overflow it, so it holds at least
+  // this many triangles
+  u32 min_triangles = (max_vertices - 2) / 3;
+  if (min_triangles > max_triangles) min_triangles = max_triangles;
+  return (n_indices / 3 + min_triangles - 1) / min_triangles;
+}
+
+static void umb_meshlet_compute_bounds(
+    umb_meshlet* meshlet,
+    const u32*   cluster_vertices,
+    u32          n_cluster_vertices,
+    const u32*   cluster_indices,
+    const f32*   positions,
+    u32          stride) {
+  f32 min[3] = {INFINITY, INFINITY, INFINITY};
+  f32 max[3] = {-INFINITY, -INFINITY, -INFINITY};
+  for (u32 i = 0; i < n_cluster_vertices; ++i) {
+    const f32* p = umb_vertex_position(positions, stride, cluster_vertices[i]);
+    for (u32 c = 0; c < 3; ++c) {
+      min[c] = p[c] < min[c] ? p[c] : min[c];
+      max[c] = p[c] > max[c] ? p[c] : max[c];
+    }
+  }
+
+  f32 radius = 0.f;
+  for (u32 c = 0; c < 3; ++c) meshlet->center[c] = (min[c] + max[c]) * 0.5f;
+  for (u32 i = 0; i < n_cluster_vertices; ++i) {
+    const f32* p  = umb_vertex_position(positions, stride, cluster_vertices[i]);
+    f32        dx = p[0] - meshlet->center[0];
+    f32        dy = p[1] - meshlet->center[1];
+    f32        dz = p[2] - meshlet->center[2];
+    f32        d  = sqrtf(dx * dx + dy * dy + dz * dz);
+    radius        = d > radius ? d : radius;
+  }
+  meshlet->radius = radius;
+
+  u32  n_tris  = meshlet->index_count / 3;
+  f32* normals = (f32*)malloc(sizeof(f32) * 3 * n_tris);
+  f32  axis[3] = {0.f, 0.f, 0.f};
+  u32  n_valid = 0;
+  for (u32 t = 0; t < n_tris; ++t) {
+    const f32* a = umb_vertex_position(positions, stride, cluster_indices[t * 3 + 0]);
+    const f32* b = umb_vertex_position(positions, stride, cluster_indices[t * 3 + 1]);
+    const f32* c = umb_vertex_position(positions, stride, cluster_indices[t * 3 + 2]);
+
+    f32 e0[3] = {b[0] - a[0], b[1] - a[1], b[2] - a[2]};
+    f32 e1[3] = {c[0] - a[0], c[1] - a[1], c[2] - a[2]};
+    f32 n[3]  = {
+        e0[1] * e1[2] - e0[2] * e1[1],
+        e0[2] * e1[0] - e0[0] * e1[2],
+        e0[0] * e1[1] - e0[1] * e1[0],
+    };
+    f32 len = sqrtf(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+    if (len == 0.f) continue;
+
+    for (u32 k = 0; k < 3; ++k) {
+      normals[n_valid * 3 + k] = n[k] / len;
+      axis[k] += normals[n_valid * 3 + k];
+    }
+    n_valid++;
+  }
+
+  f32 axis_len = sqrtf(axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2]);
+  f32 min_dp   = 1.f;
+  if (axis_len > 0.f) {
+    for (u32 k = 0; k < 3; ++k) axis[k] /= axis_len;
+    for (u32 t = 0; t < n_valid; ++t) {
+      const f32* n  = &normals[t * 3];
+      f32        dp = n[0] * axis[0] + n[1] * axis[1] + n[2] * axis[2];
+      min_dp = dp < min_dp ? dp : min_dp;
+    }
+  }
+  free(normals);
+
+  for (u32 k = 0; k < 3; ++k) meshlet->cone_axis[k] = axis[k];
+  meshlet->cone_cutoff = (axis_len == 0.f || min_dp <= 0.1f) ? 1.f : sqrtf(1.f - min_dp * min_dp);
+}
+
+u32 umb_meshlets_build(
+    umb_meshlet* meshlets,
+    u32*         meshlet_indices,
+    const u32*   indices,
+    u32          n_indices,
+    const f32*   positions,
+    u32          n_vertices,
+    u32          stride,
+    u32          max_vertices,
+    u32          max_triangles) {
+  UMB_ASSERT(n_indices % 3 == 0);
+  UMB_ASSERT(max_vertices >= 3 && max_triangles >= 1);
+
+  u32  n_tris           = n_indices / 3;
+  u32* adj_offsets      = (u32*)calloc(n_vertices + 1, sizeof(u32));
+  u32* adj_tris         = (u32*)malloc(sizeof(u32) * n_indices);
+  u32* stamps           = (u32*)calloc(n_vertices, sizeof(u32));
+  u32* fill             = (u32*)malloc(sizeof(u32) * n_vertices);
+  u32* cluster_vertices = (u32*)malloc(sizeof(u32) * max_vertices);
+  u8*  emitted          = (u8*)calloc(n_tris, 1);
+
+  for (u32 i = 0; i < n_indices; ++i) adj_offsets[indices[i] + 1]++;
+  for (u32 v = 0; v < n_vertices; ++v) adj_offsets[v + 1] += adj_offsets[v];
+  memcpy(fill, adj_offsets, sizeof(u32) * n_vertices);
+  for (u32 i = 0; i < n_indices; ++i) adj_tris[fill[indices[i]]++] = i / 3;
+
+  u32 n_meshlets = 0;
+  u32 n_out      = 0;
+  u32 scan       = 0;
+  u32 n_emitted  = 0;
+  while (n_emitted < n_tris) {
+    // stamps are cluster ids + 1 so a zeroed stamp never matches
+    u32 stamp              = n_meshlets + 1;
+    u32 n_cluster_vertices = 0;
+    u32 n_cluster_tris     = 0;
+    u32 index_offset       = n_out;
+
+    for (;;) {
+      u32 best     = INVALID_INDEX;
+      u32 best_new = 4;
+      for (u32 i = 0; i < n_cluster_vertices && best_new > 0; ++i) {
+        u32 v = cluster_vertices[i];
+        for (u32 k = adj_offsets[v]; k < adj_offsets[v + 1]; ++k) {
+          u32 t = adj_tris[k];
+          if (emitted[t]) continue;
+
+          u32 n_new = (stamps[indices[t * 3 + 0]] != stamp) +
+                      (stamps[indices[t * 3 + 1]] != stamp) +
+                      (stamps[indices[t * 3 + 2]] != stamp);
+          if (n_new < best_new) {
+            best     = t;
+            best_new = n_new;
+            if (n_new == 0) break;
+          }
+        }
+      }
+
+      if (best == INVALID_INDEX) {
+        while (scan < n_tris && emitted[scan]) scan++;
+        if (scan == n_tris) break;
+        best     = scan;
+        best_new = (stamps[indices[best * 3 + 0]] != stamp) +
+                   (stamps[indices[best * 3 + 1]] != stamp) +
+                   (stamps[indices[best * 3 + 2]] != stamp);
+      }
+
+      if (n_cluster_vertices + best_new > max_vertices || n_cluster_tris + 1 > max_triangles) break;
+
+      for (u32 c = 0; c < 3; ++c) {
+        u32 v = indices[best * 3 + c];
+        if (stamps[v] != stamp) {
+          stamps[v]                              = stamp;
+          cluster_vertices[n_cluster_vertices++] = v;
+        }
+        meshlet_indices[n_out++] = v;
+      }
+      emitted[best] = 1;
+      n_cluster_tris++;
+      n_emitted++;
+    }
+
+    umb_meshlet* meshlet  = &meshlets[n_meshlets++];
+    meshlet->index_offset = index_offset;
+    meshlet->index_count  = n_cluster_tris * 3;
+    meshlet->pad[0] = meshlet->pad[1] = 0;
+    umb_meshlet_compute_bounds(
+        meshlet,
+        cluster_vertices,
+        n_cluster_vertices,
+        meshlet_indices + index_offset,
+        positions,
+        stride);
+  }
+
+  free(emitted);
+  free(cluster_vertices);
+  free(fill);
+  free(stamps);
+  free(adj_tris);
+  free(adj_offsets);
+
+  return n_meshlets;
+}
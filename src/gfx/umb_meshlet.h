@@ -0,0 +1,37 @@
+#pragma once
+
+#include <core/umb_common.h>
+
+static constexpr u32 UMB_MESHLET_MAX_VERTICES  = 64;
+static constexpr u32 UMB_MESHLET_MAX_TRIANGLES = 124;
+
+// Matches the std430 layout of `Meshlet` in meshlet_cull.comp.
+// A cluster is back-facing for every viewer that satisfies
+//   dot(center - eye, cone_axis) >= cone_cutoff * length(center - eye) + radius
+// cone_cutoff is 1 when the normals are too spread out to ever cull the cluster.
+struct umb_meshlet {
+  f32 center[3];
+  f32 radius;
+  f32 cone_axis[3];
+  f32 cone_cutoff;
+  u32 index_offset;
+  u32 index_count;
+  u32 pad[2];
+};
+
+u32 umb_meshlet_count_bound(u32 n_indices, u32 max_vertices, u32 max_triangles);
+
+// Splits an indexed triangle list into clusters of at most max_vertices unique vertices and
+// max_triangles triangles, growing each cluster through shared vertices for spatial coherence.
+// meshlet_indices receives all n_indices indices reordered so that every cluster owns the
+// contiguous range [index_offset, index_offset + index_count). Returns the cluster count.
+u32 umb_meshlets_build(
+    umb_meshlet* meshlets,
+    u32*         meshlet_indices,
+    const u32*   indices,
+    u32          n_indices,
+    const f32*   positions,
+    u32          n_vertices,
+    u32          stride,
+    u32          max_vertices,
+    u32          max_triangles);
@@ -2,9 +2,23 @@
 
 #include <SDL.h>
 #include <chrono>
+#include <condition_variable>
 #include <core/umb_hash_table.h>
+#include <core/umb_job.h>
+#include <core/umb_math.h>
+#include <core/umb_offset_alloc.h>
+#include <core/umb_radix_sort.h>
+#include <float.h>
 #include <functional>
+#include <gfx/umb_cull.h>
 #include <gfx/umb_gfx.h>
+#include <gfx/umb_gltf.h>
+#include <gfx/umb_image.h>
+#include <gfx/umb_ktx2.h>
+#include <gfx/umb_mesh_lod.h>
+#include <gfx/umb_meshlet.h>
+#include <mutex>
+#include <thread>
 #include <utility>
 
 #define VMA_VULKAN_VERSION 1002000
@@ -14,9 +28,6 @@
 #define TINYOBJLOADER_IMPLEMENTATION
 #include <gfx/tiny_obj_loader.h>
 
-#define STB_IMAGE_IMPLEMENTATION
-#include <gfx/stb_image.h>
-
 #define VK_CHECK(x, msg)   \
   do {                     \
     if (x != VK_SUCCESS) { \
@@ -30,7 +41,42 @@ static constexpr u32 MAX_SWAPCHAIN_IMAGES                    = 3;
 static constexpr u32 MAX_FRAMES_IN_FLIGHT                    = 2;
 static constexpr u32 MAX_DESCRIPTOR_SET_LAYOUTS_PER_PIPELINE = 3;
 static constexpr u32 MAX_SHADER_STAGES                       = 3;
-static constexpr u32 MAX_GPU_OBJECTS                         = 1000;
+static constexpr u32 MAX_MESH_LODS                           = 4;
+static constexpr u32 INITIAL_RENDER_OBJECTS                  = 1024;
+static constexpr u32 MAX_MESHES                              = 4096;
+static constexpr u32 MAX_GEOMETRY_VERTICES                   = 1 << 21;
+static constexpr u32 MAX_GEOMETRY_INDICES                    = 1 << 23;
+static constexpr u32 MAX_GEOMETRY_ALLOCS                     = 1 << 14;
+static constexpr u32 MAX_MESHLETS                            = 1 << 16;
+static constexpr u32 MAX_CLUSTER_DRAWS                       = 256;
+static constexpr u32 MAX_CLUSTER_INDICES                     = 1 << 21;
+static constexpr u32 MIN_CLUSTERED_TRIANGLES                 = 2048;
+static constexpr u32 INVALID_CLUSTER_DRAW                    = ~0u;
+static constexpr u32 INVALID_STATIC_SLOT                     = ~0u;
+static constexpr u32 INVALID_INSTANCE_BUCKET                 = ~0u;
+static constexpr u64 STAGING_RING_SIZE                       = UMB_MEGABYTES(64);
+static constexpr u64 STAGING_ALIGNMENT                       = 16;
+static constexpr u32 MAX_STAGING_MARKS                       = 32;
+static constexpr u32 MAX_STAGING_DEDICATED                   = 4;
+static constexpr u32 MAX_BINDLESS_TEXTURES                   = 4096;
+static constexpr u32 MAX_MATERIALS                           = 1024;
+static constexpr u32 MAX_SORTED_PIPELINES                    = 256;
+static constexpr u32 MAX_INSTANCES                           = 1 << 17;
+static constexpr u32 CULL_JOB_SIZE                           = 256;
+static constexpr u32 RECORD_JOB_SIZE                         = 512;
+static constexpr u32 MAX_RECORD_JOBS                         = 32;
+static constexpr u32 MAX_INSTANCE_PIPELINES                  = 16;
+static constexpr u32 MAX_INSTANCE_UPDATES_PER_FRAME          = 1 << 14;
+static constexpr u32 MAX_DESCRIPTOR_WRITES                   = 64;
+static constexpr u64 FRAME_TRANSIENT_SIZE                    = UMB_MEGABYTES(4);
+static constexpr u64 MAX_DECODE_WAVE_SIZE                    = STAGING_RING_SIZE / 2;
+static constexpr u64 DEFAULT_DIRECT_UPLOAD_BUDGET            = UMB_MEGABYTES(256);
+static constexpr u64 DEFAULT_TEXTURE_BUDGET                  = UMB_MEGABYTES(512);
+static constexpr u32 STREAMING_TAIL_SIZE                     = 128;
+static constexpr u64 STREAMING_BYTES_PER_FRAME               = UMB_MEGABYTES(16);
+static constexpr u32 STREAMING_IDLE_FRAMES                   = 120;
+static constexpr u32 MAX_UPLOADS_IN_FLIGHT                   = 4;
+static constexpr u32 MAX_PENDING_UPLOADS                     = 16;
 
 static constexpr const char* VALIDATION_LAYERS[] = {
     "VK_LAYER_KHRONOS_validation",
@@ -51,6 +97,8 @@ UMB_CONTAINER_DEF(VkVertexInputAttributeDescription);
 struct umbvk_queue_family_indices {
   u32 graphics_and_compute_queue_idx = -1;
   u32 present_queue_idx              = -1;
+  u32 transfer_queue_idx             = -1;
+  u32 graphics_queue_count           = 0;
 };
 
 struct umbvk_swapchain_support_details {
@@ -62,11 +110,20 @@ struct umbvk_swapchain_support_details {
 struct umb_image_t {
   VkImage       image;
   VmaAllocation allocation;
+  u64           upload_value;
+  u32           n_mips;
+  VkFormat      format;
 };
 
+struct umbvk_streamed_texture;
+
 struct umb_texture_t {
   umb_image   image;
   VkImageView image_view;
+  // slot in the bindless texture array
+  u32         index;
+  // set when the finer levels are streamed in on demand
+  umbvk_streamed_texture* stream;
 };
 
 struct umbvk_swapchain {
@@ -115,11 +172,51 @@ struct umbvk_pipeline_builder {
 struct umbvk_buffer {
   VkBuffer      buffer;
   VmaAllocation alloc;
+  // host visible buffers stay mapped for their whole lifetime
+  byte*         mapped;
+};
+
+// bump allocator over a mapped buffer, reset once the frame that used it has finished
+struct umbvk_linear_buffer {
+  umbvk_buffer buffer;
+  u64          size;
+  u64          head;
+};
+
+// mapped per-frame buffer whose capacity doubles until the frame's data fits. it only grows once
+// its frame has retired, so the old buffer is destroyed right away and the contents are not kept.
+struct umbvk_growable_buffer {
+  umbvk_buffer       buffer;
+  u64                capacity;
+  VkBufferUsageFlags usage;
+  b32                direct;
+};
+
+struct umb_mesh_lod {
+  u32 first_index;
+  u32 index_count;
+  f32 error;
 };
 
 struct umb_mesh_t {
   umb_array_umb_mesh_vertex vertices;
-  umbvk_buffer              vertex_buffer;
+  umb_array_u32             indices;
+
+  // ranges in the global geometry buffers, in vertices / indices / meshlets
+  umb_offset_allocation vertex_alloc;
+  umb_offset_allocation index_alloc;
+  umb_offset_allocation meshlet_alloc;
+  u32                   geometry_slot;
+  str                   name;
+  u64                   upload_value;
+
+  glm::vec4    bounds;
+  u32          n_lods;
+  umb_mesh_lod lods[MAX_MESH_LODS];
+
+  // clusters of LOD 0. meshlet index offsets are relative to the mesh's index range, which holds
+  // LOD 0 in cluster order.
+  u32 meshlet_count;
 };
 
 struct umb_text_mesh_t {
@@ -127,6 +224,19 @@ struct umb_text_mesh_t {
   umbvk_buffer                   vertex_buffer;
 };
 
+struct umb_model_t {
+  umb_render_object* objects;
+  u32                n_objects;
+  str*               mesh_names;
+  u32                n_meshes;
+
+  // meshes alias the mapped file where the layout allows, everything else is converted into
+  // `converted`. both stay alive until the model is unloaded.
+  umb_gltf gltf;
+  void**   converted;
+  u32      n_converted;
+};
+
 struct umbvk_cmd_buffer {
   VkCommandBuffer cmd_buff;
   VkCommandPool   cmd_pool;
@@ -134,16 +244,113 @@ struct umbvk_cmd_buffer {
   umb_pipeline*   active_cmp_pipeline;
 };
 
-struct umbvk_upload_context {
-  VkCommandPool   cmd_pool;
-  VkCommandBuffer cmd_buff;
-  VkFence         upload_fence;
+enum umbvk_upload_op_type {
+  UMBVK_UPLOAD_COPY_BUFFER,
+  UMBVK_UPLOAD_IMAGE_BEGIN,
+  UMBVK_UPLOAD_COPY_IMAGE,
+  UMBVK_UPLOAD_IMAGE_END,
+};
+
+// recorded by the loading thread and replayed into a transfer command buffer by the upload thread
+struct umbvk_upload_op {
+  umbvk_upload_op_type type;
+  VkBuffer             src;
+  VkBuffer             dst_buffer;
+  VkImage              dst_image;
+  // IMAGE_END: when set, level 0 of that size is blitted down into the rest of `image_range`
+  VkExtent2D           blit_extent;
+  union {
+    VkBufferCopy            buffer_copy;
+    VkBufferImageCopy       image_copy;
+    VkImageSubresourceRange image_range;
+  };
+};
+
+struct umbvk_upload_batch {
+  umbvk_upload_op* ops;
+  u32              n_ops;
+  u32              cap;
+  u64              value;
+};
+
+// images released by the transfer family that the graphics family still has to acquire
+struct umbvk_image_acquire {
+  VkImage                 image;
+  VkImageSubresourceRange range;
+  VkExtent2D              blit_extent;
+  u64                     value;
+};
+
+// every submitted batch leaves a mark at the ring's head, which becomes the new tail once the
+// batch's value has completed
+struct umbvk_staging_mark {
+  u64 end;
+  u64 value;
+};
+
+// uploads larger than the whole ring get their own buffer until their batch has executed
+struct umbvk_staging_dedicated {
+  umbvk_buffer buffer;
+  u64          value;
+};
+
+// one persistently mapped buffer that staging space is carved out of in submission order
+struct umbvk_staging_ring {
+  umbvk_buffer buffer;
+  byte*        mapped;
+  u64          size;
+
+  // monotonic byte positions, the offset into the buffer is position % size
+  u64 head;
+  u64 tail;
+
+  umbvk_staging_mark marks[MAX_STAGING_MARKS];
+  u32                mark_head;
+  u32                n_marks;
+
+  umbvk_staging_dedicated dedicated[MAX_STAGING_DEDICATED];
+  u32                     n_dedicated;
+};
+
+struct umbvk_uploader {
+  // batch n signals `timeline` with value n once its copies have executed
+  VkSemaphore timeline;
+  // may be the graphics queue itself, every submit goes through _vk.queue_mutex
+  VkQueue     queue;
+
+  // upload thread
+  std::thread     thread;
+  VkCommandPool   cmd_pools[MAX_UPLOADS_IN_FLIGHT];
+  VkCommandBuffer cmd_buffs[MAX_UPLOADS_IN_FLIGHT];
+  u64             cmd_values[MAX_UPLOADS_IN_FLIGHT];
+  u32             cmd_idx;
+
+  // guarded by mutex
+  std::mutex              mutex;
+  std::condition_variable cond;
+  b32                     quit;
+  umbvk_upload_batch      pending[MAX_PENDING_UPLOADS];
+  u32                     pending_head;
+  u32                     n_pending;
+  umbvk_image_acquire*    acquires;
+  u32                     n_acquires;
+  u32                     cap_acquires;
+
+  // loading thread. `open` collects ops until it is submitted, its value is fixed up front.
+  umbvk_upload_batch open;
+  u32                batch_depth;
+  umbvk_staging_ring staging;
+
+  // render thread, the newest value the frames are allowed to see
+  u64 visible_value;
 };
 
 struct umb_gpu_camera_data {
   glm::mat4 view;
   glm::mat4 proj;
   glm::mat4 viewproj;
+  glm::vec4 frustum[6];
+  glm::vec4 position;
 };
 
 struct umb_gpu_scene_data {
@@ -156,20 +363,98 @@ struct umb_gpu_scene_data {
 
 struct umb_gpu_object_data {
   glm::mat4 model_matrix;
+  u32       material_index;
+  u32       pad[3];
 };
 
-struct umbvk_frame {
-  VkSemaphore      image_available_semaphore, render_finished_semaphore;
-  VkFence          render_fence;
-  umbvk_cmd_buffer cmd;
+struct umb_gpu_material_data {
+  glm::vec4 base_color;
+  u32       albedo_texture;
+  u32       sampler;
+  u32       pad[2];
+};
 
-  umbvk_buffer    camera_buffer;
-  VkDescriptorSet global_descriptor;
+struct umb_gpu_instance_data {
+  glm::mat4 model_matrix;
+  u32       material_index;
+  u32       mesh_index;
+  u32       bucket;
+  u32       pad;
+};
+
+struct umb_gpu_mesh_lod {
+  u32 first_index;
+  u32 index_count;
+  f32 error;
+  u32 pad;
+};
+
+// n_lods is 0 while the mesh's geometry is not visible to the frame
+struct umb_gpu_mesh_data {
+  glm::vec4        bounds;
+  i32              vertex_offset;
+  u32              n_lods;
+  u32              pad[2];
+  umb_gpu_mesh_lod lods[MAX_MESH_LODS];
+};
+
+struct umbvk_instance_cull_constants {
+  u32 instance_count;
+  f32 proj_scale;
+  f32 lod_error_threshold;
+  u32 pad;
+  u32 bucket_offsets[MAX_INSTANCE_PIPELINES];
+};
+
+struct umbvk_meshlet_cull_constants {
+  u32 meshlet_offset;
+  u32 meshlet_count;
+  u32 index_offset;
+  u32 out_offset;
+  u32 draw_index;
+  u32 object_index;
+};
+
+// a slice of the sorted draw list recorded into one secondary command buffer
+struct umbvk_record_job {
+  umbvk_cmd_buffer* cmd;
+  VkFramebuffer     framebuffer;
+  u32               first;
+  u32               end;
+};
+
+struct umbvk_draw {
+  umb_mesh         mesh;
+  umb_material*    material;
+  // the renderable's component or the static object's field, both stay put for the frame
+  const glm::mat4* transform;
+  umb_texture      texture;
+  // slot in this frame's object data, draws sorted next to each other get consecutive slots
+  u32              object_idx;
+  u32              lod;
+  u32              cluster_draw;
+  u32              cluster_index_offset;
+};
 
-  umbvk_buffer    object_buffer;
-  VkDescriptorSet object_descriptor;
+enum umbvk_draw_pass {
+  UMBVK_DRAW_PASS_OPAQUE,
 };
 
+// draws are recorded in ascending key order, most significant state first:
+//   pass:2 | pipeline:8 | material:10 | mesh:12 | lod:2 | view depth:30
+// the depth is the bit pattern of a non-negative float without its two lowest mantissa bits, which
+// orders like the float itself, so draws sharing all state go front to back.
+static constexpr u32 DRAW_KEY_DEPTH_SHIFT    = 0;
+static constexpr u32 DRAW_KEY_LOD_SHIFT      = 30;
+static constexpr u32 DRAW_KEY_MESH_SHIFT     = 32;
+static constexpr u32 DRAW_KEY_MATERIAL_SHIFT = 44;
+static constexpr u32 DRAW_KEY_PIPELINE_SHIFT = 54;
+static constexpr u32 DRAW_KEY_PASS_SHIFT     = 62;
+static_assert(MAX_MESH_LODS <= 1 << (DRAW_KEY_MESH_SHIFT - DRAW_KEY_LOD_SHIFT));
+static_assert(MAX_MESHES <= 1 << (DRAW_KEY_MATERIAL_SHIFT - DRAW_KEY_MESH_SHIFT));
+static_assert(MAX_MATERIALS <= 1 << (DRAW_KEY_PIPELINE_SHIFT - DRAW_KEY_MATERIAL_SHIFT));
+static_assert(MAX_SORTED_PIPELINES <= 1 << (DRAW_KEY_PASS_SHIFT - DRAW_KEY_PIPELINE_SHIFT));
+
 class umbvk_deletion_queue {
   public:
   using del_func = std::function<void()>;
@@ -190,6 +475,204 @@ class umbvk_deletion_queue {
   del_func             deletors[MAX_DELETORS];
 };
 
+struct umbvk_frame {
+  VkSemaphore      image_available_semaphore, render_finished_semaphore;
+  VkFence          render_fence;
+  umbvk_cmd_buffer cmd;
+
+  // secondaries the render pass is recorded into, slices of the draw list on the job system and
+  // the instance draws on the render thread. each has its own pool, so no two threads share one.
+  umbvk_cmd_buffer draw_cmds[MAX_RECORD_JOBS];
+  u32              n_draw_cmds;
+  umbvk_cmd_buffer instance_cmd;
+
+  // transient uniform and storage data, bound through dynamic offsets
+  umbvk_linear_buffer transient;
+
+  // camera and scene data offsets
+  VkDescriptorSet global_descriptor;
+  u32             global_offsets[2];
+  u32             scene_version;
+
+  // object data of this frame's draws, only visible objects are written
+  VkDescriptorSet       object_descriptor;
+  umbvk_growable_buffer object_buffer;
+
+  // compacted cluster indices live in a reserved range of the global index buffer
+  umb_offset_allocation cluster_index_alloc;
+  umbvk_buffer          cluster_draw_buffer;
+  VkDescriptorSet       cluster_descriptor;
+
+  // the views this frame's bindless set points at, rewritten when a slot's view changes
+  VkDescriptorSet bindless_descriptor;
+  VkImageView*    bindless_views;
+
+  // the mesh table the instance cull pass reads, and the draws and object data it writes
+  umbvk_buffer    mesh_table_buffer;
+  u32             mesh_version;
+  u64             mesh_visible_value;
+  umbvk_buffer    instance_draw_buffer;
+  umbvk_buffer    instance_count_buffer;
+  umbvk_buffer    instance_object_buffer;
+  VkDescriptorSet instance_descriptor;
+  VkDescriptorSet instance_object_descriptor;
+
+  // the replayed static draws, re-recorded when the static version or this frame's bindless set
+  // changes. their indirect commands are rewritten every frame.
+  umbvk_cmd_buffer      static_cmd;
+  u32                   static_version;
+  umbvk_growable_buffer static_draw_buffer;
+  umbvk_growable_buffer static_object_buffer;
+  VkDescriptorSet       static_object_descriptor;
+
+  // resources that the previously recorded frames may still read
+  umbvk_deletion_queue deletion_queue;
+};
+
+// memory that is both device local and host visible: resizable BAR, unified memory and software
+// rasterizers. data written through a mapping there needs neither a staging copy nor a submit.
+struct umbvk_direct_memory {
+  b32 supported;
+  u64 heap_size;
+  u64 budget = DEFAULT_DIRECT_UPLOAD_BUDGET;
+  u64 used;
+};
+
+// a texture whose coarse tail stays resident while finer levels are read from its mapped .ktx2
+// file as they are needed. changing the resident levels builds a replacement image, which is
+// swapped in once its upload is visible to the frames.
+struct umbvk_streamed_texture {
+  umb_ktx2      ktx2;
+  umb_texture_t texture;
+  umb_image_t   image;
+  u32           tail_level;
+  u32           resident_level;
+  u32           wanted_level;
+  u64           last_used_frame;
+
+  b32         pending;
+  u32         pending_level;
+  umb_image_t pending_image;
+
+  umbvk_streamed_texture* lru_prev;
+  umbvk_streamed_texture* lru_next;
+};
+
+// materials and textures bound once per frame: the material buffer, the samplers and one array
+// of every registered texture. draws index into them through their object's material.
+struct umbvk_bindless {
+  VkDescriptorSetLayout layout;
+  VkSampler             samplers[UMB_SAMPLER_COUNT];
+  u32                   capacity;
+
+  umb_texture* textures;
+  u32          n_textures;
+  // slot 0, sampled by materials without a texture and by textures still uploading
+  umb_image_t   default_image;
+  umb_texture_t default_texture;
+
+  umbvk_buffer material_buffer;
+  u32          n_materials;
+};
+
+// objects culled, LOD selected and turned into indirect draws on the GPU. their data lives in a
+// device local buffer that only changed slots are copied into, so a frame's CPU cost does not grow
+// with their number. instances are bucketed by pipeline, each bucket owning a range of the draw
+// buffers as large as its instance count.
+struct umbvk_instances {
+  b32 supported;
+
+  umbvk_buffer           buffer;
+  umb_gpu_instance_data* data;
+  umb_mesh*              meshes;
+  u32                    n_instances;
+
+  // handles stay put while slots are compacted on removal
+  u32* handle_slots;
+  u32* slot_handles;
+  u32* free_handles;
+  u32  n_free_handles;
+  u32  n_handles;
+
+  // slots changed since they were last copied to the GPU. reassigned slots hold another instance
+  // than their GPU copy, if their copy has to wait the copy's bucket is invalidated so culling
+  // does not count it against the bucket's draws.
+  u32* dirty_slots;
+  b32* dirty;
+  b32* reassigned;
+  u32  n_dirty;
+
+  umb_pipeline pipelines[MAX_INSTANCE_PIPELINES];
+  u32          bucket_sizes[MAX_INSTANCE_PIPELINES];
+  u32          n_buckets;
+
+  // bumped when mesh slots or ranges change, frames rewrite their mesh table when it moves. the
+  // tables are also rewritten while meshes up to `mesh_upload_value` are not visible yet.
+  u32 mesh_version;
+  u64 mesh_upload_value;
+
+  VkDescriptorSetLayout set_layout;
+  umb_pipeline          cull_pipeline;
+};
+
+// render objects that rarely change. their draws are sorted once and recorded into a secondary per
+// frame in flight that is replayed until `version` moves. the recorded draws are indirect, only
+// culling and LOD selection run per frame, writing the commands they read.
+struct umbvk_statics {
+  b32 supported;
+
+  umb_ptr_array_umb_render_object objects;
+  umbvk_draw*                     draws;
+  u32                             n_draws;
+  // world space bounds of the sorted draws
+  umb_cull_spheres                spheres;
+  u32*                            visible;
+  // draw slot of each object, INVALID_STATIC_SLOT while its mesh is uploading
+  u32*                            object_slots;
+
+  // moved objects, each with a bit per frame in flight whose object buffer has yet to be updated
+  u32* dirty_objects;
+  u8*  dirty_frames;
+  u32  n_dirty;
+
+  // bumped by changes to the objects, materials, meshes and swapchain. the draws are rebuilt when
+  // it moves past `built_version`, and again once objects left out until `pending_value` show up.
+  u32 version;
+  u32 built_version;
+  u32 mesh_version;
+  u64 pending_value;
+};
+static_assert(MAX_FRAMES_IN_FLIGHT <= 8);
+
+struct umbvk_texture_streaming {
+  // most recently used first
+  umbvk_streamed_texture* lru_head;
+  umbvk_streamed_texture* lru_tail;
+  // what the textures occupy once their pending images have been swapped in
+  u64 planned_size;
+  u64 budget = DEFAULT_TEXTURE_BUDGET;
+  u64 frame;
+  u64 frame_uploaded;
+};
+
+// every mesh is a sub-allocation of these, so a scene binds one vertex and one index buffer
+struct umbvk_geometry {
+  umbvk_buffer         vertex_buffer;
+  umbvk_buffer         index_buffer;
+  umbvk_buffer         meshlet_buffer;
+  // set when the buffers live in direct memory, registration then writes through these
+  b32                  direct;
+  byte*                vertex_mapped;
+  byte*                index_mapped;
+  byte*                meshlet_mapped;
+  umb_offset_allocator vertex_allocator;
+  umb_offset_allocator index_allocator;
+  umb_offset_allocator meshlet_allocator;
+
+  umb_mesh* meshes;
+  u32       n_meshes;
+};
+
 struct {
   VkInstance               instance;
   VkPhysicalDevice         physical_device;
@@ -197,6 +680,8 @@ struct {
   VkDebugUtilsMessengerEXT debug_messenger;
   VkQueue                  graphics_queue;
   VkQueue                  compute_queue;
+  u32                      n_sharing_families;
+  u32                      sharing_families[2];
   VkQueue                  present_queue;
   b32                      validation_layers_enabled = true;
   b32                      initialized               = false;
@@ -218,16 +703,70 @@ struct {
   umb_arena_t          arena;
   umbvk_deletion_queue deletion_queue;
 
-  umb_ptr_array_umb_render_object render_objects;
+  // the renderable entities, and the size of the per-object arrays below
+  umb_ecs_world      scene;
+  umb_gfx_components components;
+  umb_ecs_query      renderables;
+  u32                render_object_capacity;
+
+  // the node hierarchy renderables can be attached to, and the entity of every node handle
+  umb_transform_hierarchy transforms;
+  umb_entity*             node_entities;
+  u32                     node_entities_cap;
+
+  umbvk_draw* draws;
+  u32         n_draws;
+  u32         n_cluster_draws;
+
+  // sort keys of the draws, the scratch halves and the buffer the sorted draws are gathered into
+  u64*        draw_keys;
+  u32*        draw_order;
+  umbvk_draw* sorted_draws;
+
+  // world space bounds of the renderables and the indices of the ones the camera can see, in
+  // query order. each chunk of the query culls into its own range and counts its survivors.
+  umb_cull_spheres cull_spheres;
+  u32*             visible_objects;
+  u32*             chunk_visible;
+  u32              chunk_visible_cap;
+
+  // small ids for the pipelines of registered materials, indexed by material index
+  VkPipeline sorted_pipelines[MAX_SORTED_PIPELINES];
+  u32        n_sorted_pipelines;
+  u8         material_pipeline_ids[MAX_MATERIALS];
+
+  VkPhysicalDeviceFeatures device_features;
+  VkPhysicalDeviceLimits   device_limits;
+  b32                      memory_budget_supported;
 
   VkDescriptorSetLayout global_set_layout;
   VkDescriptorSetLayout object_set_layout;
+  VkDescriptorSetLayout cluster_set_layout;
   VkDescriptorPool      descriptor_pool;
+  umbvk_bindless        bindless;
+  umbvk_instances       instances;
+  umbvk_statics         statics;
+
+  // the draw list slices being recorded for the current frame
+  umbvk_record_job record_jobs[MAX_RECORD_JOBS];
+  umb_job_counter  record_counter;
+
+  umb_gpu_camera_data camera;
+
+  umbvk_geometry geometry;
+  umb_pipeline   meshlet_cull_pipeline;
 
+  // a frame rewrites its slot of the scene buffer only when the version moves past its own
   umb_gpu_scene_data scene_parameters;
   umbvk_buffer       scene_parameters_buffer;
+  u32                scene_version;
 
-  umbvk_upload_context upload_context;
+  f32 lod_error_threshold = 1.0f;
+
+  umbvk_uploader      uploader;
+  umbvk_direct_memory     direct;
+  umbvk_texture_streaming streaming;
+  std::mutex              queue_mutex;
 
   umb_hash_table materials;
   umb_hash_table meshes;
@@ -240,9 +779,7 @@ struct umb_push_constants {
 };
 
 u64 umbvk_pad_uniform_buffer_size(u64 original_size) {
-  VkPhysicalDeviceProperties props;
-  vkGetPhysicalDeviceProperties(_vk.physical_device, &props);
-  u64 min_ubo_alignment = props.limits.minUniformBufferOffsetAlignment;
+  u64 min_ubo_alignment = _vk.device_limits.minUniformBufferOffsetAlignment;
   u64 aligned_size      = original_size;
   if (min_ubo_alignment > 0) {
     aligned_size = (aligned_size + min_ubo_alignment - 1) & ~(min_ubo_alignment - 1);
@@ -294,7 +831,49 @@ umb_array_VkVertexInputAttributeDescription umbvk_get_vertex_attribute_descripti
   return attribute_descs;
 }
 
-umbvk_buffer umbvk_buffer_create_gpu_upload(u64 alloc_size, VkBufferUsageFlags usage) {
+// reserves `size` bytes of the direct memory budget, false when the device has none or it is spent
+b32 umbvk_direct_reserve(u64 size) {
+  umbvk_direct_memory* direct = &_vk.direct;
+  if (!direct->supported) return false;
+
+  // leave room on small BAR heaps for the driver and everything else that wants to live there
+  u64 limit = direct->heap_size / 4 * 3;
+  if (direct->budget < limit) limit = direct->budget;
+  if (direct->used + size > limit) return false;
+
+  direct->used += size;
+  return true;
+}
+
+void umbvk_direct_release(u64 size) {
+  UMB_ASSERT(_vk.direct.used >= size);
+  _vk.direct.used -= size;
+}
+
+void umbvk_detect_direct_memory() {
+  VkPhysicalDeviceMemoryProperties mem_props;
+  vkGetPhysicalDeviceMemoryProperties(_vk.physical_device, &mem_props);
+
+  VkMemoryPropertyFlags direct_flags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT |
+                                       VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+                                       VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+  for (u32 i = 0; i < mem_props.memoryTypeCount; ++i) {
+    if ((mem_props.memoryTypes[i].propertyFlags & direct_flags) != direct_flags) continue;
+    u64 heap_size        = mem_props.memoryHeaps[mem_props.memoryTypes[i].heapIndex].size;
+    _vk.direct.supported = true;
+    _vk.direct.heap_size = heap_size > _vk.direct.heap_size ? heap_size : _vk.direct.heap_size;
+  }
+
+  if (_vk.direct.supported) {
+    UMBI_LOG_INFO(
+        "direct uploads enabled, %llu MB host visible device local heap",
+        (unsigned long long)(_vk.direct.heap_size >> 20));
+  }
+}
+
+// per-frame data written by the CPU every frame, mapped once. placed in direct memory while the
+// budget allows, otherwise the GPU reads it from host memory. the caller owns the buffer.
+umbvk_buffer umbvk_buffer_create_mapped(u64 alloc_size, VkBufferUsageFlags usage, b32* out_direct) {
   VkBufferCreateInfo buffer_info = {
       .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
       .size  = alloc_size,
@@ -302,11 +881,15 @@ umbvk_buffer umbvk_buffer_create_gpu_upload(u64 alloc_size, VkBufferUsageFlags u
   };
 
   VmaAllocationCreateInfo alloc_info = {
+      .flags         = VMA_ALLOCATION_CREATE_MAPPED_BIT,
       .usage         = VMA_MEMORY_USAGE_CPU_TO_GPU,
       .requiredFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
   };
+  *out_direct = umbvk_direct_reserve(alloc_size);
+  if (*out_direct) alloc_info.requiredFlags |= VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
 
-  umbvk_buffer buffer;
+  umbvk_buffer      buffer = {};
+  VmaAllocationInfo info;
 
   VK_CHECK(
       vmaCreateBuffer(
@@ -315,40 +898,77 @@ umbvk_buffer umbvk_buffer_create_gpu_upload(u64 alloc_size, VkBufferUsageFlags u
           &alloc_info,
           &buffer.buffer,
           &buffer.alloc,
-          nullptr),
+          &info),
       "Failed to create vertex buffer!");
+  buffer.mapped = (byte*)info.pMappedData;
+  return buffer;
+}
 
-  _vk.deletion_queue.push([=]() { vmaDestroyBuffer(_vk.allocator, buffer.buffer, buffer.alloc); });
-
+umbvk_buffer umbvk_buffer_create_gpu_upload(u64 alloc_size, VkBufferUsageFlags usage) {
+  b32          direct;
+  umbvk_buffer buffer = umbvk_buffer_create_mapped(alloc_size, usage, &direct);
+  _vk.deletion_queue.push([=]() {
+    if (direct) umbvk_direct_release(alloc_size);
+    vmaDestroyBuffer(_vk.allocator, buffer.buffer, buffer.alloc);
+  });
   return buffer;
 }
 
-umbvk_buffer umbvk_buffer_create_staging(u64 alloc_size) {
-  VkBufferCreateInfo buffer_info = {
-      .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
-      .size  = alloc_size,
-      .usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-  };
+void umbvk_growable_buffer_destroy(umbvk_growable_buffer* buffer) {
+  if (buffer->direct) umbvk_direct_release(buffer->capacity);
+  vmaDestroyBuffer(_vk.allocator, buffer->buffer.buffer, buffer->buffer.alloc);
+  buffer->buffer = {};
+}
 
-  VmaAllocationCreateInfo alloc_info = {
-      .usage         = VMA_MEMORY_USAGE_CPU_ONLY,
-      .requiredFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+void umbvk_growable_buffer_create(
+    umbvk_growable_buffer* buffer,
+    u64                    capacity,
+    VkBufferUsageFlags     usage) {
+  buffer->buffer   = umbvk_buffer_create_mapped(capacity, usage, &buffer->direct);
+  buffer->capacity = capacity;
+  buffer->usage    = usage;
+  _vk.deletion_queue.push([=]() { umbvk_growable_buffer_destroy(buffer); });
+}
+
+// true when the buffer had to be replaced, descriptors and recordings referring to it are stale
+b32 umbvk_growable_buffer_reserve(umbvk_growable_buffer* buffer, u64 size) {
+  if (size <= buffer->capacity) return false;
+
+  u64 capacity = buffer->capacity;
+  while (capacity < size) capacity *= 2;
+
+  umbvk_growable_buffer_destroy(buffer);
+  buffer->buffer   = umbvk_buffer_create_mapped(capacity, buffer->usage, &buffer->direct);
+  buffer->capacity = capacity;
+  return true;
+}
+
+umbvk_linear_buffer umbvk_linear_buffer_create(u64 size, VkBufferUsageFlags usage) {
+  return {
+      .buffer = umbvk_buffer_create_gpu_upload(size, usage),
+      .size   = size,
+      .head   = 0,
   };
+}
 
-  umbvk_buffer buffer;
-  VK_CHECK(
-      vmaCreateBuffer(
-          _vk.allocator,
-          &buffer_info,
-          &alloc_info,
-          &buffer.buffer,
-          &buffer.alloc,
-          nullptr),
-      "Failed to create vertex buffer!");
+// space for `size` bytes of the frame's transient data, at an offset usable as a dynamic uniform
+// or storage buffer offset. NULL once the frame has run out of transient memory.
+byte* umbvk_frame_push(umbvk_frame* frame, u64 size, u32* out_offset) {
+  umbvk_linear_buffer* lb = &frame->transient;
 
-  _vk.deletion_queue.push([=]() { vmaDestroyBuffer(_vk.allocator, buffer.buffer, buffer.alloc); });
+  u64 alignment = _vk.device_limits.minUniformBufferOffsetAlignment;
+  if (_vk.device_limits.minStorageBufferOffsetAlignment > alignment) {
+    alignment = _vk.device_limits.minStorageBufferOffsetAlignment;
+  }
+  u64 offset = (lb->head + alignment - 1) & ~(alignment - 1);
+  if (offset + size > lb->size) {
+    UMBI_LOG_ERROR("frame transient buffer is out of space!");
+    return NULL;
+  }
 
-  return buffer;
+  lb->head    = offset + size;
+  *out_offset = (u32)offset;
+  return lb->buffer.mapped + offset;
 }
 
 umbvk_buffer umbvk_buffer_create_transfer(u64 alloc_size, VkBufferUsageFlags usage) {
@@ -516,6 +1136,26 @@ umbvk_find_queue_families(VkSurfaceKHR surface, VkPhysicalDevice phys_device) {
     if (indices.graphics_and_compute_queue_idx != -1 && indices.present_queue_idx != -1) break;
   }
 
+  // prefer a transfer-only family (the DMA engines), then any non-graphics family
+  u32 async_transfer_idx = -1;
+  for (i32 i = 0; i < queue_family_count; i++) {
+    VkQueueFlags flags = queue_families[i].queueFlags;
+    if (!(flags & VK_QUEUE_TRANSFER_BIT) || (flags & VK_QUEUE_GRAPHICS_BIT)) continue;
+    if (!(flags & VK_QUEUE_COMPUTE_BIT)) {
+      indices.transfer_queue_idx = i;
+      break;
+    }
+    if (async_transfer_idx == -1) async_transfer_idx = i;
+  }
+  if (indices.transfer_queue_idx == -1) indices.transfer_queue_idx = async_transfer_idx;
+  if (indices.transfer_queue_idx == -1) {
+    indices.transfer_queue_idx = indices.graphics_and_compute_queue_idx;
+  }
+  if (indices.graphics_and_compute_queue_idx != -1) {
+    indices.graphics_queue_count =
+        queue_families[indices.graphics_and_compute_queue_idx].queueCount;
+  }
+
   return indices;
 }
 
@@ -686,6 +1326,25 @@ b32 umbvk_check_device_extension_support(
   return n_found_exts == n_requested_exts;
 }
 
+b32 umbvk_device_extension_supported(VkPhysicalDevice phys_device, str name) {
+  umb_scope_arena scope(&_vk.arena);
+
+  u32 extension_count;
+  vkEnumerateDeviceExtensionProperties(phys_device, nullptr, &extension_count, nullptr);
+  VkExtensionProperties* available_extensions =
+      umb_arena_push_array(&_vk.arena, VkExtensionProperties, extension_count);
+  vkEnumerateDeviceExtensionProperties(
+      phys_device,
+      nullptr,
+      &extension_count,
+      available_extensions);
+
+  for (u32 i = 0; i < extension_count; ++i) {
+    if (strcmp(available_extensions[i].extensionName, name) == 0) return true;
+  }
+  return false;
+}
+
 b32 umbvk_is_device_suitable(
     VkSurfaceKHR       surface,
     VkPhysicalDevice   phys_device,
@@ -723,6 +1382,10 @@ void umbvk_set_physical_device() {
     }
   }
   UMB_ASSERT(_vk.physical_device != VK_NULL_HANDLE);
+
+  VkPhysicalDeviceProperties props;
+  vkGetPhysicalDeviceProperties(_vk.physical_device, &props);
+  _vk.device_limits = props.limits;
   _vk.queue_families = umbvk_find_queue_families(_vk.surface, _vk.physical_device);
 }
 
@@ -732,31 +1395,97 @@ void umbvk_set_logical_device() {
   umb_array_VkDeviceQueueCreateInfo queue_create_infos =
       UMB_ARRAY_CREATE(VkDeviceQueueCreateInfo, &_vk.arena, 8);
 
+  umbvk_queue_family_indices qfams = _vk.queue_families;
+
   u32 unique_qfam[3];
   u32 unique_qfam_count            = 0;
-  unique_qfam[unique_qfam_count++] = _vk.queue_families.graphics_and_compute_queue_idx;
-  if (_vk.queue_families.graphics_and_compute_queue_idx != _vk.queue_families.present_queue_idx) {
-    unique_qfam[unique_qfam_count++] = _vk.queue_families.present_queue_idx;
+  unique_qfam[unique_qfam_count++] = qfams.graphics_and_compute_queue_idx;
+  if (qfams.graphics_and_compute_queue_idx != qfams.present_queue_idx) {
+    unique_qfam[unique_qfam_count++] = qfams.present_queue_idx;
   }
+  if (qfams.transfer_queue_idx != qfams.graphics_and_compute_queue_idx &&
+      qfams.transfer_queue_idx != qfams.present_queue_idx) {
+    unique_qfam[unique_qfam_count++] = qfams.transfer_queue_idx;
+  }
+
+  // without a separate transfer family, uploads take a second graphics queue when there is one
+  b32 second_graphics_queue = qfams.transfer_queue_idx == qfams.graphics_and_compute_queue_idx &&
+                              qfams.graphics_queue_count > 1;
 
-  f32 queue_priority = 1.0f;
+  f32 queue_priorities[] = {1.0f, 1.0f};
   for (i32 i = 0; i < unique_qfam_count; ++i) {
+    b32 graphics = unique_qfam[i] == qfams.graphics_and_compute_queue_idx;
     VkDeviceQueueCreateInfo queue_create_info {
         .sType            = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO,
         .queueFamilyIndex = unique_qfam[i],
-        .queueCount       = 1,
-        .pQueuePriorities = &queue_priority,
+        .queueCount       = (graphics && second_graphics_queue) ? 2u : 1u,
+        .pQueuePriorities = queue_priorities,
     };
     UMB_ARRAY_PUSH(queue_create_infos, queue_create_info);
   }
 
+  VkPhysicalDeviceFeatures supported_features;
+  vkGetPhysicalDeviceFeatures(_vk.physical_device, &supported_features);
+
+  // cluster culling draws with a non-zero firstInstance from an indirect buffer, compiled
+  // textures are uploaded block-compressed
   VkPhysicalDeviceFeatures device_features {};
-  VkDeviceCreateInfo       create_info {
+  device_features.drawIndirectFirstInstance = supported_features.drawIndirectFirstInstance;
+  device_features.multiDrawIndirect         = supported_features.multiDrawIndirect;
+  device_features.textureCompressionBC      = supported_features.textureCompressionBC;
+  _vk.device_features                       = device_features;
+
+  VkPhysicalDeviceVulkan12Features supported_vulkan12 {
+      .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES,
+  };
+  VkPhysicalDeviceFeatures2 supported_features2 {
+      .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2,
+      .pNext = &supported_vulkan12,
+  };
+  vkGetPhysicalDeviceFeatures2(_vk.physical_device, &supported_features2);
+
+  // bindless textures index one partially bound array with material data that varies per draw
+  b32 bindless_supported = supported_vulkan12.runtimeDescriptorArray &&
+                           supported_vulkan12.descriptorBindingPartiallyBound &&
+                           supported_vulkan12.shaderSampledImageArrayNonUniformIndexing;
+  if (!bindless_supported) UMBI_LOG_ERROR("the device does not support bindless textures!");
+  UMB_ASSERT(bindless_supported);
+
+  // instances are drawn with one indirect draw per pipeline, its count written by the cull pass
+  _vk.instances.supported = supported_features.multiDrawIndirect &&
+                            supported_features.drawIndirectFirstInstance &&
+                            supported_vulkan12.drawIndirectCount;
+  if (!_vk.instances.supported) UMBI_LOG_WARN("GPU-driven instances are not supported, skipping");
+
+  // core in 1.2, batches signal their completion on a timeline
+  VkPhysicalDeviceVulkan12Features vulkan12_features {
+      .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES,
+      .shaderSampledImageArrayNonUniformIndexing = VK_TRUE,
+      .descriptorBindingPartiallyBound           = VK_TRUE,
+      .runtimeDescriptorArray                    = VK_TRUE,
+      .timelineSemaphore                         = VK_TRUE,
+  };
+  vulkan12_features.drawIndirectCount = supported_vulkan12.drawIndirectCount;
+
+  // heap budgets that account for the other processes on the device, textures stream against them
+  str enabled_extensions[UMB_ARRAY_COUNT(DEVICE_EXTENSIONS, str) + 1];
+  u32 n_enabled_extensions = 0;
+  for (u32 i = 0; i < UMB_ARRAY_COUNT(DEVICE_EXTENSIONS, str); ++i) {
+    enabled_extensions[n_enabled_extensions++] = DEVICE_EXTENSIONS[i];
+  }
+  _vk.memory_budget_supported =
+      umbvk_device_extension_supported(_vk.physical_device, VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+  if (_vk.memory_budget_supported) {
+    enabled_extensions[n_enabled_extensions++] = VK_EXT_MEMORY_BUDGET_EXTENSION_NAME;
+  }
+
+  VkDeviceCreateInfo create_info {
             .sType                   = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO,
+            .pNext                   = &vulkan12_features,
             .queueCreateInfoCount    = static_cast<u32>(queue_create_infos.len),
             .pQueueCreateInfos       = queue_create_infos.data,
-            .enabledExtensionCount   = UMB_ARRAY_COUNT(DEVICE_EXTENSIONS, str),
-            .ppEnabledExtensionNames = DEVICE_EXTENSIONS,
+            .enabledExtensionCount   = n_enabled_extensions,
+            .ppEnabledExtensionNames = enabled_extensions,
             .pEnabledFeatures        = &device_features,
   };
 
@@ -782,6 +1511,22 @@ void umbvk_set_logical_device() {
       0,
       &_vk.compute_queue);
   vkGetDeviceQueue(_vk.device, _vk.queue_families.present_queue_idx, 0, &_vk.present_queue);
+
+  if (qfams.transfer_queue_idx != qfams.graphics_and_compute_queue_idx) {
+    vkGetDeviceQueue(_vk.device, qfams.transfer_queue_idx, 0, &_vk.uploader.queue);
+  } else if (second_graphics_queue) {
+    vkGetDeviceQueue(_vk.device, qfams.graphics_and_compute_queue_idx, 1, &_vk.uploader.queue);
+  } else {
+    _vk.uploader.queue = _vk.graphics_queue;
+  }
+
+  // buffers that are sub-allocated and written by uploads while the frames read other ranges are
+  // shared concurrently instead of being passed back and forth
+  _vk.n_sharing_families  = 1;
+  _vk.sharing_families[0] = qfams.graphics_and_compute_queue_idx;
+  if (qfams.transfer_queue_idx != qfams.graphics_and_compute_queue_idx) {
+    _vk.sharing_families[_vk.n_sharing_families++] = qfams.transfer_queue_idx;
+  }
 }
 
 void umbvk_destroy_swapchain(umbvk_swapchain* swapchain) {
@@ -977,7 +1722,11 @@ void umbvk_recreate_swapchain() {
     SDL_WaitEvent(nullptr);
   }
 
-  vkDeviceWaitIdle(_vk.device);
+  {
+    // the upload thread may share a queue with the frames
+    std::lock_guard<std::mutex> lock(_vk.queue_mutex);
+    vkDeviceWaitIdle(_vk.device);
+  }
 
   umbvk_destroy_swapchain(&_vk.swapchain);
 
@@ -987,6 +1736,9 @@ void umbvk_recreate_swapchain() {
   VkPresentModeKHR   present_mode = umbvk_choose_swap_present_mode(swapchain_support.present_modes);
   VkExtent2D         extent = umbvk_choose_swap_extent(_vk.window, swapchain_support.capabilities);
   _vk.swapchain = umbvk_create_swapchain(swapchain_support, surface_format, present_mode, extent);
+
+  // the recorded static draws set the old extent
+  _vk.statics.version++;
 }
 
 umbvk_shader_stage
@@ -1196,7 +1948,12 @@ umb_pipeline umbvk_default_graphics_pipeline_create() {
       .size       = sizeof(umb_push_constants),
   };
 
-  VkDescriptorSetLayout      set_layouts[] = {_vk.global_set_layout, _vk.object_set_layout};
+  // every material pipeline has this layout, so bound sets survive pipeline changes
+  VkDescriptorSetLayout set_layouts[] = {
+      _vk.global_set_layout,
+      _vk.object_set_layout,
+      _vk.bindless.layout,
+  };
   VkPipelineLayoutCreateInfo pipeline_layout_create_info = {
       .sType                  = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
       .pushConstantRangeCount = 1,
@@ -1222,6 +1979,69 @@ umb_pipeline umbvk_default_graphics_pipeline_create() {
   return gfx_pipeline;
 }
 
+umb_pipeline umbvk_compute_pipeline_create(
+    str                          shader_file,
+    const VkDescriptorSetLayout* set_layouts,
+    u32                          n_set_layouts,
+    u32                          push_constant_size) {
+  umb_array_byte     shader_code = umb_read_file_binary(&_vk.arena, shader_file);
+  umbvk_shader_stage stage = umbvk_shader_stage_create(shader_code, VK_SHADER_STAGE_COMPUTE_BIT);
+
+  VkPushConstantRange push_constant = {
+      .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+      .offset     = 0,
+      .size       = push_constant_size,
+  };
+
+  VkPipelineLayoutCreateInfo pipeline_layout_create_info = {
+      .sType                  = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+      .setLayoutCount         = n_set_layouts,
+      .pSetLayouts            = set_layouts,
+      .pushConstantRangeCount = push_constant_size > 0 ? 1u : 0u,
+      .pPushConstantRanges    = &push_constant,
+  };
+
+  umb_pipeline new_pipeline = {};
+  VK_CHECK(
+      vkCreatePipelineLayout(
+          _vk.device,
+          &pipeline_layout_create_info,
+          nullptr,
+          &new_pipeline.pipeline_layout),
+      "Failed to create pipeline layout.");
+
+  VkComputePipelineCreateInfo pipeline_info = {
+      .sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
+      .stage =
+          {
+              .sType  = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+              .stage  = VK_SHADER_STAGE_COMPUTE_BIT,
+              .module = stage.shader_module,
+              .pName  = "main",
+          },
+      .layout = new_pipeline.pipeline_layout,
+  };
+
+  VK_CHECK(
+      vkCreateComputePipelines(
+          _vk.device,
+          VK_NULL_HANDLE,
+          1,
+          &pipeline_info,
+          nullptr,
+          &new_pipeline.pipeline),
+      "Failed to create compute pipeline!");
+
+  _vk.deletion_queue.push([=]() {
+    vkDestroyPipeline(_vk.device, new_pipeline.pipeline, nullptr);
+    vkDestroyPipelineLayout(_vk.device, new_pipeline.pipeline_layout, nullptr);
+  });
+
+  umbvk_shader_stage_destroy(&stage);
+
+  return new_pipeline;
+}
+
 void umb_pipeline_destroy(umb_pipeline* pipeline) {
   vkDestroyPipeline(_vk.device, pipeline->pipeline, nullptr);
 }
@@ -1255,34 +2075,247 @@ VkWriteDescriptorSet umbvk_descriptor_buffer_write(
   return set_write;
 }
 
-void umbvk_set_descriptors() {
-  const u64 scene_param_buffer_size =
-      MAX_FRAMES_IN_FLIGHT * umbvk_pad_uniform_buffer_size(sizeof(umb_gpu_scene_data));
-  _vk.scene_parameters_buffer =
-      umbvk_buffer_create_gpu_upload(scene_param_buffer_size, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT);
+// points an object set at the buffer, clamped to the largest range the device can bind
+void umbvk_object_descriptor_write(VkDescriptorSet set, const umbvk_growable_buffer* buffer) {
+  u64 range = buffer->capacity;
+  if (range > _vk.device_limits.maxStorageBufferRange) {
+    UMBI_LOG_WARN("object data exceeds the storage buffer range, objects past it are not drawn");
+    range = _vk.device_limits.maxStorageBufferRange;
+  }
 
-  VkDescriptorPoolSize sizes[] = {
-      {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 10},
-      {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 10},
-      {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 10},
+  VkDescriptorBufferInfo binfo = {
+      .buffer = buffer->buffer.buffer,
+      .range  = range,
   };
+  VkWriteDescriptorSet write = umbvk_descriptor_buffer_write(
+      VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC,
+      set,
+      &binfo,
+      0);
+  vkUpdateDescriptorSets(_vk.device, 1, &write, 0, nullptr);
+}
 
-  VkDescriptorPoolCreateInfo pool_info = {
-      .sType         = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
-      .maxSets       = 10,
-      .poolSizeCount = (u32)UMB_ARRAY_COUNT(sizes, VkDescriptorPoolSize),
-      .pPoolSizes    = sizes,
+umbvk_buffer umbvk_geometry_buffer_create(
+    u64                alloc_size,
+    VkBufferUsageFlags usage,
+    b32                direct,
+    byte**             out_mapped) {
+  VkBufferCreateInfo buffer_info = {
+      .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+      .size  = alloc_size,
+      .usage = usage | VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+      .sharingMode = _vk.n_sharing_families > 1 ? VK_SHARING_MODE_CONCURRENT
+                                                : VK_SHARING_MODE_EXCLUSIVE,
+      .queueFamilyIndexCount = _vk.n_sharing_families,
+      .pQueueFamilyIndices   = _vk.sharing_families,
   };
-  vkCreateDescriptorPool(_vk.device, &pool_info, nullptr, &_vk.descriptor_pool);
 
-  VkDescriptorSetLayoutBinding cam_bind = umbvk_descriptor_set_layout_binding_create(
-      VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
-      VK_SHADER_STAGE_VERTEX_BIT,
-      0);
-  VkDescriptorSetLayoutBinding scene_bind = umbvk_descriptor_set_layout_binding_create(
-      VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC,
-      VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
-      1);
+  VmaAllocationCreateInfo alloc_info = {.usage = VMA_MEMORY_USAGE_GPU_ONLY};
+  if (direct) {
+    alloc_info.flags         = VMA_ALLOCATION_CREATE_MAPPED_BIT;
+    alloc_info.requiredFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT |
+                               VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+                               VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+  }
+
+  // not on the deletion queue, defragmentation replaces these buffers
+  umbvk_buffer      buffer;
+  VmaAllocationInfo info;
+  VK_CHECK(
+      vmaCreateBuffer(
+          _vk.allocator,
+          &buffer_info,
+          &alloc_info,
+          &buffer.buffer,
+          &buffer.alloc,
+          &info),
+      "Failed to create geometry buffer!");
+  *out_mapped = direct ? (byte*)info.pMappedData : NULL;
+
+  return buffer;
+}
+
+static constexpr u64 GEOMETRY_BUFFERS_SIZE = sizeof(umb_mesh_vertex) * MAX_GEOMETRY_VERTICES +
+                                             sizeof(u32) * MAX_GEOMETRY_INDICES +
+                                             sizeof(umb_meshlet) * MAX_MESHLETS;
+
+// the budget is checked again every time the buffers are recreated
+void umbvk_geometry_buffers_create(umbvk_geometry* geometry) {
+  geometry->direct        = umbvk_direct_reserve(GEOMETRY_BUFFERS_SIZE);
+  geometry->vertex_buffer = umbvk_geometry_buffer_create(
+      sizeof(umb_mesh_vertex) * MAX_GEOMETRY_VERTICES,
+      VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+      geometry->direct,
+      &geometry->vertex_mapped);
+  geometry->index_buffer = umbvk_geometry_buffer_create(
+      sizeof(u32) * MAX_GEOMETRY_INDICES,
+      VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+      geometry->direct,
+      &geometry->index_mapped);
+  geometry->meshlet_buffer = umbvk_geometry_buffer_create(
+      sizeof(umb_meshlet) * MAX_MESHLETS,
+      VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+      geometry->direct,
+      &geometry->meshlet_mapped);
+}
+
+void umbvk_geometry_buffers_destroy(umbvk_geometry* geometry) {
+  if (geometry->direct) umbvk_direct_release(GEOMETRY_BUFFERS_SIZE);
+  vmaDestroyBuffer(_vk.allocator, geometry->vertex_buffer.buffer, geometry->vertex_buffer.alloc);
+  vmaDestroyBuffer(_vk.allocator, geometry->index_buffer.buffer, geometry->index_buffer.alloc);
+  vmaDestroyBuffer(_vk.allocator, geometry->meshlet_buffer.buffer, geometry->meshlet_buffer.alloc);
+}
+
+// the cluster output ranges are reserved first so they sit at the start of the index buffer,
+// which keeps them aligned for storage buffer descriptors
+void umbvk_geometry_reserve_cluster_ranges() {
+  for (u32 i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i) {
+    _vk.frames[i].cluster_index_alloc =
+        umb_offset_alloc(&_vk.geometry.index_allocator, MAX_CLUSTER_INDICES);
+    UMB_ASSERT(_vk.frames[i].cluster_index_alloc.offset != UMB_OFFSET_ALLOC_NO_SPACE);
+  }
+}
+
+void umbvk_geometry_create() {
+  umbvk_geometry_buffers_create(&_vk.geometry);
+  _vk.geometry.vertex_allocator =
+      umb_offset_allocator_create(MAX_GEOMETRY_VERTICES, MAX_GEOMETRY_ALLOCS);
+  _vk.geometry.index_allocator =
+      umb_offset_allocator_create(MAX_GEOMETRY_INDICES, MAX_GEOMETRY_ALLOCS);
+  _vk.geometry.meshlet_allocator = umb_offset_allocator_create(MAX_MESHLETS, MAX_GEOMETRY_ALLOCS);
+  _vk.geometry.meshes            = umb_arena_push_array(&_vk.arena, umb_mesh, MAX_MESHES);
+  umbvk_geometry_reserve_cluster_ranges();
+
+  _vk.deletion_queue.push([&]() {
+    umbvk_geometry_buffers_destroy(&_vk.geometry);
+    umb_offset_allocator_destroy(&_vk.geometry.vertex_allocator);
+    umb_offset_allocator_destroy(&_vk.geometry.index_allocator);
+    umb_offset_allocator_destroy(&_vk.geometry.meshlet_allocator);
+  });
+}
+
+void umbvk_write_cluster_descriptors() {
+  for (u32 i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i) {
+    VkDescriptorBufferInfo cluster_binfos[] = {
+        {.buffer = _vk.geometry.meshlet_buffer.buffer, .range = VK_WHOLE_SIZE},
+        {.buffer = _vk.geometry.index_buffer.buffer, .range = VK_WHOLE_SIZE},
+        {.buffer = _vk.frames[i].cluster_draw_buffer.buffer, .range = VK_WHOLE_SIZE},
+    };
+    VkWriteDescriptorSet cluster_writes[3];
+    for (u32 b = 0; b < 3; ++b) {
+      cluster_writes[b] = umbvk_descriptor_buffer_write(
+          VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+          _vk.frames[i].cluster_descriptor,
+          &cluster_binfos[b],
+          b);
+    }
+    vkUpdateDescriptorSets(_vk.device, 3, cluster_writes, 0, nullptr);
+  }
+}
+
+// samplers are immutable in the layout, the texture array may have unwritten slots
+void umbvk_bindless_create() {
+  VkSamplerCreateInfo sampler_infos[UMB_SAMPLER_COUNT] = {};
+  for (u32 i = 0; i < UMB_SAMPLER_COUNT; ++i) {
+    b32 nearest = i == UMB_SAMPLER_NEAREST_REPEAT;
+    b32 clamp   = i == UMB_SAMPLER_LINEAR_CLAMP;
+
+    VkSamplerAddressMode address_mode =
+        clamp ? VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE : VK_SAMPLER_ADDRESS_MODE_REPEAT;
+    sampler_infos[i] = {
+        .sType        = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO,
+        .magFilter    = nearest ? VK_FILTER_NEAREST : VK_FILTER_LINEAR,
+        .minFilter    = nearest ? VK_FILTER_NEAREST : VK_FILTER_LINEAR,
+        .mipmapMode   = nearest ? VK_SAMPLER_MIPMAP_MODE_NEAREST : VK_SAMPLER_MIPMAP_MODE_LINEAR,
+        .addressModeU = address_mode,
+        .addressModeV = address_mode,
+        .addressModeW = address_mode,
+        .maxLod       = VK_LOD_CLAMP_NONE,
+    };
+    vkCreateSampler(_vk.device, &sampler_infos[i], nullptr, &_vk.bindless.samplers[i]);
+  }
+
+  VkDescriptorSetLayoutBinding material_bind = umbvk_descriptor_set_layout_binding_create(
+      VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+      VK_SHADER_STAGE_FRAGMENT_BIT,
+      0);
+  VkDescriptorSetLayoutBinding sampler_bind = {
+      .binding            = 1,
+      .descriptorType     = VK_DESCRIPTOR_TYPE_SAMPLER,
+      .descriptorCount    = UMB_SAMPLER_COUNT,
+      .stageFlags         = VK_SHADER_STAGE_FRAGMENT_BIT,
+      .pImmutableSamplers = _vk.bindless.samplers,
+  };
+  VkDescriptorSetLayoutBinding texture_bind = {
+      .binding         = 2,
+      .descriptorType  = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,
+      .descriptorCount = _vk.bindless.capacity,
+      .stageFlags      = VK_SHADER_STAGE_FRAGMENT_BIT,
+  };
+
+  VkDescriptorSetLayoutBinding bindings[]      = {material_bind, sampler_bind, texture_bind};
+  VkDescriptorBindingFlags     binding_flags[] = {
+      0,
+      0,
+      VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT,
+  };
+  VkDescriptorSetLayoutBindingFlagsCreateInfo flags_info = {
+      .sType         = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO,
+      .bindingCount  = UMB_ARRAY_COUNT(binding_flags, VkDescriptorBindingFlags),
+      .pBindingFlags = binding_flags,
+  };
+  VkDescriptorSetLayoutCreateInfo set_info = {
+      .sType        = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+      .pNext        = &flags_info,
+      .bindingCount = UMB_ARRAY_COUNT(bindings, VkDescriptorSetLayoutBinding),
+      .pBindings    = bindings,
+  };
+  vkCreateDescriptorSetLayout(_vk.device, &set_info, nullptr, &_vk.bindless.layout);
+
+  _vk.bindless.textures = umb_arena_push_array(&_vk.arena, umb_texture, _vk.bindless.capacity);
+  _vk.bindless.material_buffer = umbvk_buffer_create_gpu_upload(
+      sizeof(umb_gpu_material_data) * MAX_MATERIALS,
+      VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
+}
+
+void umbvk_set_descriptors() {
+  const u64 scene_param_buffer_size =
+      MAX_FRAMES_IN_FLIGHT * umbvk_pad_uniform_buffer_size(sizeof(umb_gpu_scene_data));
+  _vk.scene_parameters_buffer =
+      umbvk_buffer_create_gpu_upload(scene_param_buffer_size, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT);
+  _vk.scene_parameters.ambient_color = {1.0f, 0.0f, 0.0f, 1.0f};
+  _vk.scene_version                  = 1;
+
+  // the texture array is capped by what a single shader stage may sample
+  u32 max_sampled_images = _vk.device_limits.maxPerStageDescriptorSampledImages;
+  _vk.bindless.capacity =
+      max_sampled_images < MAX_BINDLESS_TEXTURES ? max_sampled_images : MAX_BINDLESS_TEXTURES;
+
+  VkDescriptorPoolSize sizes[] = {
+      {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 10},
+      {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 10},
+      {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 32},
+      {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC, 10},
+      {VK_DESCRIPTOR_TYPE_SAMPLER, UMB_SAMPLER_COUNT * MAX_FRAMES_IN_FLIGHT},
+      {VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, _vk.bindless.capacity * MAX_FRAMES_IN_FLIGHT},
+  };
+
+  VkDescriptorPoolCreateInfo pool_info = {
+      .sType         = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+      .maxSets       = 16,
+      .poolSizeCount = (u32)UMB_ARRAY_COUNT(sizes, VkDescriptorPoolSize),
+      .pPoolSizes    = sizes,
+  };
+  vkCreateDescriptorPool(_vk.device, &pool_info, nullptr, &_vk.descriptor_pool);
+
+  VkDescriptorSetLayoutBinding cam_bind = umbvk_descriptor_set_layout_binding_create(
+      VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC,
+      VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_COMPUTE_BIT,
+      0);
+  VkDescriptorSetLayoutBinding scene_bind = umbvk_descriptor_set_layout_binding_create(
+      VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC,
+      VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
+      1);
 
   VkDescriptorSetLayoutBinding    bindings[] = {cam_bind, scene_bind};
   VkDescriptorSetLayoutCreateInfo set_info   = {
@@ -1293,8 +2326,8 @@ void umbvk_set_descriptors() {
   vkCreateDescriptorSetLayout(_vk.device, &set_info, nullptr, &_vk.global_set_layout);
 
   VkDescriptorSetLayoutBinding obj_bind = umbvk_descriptor_set_layout_binding_create(
-      VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
-      VK_SHADER_STAGE_VERTEX_BIT,
+      VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC,
+      VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_COMPUTE_BIT,
       0);
   VkDescriptorSetLayoutCreateInfo obj_info = {
       .sType        = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
@@ -1303,14 +2336,28 @@ void umbvk_set_descriptors() {
   };
   vkCreateDescriptorSetLayout(_vk.device, &obj_info, nullptr, &_vk.object_set_layout);
 
-  for (i32 i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i) {
-    _vk.frames[i].object_buffer = umbvk_buffer_create_gpu_upload(
-        (sizeof(umb_gpu_object_data) * MAX_GPU_OBJECTS),
-        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
+  // meshlets, geometry indices (read, and written in the frame's cluster range), draw commands
+  VkDescriptorSetLayoutBinding cluster_binds[3];
+  for (u32 i = 0; i < 3; ++i) {
+    cluster_binds[i] = umbvk_descriptor_set_layout_binding_create(
+        VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+        VK_SHADER_STAGE_COMPUTE_BIT,
+        i);
+  }
+  VkDescriptorSetLayoutCreateInfo cluster_info = {
+      .sType        = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+      .bindingCount = UMB_ARRAY_COUNT(cluster_binds, VkDescriptorSetLayoutBinding),
+      .pBindings    = cluster_binds,
+  };
+  vkCreateDescriptorSetLayout(_vk.device, &cluster_info, nullptr, &_vk.cluster_set_layout);
 
-    _vk.frames[i].camera_buffer = umbvk_buffer_create_gpu_upload(
-        sizeof(umb_gpu_camera_data),
-        VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT);
+  umbvk_bindless_create();
+
+  for (i32 i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i) {
+    _vk.frames[i].transient = umbvk_linear_buffer_create(
+        FRAME_TRANSIENT_SIZE,
+        VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+            VK_BUFFER_USAGE_TRANSFER_SRC_BIT);
 
     VkDescriptorSetAllocateInfo alloc_info = {
         .sType              = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
@@ -1329,20 +2376,15 @@ void umbvk_set_descriptors() {
     vkAllocateDescriptorSets(_vk.device, &obj_alloc_info, &_vk.frames[i].object_descriptor);
 
     VkDescriptorBufferInfo cam_binfo = {
-        .buffer = _vk.frames[i].camera_buffer.buffer,
+        .buffer = _vk.frames[i].transient.buffer.buffer,
         .range  = sizeof(umb_gpu_camera_data),
     };
     VkDescriptorBufferInfo scene_binfo = {
         .buffer = _vk.scene_parameters_buffer.buffer,
         .range  = sizeof(umb_gpu_scene_data),
     };
-    VkDescriptorBufferInfo obj_binfo = {
-        .buffer = _vk.frames[i].object_buffer.buffer,
-        .range  = sizeof(umb_gpu_object_data) * MAX_GPU_OBJECTS,
-    };
-
     VkWriteDescriptorSet cam_write = umbvk_descriptor_buffer_write(
-        VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
+        VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC,
         _vk.frames[i].global_descriptor,
         &cam_binfo,
         0);
@@ -1352,60 +2394,68 @@ void umbvk_set_descriptors() {
         &scene_binfo,
         1);
 
-    VkWriteDescriptorSet obj_write = umbvk_descriptor_buffer_write(
-        VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
-        _vk.frames[i].object_descriptor,
-        &obj_binfo,
-        0);
-
-    VkWriteDescriptorSet set_writes[] = {cam_write, scene_write, obj_write};
+    VkWriteDescriptorSet set_writes[] = {cam_write, scene_write};
     vkUpdateDescriptorSets(
         _vk.device,
         UMB_ARRAY_COUNT(set_writes, VkWriteDescriptorSet),
         set_writes,
         0,
         nullptr);
+
+    umbvk_growable_buffer_create(
+        &_vk.frames[i].object_buffer,
+        sizeof(umb_gpu_object_data) * INITIAL_RENDER_OBJECTS,
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
+    umbvk_object_descriptor_write(_vk.frames[i].object_descriptor, &_vk.frames[i].object_buffer);
+
+    _vk.frames[i].cluster_draw_buffer = umbvk_buffer_create_gpu_upload(
+        sizeof(VkDrawIndexedIndirectCommand) * MAX_CLUSTER_DRAWS,
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT);
+
+    VkDescriptorSetAllocateInfo cluster_alloc_info = {
+        .sType              = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+        .descriptorPool     = _vk.descriptor_pool,
+        .descriptorSetCount = 1,
+        .pSetLayouts        = &_vk.cluster_set_layout,
+    };
+    vkAllocateDescriptorSets(_vk.device, &cluster_alloc_info, &_vk.frames[i].cluster_descriptor);
+
+    VkDescriptorSetAllocateInfo bindless_alloc_info = {
+        .sType              = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+        .descriptorPool     = _vk.descriptor_pool,
+        .descriptorSetCount = 1,
+        .pSetLayouts        = &_vk.bindless.layout,
+    };
+    vkAllocateDescriptorSets(_vk.device, &bindless_alloc_info, &_vk.frames[i].bindless_descriptor);
+    _vk.frames[i].bindless_views =
+        umb_arena_push_array(&_vk.arena, VkImageView, _vk.bindless.capacity);
+
+    VkDescriptorBufferInfo material_binfo = {
+        .buffer = _vk.bindless.material_buffer.buffer,
+        .range  = sizeof(umb_gpu_material_data) * MAX_MATERIALS,
+    };
+    VkWriteDescriptorSet material_write = umbvk_descriptor_buffer_write(
+        VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+        _vk.frames[i].bindless_descriptor,
+        &material_binfo,
+        0);
+    vkUpdateDescriptorSets(_vk.device, 1, &material_write, 0, nullptr);
   }
+  umbvk_write_cluster_descriptors();
 
   _vk.deletion_queue.push([&]() {
     vkDestroyDescriptorSetLayout(_vk.device, _vk.global_set_layout, nullptr);
     vkDestroyDescriptorSetLayout(_vk.device, _vk.object_set_layout, nullptr);
+    vkDestroyDescriptorSetLayout(_vk.device, _vk.cluster_set_layout, nullptr);
+    vkDestroyDescriptorSetLayout(_vk.device, _vk.bindless.layout, nullptr);
+    for (u32 i = 0; i < UMB_SAMPLER_COUNT; ++i) {
+      vkDestroySampler(_vk.device, _vk.bindless.samplers[i], nullptr);
+    }
     vkDestroyDescriptorPool(_vk.device, _vk.descriptor_pool, nullptr);
   });
 }
 
-umbvk_upload_context umbvk_upload_context_create() {
-  umbvk_upload_context ctx = {};
-
-  umbvk_queue_family_indices indices = _vk.queue_families;
-
-  VkCommandPoolCreateInfo cmd_pool_info = {
-      .sType            = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
-      .flags            = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT,
-      .queueFamilyIndex = indices.graphics_and_compute_queue_idx,
-  };
-
-  VK_CHECK(
-      vkCreateCommandPool(_vk.device, &cmd_pool_info, nullptr, &ctx.cmd_pool),
-      "Failed to create command pool!");
-
-  _vk.deletion_queue.push([=]() { vkDestroyCommandPool(_vk.device, ctx.cmd_pool, nullptr); });
-
-  VkCommandBufferAllocateInfo alloc_info = {
-      .sType              = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
-      .commandPool        = ctx.cmd_pool,
-      .level              = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
-      .commandBufferCount = 1,
-  };
-
-  VK_CHECK(
-      vkAllocateCommandBuffers(_vk.device, &alloc_info, &ctx.cmd_buff),
-      "Failed to allocate command buffer!");
-
-  return ctx;
-}
-
-umbvk_cmd_buffer umbvk_cmd_buffer_create() {
+umbvk_cmd_buffer umbvk_cmd_buffer_create(VkCommandBufferLevel level) {
   umbvk_cmd_buffer cmd = {};
 
   umbvk_queue_family_indices indices = _vk.queue_families;
@@ -1425,7 +2475,7 @@ umbvk_cmd_buffer umbvk_cmd_buffer_create() {
   VkCommandBufferAllocateInfo alloc_info = {
       .sType              = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
       .commandPool        = cmd.cmd_pool,
-      .level              = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+      .level              = level,
       .commandBufferCount = 1,
   };
 
@@ -1452,6 +2502,31 @@ void umbvk_cmd_begin(umbvk_cmd_buffer* cmd) {
       "Failed to beging recording command buffer!");
 }
 
+// the secondary continues the first subpass of the primary's render pass. the framebuffer is only a
+// hint and may be VK_NULL_HANDLE.
+void umbvk_cmd_begin_secondary(
+    umbvk_cmd_buffer*         cmd,
+    VkFramebuffer             framebuffer,
+    VkCommandBufferUsageFlags flags) {
+  VkCommandBufferInheritanceInfo inheritance_info = {
+      .sType       = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO,
+      .renderPass  = _vk.compatible_render_pass,
+      .subpass     = 0,
+      .framebuffer = framebuffer,
+  };
+  VkCommandBufferBeginInfo begin_info = {
+      .sType            = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+      .flags            = flags | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT,
+      .pInheritanceInfo = &inheritance_info,
+  };
+
+  cmd->active_gfx_pipeline = nullptr;
+  cmd->active_cmp_pipeline = nullptr;
+  VK_CHECK(
+      vkBeginCommandBuffer(cmd->cmd_buff, &begin_info),
+      "Failed to begin recording secondary command buffer!");
+}
+
 void umbvk_cmd_bind_graphics_pipeline(umbvk_cmd_buffer* cmd, umb_pipeline* pipeline) {
   // TODO(brysonm): handle previously bound resources
   cmd->active_gfx_pipeline = pipeline;
@@ -1464,6 +2539,10 @@ void umbvk_cmd_bind_compute_pipeline(umbvk_cmd_buffer* cmd, umb_pipeline* pipeli
   vkCmdBindPipeline(cmd->cmd_buff, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline->pipeline);
 }
 
+void umbvk_cmd_bind_index_buffer(umbvk_cmd_buffer* cmd, VkBuffer buffer, VkDeviceSize offset) {
+  vkCmdBindIndexBuffer(cmd->cmd_buff, buffer, offset, VK_INDEX_TYPE_UINT32);
+}
+
 void umbvk_cmd_bind_vertex_buffer(
     umbvk_cmd_buffer* cmd,
     u32               first_binding,
@@ -1486,7 +2565,10 @@ void umbvk_cmd_push_constants(
       constants);
 }
 
-void umbvk_cmd_render_pass_begin(umbvk_cmd_buffer* cmd, u32 image_idx) {
+void umbvk_cmd_render_pass_begin(
+    umbvk_cmd_buffer* cmd,
+    u32               image_idx,
+    VkSubpassContents contents) {
   VkClearValue clear_color    = {{0.0f, 0.0f, 0.0f, 1.0f}};
   VkClearValue depth_clear    = {.depthStencil = 1.f};
   VkClearValue clear_values[] = {clear_color, depth_clear};
@@ -1504,7 +2586,7 @@ void umbvk_cmd_render_pass_begin(umbvk_cmd_buffer* cmd, u32 image_idx) {
       .pClearValues    = clear_values,
   };
 
-  vkCmdBeginRenderPass(cmd->cmd_buff, &render_pass_info, VK_SUBPASS_CONTENTS_INLINE);
+  vkCmdBeginRenderPass(cmd->cmd_buff, &render_pass_info, contents);
 }
 
 void umbvk_cmd_render_pass_end(umbvk_cmd_buffer* cmd) {
@@ -1536,430 +2618,3386 @@ void umbvk_cmd_draw(
     bool              indexed,
     u32               n_elts,
     u32               n_instances,
-    u32               first_elt) {
+    u32               first_elt,
+    i32               vertex_offset,
+    u32               first_instance) {
   if (indexed) {
-    vkCmdDrawIndexed(cmd->cmd_buff, n_elts, n_instances, first_elt, 0u, 0u);
+    vkCmdDrawIndexed(cmd->cmd_buff, n_elts, n_instances, first_elt, vertex_offset, first_instance);
   } else {
-    vkCmdDraw(cmd->cmd_buff, n_elts, n_instances, first_elt, 0u);
+    vkCmdDraw(cmd->cmd_buff, n_elts, n_instances, first_elt, first_instance);
   }
 }
 
+void umbvk_cmd_draw_indexed_indirect(
+    umbvk_cmd_buffer* cmd,
+    VkBuffer          buffer,
+    VkDeviceSize      offset,
+    u32               n_draws) {
+  vkCmdDrawIndexedIndirect(
+      cmd->cmd_buff,
+      buffer,
+      offset,
+      n_draws,
+      sizeof(VkDrawIndexedIndirectCommand));
+}
+
+void umbvk_cmd_dispatch(umbvk_cmd_buffer* cmd, u32 x, u32 y, u32 z) {
+  vkCmdDispatch(cmd->cmd_buff, x, y, z);
+}
+
 void umbvk_cmd_end(umbvk_cmd_buffer* cmd) {
   VK_CHECK(vkEndCommandBuffer(cmd->cmd_buff), "Failed to record command buffer!");
 }
 
-void umbvk_cmd_immediate(std::function<void(VkCommandBuffer cmd)>&& cmd_func) {
-  VkCommandBuffer cmd = _vk.upload_context.cmd_buff;
-
-  VkCommandBufferBeginInfo begin_info = {
-      .sType            = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
-      .flags            = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
-      .pInheritanceInfo = nullptr,
+umbvk_buffer umbvk_staging_buffer_create(u64 size, byte** out_mapped) {
+  VkBufferCreateInfo buffer_info = {
+      .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+      .size  = size,
+      .usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
   };
 
-  VK_CHECK(vkBeginCommandBuffer(cmd, &begin_info), "could not begin immediate command recording!");
-  cmd_func(cmd);
-  VK_CHECK(vkEndCommandBuffer(cmd), "could not end immediate buffer!");
-
-  VkSubmitInfo submit_info {
-      .sType              = VK_STRUCTURE_TYPE_SUBMIT_INFO,
-      .commandBufferCount = 1,
-      .pCommandBuffers    = &cmd,
+  VmaAllocationCreateInfo alloc_info = {
+      .usage         = VMA_MEMORY_USAGE_CPU_ONLY,
+      .requiredFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
   };
 
+  umbvk_buffer buffer;
   VK_CHECK(
-      vkQueueSubmit(_vk.graphics_queue, 1, &submit_info, _vk.upload_context.upload_fence),
-      "failed to submit immediate command buffer!");
+      vmaCreateBuffer(
+          _vk.allocator,
+          &buffer_info,
+          &alloc_info,
+          &buffer.buffer,
+          &buffer.alloc,
+          nullptr),
+      "Failed to create staging buffer!");
+  vmaMapMemory(_vk.allocator, buffer.alloc, (void**)out_mapped);
 
-  vkWaitForFences(_vk.device, 1, &_vk.upload_context.upload_fence, VK_TRUE, UINT64_MAX);
-  vkResetFences(_vk.device, 1, &_vk.upload_context.upload_fence);
-  vkResetCommandPool(_vk.device, _vk.upload_context.cmd_pool, 0);
+  return buffer;
 }
 
-void umbvk_create_frame_resources() {
-  VkSemaphoreCreateInfo semaphore_info = {
-      .sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
-  };
-  VkFenceCreateInfo fence_info = {
-      .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
-      .flags = VK_FENCE_CREATE_SIGNALED_BIT,
-  };
-
-  for (i32 i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
-    VK_CHECK(
-        vkCreateSemaphore(
-            _vk.device,
-            &semaphore_info,
-            nullptr,
-            &_vk.frames[i].image_available_semaphore),
-        "failed to create semaphore");
-    _vk.deletion_queue.push([=]() {
-      vkDestroySemaphore(_vk.device, _vk.frames[i].image_available_semaphore, nullptr);
-    });
-
-    VK_CHECK(
-        vkCreateSemaphore(
-            _vk.device,
-            &semaphore_info,
-            nullptr,
-            &_vk.frames[i].render_finished_semaphore),
-        "failed to create semaphore");
-    _vk.deletion_queue.push([=]() {
-      vkDestroySemaphore(_vk.device, _vk.frames[i].render_finished_semaphore, nullptr);
-    });
-
-    VK_CHECK(
-        vkCreateFence(_vk.device, &fence_info, nullptr, &_vk.frames[i].render_fence),
-        "failed to create fence");
-    _vk.deletion_queue.push(
-        [=]() { vkDestroyFence(_vk.device, _vk.frames[i].render_fence, nullptr); });
+void umbvk_staging_buffer_destroy(umbvk_buffer* buffer) {
+  vmaUnmapMemory(_vk.allocator, buffer->alloc);
+  vmaDestroyBuffer(_vk.allocator, buffer->buffer, buffer->alloc);
+}
 
-    _vk.frames[i].cmd = umbvk_cmd_buffer_create();
+// moves the tail past every batch that has executed and frees their dedicated buffers
+void umbvk_staging_reclaim(umbvk_staging_ring* ring, u64 completed) {
+  while (ring->n_marks > 0 && ring->marks[ring->mark_head].value <= completed) {
+    ring->tail      = ring->marks[ring->mark_head].end;
+    ring->mark_head = (ring->mark_head + 1) % MAX_STAGING_MARKS;
+    ring->n_marks--;
   }
 
-  VkFenceCreateInfo upload_fence_info {
-      .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
-  };
-  VK_CHECK(
-      vkCreateFence(_vk.device, &upload_fence_info, nullptr, &_vk.upload_context.upload_fence),
-      "failed to create upload fence!");
+  u32 n_kept = 0;
+  for (u32 i = 0; i < ring->n_dedicated; ++i) {
+    if (ring->dedicated[i].value <= completed) {
+      umbvk_staging_buffer_destroy(&ring->dedicated[i].buffer);
+    } else {
+      ring->dedicated[n_kept++] = ring->dedicated[i];
+    }
+  }
+  ring->n_dedicated = n_kept;
+}
 
-  _vk.deletion_queue.push(
-      [=]() { vkDestroyFence(_vk.device, _vk.upload_context.upload_fence, nullptr); });
+u64 umbvk_upload_completed_value() {
+  u64 value;
+  vkGetSemaphoreCounterValue(_vk.device, _vk.uploader.timeline, &value);
+  return value;
 }
 
-void umbvk_cmd_bind_gfx_descriptor_sets(
-    umbvk_cmd_buffer* cmd,
-    u32               set,
-    VkDescriptorSet*  descriptor) {
-  vkCmdBindDescriptorSets(
-      cmd->cmd_buff,
-      VK_PIPELINE_BIND_POINT_GRAPHICS,
-      cmd->active_gfx_pipeline->pipeline_layout,
-      set,
-      1,
-      descriptor,
-      0,
-      nullptr);
+void umbvk_upload_wait_value(u64 value) {
+  VkSemaphoreWaitInfo wait_info = {
+      .sType          = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO,
+      .semaphoreCount = 1,
+      .pSemaphores    = &_vk.uploader.timeline,
+      .pValues        = &value,
+  };
+  VK_CHECK(
+      vkWaitSemaphores(_vk.device, &wait_info, UINT64_MAX),
+      "failed to wait for upload timeline!");
 }
 
-void umbvk_cmd_bind_gfx_descriptor_sets_offset(
-    umbvk_cmd_buffer* cmd,
-    u32               set,
-    VkDescriptorSet*  descriptor,
-    u32*              uniform_offset) {
-  vkCmdBindDescriptorSets(
-      cmd->cmd_buff,
-      VK_PIPELINE_BIND_POINT_GRAPHICS,
-      cmd->active_gfx_pipeline->pipeline_layout,
-      set,
-      1,
-      descriptor,
-      1,
-      uniform_offset);
+void umbvk_upload_push_op(umbvk_upload_op op) {
+  umbvk_upload_batch* batch = &_vk.uploader.open;
+  if (batch->n_ops == batch->cap) {
+    batch->cap = batch->cap ? batch->cap * 2 : 64;
+    batch->ops = (umbvk_upload_op*)realloc(batch->ops, sizeof(umbvk_upload_op) * batch->cap);
+  }
+  batch->ops[batch->n_ops++] = op;
 }
 
-void umbvk_cmd_draw_objects(umbvk_cmd_buffer* cmd) {
-  glm::mat4 model      = glm::translate(glm::mat4(1), glm::vec3(0, 5, 0));
-  glm::vec3 camPos     = {0.f, -6.f, -10.f};
-  glm::mat4 view       = glm::translate(glm::mat4(1.f), camPos);
-  glm::mat4 projection = glm::perspective(glm::radians(70.f), 1700.f / 900.f, 0.1f, 200.0f);
-  projection[1][1] *= -1;
+// hands the open batch to the upload thread and returns the timeline value it will signal. an
+// empty batch stays open, so the returned value is the last one submitted.
+u64 umbvk_upload_submit_open() {
+  umbvk_uploader* up = &_vk.uploader;
+  if (up->open.n_ops == 0) return up->open.value - 1;
+
+  u64 value = up->open.value;
+  {
+    std::unique_lock<std::mutex> lock(up->mutex);
+    up->cond.wait(lock, [=]() { return up->n_pending < MAX_PENDING_UPLOADS; });
+    up->pending[(up->pending_head + up->n_pending) % MAX_PENDING_UPLOADS] = up->open;
+    up->n_pending++;
+  }
+  up->cond.notify_all();
 
-  umb_gpu_camera_data cam_data = {
-      .view     = view,
-      .proj     = projection,
-      .viewproj = projection * view,
+  umbvk_staging_ring* ring = &up->staging;
+  if (ring->n_marks == MAX_STAGING_MARKS) {
+    umbvk_upload_wait_value(ring->marks[ring->mark_head].value);
+    umbvk_staging_reclaim(ring, umbvk_upload_completed_value());
+  }
+  ring->marks[(ring->mark_head + ring->n_marks++) % MAX_STAGING_MARKS] = {
+      .end   = ring->head,
+      .value = value,
   };
 
-  void* data;
-  vmaMapMemory(_vk.allocator, _vk.frames[_vk.frame_id].camera_buffer.alloc, &data);
-  memcpy(data, &cam_data, sizeof(umb_gpu_camera_data));
-  vmaUnmapMemory(_vk.allocator, _vk.frames[_vk.frame_id].camera_buffer.alloc);
+  up->open = {.value = value + 1};
+  return value;
+}
 
-  _vk.scene_parameters.ambient_color = {1.0f, 0.0f, 0.0f, 1.0f};
-  byte* scene_data;
-  vmaMapMemory(_vk.allocator, _vk.scene_parameters_buffer.alloc, (void**)&scene_data);
-  scene_data += umbvk_pad_uniform_buffer_size(sizeof(umb_gpu_scene_data)) * _vk.frame_id;
-  memcpy(scene_data, &_vk.scene_parameters, sizeof(umb_gpu_scene_data));
-  vmaUnmapMemory(_vk.allocator, _vk.scene_parameters_buffer.alloc);
-
-  void* obj_data;
-  vmaMapMemory(_vk.allocator, _vk.frames[_vk.frame_id].object_buffer.alloc, &obj_data);
-  umb_gpu_object_data* obj_ssbo = (umb_gpu_object_data*)obj_data;
-  for (i32 i = 0; i < _vk.render_objects.len; ++i) {
-    umb_render_object* o     = _vk.render_objects.data[i];
-    obj_ssbo[i].model_matrix = o->transform;
-  }
-  vmaUnmapMemory(_vk.allocator, _vk.frames[_vk.frame_id].object_buffer.alloc);
-
-  umb_mesh      last_mesh     = NULL;
-  umb_material* last_material = NULL;
-  for (i32 i = 0; i < _vk.render_objects.len; ++i) {
-    umb_render_object* o = _vk.render_objects.data[i];
-
-    if (o->material != last_material) {
-      umbvk_cmd_bind_graphics_pipeline(cmd, &o->material->pipeline);
-      last_material = o->material;
-
-      u32 uniform_offset = umbvk_pad_uniform_buffer_size(sizeof(umb_gpu_scene_data)) * _vk.frame_id;
-      umbvk_cmd_bind_gfx_descriptor_sets_offset(
-          cmd,
-          0,
-          &_vk.frames[_vk.frame_id].global_descriptor,
-          &uniform_offset);
-      umbvk_cmd_bind_gfx_descriptor_sets(cmd, 1, &_vk.frames[_vk.frame_id].object_descriptor);
+// returns mapped staging memory for `size` bytes and where it lives, for copy ops. may submit the
+// open batch or wait for older ones to free ring space, so push the ops out of one allocation
+// before making the next.
+byte* umbvk_upload_staging_alloc(u64 size, VkBuffer* out_buffer, u64* out_offset) {
+  umbvk_uploader*     up   = &_vk.uploader;
+  umbvk_staging_ring* ring = &up->staging;
+  umbvk_staging_reclaim(ring, umbvk_upload_completed_value());
+
+  if (size > ring->size) {
+    while (ring->n_dedicated == MAX_STAGING_DEDICATED) {
+      umbvk_upload_wait_value(umbvk_upload_submit_open());
+      umbvk_staging_reclaim(ring, umbvk_upload_completed_value());
     }
 
-    umb_push_constants constants {.render_matrix = model};
-    umbvk_cmd_push_constants(cmd, &constants, VK_SHADER_STAGE_VERTEX_BIT);
+    byte*                    mapped;
+    umbvk_staging_dedicated* dedicated = &ring->dedicated[ring->n_dedicated++];
+    dedicated->buffer                  = umbvk_staging_buffer_create(size, &mapped);
+    dedicated->value                   = up->open.value;
+    *out_buffer                        = dedicated->buffer.buffer;
+    *out_offset                        = 0;
+    return mapped;
+  }
+
+  for (;;) {
+    u64 offset = (ring->head + STAGING_ALIGNMENT - 1) & ~(STAGING_ALIGNMENT - 1);
 
-    if (o->mesh != last_mesh) {
-      VkDeviceSize offset = 0;
-      umbvk_cmd_bind_vertex_buffer(cmd, 0, 1, &o->mesh->vertex_buffer.buffer, &offset);
-      last_mesh = o->mesh;
+    // allocations never straddle the end of the buffer, the rest of the lap is skipped
+    u64 ring_offset = offset % ring->size;
+    if (ring_offset + size > ring->size) offset += ring->size - ring_offset;
+
+    if (offset + size - ring->tail <= ring->size) {
+      ring->head  = offset + size;
+      *out_buffer = ring->buffer.buffer;
+      *out_offset = offset % ring->size;
+      return ring->mapped + *out_offset;
     }
 
-    umbvk_cmd_draw(cmd, false, o->mesh->vertices.len, 1, 0);
+    if (ring->n_marks == 0) {
+      // everything still in use belongs to the open batch, it has to go out first
+      UMB_ASSERT(up->open.n_ops > 0);
+      umbvk_upload_wait_value(umbvk_upload_submit_open());
+    } else {
+      umbvk_upload_wait_value(ring->marks[ring->mark_head].value);
+    }
+    umbvk_staging_reclaim(ring, umbvk_upload_completed_value());
   }
 }
 
-void umbvk_set_allocator() {
-  VmaAllocatorCreateInfo allocator_info = {
-      .physicalDevice = _vk.physical_device,
-      .device         = _vk.device,
-      .instance       = _vk.instance,
+// fills every level of `range` past the first by blitting each level into the next. expects all
+// levels in TRANSFER_DST_OPTIMAL with level 0 written, leaves them SHADER_READ_ONLY_OPTIMAL.
+void umbvk_cmd_generate_mips(
+    VkCommandBuffer         cmd,
+    VkImage                 image,
+    VkExtent2D              extent,
+    VkImageSubresourceRange range) {
+  const VkPipelineStageFlags shader_stages = VK_PIPELINE_STAGE_VERTEX_SHADER_BIT |
+                                             VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT |
+                                             VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+
+  VkImageMemoryBarrier barrier = {
+      .sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+      .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+      .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+      .image               = image,
+      .subresourceRange    = range,
   };
+  barrier.subresourceRange.levelCount = 1;
+
+  i32 width  = (i32)extent.width;
+  i32 height = (i32)extent.height;
+  u32 last   = range.baseMipLevel + range.levelCount - 1;
+  for (u32 level = range.baseMipLevel; level < last; ++level) {
+    // the level was just written, read it as the source of the next one
+    barrier.subresourceRange.baseMipLevel = level;
+    barrier.srcAccessMask                 = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask                 = VK_ACCESS_TRANSFER_READ_BIT;
+    barrier.oldLayout                     = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.newLayout                     = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    vkCmdPipelineBarrier(
+        cmd,
+        VK_PIPELINE_STAGE_TRANSFER_BIT,
+        VK_PIPELINE_STAGE_TRANSFER_BIT,
+        0,
+        0,
+        nullptr,
+        0,
+        nullptr,
+        1,
+        &barrier);
 
-  vmaCreateAllocator(&allocator_info, &_vk.allocator);
+    i32 next_width  = width > 1 ? width / 2 : 1;
+    i32 next_height = height > 1 ? height / 2 : 1;
+
+    VkImageBlit blit = {
+        .srcSubresource =
+            {
+                .aspectMask     = range.aspectMask,
+                .mipLevel       = level,
+                .baseArrayLayer = range.baseArrayLayer,
+                .layerCount     = range.layerCount,
+            },
+        .srcOffsets = {{0, 0, 0}, {width, height, 1}},
+        .dstSubresource =
+            {
+                .aspectMask     = range.aspectMask,
+                .mipLevel       = level + 1,
+                .baseArrayLayer = range.baseArrayLayer,
+                .layerCount     = range.layerCount,
+            },
+        .dstOffsets = {{0, 0, 0}, {next_width, next_height, 1}},
+    };
+    vkCmdBlitImage(
+        cmd,
+        image,
+        VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+        image,
+        VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+        1,
+        &blit,
+        VK_FILTER_LINEAR);
+
+    // done as a source, hand it to the shaders
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    barrier.oldLayout     = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    barrier.newLayout     = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    vkCmdPipelineBarrier(
+        cmd,
+        VK_PIPELINE_STAGE_TRANSFER_BIT,
+        shader_stages,
+        0,
+        0,
+        nullptr,
+        0,
+        nullptr,
+        1,
+        &barrier);
+
+    width  = next_width;
+    height = next_height;
+  }
+
+  barrier.subresourceRange.baseMipLevel = last;
+  barrier.srcAccessMask                 = VK_ACCESS_TRANSFER_WRITE_BIT;
+  barrier.dstAccessMask                 = VK_ACCESS_SHADER_READ_BIT;
+  barrier.oldLayout                     = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+  barrier.newLayout                     = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+  vkCmdPipelineBarrier(
+      cmd,
+      VK_PIPELINE_STAGE_TRANSFER_BIT,
+      shader_stages,
+      0,
+      0,
+      nullptr,
+      0,
+      nullptr,
+      1,
+      &barrier);
 }
 
-void umb_gfx_init(umb_window* window) {
-  _vk.arena          = umb_arena_create(UMB_MEGABYTES(4));
-  _vk.render_objects = UMB_PTR_ARRAY_CREATE(umb_render_object, &_vk.arena, 1024);
-  _vk.materials      = umb_hash_table_create(&_vk.arena, DEFAULT_NUM_SLOTS);
-  _vk.meshes         = umb_hash_table_create(&_vk.arena, DEFAULT_NUM_SLOTS);
+void umbvk_upload_record(VkCommandBuffer cmd, umbvk_upload_op* op, u64 value) {
+  u32 graphics_family = _vk.queue_families.graphics_and_compute_queue_idx;
+  u32 transfer_family = _vk.queue_families.transfer_queue_idx;
 
-  VkApplicationInfo app_info {
-      .sType              = VK_STRUCTURE_TYPE_APPLICATION_INFO,
-      .pApplicationName   = "Game",
-      .applicationVersion = VK_MAKE_VERSION(1, 0, 0),
-      .pEngineName        = "[umbral]",
-      .engineVersion      = VK_MAKE_VERSION(1, 0, 0),
-      .apiVersion         = VK_API_VERSION_1_2};
+  switch (op->type) {
+  case UMBVK_UPLOAD_COPY_BUFFER: {
+    vkCmdCopyBuffer(cmd, op->src, op->dst_buffer, 1, &op->buffer_copy);
+  } break;
 
-  _vk.window                        = window;
-  umb_array_str required_extensions = umbvk_get_required_extensions(_vk.window);
+  case UMBVK_UPLOAD_IMAGE_BEGIN: {
+    VkImageMemoryBarrier image_barrier_to_transfer = {
+        .sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+        .srcAccessMask       = 0,
+        .dstAccessMask       = VK_ACCESS_TRANSFER_WRITE_BIT,
+        .oldLayout           = VK_IMAGE_LAYOUT_UNDEFINED,
+        .newLayout           = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+        .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .image               = op->dst_image,
+        .subresourceRange    = op->image_range,
+    };
+    vkCmdPipelineBarrier(
+        cmd,
+        VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+        VK_PIPELINE_STAGE_TRANSFER_BIT,
+        0,
+        0,
+        nullptr,
+        0,
+        nullptr,
+        1,
+        &image_barrier_to_transfer);
+  } break;
 
-  VkInstanceCreateInfo vulkan_create_info {
-    .sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO, .pApplicationInfo = &app_info,
-    .enabledExtensionCount   = required_extensions.len,
-    .ppEnabledExtensionNames = required_extensions.data,
-#if defined(__APPLE__)
-    .flags = VK_INSTANCE_CREATE_ENUMERATE_PORTABILITY_BIT_KHR,
-#endif
+  case UMBVK_UPLOAD_COPY_IMAGE: {
+    vkCmdCopyBufferToImage(
+        cmd,
+        op->src,
+        op->dst_image,
+        VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+        1,
+        &op->image_copy);
+  } break;
+
+  case UMBVK_UPLOAD_IMAGE_END: {
+    // images are exclusive to one family, so a dedicated transfer family releases them here and
+    // the frame that first sees `value` acquires them on the graphics family. blits need a
+    // graphics queue, a transfer-only family leaves the mip chain to the acquiring frame.
+    b32 transfer = transfer_family != graphics_family;
+    b32 blit     = op->blit_extent.width > 0;
+    if (blit && !transfer) {
+      umbvk_cmd_generate_mips(cmd, op->dst_image, op->blit_extent, op->image_range);
+      break;
+    }
+
+    VkImageMemoryBarrier image_barrier_to_readable = {
+        .sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+        .srcAccessMask       = VK_ACCESS_TRANSFER_WRITE_BIT,
+        .dstAccessMask       = transfer ? 0u : VK_ACCESS_SHADER_READ_BIT,
+        .oldLayout           = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+        .newLayout           = blit ? VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL
+                                    : VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+        .srcQueueFamilyIndex = transfer ? transfer_family : VK_QUEUE_FAMILY_IGNORED,
+        .dstQueueFamilyIndex = transfer ? graphics_family : VK_QUEUE_FAMILY_IGNORED,
+        .image               = op->dst_image,
+        .subresourceRange    = op->image_range,
+    };
+    vkCmdPipelineBarrier(
+        cmd,
+        VK_PIPELINE_STAGE_TRANSFER_BIT,
+        transfer ? VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT : VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+        0,
+        0,
+        nullptr,
+        0,
+        nullptr,
+        1,
+        &image_barrier_to_readable);
+
+    if (transfer) {
+      umbvk_uploader*              up = &_vk.uploader;
+      std::lock_guard<std::mutex> lock(up->mutex);
+      if (up->n_acquires == up->cap_acquires) {
+        up->cap_acquires = up->cap_acquires ? up->cap_acquires * 2 : 16;
+        up->acquires     = (umbvk_image_acquire*)realloc(
+            up->acquires,
+            sizeof(umbvk_image_acquire) * up->cap_acquires);
+      }
+      up->acquires[up->n_acquires++] = {
+          .image       = op->dst_image,
+          .range       = op->image_range,
+          .blit_extent = op->blit_extent,
+          .value       = value,
+      };
+    }
+  } break;
+  }
+}
+
+// records and submits one batch on the transfer queue, signalling its value on the timeline
+void umbvk_upload_execute(umbvk_upload_batch* batch) {
+  umbvk_uploader* up   = &_vk.uploader;
+  u32             slot = up->cmd_idx;
+  up->cmd_idx          = (up->cmd_idx + 1) % MAX_UPLOADS_IN_FLIGHT;
+
+  umbvk_upload_wait_value(up->cmd_values[slot]);
+  vkResetCommandPool(_vk.device, up->cmd_pools[slot], 0);
+
+  VkCommandBuffer          cmd        = up->cmd_buffs[slot];
+  VkCommandBufferBeginInfo begin_info = {
+      .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+      .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+  };
+  VK_CHECK(vkBeginCommandBuffer(cmd, &begin_info), "could not begin upload command recording!");
+  for (u32 i = 0; i < batch->n_ops; ++i) umbvk_upload_record(cmd, &batch->ops[i], batch->value);
+  VK_CHECK(vkEndCommandBuffer(cmd), "could not end upload command buffer!");
+
+  VkTimelineSemaphoreSubmitInfo timeline_info = {
+      .sType                     = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO,
+      .signalSemaphoreValueCount = 1,
+      .pSignalSemaphoreValues    = &batch->value,
+  };
+  VkSubmitInfo submit_info {
+      .sType                = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+      .pNext                = &timeline_info,
+      .commandBufferCount   = 1,
+      .pCommandBuffers      = &cmd,
+      .signalSemaphoreCount = 1,
+      .pSignalSemaphores    = &up->timeline,
   };
+  {
+    std::lock_guard<std::mutex> lock(_vk.queue_mutex);
+    VK_CHECK(
+        vkQueueSubmit(up->queue, 1, &submit_info, VK_NULL_HANDLE),
+        "failed to submit upload command buffer!");
+  }
 
-  VkDebugUtilsMessengerCreateInfoEXT debug_create_info {};
-  if (_vk.validation_layers_enabled) {
-    UMB_ASSERT(umbvk_check_validation_layer_support(VALIDATION_LAYERS));
-    vulkan_create_info.enabledLayerCount   = UMB_ARRAY_COUNT(VALIDATION_LAYERS, str);
-    vulkan_create_info.ppEnabledLayerNames = VALIDATION_LAYERS;
-    debug_messenger_create_info(debug_create_info);
-    vulkan_create_info.pNext = (VkDebugUtilsMessengerCreateInfoEXT*)&debug_create_info;
-  } else {
-    vulkan_create_info.enabledLayerCount = 0;
-    vulkan_create_info.pNext             = nullptr;
+  up->cmd_values[slot] = batch->value;
+  free(batch->ops);
+}
+
+void umbvk_upload_thread_main() {
+  umbvk_uploader* up = &_vk.uploader;
+  for (;;) {
+    umbvk_upload_batch batch;
+    {
+      std::unique_lock<std::mutex> lock(up->mutex);
+      up->cond.wait(lock, [=]() { return up->quit || up->n_pending > 0; });
+      // batches still queued at shutdown are submitted before leaving
+      if (up->n_pending == 0) return;
+      batch            = up->pending[up->pending_head];
+      up->pending_head = (up->pending_head + 1) % MAX_PENDING_UPLOADS;
+      up->n_pending--;
+    }
+    up->cond.notify_all();
+    umbvk_upload_execute(&batch);
   }
+}
+
+void umbvk_uploader_create() {
+  umbvk_uploader* up = &_vk.uploader;
 
+  VkSemaphoreTypeCreateInfo timeline_type_info = {
+      .sType         = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO,
+      .semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE,
+      .initialValue  = 0,
+  };
+  VkSemaphoreCreateInfo timeline_info = {
+      .sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+      .pNext = &timeline_type_info,
+  };
   VK_CHECK(
-      vkCreateInstance(&vulkan_create_info, nullptr, &_vk.instance),
-      "failed to create instance!");
+      vkCreateSemaphore(_vk.device, &timeline_info, nullptr, &up->timeline),
+      "failed to create upload timeline semaphore!");
 
-  // debug messenger for validation layers
-  if (_vk.validation_layers_enabled) {
+  VkCommandPoolCreateInfo cmd_pool_info = {
+      .sType            = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+      .flags            = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT,
+      .queueFamilyIndex = _vk.queue_families.transfer_queue_idx,
+  };
+  for (u32 i = 0; i < MAX_UPLOADS_IN_FLIGHT; ++i) {
     VK_CHECK(
-        umbvk_create_debug_utils_messenger_ext(
-            _vk.instance,
-            &debug_create_info,
-            nullptr,
-            &_vk.debug_messenger),
-        "failed to create debug messenger!");
+        vkCreateCommandPool(_vk.device, &cmd_pool_info, nullptr, &up->cmd_pools[i]),
+        "Failed to create command pool!");
+
+    VkCommandBufferAllocateInfo alloc_info = {
+        .sType              = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+        .commandPool        = up->cmd_pools[i],
+        .level              = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+        .commandBufferCount = 1,
+    };
+    VK_CHECK(
+        vkAllocateCommandBuffers(_vk.device, &alloc_info, &up->cmd_buffs[i]),
+        "Failed to allocate command buffer!");
+    up->cmd_values[i] = 0;
   }
 
-  _vk.initialized = true;
+  up->staging        = {.size = STAGING_RING_SIZE};
+  up->staging.buffer = umbvk_staging_buffer_create(STAGING_RING_SIZE, &up->staging.mapped);
 
-  UMB_ASSERT(SDL_Vulkan_CreateSurface((SDL_Window*)window->raw_handle, _vk.instance, &_vk.surface));
+  up->open          = {.value = 1};
+  up->batch_depth   = 0;
+  up->visible_value = 0;
+  up->quit          = false;
+  up->thread        = std::thread(umbvk_upload_thread_main);
 
-  // Device
-  umbvk_set_physical_device();
-  umbvk_set_logical_device();
-  umbvk_set_allocator();
+  _vk.deletion_queue.push([=]() {
+    for (u32 i = 0; i < MAX_UPLOADS_IN_FLIGHT; ++i) {
+      vkDestroyCommandPool(_vk.device, _vk.uploader.cmd_pools[i], nullptr);
+    }
+    umbvk_staging_ring* ring = &_vk.uploader.staging;
+    umbvk_staging_buffer_destroy(&ring->buffer);
+    for (u32 i = 0; i < ring->n_dedicated; ++i) {
+      umbvk_staging_buffer_destroy(&ring->dedicated[i].buffer);
+    }
+    vkDestroySemaphore(_vk.device, _vk.uploader.timeline, nullptr);
+    free(_vk.uploader.open.ops);
+    free(_vk.uploader.acquires);
+  });
+}
 
-  // RenderPass and Swapchain
-  umbvk_swapchain_support_details swapchain_support =
-      umbvk_query_swapchain_support(_vk.surface, _vk.physical_device);
-  VkSurfaceFormatKHR surface_format = umbvk_choose_swap_surface_format(swapchain_support.formats);
-  VkPresentModeKHR   present_mode = umbvk_choose_swap_present_mode(swapchain_support.present_modes);
-  VkExtent2D         extent = umbvk_choose_swap_extent(_vk.window, swapchain_support.capabilities);
+// lets the upload thread drain its queue and exit, call before waiting for the device to idle
+void umbvk_uploader_stop() {
+  umbvk_uploader* up = &_vk.uploader;
+  {
+    std::lock_guard<std::mutex> lock(up->mutex);
+    up->quit = true;
+  }
+  up->cond.notify_all();
+  up->thread.join();
+}
 
-  // TODO(bryson): change API to just 'set_XXX'
-  _vk.depth_format           = VK_FORMAT_D32_SFLOAT;
-  _vk.compatible_render_pass = umbvk_create_render_pass(surface_format.format);
-  _vk.swapchain = umbvk_create_swapchain(swapchain_support, surface_format, present_mode, extent);
-  _vk.upload_context = umbvk_upload_context_create();
+// frames draw everything that finished uploading before the frame started and wait for it on the
+// GPU, the CPU never blocks on an upload here
+void umbvk_upload_poll() {
+  _vk.uploader.visible_value = umbvk_upload_completed_value();
+}
 
-  umbvk_set_descriptors();
+// acquires the images released by the transfer family that are now visible to this frame
+void umbvk_cmd_acquire_uploads(umbvk_cmd_buffer* cmd) {
+  umbvk_uploader*             up = &_vk.uploader;
+  std::lock_guard<std::mutex> lock(up->mutex);
+
+  u32 n_kept = 0;
+  for (u32 i = 0; i < up->n_acquires; ++i) {
+    umbvk_image_acquire acquire = up->acquires[i];
+    if (acquire.value > up->visible_value) {
+      up->acquires[n_kept++] = acquire;
+      continue;
+    }
 
-  // default material
-  umb_material* default_gfx_material = umb_arena_push(&_vk.arena, umb_material);
-  default_gfx_material->pipeline     = umbvk_default_graphics_pipeline_create();
-  umb_gfx_register_material("default", default_gfx_material);
+    // images that still need their mip chain stay transfer destinations until it is blitted
+    b32                  blit                  = acquire.blit_extent.width > 0;
+    VkImageMemoryBarrier image_barrier_acquire = {
+        .sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+        .srcAccessMask       = 0,
+        .dstAccessMask       = blit ? VK_ACCESS_TRANSFER_WRITE_BIT | VK_ACCESS_TRANSFER_READ_BIT
+                                    : VK_ACCESS_SHADER_READ_BIT,
+        .oldLayout           = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+        .newLayout           = blit ? VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL
+                                    : VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+        .srcQueueFamilyIndex = _vk.queue_families.transfer_queue_idx,
+        .dstQueueFamilyIndex = _vk.queue_families.graphics_and_compute_queue_idx,
+        .image               = acquire.image,
+        .subresourceRange    = acquire.range,
+    };
+    vkCmdPipelineBarrier(
+        cmd->cmd_buff,
+        VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+        blit ? VK_PIPELINE_STAGE_TRANSFER_BIT
+             : VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT |
+                   VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+        0,
+        0,
+        nullptr,
+        0,
+        nullptr,
+        1,
+        &image_barrier_acquire);
 
-  umbvk_create_frame_resources();
+    if (blit) {
+      umbvk_cmd_generate_mips(cmd->cmd_buff, acquire.image, acquire.blit_extent, acquire.range);
+    }
+  }
+  up->n_acquires = n_kept;
 }
 
-void umb_gfx_shutdown() {
-  if (_vk.initialized) {
-    vkDeviceWaitIdle(_vk.device);
+void umb_gfx_upload_batch_begin() {
+  _vk.uploader.batch_depth++;
+}
 
-    _vk.deletion_queue.flush();
+u64 umb_gfx_upload_batch_end() {
+  UMB_ASSERT(_vk.uploader.batch_depth > 0);
+  if (--_vk.uploader.batch_depth == 0) return umbvk_upload_submit_open();
+  return _vk.uploader.open.value;
+}
 
-    vmaDestroyAllocator(_vk.allocator);
+void umb_gfx_upload_wait(u64 value) {
+  if (value >= _vk.uploader.open.value) value = umbvk_upload_submit_open();
+  if (value > 0) umbvk_upload_wait_value(value);
+}
+
+void umbvk_create_frame_resources() {
+  VkSemaphoreCreateInfo semaphore_info = {
+      .sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+  };
+  VkFenceCreateInfo fence_info = {
+      .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
+      .flags = VK_FENCE_CREATE_SIGNALED_BIT,
+  };
+
+  for (i32 i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+    VK_CHECK(
+        vkCreateSemaphore(
+            _vk.device,
+            &semaphore_info,
+            nullptr,
+            &_vk.frames[i].image_available_semaphore),
+        "failed to create semaphore");
+    _vk.deletion_queue.push([=]() {
+      vkDestroySemaphore(_vk.device, _vk.frames[i].image_available_semaphore, nullptr);
+    });
+
+    VK_CHECK(
+        vkCreateSemaphore(
+            _vk.device,
+            &semaphore_info,
+            nullptr,
+            &_vk.frames[i].render_finished_semaphore),
+        "failed to create semaphore");
+    _vk.deletion_queue.push([=]() {
+      vkDestroySemaphore(_vk.device, _vk.frames[i].render_finished_semaphore, nullptr);
+    });
+
+    VK_CHECK(
+        vkCreateFence(_vk.device, &fence_info, nullptr, &_vk.frames[i].render_fence),
+        "failed to create fence");
+    _vk.deletion_queue.push(
+        [=]() { vkDestroyFence(_vk.device, _vk.frames[i].render_fence, nullptr); });
+
+    _vk.frames[i].cmd = umbvk_cmd_buffer_create(VK_COMMAND_BUFFER_LEVEL_PRIMARY);
+    for (u32 j = 0; j < MAX_RECORD_JOBS; ++j) {
+      _vk.frames[i].draw_cmds[j] = umbvk_cmd_buffer_create(VK_COMMAND_BUFFER_LEVEL_SECONDARY);
+    }
+    _vk.frames[i].instance_cmd = umbvk_cmd_buffer_create(VK_COMMAND_BUFFER_LEVEL_SECONDARY);
+  }
+}
+
+void umbvk_cmd_bind_gfx_descriptor_sets(
+    umbvk_cmd_buffer* cmd,
+    u32               set,
+    VkDescriptorSet*  descriptor) {
+  vkCmdBindDescriptorSets(
+      cmd->cmd_buff,
+      VK_PIPELINE_BIND_POINT_GRAPHICS,
+      cmd->active_gfx_pipeline->pipeline_layout,
+      set,
+      1,
+      descriptor,
+      0,
+      nullptr);
+}
+
+void umbvk_cmd_bind_cmp_descriptor_sets(
+    umbvk_cmd_buffer* cmd,
+    u32               set,
+    VkDescriptorSet*  descriptor,
+    u32               n_offsets,
+    u32*              uniform_offsets) {
+  vkCmdBindDescriptorSets(
+      cmd->cmd_buff,
+      VK_PIPELINE_BIND_POINT_COMPUTE,
+      cmd->active_cmp_pipeline->pipeline_layout,
+      set,
+      1,
+      descriptor,
+      n_offsets,
+      uniform_offsets);
+}
+
+void umbvk_cmd_bind_gfx_descriptor_sets_offset(
+    umbvk_cmd_buffer* cmd,
+    u32               set,
+    VkDescriptorSet*  descriptor,
+    u32               n_offsets,
+    u32*              uniform_offsets) {
+  vkCmdBindDescriptorSets(
+      cmd->cmd_buff,
+      VK_PIPELINE_BIND_POINT_GRAPHICS,
+      cmd->active_gfx_pipeline->pipeline_layout,
+      set,
+      1,
+      descriptor,
+      n_offsets,
+      uniform_offsets);
+}
+
+// diameter of the mesh bounds on screen, in pixels
+f32 umbvk_screen_size(
+    umb_mesh         mesh,
+    const glm::mat4& model,
+    const glm::mat4& view,
+    f32              proj_scale) {
+  f32 scale = glm::max(
+      glm::length(glm::vec3(model[0])),
+      glm::max(glm::length(glm::vec3(model[1])), glm::length(glm::vec3(model[2]))));
+
+  glm::vec4 center   = view * model * glm::vec4(glm::vec3(mesh->bounds), 1.0f);
+  f32       radius   = mesh->bounds.w * scale;
+  f32       distance = glm::max(glm::length(glm::vec3(center)) - radius, 0.1f);
+  return 2.0f * radius * proj_scale / distance;
+}
+
+// picks the coarsest LOD whose simplification error, projected to the screen, stays under the
+// configured pixel threshold
+u32 umbvk_select_mesh_lod(
+    umb_mesh         mesh,
+    const glm::mat4& model,
+    const glm::mat4& view,
+    f32              proj_scale) {
+  if (mesh->n_lods <= 1) return 0;
+
+  f32 scale = glm::max(
+      glm::length(glm::vec3(model[0])),
+      glm::max(glm::length(glm::vec3(model[1])), glm::length(glm::vec3(model[2]))));
+
+  glm::vec4 center   = view * model * glm::vec4(glm::vec3(mesh->bounds), 1.0f);
+  f32       distance = glm::length(glm::vec3(center)) - mesh->bounds.w * scale;
+  if (distance <= 0.1f) return 0;
+
+  for (u32 lod = mesh->n_lods - 1; lod > 0; --lod) {
+    f32 error_px = mesh->lods[lod].error * scale * proj_scale / distance;
+    if (error_px <= _vk.lod_error_threshold) return lod;
+  }
+  return 0;
+}
+
+// gribb-hartmann planes for a [0, 1] depth range, pointing inwards
+void umbvk_extract_frustum_planes(const glm::mat4& viewproj, glm::vec4 planes[6]) {
+  glm::mat4 m = glm::transpose(viewproj);
+  planes[0]   = m[3] + m[0];
+  planes[1]   = m[3] - m[0];
+  planes[2]   = m[3] + m[1];
+  planes[3]   = m[3] - m[1];
+  planes[4]   = m[2];
+  planes[5]   = m[3] - m[2];
+  for (u32 i = 0; i < 6; ++i) planes[i] /= glm::length(glm::vec3(planes[i]));
+}
+
+u64 umbvk_draw_sort_key(umbvk_draw_pass pass, const umbvk_draw* draw, f32 depth) {
+  depth = depth > 0.f ? depth : 0.f;
+  u32 depth_bits;
+  memcpy(&depth_bits, &depth, sizeof(depth_bits));
+
+  return ((u64)pass << DRAW_KEY_PASS_SHIFT) |
+         ((u64)_vk.material_pipeline_ids[draw->material->index] << DRAW_KEY_PIPELINE_SHIFT) |
+         ((u64)draw->material->index << DRAW_KEY_MATERIAL_SHIFT) |
+         ((u64)draw->mesh->geometry_slot << DRAW_KEY_MESH_SHIFT) |
+         ((u64)draw->lod << DRAW_KEY_LOD_SHIFT) |
+         ((u64)(depth_bits >> 2) << DRAW_KEY_DEPTH_SHIFT);
+}
+
+// orders the draw list by the draw keys, so recording changes state as rarely as possible
+// whatever order the objects were submitted in
+void umbvk_sort_draws() {
+  u32  n             = _vk.n_draws;
+  u64* keys          = _vk.draw_keys;
+  u32* order         = _vk.draw_order;
+  u64* scratch_keys  = _vk.draw_keys + _vk.render_object_capacity;
+  u32* scratch_order = _vk.draw_order + _vk.render_object_capacity;
+  umb_radix_sort_u64(keys, order, scratch_keys, scratch_order, n);
+
+  for (u32 i = 0; i < n; ++i) _vk.sorted_draws[i] = _vk.draws[order[i]];
+
+  umbvk_draw* draws = _vk.draws;
+  _vk.draws         = _vk.sorted_draws;
+  _vk.sorted_draws  = draws;
+}
+
+// the mesh's bounding sphere around the transformed center, scaled by the largest axis scale
+glm::vec4 umbvk_world_bounds(umb_mesh mesh, const glm::mat4& model) {
+  f32 scale = glm::max(
+      glm::length(glm::vec3(model[0])),
+      glm::max(glm::length(glm::vec3(model[1])), glm::length(glm::vec3(model[2]))));
+  glm::vec4 center = model * glm::vec4(glm::vec3(mesh->bounds), 1.0f);
+  return glm::vec4(glm::vec3(center), mesh->bounds.w * scale);
+}
+
+// sorts the static objects whose meshes are visible into the static draw list and computes their
+// world space bounds. objects still uploading are added by a later rebuild.
+void umbvk_statics_build() {
+  umbvk_statics* statics = &_vk.statics;
+
+  if (statics->mesh_version != _vk.instances.mesh_version ||
+      (statics->pending_value && statics->pending_value <= _vk.uploader.visible_value)) {
+    statics->version++;
+  }
+  if (statics->built_version == statics->version) return;
+
+  umb_scope_arena scope(&_vk.arena);
+  u32             n_objects = (u32)statics->objects.len;
+  u64*            keys      = umb_arena_push_array(&_vk.arena, u64, n_objects * 2);
+  u32*            order     = umb_arena_push_array(&_vk.arena, u32, n_objects * 2);
+  umbvk_draw*     draws     = umb_arena_push_array(&_vk.arena, umbvk_draw, n_objects);
+  u32*            objects   = umb_arena_push_array(&_vk.arena, u32, n_objects);
+
+  u32 n_draws            = 0;
+  statics->pending_value = 0;
+  for (u32 i = 0; i < n_objects; ++i) {
+    umb_render_object* o     = statics->objects.data[i];
+    statics->object_slots[i] = INVALID_STATIC_SLOT;
+    if (o->mesh->upload_value > _vk.uploader.visible_value) {
+      u64 value              = o->mesh->upload_value;
+      statics->pending_value = value > statics->pending_value ? value : statics->pending_value;
+      continue;
+    }
+
+    draws[n_draws] = {
+        .mesh         = o->mesh,
+        .material     = o->material,
+        .transform    = &o->transform,
+        .texture      = o->texture,
+        .cluster_draw = INVALID_CLUSTER_DRAW,
+    };
+    keys[n_draws]    = umbvk_draw_sort_key(UMBVK_DRAW_PASS_OPAQUE, &draws[n_draws], 0.f);
+    order[n_draws]   = n_draws;
+    objects[n_draws] = i;
+    n_draws++;
+  }
+  umb_radix_sort_u64(keys, order, keys + n_objects, order + n_objects, n_draws);
+
+  for (u32 i = 0; i < n_draws; ++i) {
+    umbvk_draw* draw = &statics->draws[i];
+    *draw            = draws[order[i]];
+    draw->object_idx = i;
+
+    statics->object_slots[objects[order[i]]] = i;
+
+    glm::vec4 sphere      = umbvk_world_bounds(draw->mesh, *draw->transform);
+    statics->spheres.x[i] = sphere.x;
+    statics->spheres.y[i] = sphere.y;
+    statics->spheres.z[i] = sphere.z;
+    statics->spheres.r[i] = sphere.w;
+  }
+
+  // every frame rewrites all of its object data after a rebuild
+  for (u32 i = 0; i < statics->n_dirty; ++i) statics->dirty_frames[statics->dirty_objects[i]] = 0;
+  statics->n_dirty = 0;
+
+  statics->n_draws       = n_draws;
+  statics->built_version = statics->version;
+  statics->mesh_version  = _vk.instances.mesh_version;
+}
+
+// records one indirect draw per static draw, reading the command slot of the same index. the
+// camera is pushed first into the transient buffer, so a frame's global offsets never change and
+// are safe to record.
+void umbvk_record_static_draws(umbvk_frame* frame) {
+  umbvk_statics*    statics = &_vk.statics;
+  umbvk_cmd_buffer* cmd     = &frame->static_cmd;
+  glm::mat4         model   = glm::translate(glm::mat4(1), glm::vec3(0, 5, 0));
+  u32               zero    = 0;
+
+  umbvk_cmd_begin_secondary(cmd, VK_NULL_HANDLE, 0);
+  umbvk_cmd_viewport(cmd, 0, 0, _vk.swapchain.extent.width, _vk.swapchain.extent.height);
+  umbvk_cmd_scissor(cmd, 0, 0, _vk.swapchain.extent.width, _vk.swapchain.extent.height);
+
+  VkDeviceSize offset = 0;
+  umbvk_cmd_bind_vertex_buffer(cmd, 0, 1, &_vk.geometry.vertex_buffer.buffer, &offset);
+  umbvk_cmd_bind_index_buffer(cmd, _vk.geometry.index_buffer.buffer, 0);
+
+  for (u32 i = 0; i < statics->n_draws;) {
+    umb_material* material = statics->draws[i].material;
+    umbvk_cmd_bind_graphics_pipeline(cmd, &material->pipeline);
+    if (i == 0) {
+      umbvk_cmd_bind_gfx_descriptor_sets_offset(
+          cmd,
+          0,
+          &frame->global_descriptor,
+          2,
+          frame->global_offsets);
+      umbvk_cmd_bind_gfx_descriptor_sets_offset(cmd, 1, &frame->static_object_descriptor, 1, &zero);
+      umbvk_cmd_bind_gfx_descriptor_sets(cmd, 2, &frame->bindless_descriptor);
+
+      umb_push_constants constants {.render_matrix = model};
+      umbvk_cmd_push_constants(cmd, &constants, VK_SHADER_STAGE_VERTEX_BIT);
+    }
+
+    // draws are sorted by pipeline first, each run of one is a single multi-draw
+    u32 n_run = 1;
+    while (i + n_run < statics->n_draws &&
+           statics->draws[i + n_run].material->pipeline.pipeline ==
+               material->pipeline.pipeline) {
+      n_run++;
+    }
+    if (_vk.device_features.multiDrawIndirect) {
+      umbvk_cmd_draw_indexed_indirect(
+          cmd,
+          frame->static_draw_buffer.buffer.buffer,
+          i * sizeof(VkDrawIndexedIndirectCommand),
+          n_run);
+    } else {
+      for (u32 d = i; d < i + n_run; ++d) {
+        umbvk_cmd_draw_indexed_indirect(
+            cmd,
+            frame->static_draw_buffer.buffer.buffer,
+            d * sizeof(VkDrawIndexedIndirectCommand),
+            1);
+      }
+    }
+    i += n_run;
+  }
+  umbvk_cmd_end(cmd);
+}
+
+// re-records the frame's static draws if they are stale, then culls them and selects their LODs
+// into this frame's indirect commands. culled draws keep their slot with no instances.
+void umbvk_update_static_draws(umbvk_frame* frame, const glm::mat4& view, f32 proj_scale) {
+  umbvk_statics* statics = &_vk.statics;
+  if (!statics->supported) return;
+
+  umbvk_statics_build();
+
+  // the recording refers to the buffers, replacing one makes it stale
+  u64 n_draws = statics->n_draws;
+  if (umbvk_growable_buffer_reserve(
+          &frame->static_draw_buffer,
+          sizeof(VkDrawIndexedIndirectCommand) * n_draws)) {
+    frame->static_version = 0;
+  }
+  if (umbvk_growable_buffer_reserve(
+          &frame->static_object_buffer,
+          sizeof(umb_gpu_object_data) * n_draws)) {
+    umbvk_object_descriptor_write(frame->static_object_descriptor, &frame->static_object_buffer);
+    frame->static_version = 0;
+  }
+
+  umb_gpu_object_data* objects = (umb_gpu_object_data*)frame->static_object_buffer.buffer.mapped;
+  if (frame->static_version != statics->built_version) {
+    for (u32 i = 0; i < statics->n_draws; ++i) {
+      umbvk_draw* draw          = &statics->draws[i];
+      objects[i].model_matrix   = *draw->transform;
+      objects[i].material_index = draw->material->index;
+    }
+    umbvk_record_static_draws(frame);
+    frame->static_version = statics->built_version;
+  }
+
+  // each frame copies a moved object's transform into its own buffer once, the object leaves the
+  // list when all of them have
+  u8  frame_bit = (u8)(1 << _vk.frame_id);
+  u32 n_left    = 0;
+  for (u32 i = 0; i < statics->n_dirty; ++i) {
+    u32 object = statics->dirty_objects[i];
+    u32 slot   = statics->object_slots[object];
+    if (slot == INVALID_STATIC_SLOT) {
+      statics->dirty_frames[object] = 0;
+    } else if (statics->dirty_frames[object] & frame_bit) {
+      objects[slot].model_matrix = statics->objects.data[object]->transform;
+      statics->dirty_frames[object] &= ~frame_bit;
+    }
+    if (statics->dirty_frames[object]) statics->dirty_objects[n_left++] = object;
+  }
+  statics->n_dirty = n_left;
+  if (statics->n_draws == 0) return;
+
+  f32 planes[UMB_CULL_PLANES][4];
+  for (u32 p = 0; p < UMB_CULL_PLANES; ++p) {
+    memcpy(planes[p], &_vk.camera.frustum[p], sizeof(planes[p]));
+  }
+  umb_cull_frustum frustum   = umb_cull_frustum_create(planes);
+  u32              n_visible = umb_cull_spheres_frustum(
+      &frustum,
+      &statics->spheres,
+      0,
+      statics->n_draws,
+      statics->visible);
+
+  VkDrawIndexedIndirectCommand* commands =
+      (VkDrawIndexedIndirectCommand*)frame->static_draw_buffer.buffer.mapped;
+  u32 v = 0;
+  for (u32 i = 0; i < statics->n_draws; ++i) {
+    if (v == n_visible || statics->visible[v] != i) {
+      commands[i] = {};
+      continue;
+    }
+    v++;
+
+    umbvk_draw*         draw = &statics->draws[i];
+    umb_mesh            mesh = draw->mesh;
+    u32                 lod  = umbvk_select_mesh_lod(mesh, *draw->transform, view, proj_scale);
+    const umb_mesh_lod* l    = &mesh->lods[lod];
+    commands[i]              = {
+        .indexCount    = l->index_count,
+        .instanceCount = 1,
+        .firstIndex    = mesh->index_alloc.offset + l->first_index,
+        .vertexOffset  = (i32)mesh->vertex_alloc.offset,
+        .firstInstance = i,
+    };
+
+    if (draw->texture) {
+      f32 screen_size = umbvk_screen_size(mesh, *draw->transform, view, proj_scale);
+      umb_gfx_report_texture_usage(draw->texture, screen_size);
+    }
+  }
+}
+
+template<typename T> T* umbvk_array_grow(T* data, u64 capacity) {
+  T* grown = (T*)realloc(data, sizeof(T) * capacity);
+  UMB_ASSERT(grown);
+  return grown;
+}
+
+// only the nodes the update recomputed are copied, renderables that did not move are not touched
+void umbvk_update_transforms() {
+  umb_transform_hierarchy* transforms = &_vk.transforms;
+  umb_transform_hierarchy_update(transforms);
+
+  for (u32 i = 0; i < transforms->n_changed; ++i) {
+    umb_transform node = transforms->changed[i];
+    if (node >= _vk.node_entities_cap || _vk.node_entities[node] == UMB_ENTITY_NONE) continue;
+    umb_ecs_set(
+        &_vk.scene,
+        _vk.node_entities[node],
+        _vk.components.transform,
+        umb_transform_world(transforms, node));
+  }
+}
+
+// every per-object array of the frame's draw list grows together. the sort arrays hold a scratch
+// half after the first `capacity` entries.
+void umbvk_render_objects_grow(u32 capacity) {
+  _vk.render_object_capacity = capacity;
+  _vk.draws                  = umbvk_array_grow(_vk.draws, capacity);
+  _vk.sorted_draws           = umbvk_array_grow(_vk.sorted_draws, capacity);
+  _vk.draw_keys              = umbvk_array_grow(_vk.draw_keys, capacity * 2);
+  _vk.draw_order             = umbvk_array_grow(_vk.draw_order, capacity * 2);
+  _vk.cull_spheres.x         = umbvk_array_grow(_vk.cull_spheres.x, capacity);
+  _vk.cull_spheres.y         = umbvk_array_grow(_vk.cull_spheres.y, capacity);
+  _vk.cull_spheres.z         = umbvk_array_grow(_vk.cull_spheres.z, capacity);
+  _vk.cull_spheres.r         = umbvk_array_grow(_vk.cull_spheres.r, capacity);
+  _vk.visible_objects        = umbvk_array_grow(_vk.visible_objects, capacity);
+}
+
+// moves a chunk's mesh bounds to world space and culls them into the chunk's range of the visible
+// list. renderables whose mesh is not uploaded yet get a radius no plane can keep.
+void umbvk_cull_chunk(const umb_ecs_chunk* chunk, void* data) {
+  const umb_cull_frustum*   frustum    = (const umb_cull_frustum*)data;
+  const umb_gfx_components* c          = &_vk.components;
+  umb_cull_spheres*         spheres    = &_vk.cull_spheres;
+  u32                       first      = chunk->first;
+  u32                       n          = chunk->n;
+  const umb_mesh*           meshes     = umb_ecs_column<umb_mesh>(chunk, c->mesh);
+  const glm::mat4*          transforms = umb_ecs_column<glm::mat4>(chunk, c->transform);
+  const glm::vec4*          bounds     = umb_ecs_column<glm::vec4>(chunk, c->bounds);
+
+  for (u32 i = 0; i < n; ++i) {
+    spheres->x[first + i] = bounds[i].x;
+    spheres->y[first + i] = bounds[i].y;
+    spheres->z[first + i] = bounds[i].z;
+    spheres->r[first + i] = bounds[i].w;
+  }
+
+  umb_sphere_soa world = {
+      .x = spheres->x + first,
+      .y = spheres->y + first,
+      .z = spheres->z + first,
+      .r = spheres->r + first,
+  };
+  umb_mat4_transform_spheres((const f32*)transforms, 16, &world, &world, n);
+
+  for (u32 i = 0; i < n; ++i) {
+    if (meshes[i]->upload_value > _vk.uploader.visible_value) spheres->r[first + i] = -FLT_MAX;
+  }
+  _vk.chunk_visible[chunk->index] =
+      umb_cull_spheres_frustum(frustum, spheres, first, n, _vk.visible_objects + first);
+}
+
+// fills _vk.visible_objects with the query positions of the renderables inside the camera
+// frustum, in query order. chunks are culled in jobs of at least CULL_JOB_SIZE renderables, each
+// into its own range of the list, and the ranges are compacted afterwards.
+u32 umbvk_cull_objects() {
+  u32 n_objects = umb_ecs_query_count(&_vk.scene, &_vk.renderables);
+  if (n_objects == 0) return 0;
+
+  if (n_objects > _vk.render_object_capacity) {
+    u32 capacity = _vk.render_object_capacity;
+    while (capacity < n_objects) capacity *= 2;
+    umbvk_render_objects_grow(capacity);
+  }
+  u32 n_chunks = umb_ecs_query_chunk_count(&_vk.scene, &_vk.renderables);
+  if (n_chunks > _vk.chunk_visible_cap) {
+    _vk.chunk_visible_cap = n_chunks * 2;
+    _vk.chunk_visible     = umbvk_array_grow(_vk.chunk_visible, _vk.chunk_visible_cap);
+  }
+
+  f32 planes[UMB_CULL_PLANES][4];
+  for (u32 p = 0; p < UMB_CULL_PLANES; ++p) {
+    memcpy(planes[p], &_vk.camera.frustum[p], sizeof(planes[p]));
+  }
+  umb_cull_frustum frustum = umb_cull_frustum_create(planes);
+  umb_ecs_query_run_parallel(
+      &_vk.scene,
+      &_vk.renderables,
+      umbvk_cull_chunk,
+      &frustum,
+      CULL_JOB_SIZE);
+
+  u32           n_visible = 0;
+  umb_ecs_iter  it        = umb_ecs_query_iter(&_vk.scene, &_vk.renderables);
+  umb_ecs_chunk chunk;
+  while (umb_ecs_iter_next(&it, &chunk)) {
+    u32 n = _vk.chunk_visible[chunk.index];
+    if (n_visible != chunk.first) {
+      memmove(
+          _vk.visible_objects + n_visible,
+          _vk.visible_objects + chunk.first,
+          n * sizeof(u32));
+    }
+    n_visible += n;
+  }
+  return n_visible;
+}
+
+// writes this frame's camera, scene and object data and builds the draw list from the objects
+// that survive frustum culling. LOD 0 draws of clustered meshes are routed through the meshlet
+// cull pass.
+void umbvk_update_frame_data() {
+  umbvk_frame* frame = &_vk.frames[_vk.frame_id];
+
+  glm::vec3 camPos     = {0.f, -6.f, -10.f};
+  glm::mat4 view       = glm::translate(glm::mat4(1.f), camPos);
+  glm::mat4 projection = glm::perspective(glm::radians(70.f), 1700.f / 900.f, 0.1f, 200.0f);
+  projection[1][1] *= -1;
+
+  _vk.camera = {
+      .view     = view,
+      .proj     = projection,
+      .viewproj = projection * view,
+      .position = glm::inverse(view)[3],
+  };
+  umbvk_extract_frustum_planes(_vk.camera.viewproj, _vk.camera.frustum);
+
+  // the fixed per-frame data is pushed first, so it always fits
+  byte* camera_data =
+      umbvk_frame_push(frame, sizeof(umb_gpu_camera_data), &frame->global_offsets[0]);
+  memcpy(camera_data, &_vk.camera, sizeof(umb_gpu_camera_data));
+
+  u64 scene_offset = umbvk_pad_uniform_buffer_size(sizeof(umb_gpu_scene_data)) * _vk.frame_id;
+  frame->global_offsets[1] = (u32)scene_offset;
+  if (frame->scene_version != _vk.scene_version) {
+    memcpy(
+        _vk.scene_parameters_buffer.mapped + scene_offset,
+        &_vk.scene_parameters,
+        sizeof(umb_gpu_scene_data));
+    frame->scene_version = _vk.scene_version;
+  }
+
+  // pixels covered by one world unit at distance 1
+  f32 proj_scale = glm::abs(projection[1][1]) * 0.5f * (f32)_vk.swapchain.extent.height;
+
+  VkDrawIndexedIndirectCommand* cluster_draws =
+      (VkDrawIndexedIndirectCommand*)frame->cluster_draw_buffer.mapped;
+
+  umbvk_update_static_draws(frame, view, proj_scale);
+
+  umbvk_update_transforms();
+  u32 n_visible = umbvk_cull_objects();
+
+  _vk.n_draws           = 0;
+  _vk.n_cluster_draws   = 0;
+  u32 n_cluster_indices = 0;
+  // the visible list is in query order, so the chunks are walked alongside it
+  const umb_gfx_components* c  = &_vk.components;
+  umb_ecs_iter              it = umb_ecs_query_iter(&_vk.scene, &_vk.renderables);
+  umb_ecs_chunk             chunk {};
+  for (u32 i = 0; i < n_visible; ++i) {
+    while (_vk.visible_objects[i] >= chunk.first + chunk.n) umb_ecs_iter_next(&it, &chunk);
+    u32 row = _vk.visible_objects[i] - chunk.first;
+
+    umb_texture* textures = umb_ecs_column<umb_texture>(&chunk, c->texture);
+    u32          draw_idx = _vk.n_draws++;
+    umbvk_draw*  draw     = &_vk.draws[draw_idx];
+    *draw                 = {
+        .mesh         = umb_ecs_column<umb_mesh>(&chunk, c->mesh)[row],
+        .material     = umb_ecs_column<umb_material*>(&chunk, c->material)[row],
+        .transform    = &umb_ecs_column<glm::mat4>(&chunk, c->transform)[row],
+        .texture      = textures ? textures[row] : NULL,
+        .cluster_draw = INVALID_CLUSTER_DRAW,
+    };
+    umb_mesh mesh = draw->mesh;
+    draw->lod     = umbvk_select_mesh_lod(mesh, *draw->transform, view, proj_scale);
+
+    f32 depth                = -(view * (*draw->transform)[3]).z;
+    _vk.draw_keys[draw_idx]  = umbvk_draw_sort_key(UMBVK_DRAW_PASS_OPAQUE, draw, depth);
+    _vk.draw_order[draw_idx] = draw_idx;
+
+    // the texture is assumed to span the object once
+    if (draw->texture) {
+      f32 screen_size = umbvk_screen_size(mesh, *draw->transform, view, proj_scale);
+      umb_gfx_report_texture_usage(draw->texture, screen_size);
+    }
+
+    // worst case every cluster survives, so reserve the full LOD 0 index count
+    u32 n_indices = mesh->lods[0].index_count;
+    b32 clustered = draw->lod == 0 && mesh->meshlet_count > 0 &&
+                    _vk.device_features.drawIndirectFirstInstance &&
+                    _vk.n_cluster_draws < MAX_CLUSTER_DRAWS &&
+                    n_cluster_indices + n_indices <= MAX_CLUSTER_INDICES;
+    if (clustered) {
+      draw->cluster_draw         = _vk.n_cluster_draws++;
+      draw->cluster_index_offset = n_cluster_indices;
+      n_cluster_indices += n_indices;
+    }
+  }
+
+  umbvk_sort_draws();
+
+  // object data is written in draw order, so runs of instanced draws read consecutive slots.
+  // culled objects have no draw and are not written.
+  if (umbvk_growable_buffer_reserve(
+          &frame->object_buffer,
+          sizeof(umb_gpu_object_data) * _vk.n_draws)) {
+    umbvk_object_descriptor_write(frame->object_descriptor, &frame->object_buffer);
+  }
+  umb_gpu_object_data* obj_ssbo = (umb_gpu_object_data*)frame->object_buffer.buffer.mapped;
+  for (u32 i = 0; i < _vk.n_draws; ++i) {
+    umbvk_draw* draw           = &_vk.draws[i];
+    draw->object_idx           = i;
+    obj_ssbo[i].model_matrix   = *draw->transform;
+    obj_ssbo[i].material_index = draw->material->index;
+
+    if (draw->cluster_draw != INVALID_CLUSTER_DRAW) {
+      cluster_draws[draw->cluster_draw] = {
+          .indexCount    = 0,
+          .instanceCount = 1,
+          .firstIndex    = frame->cluster_index_alloc.offset + draw->cluster_index_offset,
+          .vertexOffset  = (i32)draw->mesh->vertex_alloc.offset,
+          .firstInstance = i,
+      };
+    }
+  }
+}
+
+// compacts the indices of visible clusters into the frame's cluster range of the index buffer and
+// bumps the matching indirect index counts. recorded outside the render pass.
+void umbvk_cmd_cull_clusters(umbvk_cmd_buffer* cmd) {
+  if (_vk.n_cluster_draws == 0) return;
+
+  umbvk_frame* frame = &_vk.frames[_vk.frame_id];
+  umbvk_cmd_bind_compute_pipeline(cmd, &_vk.meshlet_cull_pipeline);
+
+  umbvk_cmd_bind_cmp_descriptor_sets(cmd, 0, &frame->global_descriptor, 2, frame->global_offsets);
+  u32 object_offset = 0;
+  umbvk_cmd_bind_cmp_descriptor_sets(cmd, 1, &frame->object_descriptor, 1, &object_offset);
+  umbvk_cmd_bind_cmp_descriptor_sets(cmd, 2, &frame->cluster_descriptor, 0, nullptr);
+
+  for (u32 i = 0; i < _vk.n_draws; ++i) {
+    umbvk_draw* draw = &_vk.draws[i];
+    if (draw->cluster_draw == INVALID_CLUSTER_DRAW) continue;
+
+    umb_mesh                     mesh      = draw->mesh;
+    umbvk_meshlet_cull_constants constants = {
+        .meshlet_offset = mesh->meshlet_alloc.offset,
+        .meshlet_count  = mesh->meshlet_count,
+        .index_offset   = mesh->index_alloc.offset,
+        .out_offset     = frame->cluster_index_alloc.offset + draw->cluster_index_offset,
+        .draw_index     = draw->cluster_draw,
+        .object_index   = draw->object_idx,
+    };
+    vkCmdPushConstants(
+        cmd->cmd_buff,
+        _vk.meshlet_cull_pipeline.pipeline_layout,
+        VK_SHADER_STAGE_COMPUTE_BIT,
+        0,
+        sizeof(umbvk_meshlet_cull_constants),
+        &constants);
+    umbvk_cmd_dispatch(cmd, (constants.meshlet_count + 63) / 64, 1, 1);
+  }
+
+  VkMemoryBarrier barrier = {
+      .sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+      .srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT,
+      .dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_INDEX_READ_BIT,
+  };
+  vkCmdPipelineBarrier(
+      cmd->cmd_buff,
+      VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+      VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+      0,
+      1,
+      &barrier,
+      0,
+      nullptr,
+      0,
+      nullptr);
+}
+
+// records draws [first, end) of the sorted draw list, binding all state it needs itself
+void umbvk_cmd_draw_objects(umbvk_cmd_buffer* cmd, u32 first, u32 end) {
+  umbvk_frame* frame         = &_vk.frames[_vk.frame_id];
+  glm::mat4    model         = glm::translate(glm::mat4(1), glm::vec3(0, 5, 0));
+  u32          object_offset = 0;
+
+  VkDeviceSize offset = 0;
+  umbvk_cmd_bind_vertex_buffer(cmd, 0, 1, &_vk.geometry.vertex_buffer.buffer, &offset);
+  umbvk_cmd_bind_index_buffer(cmd, _vk.geometry.index_buffer.buffer, 0);
+
+  // materials differ only in the data their draws index, so only pipeline changes break batches.
+  // the draws are sorted by pipeline first, each one is bound once.
+  VkPipeline last_pipeline = VK_NULL_HANDLE;
+  for (u32 i = first; i < end;) {
+    umbvk_draw* draw = &_vk.draws[i];
+
+    if (draw->material->pipeline.pipeline != last_pipeline) {
+      umbvk_cmd_bind_graphics_pipeline(cmd, &draw->material->pipeline);
+
+      if (last_pipeline == VK_NULL_HANDLE) {
+        umbvk_cmd_bind_gfx_descriptor_sets_offset(
+            cmd,
+            0,
+            &frame->global_descriptor,
+            2,
+            frame->global_offsets);
+        umbvk_cmd_bind_gfx_descriptor_sets_offset(
+            cmd,
+            1,
+            &frame->object_descriptor,
+            1,
+            &object_offset);
+        umbvk_cmd_bind_gfx_descriptor_sets(cmd, 2, &frame->bindless_descriptor);
+
+        umb_push_constants constants {.render_matrix = model};
+        umbvk_cmd_push_constants(cmd, &constants, VK_SHADER_STAGE_VERTEX_BIT);
+      }
+      last_pipeline = draw->material->pipeline.pipeline;
+    }
+
+    if (draw->cluster_draw != INVALID_CLUSTER_DRAW) {
+      umbvk_cmd_draw_indexed_indirect(
+          cmd,
+          frame->cluster_draw_buffer.buffer,
+          draw->cluster_draw * sizeof(VkDrawIndexedIndirectCommand),
+          1);
+      i++;
+      continue;
+    }
+
+    // the following draws of the same mesh LOD and material become instances of this one, their
+    // object data sits in the slots right after it
+    u32 n_instances = 1;
+    while (i + n_instances < end) {
+      umbvk_draw* next = &_vk.draws[i + n_instances];
+      if (next->cluster_draw != INVALID_CLUSTER_DRAW || next->mesh != draw->mesh ||
+          next->material != draw->material || next->lod != draw->lod) {
+        break;
+      }
+      n_instances++;
+    }
+
+    const umb_mesh_lod* lod = &draw->mesh->lods[draw->lod];
+    umbvk_cmd_draw(
+        cmd,
+        true,
+        lod->index_count,
+        n_instances,
+        draw->mesh->index_alloc.offset + lod->first_index,
+        (i32)draw->mesh->vertex_alloc.offset,
+        draw->object_idx);
+    i += n_instances;
+  }
+}
+
+void umbvk_set_allocator() {
+  // without the extension VMA estimates the budgets from the heap sizes and its own allocations
+  VmaAllocatorCreateFlags flags = 0;
+  if (_vk.memory_budget_supported) flags |= VMA_ALLOCATOR_CREATE_EXT_MEMORY_BUDGET_BIT;
+
+  VmaAllocatorCreateInfo allocator_info = {
+      .flags            = flags,
+      .physicalDevice   = _vk.physical_device,
+      .device           = _vk.device,
+      .instance         = _vk.instance,
+      .vulkanApiVersion = VK_API_VERSION_1_2,
+  };
+
+  vmaCreateAllocator(&allocator_info, &_vk.allocator);
+}
+
+void umbvk_instance_mark_dirty(u32 slot, b32 reassigned) {
+  umbvk_instances* inst = &_vk.instances;
+  inst->reassigned[slot] |= reassigned;
+  if (inst->dirty[slot]) return;
+  inst->dirty[slot]                  = true;
+  inst->dirty_slots[inst->n_dirty++] = slot;
+}
+
+void umbvk_instances_create() {
+  umbvk_instances* inst = &_vk.instances;
+
+  inst->buffer = umbvk_buffer_create_transfer(
+      sizeof(umb_gpu_instance_data) * MAX_INSTANCES,
+      VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
+  inst->data         = umb_arena_push_array(&_vk.arena, umb_gpu_instance_data, MAX_INSTANCES);
+  inst->meshes       = umb_arena_push_array(&_vk.arena, umb_mesh, MAX_INSTANCES);
+  inst->handle_slots = umb_arena_push_array(&_vk.arena, u32, MAX_INSTANCES);
+  inst->slot_handles = umb_arena_push_array(&_vk.arena, u32, MAX_INSTANCES);
+  inst->free_handles = umb_arena_push_array(&_vk.arena, u32, MAX_INSTANCES);
+  inst->dirty_slots  = umb_arena_push_array(&_vk.arena, u32, MAX_INSTANCES);
+  inst->dirty        = umb_arena_push_array(&_vk.arena, b32, MAX_INSTANCES);
+  inst->reassigned   = umb_arena_push_array(&_vk.arena, b32, MAX_INSTANCES);
+  inst->mesh_version = 1;
+
+  // instances, mesh table (read), draw commands, draw counts, object data (written)
+  VkDescriptorSetLayoutBinding binds[5];
+  for (u32 i = 0; i < 5; ++i) {
+    binds[i] = umbvk_descriptor_set_layout_binding_create(
+        VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+        VK_SHADER_STAGE_COMPUTE_BIT,
+        i);
+  }
+  VkDescriptorSetLayoutCreateInfo set_info = {
+      .sType        = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+      .bindingCount = UMB_ARRAY_COUNT(binds, VkDescriptorSetLayoutBinding),
+      .pBindings    = binds,
+  };
+  vkCreateDescriptorSetLayout(_vk.device, &set_info, nullptr, &inst->set_layout);
+  _vk.deletion_queue.push([=]() {
+    vkDestroyDescriptorSetLayout(_vk.device, inst->set_layout, nullptr);
+  });
+
+  for (u32 i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i) {
+    umbvk_frame* frame       = &_vk.frames[i];
+    frame->mesh_table_buffer = umbvk_buffer_create_gpu_upload(
+        sizeof(umb_gpu_mesh_data) * MAX_MESHES,
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
+    frame->instance_draw_buffer = umbvk_buffer_create_transfer(
+        sizeof(VkDrawIndexedIndirectCommand) * MAX_INSTANCES,
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT);
+    frame->instance_count_buffer = umbvk_buffer_create_transfer(
+        sizeof(u32) * MAX_INSTANCE_PIPELINES,
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT);
+    frame->instance_object_buffer = umbvk_buffer_create_transfer(
+        sizeof(umb_gpu_object_data) * MAX_INSTANCES,
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
+
+    VkDescriptorSetAllocateInfo alloc_info = {
+        .sType              = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+        .descriptorPool     = _vk.descriptor_pool,
+        .descriptorSetCount = 1,
+        .pSetLayouts        = &inst->set_layout,
+    };
+    vkAllocateDescriptorSets(_vk.device, &alloc_info, &frame->instance_descriptor);
+
+    // instance draws read their object data through the regular object set layout
+    VkDescriptorSetAllocateInfo obj_alloc_info = {
+        .sType              = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+        .descriptorPool     = _vk.descriptor_pool,
+        .descriptorSetCount = 1,
+        .pSetLayouts        = &_vk.object_set_layout,
+    };
+    vkAllocateDescriptorSets(_vk.device, &obj_alloc_info, &frame->instance_object_descriptor);
+
+    VkDescriptorBufferInfo binfos[] = {
+        {.buffer = inst->buffer.buffer, .range = VK_WHOLE_SIZE},
+        {.buffer = frame->mesh_table_buffer.buffer, .range = VK_WHOLE_SIZE},
+        {.buffer = frame->instance_draw_buffer.buffer, .range = VK_WHOLE_SIZE},
+        {.buffer = frame->instance_count_buffer.buffer, .range = VK_WHOLE_SIZE},
+        {.buffer = frame->instance_object_buffer.buffer, .range = VK_WHOLE_SIZE},
+    };
+    VkWriteDescriptorSet writes[UMB_ARRAY_COUNT(binfos, VkDescriptorBufferInfo) + 1];
+    for (u32 b = 0; b < UMB_ARRAY_COUNT(binfos, VkDescriptorBufferInfo); ++b) {
+      writes[b] = umbvk_descriptor_buffer_write(
+          VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+          frame->instance_descriptor,
+          &binfos[b],
+          b);
+    }
+
+    VkDescriptorBufferInfo obj_binfo = {
+        .buffer = frame->instance_object_buffer.buffer,
+        .range  = sizeof(umb_gpu_object_data) * MAX_INSTANCES,
+    };
+    writes[UMB_ARRAY_COUNT(binfos, VkDescriptorBufferInfo)] = umbvk_descriptor_buffer_write(
+        VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC,
+        frame->instance_object_descriptor,
+        &obj_binfo,
+        0);
+    vkUpdateDescriptorSets(
+        _vk.device,
+        UMB_ARRAY_COUNT(writes, VkWriteDescriptorSet),
+        writes,
+        0,
+        nullptr);
+  }
+}
+
+void umbvk_statics_grow(u32 capacity) {
+  umbvk_statics* statics = &_vk.statics;
+  statics->objects.data  = umbvk_array_grow(statics->objects.data, capacity);
+  statics->objects.cap   = capacity;
+  statics->draws         = umbvk_array_grow(statics->draws, capacity);
+  statics->visible       = umbvk_array_grow(statics->visible, capacity);
+  statics->object_slots  = umbvk_array_grow(statics->object_slots, capacity);
+  statics->dirty_objects = umbvk_array_grow(statics->dirty_objects, capacity);
+  statics->dirty_frames  = umbvk_array_grow(statics->dirty_frames, capacity);
+  statics->spheres.x     = umbvk_array_grow(statics->spheres.x, capacity);
+  statics->spheres.y     = umbvk_array_grow(statics->spheres.y, capacity);
+  statics->spheres.z     = umbvk_array_grow(statics->spheres.z, capacity);
+  statics->spheres.r     = umbvk_array_grow(statics->spheres.r, capacity);
+}
+
+void umbvk_render_objects_free() {
+  free(_vk.draws);
+  free(_vk.sorted_draws);
+  free(_vk.draw_keys);
+  free(_vk.draw_order);
+  free(_vk.cull_spheres.x);
+  free(_vk.cull_spheres.y);
+  free(_vk.cull_spheres.z);
+  free(_vk.cull_spheres.r);
+  free(_vk.visible_objects);
+  free(_vk.chunk_visible);
+
+  umbvk_statics* statics = &_vk.statics;
+  free(statics->objects.data);
+  free(statics->draws);
+  free(statics->visible);
+  free(statics->object_slots);
+  free(statics->dirty_objects);
+  free(statics->dirty_frames);
+  free(statics->spheres.x);
+  free(statics->spheres.y);
+  free(statics->spheres.z);
+  free(statics->spheres.r);
+}
+
+void umbvk_statics_create() {
+  umbvk_statics* statics = &_vk.statics;
+
+  statics->supported = _vk.device_features.drawIndirectFirstInstance;
+  if (!statics->supported) return;
+
+  umbvk_statics_grow(INITIAL_RENDER_OBJECTS);
+  statics->version = 1;
+
+  for (u32 i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i) {
+    umbvk_frame* frame = &_vk.frames[i];
+    frame->static_cmd  = umbvk_cmd_buffer_create(VK_COMMAND_BUFFER_LEVEL_SECONDARY);
+    umbvk_growable_buffer_create(
+        &frame->static_draw_buffer,
+        sizeof(VkDrawIndexedIndirectCommand) * INITIAL_RENDER_OBJECTS,
+        VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT);
+    umbvk_growable_buffer_create(
+        &frame->static_object_buffer,
+        sizeof(umb_gpu_object_data) * INITIAL_RENDER_OBJECTS,
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
+
+    VkDescriptorSetAllocateInfo alloc_info = {
+        .sType              = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+        .descriptorPool     = _vk.descriptor_pool,
+        .descriptorSetCount = 1,
+        .pSetLayouts        = &_vk.object_set_layout,
+    };
+    vkAllocateDescriptorSets(_vk.device, &alloc_info, &frame->static_object_descriptor);
+    umbvk_object_descriptor_write(frame->static_object_descriptor, &frame->static_object_buffer);
+  }
+}
+
+VkImageView umbvk_image_view_create(const umb_image_t* image) {
+  VkImageViewCreateInfo image_info {
+      .sType    = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+      .image    = image->image,
+      .viewType = VK_IMAGE_VIEW_TYPE_2D,
+      .format   = image->format,
+      .components =
+          {
+              .r = VK_COMPONENT_SWIZZLE_IDENTITY,
+              .g = VK_COMPONENT_SWIZZLE_IDENTITY,
+              .b = VK_COMPONENT_SWIZZLE_IDENTITY,
+              .a = VK_COMPONENT_SWIZZLE_IDENTITY,
+          },
+      .subresourceRange =
+          {
+              .aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT,
+              .baseMipLevel   = 0,
+              .levelCount     = image->n_mips,
+              .baseArrayLayer = 0,
+              .layerCount     = 1,
+          },
+  };
+
+  VkImageView image_view;
+  vkCreateImageView(_vk.device, &image_info, nullptr, &image_view);
+  return image_view;
+}
+
+void umbvk_bindless_add_texture(umb_texture texture) {
+  UMB_ASSERT(_vk.bindless.n_textures < _vk.bindless.capacity);
+  texture->index                        = _vk.bindless.n_textures++;
+  _vk.bindless.textures[texture->index] = texture;
+}
+
+// points the frame's texture slots at their current views. textures whose upload the frame
+// cannot see yet, and streamed ones between swaps, read the default texture.
+void umbvk_bindless_update(umbvk_frame* frame) {
+  VkDescriptorImageInfo image_infos[MAX_DESCRIPTOR_WRITES];
+  VkWriteDescriptorSet  writes[MAX_DESCRIPTOR_WRITES];
+  u32                   n_writes = 0;
+
+  for (u32 i = 0; i < _vk.bindless.n_textures; ++i) {
+    umb_texture texture = _vk.bindless.textures[i];
+    VkImageView view    = texture->image->upload_value <= _vk.uploader.visible_value
+                              ? texture->image_view
+                              : _vk.bindless.default_texture.image_view;
+    if (frame->bindless_views[i] == view) continue;
+    frame->bindless_views[i] = view;
+    // the set is bound by the recorded static draws, updating it invalidates the recording
+    frame->static_version = 0;
+
+    image_infos[n_writes] = {
+        .imageView   = view,
+        .imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+    };
+    writes[n_writes] = {
+        .sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+        .dstSet          = frame->bindless_descriptor,
+        .dstBinding      = 2,
+        .dstArrayElement = i,
+        .descriptorCount = 1,
+        .descriptorType  = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,
+        .pImageInfo      = &image_infos[n_writes],
+    };
+    if (++n_writes == MAX_DESCRIPTOR_WRITES) {
+      vkUpdateDescriptorSets(_vk.device, n_writes, writes, 0, nullptr);
+      n_writes = 0;
+    }
+  }
+  if (n_writes > 0) vkUpdateDescriptorSets(_vk.device, n_writes, writes, 0, nullptr);
+}
+
+// a white texel in slot 0. waited for, so every frame can sample it.
+void umbvk_default_texture_create() {
+  umb_gfx_upload_batch_begin();
+
+  VkBuffer staging_buffer;
+  u64      staging_offset;
+  byte*    data = umbvk_upload_staging_alloc(4, &staging_buffer, &staging_offset);
+  memset(data, 0xFF, 4);
+
+  VkImageCreateInfo dimg_info = {
+      .sType       = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+      .imageType   = VK_IMAGE_TYPE_2D,
+      .format      = VK_FORMAT_R8G8B8A8_UNORM,
+      .extent      = {.width = 1, .height = 1, .depth = 1},
+      .mipLevels   = 1,
+      .arrayLayers = 1,
+      .samples     = VK_SAMPLE_COUNT_1_BIT,
+      .tiling      = VK_IMAGE_TILING_OPTIMAL,
+      .usage       = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT,
+  };
+
+  VmaAllocationCreateInfo dimg_allocinfo = {
+      .usage = VMA_MEMORY_USAGE_GPU_ONLY,
+  };
+
+  umb_image_t* image = &_vk.bindless.default_image;
+  image->n_mips      = 1;
+  image->format      = VK_FORMAT_R8G8B8A8_UNORM;
+  vmaCreateImage(
+      _vk.allocator,
+      &dimg_info,
+      &dimg_allocinfo,
+      &image->image,
+      &image->allocation,
+      nullptr);
+
+  VkImageSubresourceRange range = {
+      .aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT,
+      .baseMipLevel   = 0,
+      .levelCount     = 1,
+      .baseArrayLayer = 0,
+      .layerCount     = 1,
+  };
+
+  umbvk_upload_push_op({
+      .type        = UMBVK_UPLOAD_IMAGE_BEGIN,
+      .dst_image   = image->image,
+      .image_range = range,
+  });
+  umbvk_upload_push_op({
+      .type       = UMBVK_UPLOAD_COPY_IMAGE,
+      .src        = staging_buffer,
+      .dst_image  = image->image,
+      .image_copy = {
+          .bufferOffset = staging_offset,
+          .imageSubresource =
+              {
+                  .aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT,
+                  .mipLevel       = 0,
+                  .baseArrayLayer = 0,
+                  .layerCount     = 1,
+              },
+          .imageExtent = {.width = 1, .height = 1, .depth = 1},
+      },
+  });
+  umbvk_upload_push_op({
+      .type        = UMBVK_UPLOAD_IMAGE_END,
+      .dst_image   = image->image,
+      .image_range = range,
+  });
+
+  image->upload_value = _vk.uploader.open.value;
+  umb_gfx_upload_wait(umb_gfx_upload_batch_end());
+
+  umb_texture texture = &_vk.bindless.default_texture;
+  texture->image      = image;
+  texture->image_view = umbvk_image_view_create(image);
+  umbvk_bindless_add_texture(texture);
+
+  _vk.deletion_queue.push([=]() {
+    vkDestroyImageView(_vk.device, texture->image_view, nullptr);
+    vmaDestroyImage(_vk.allocator, image->image, image->allocation);
+  });
+}
+
+void umb_gfx_init(umb_window* window) {
+  _vk.arena     = umb_arena_create(UMB_MEGABYTES(64));
+  _vk.materials = umb_hash_table_create(&_vk.arena, DEFAULT_NUM_SLOTS);
+  _vk.meshes    = umb_hash_table_create(&_vk.arena, DEFAULT_NUM_SLOTS);
+  _vk.textures  = umb_hash_table_create(&_vk.arena, DEFAULT_NUM_SLOTS);
+  umbvk_render_objects_grow(INITIAL_RENDER_OBJECTS);
+
+  // bounds are the mesh space sphere, copied from the mesh so culling reads them in order
+  _vk.scene             = umb_ecs_world_create();
+  umb_gfx_components* c = &_vk.components;
+
+  c->mesh      = umb_ecs_register_component(&_vk.scene, sizeof(umb_mesh), alignof(umb_mesh));
+  c->material  = umb_ecs_register_component(&_vk.scene, sizeof(umb_material*), alignof(void*));
+  c->transform = umb_ecs_register_component(&_vk.scene, sizeof(glm::mat4), alignof(glm::mat4));
+  c->bounds    = umb_ecs_register_component(&_vk.scene, sizeof(glm::vec4), alignof(glm::vec4));
+  c->texture   = umb_ecs_register_component(&_vk.scene, sizeof(umb_texture), alignof(void*));
+  c->node      = umb_ecs_register_component(
+      &_vk.scene,
+      sizeof(umb_transform),
+      alignof(umb_transform));
+
+  _vk.transforms = umb_transform_hierarchy_create(INITIAL_RENDER_OBJECTS);
+
+  _vk.renderables = umb_ecs_query_create(
+      UMB_COMPONENT_BIT(c->mesh) | UMB_COMPONENT_BIT(c->material) |
+          UMB_COMPONENT_BIT(c->transform) | UMB_COMPONENT_BIT(c->bounds),
+      0);
+
+  VkApplicationInfo app_info {
+      .sType              = VK_STRUCTURE_TYPE_APPLICATION_INFO,
+      .pApplicationName   = "Game",
+      .applicationVersion = VK_MAKE_VERSION(1, 0, 0),
+      .pEngineName        = "[umbral]",
+      .engineVersion      = VK_MAKE_VERSION(1, 0, 0),
+      .apiVersion         = VK_API_VERSION_1_2};
+
+  _vk.window                        = window;
+  umb_array_str required_extensions = umbvk_get_required_extensions(_vk.window);
+
+  VkInstanceCreateInfo vulkan_create_info {
+    .sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO, .pApplicationInfo = &app_info,
+    .enabledExtensionCount   = required_extensions.len,
+    .ppEnabledExtensionNames = required_extensions.data,
+#if defined(__APPLE__)
+    .flags = VK_INSTANCE_CREATE_ENUMERATE_PORTABILITY_BIT_KHR,
+#endif
+  };
+
+  VkDebugUtilsMessengerCreateInfoEXT debug_create_info {};
+  if (_vk.validation_layers_enabled) {
+    UMB_ASSERT(umbvk_check_validation_layer_support(VALIDATION_LAYERS));
+    vulkan_create_info.enabledLayerCount   = UMB_ARRAY_COUNT(VALIDATION_LAYERS, str);
+    vulkan_create_info.ppEnabledLayerNames = VALIDATION_LAYERS;
+    debug_messenger_create_info(debug_create_info);
+    vulkan_create_info.pNext = (VkDebugUtilsMessengerCreateInfoEXT*)&debug_create_info;
+  } else {
+    vulkan_create_info.enabledLayerCount = 0;
+    vulkan_create_info.pNext             = nullptr;
+  }
+
+  VK_CHECK(
+      vkCreateInstance(&vulkan_create_info, nullptr, &_vk.instance),
+      "failed to create instance!");
+
+  // debug messenger for validation layers
+  if (_vk.validation_layers_enabled) {
+    VK_CHECK(
+        umbvk_create_debug_utils_messenger_ext(
+            _vk.instance,
+            &debug_create_info,
+            nullptr,
+            &_vk.debug_messenger),
+        "failed to create debug messenger!");
+  }
+
+  _vk.initialized = true;
+
+  UMB_ASSERT(SDL_Vulkan_CreateSurface((SDL_Window*)window->raw_handle, _vk.instance, &_vk.surface));
+
+  // Device
+  umbvk_set_physical_device();
+  umbvk_set_logical_device();
+  umbvk_set_allocator();
+  umbvk_detect_direct_memory();
+
+  // RenderPass and Swapchain
+  umbvk_swapchain_support_details swapchain_support =
+      umbvk_query_swapchain_support(_vk.surface, _vk.physical_device);
+  VkSurfaceFormatKHR surface_format = umbvk_choose_swap_surface_format(swapchain_support.formats);
+  VkPresentModeKHR   present_mode = umbvk_choose_swap_present_mode(swapchain_support.present_modes);
+  VkExtent2D         extent = umbvk_choose_swap_extent(_vk.window, swapchain_support.capabilities);
+
+  // TODO(bryson): change API to just 'set_XXX'
+  _vk.depth_format           = VK_FORMAT_D32_SFLOAT;
+  _vk.compatible_render_pass = umbvk_create_render_pass(surface_format.format);
+  _vk.swapchain = umbvk_create_swapchain(swapchain_support, surface_format, present_mode, extent);
+  umbvk_uploader_create();
+
+  umbvk_geometry_create();
+  umbvk_set_descriptors();
+  umbvk_default_texture_create();
+
+  // default material
+  umb_material* default_gfx_material = umb_arena_push(&_vk.arena, umb_material);
+  default_gfx_material->pipeline     = umbvk_default_graphics_pipeline_create();
+  default_gfx_material->base_color   = glm::vec4(1.0f);
+  umb_gfx_register_material("default", default_gfx_material);
+
+  VkDescriptorSetLayout cull_set_layouts[] = {
+      _vk.global_set_layout,
+      _vk.object_set_layout,
+      _vk.cluster_set_layout,
+  };
+  _vk.meshlet_cull_pipeline = umbvk_compute_pipeline_create(
+      "res/shaders/meshlet_cull.comp.spv",
+      cull_set_layouts,
+      UMB_ARRAY_COUNT(cull_set_layouts, VkDescriptorSetLayout),
+      sizeof(umbvk_meshlet_cull_constants));
+
+  umbvk_instances_create();
+  umbvk_statics_create();
+  VkDescriptorSetLayout instance_cull_set_layouts[] = {
+      _vk.global_set_layout,
+      _vk.instances.set_layout,
+  };
+  _vk.instances.cull_pipeline = umbvk_compute_pipeline_create(
+      "res/shaders/instance_cull.comp.spv",
+      instance_cull_set_layouts,
+      UMB_ARRAY_COUNT(instance_cull_set_layouts, VkDescriptorSetLayout),
+      sizeof(umbvk_instance_cull_constants));
+
+  umbvk_create_frame_resources();
+}
+
+void umb_gfx_shutdown() {
+  if (_vk.initialized) {
+    umbvk_uploader_stop();
+    vkDeviceWaitIdle(_vk.device);
+
+    for (u32 i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i) _vk.frames[i].deletion_queue.flush();
+    _vk.deletion_queue.flush();
+    umbvk_render_objects_free();
+    umb_ecs_query_destroy(&_vk.renderables);
+    umb_ecs_world_destroy(&_vk.scene);
+    umb_transform_hierarchy_destroy(&_vk.transforms);
+    free(_vk.node_entities);
+
+    vmaDestroyAllocator(_vk.allocator);
+
+    umbvk_destroy_swapchain(&_vk.swapchain);
+    vkDestroySurfaceKHR(_vk.instance, _vk.surface, nullptr);
+    vkDestroyDevice(_vk.device, nullptr);
+    if (_vk.validation_layers_enabled) {
+      auto destroy_func = (PFN_vkDestroyDebugUtilsMessengerEXT)vkGetInstanceProcAddr(
+          _vk.instance,
+          "vkDestroyDebugUtilsMessengerEXT");
+      if (destroy_func != nullptr) destroy_func(_vk.instance, _vk.debug_messenger, nullptr);
+    }
+    vkDestroyInstance(_vk.instance, nullptr);
+  }
+}
+
+umb_ecs_world* umb_gfx_scene() {
+  return &_vk.scene;
+}
+
+const umb_gfx_components* umb_gfx_scene_components() {
+  return &_vk.components;
+}
+
+umb_entity umb_gfx_create_renderable(
+    umb_mesh         mesh,
+    umb_material*    material,
+    const glm::mat4& transform,
+    umb_texture      texture) {
+  const umb_gfx_components* c = &_vk.components;
+
+  umb_component_mask components = UMB_COMPONENT_BIT(c->mesh) | UMB_COMPONENT_BIT(c->material) |
+                                  UMB_COMPONENT_BIT(c->transform) | UMB_COMPONENT_BIT(c->bounds);
+  if (texture) components |= UMB_COMPONENT_BIT(c->texture);
+
+  umb_entity entity = umb_ecs_create(&_vk.scene, components);
+  umb_ecs_set(&_vk.scene, entity, c->mesh, &mesh);
+  umb_ecs_set(&_vk.scene, entity, c->material, &material);
+  umb_ecs_set(&_vk.scene, entity, c->transform, &transform);
+  umb_ecs_set(&_vk.scene, entity, c->bounds, &mesh->bounds);
+  if (texture) umb_ecs_set(&_vk.scene, entity, c->texture, &texture);
+  return entity;
+}
+
+void umb_gfx_set_renderable_transform(umb_entity entity, const glm::mat4& transform) {
+  umb_ecs_set(&_vk.scene, entity, _vk.components.transform, &transform);
+}
+
+void umb_gfx_destroy_renderable(umb_entity entity) {
+  umb_transform* node = (umb_transform*)umb_ecs_get(&_vk.scene, entity, _vk.components.node);
+  if (node) _vk.node_entities[*node] = UMB_ENTITY_NONE;
+  umb_ecs_destroy(&_vk.scene, entity);
+}
+
+umb_transform_hierarchy* umb_gfx_transforms() {
+  return &_vk.transforms;
+}
+
+void umb_gfx_attach_transform(umb_entity entity, umb_transform node) {
+  const umb_gfx_components* c = &_vk.components;
+
+  if (node >= _vk.node_entities_cap) {
+    u32 capacity = _vk.node_entities_cap ? _vk.node_entities_cap : INITIAL_RENDER_OBJECTS;
+    while (capacity <= node) capacity *= 2;
+    _vk.node_entities = umbvk_array_grow(_vk.node_entities, capacity);
+    for (u32 i = _vk.node_entities_cap; i < capacity; ++i) _vk.node_entities[i] = UMB_ENTITY_NONE;
+    _vk.node_entities_cap = capacity;
+  }
+  UMB_ASSERT(_vk.node_entities[node] == UMB_ENTITY_NONE);
+
+  umb_transform* attached = (umb_transform*)umb_ecs_get(&_vk.scene, entity, c->node);
+  if (attached) _vk.node_entities[*attached] = UMB_ENTITY_NONE;
+  else umb_ecs_add(&_vk.scene, entity, c->node);
+  umb_ecs_set(&_vk.scene, entity, c->node, &node);
+  _vk.node_entities[node] = entity;
+
+  // a dirty node is copied by the next update, a clean one would not be in its changed list
+  if (!_vk.transforms.nodes[node].queued) {
+    umb_ecs_set(&_vk.scene, entity, c->transform, umb_transform_world(&_vk.transforms, node));
+  }
+}
+
+umb_entity umb_gfx_draw_object(umb_render_object* o) {
+  return umb_gfx_create_renderable(o->mesh, o->material, o->transform, o->texture);
+}
+
+umb_static_object umb_gfx_draw_static_object(umb_render_object* o) {
+  umbvk_statics* statics = &_vk.statics;
+  if (!statics->supported) {
+    umb_gfx_draw_object(o);
+    return UMB_INVALID_STATIC_OBJECT;
+  }
+  if (statics->objects.len == statics->objects.cap) umbvk_statics_grow(statics->objects.cap * 2);
+
+  umb_static_object object      = statics->objects.len;
+  statics->dirty_frames[object] = 0;
+  statics->object_slots[object] = INVALID_STATIC_SLOT;
+  UMB_ARRAY_PUSH(statics->objects, o);
+  statics->version++;
+  return object;
+}
+
+void umb_gfx_static_object_moved(umb_static_object object) {
+  umbvk_statics* statics = &_vk.statics;
+  if (object == UMB_INVALID_STATIC_OBJECT) return;
+
+  // the bounds are shared by the frames, only the object data is per frame
+  u32 slot = statics->object_slots[object];
+  if (slot != INVALID_STATIC_SLOT) {
+    umb_render_object* o      = statics->objects.data[object];
+    glm::vec4          sphere = umbvk_world_bounds(o->mesh, o->transform);
+
+    statics->spheres.x[slot] = sphere.x;
+    statics->spheres.y[slot] = sphere.y;
+    statics->spheres.z[slot] = sphere.z;
+    statics->spheres.r[slot] = sphere.w;
+  }
+
+  if (statics->dirty_frames[object]) return;
+  statics->dirty_frames[object]              = (u8)((1 << MAX_FRAMES_IN_FLIGHT) - 1);
+  statics->dirty_objects[statics->n_dirty++] = object;
+}
+
+void umb_gfx_static_objects_changed() {
+  _vk.statics.version++;
+}
+
+void umbvk_mesh_compute_bounds(umb_mesh mesh) {
+  if (mesh->vertices.len == 0) {
+    mesh->bounds = glm::vec4(0.0f);
+    return;
+  }
+
+  glm::vec3 min = mesh->vertices.data[0].position;
+  glm::vec3 max = min;
+  for (u32 i = 1; i < mesh->vertices.len; ++i) {
+    min = glm::min(min, mesh->vertices.data[i].position);
+    max = glm::max(max, mesh->vertices.data[i].position);
+  }
+
+  glm::vec3 center = (min + max) * 0.5f;
+  f32       radius = 0.0f;
+  for (u32 i = 0; i < mesh->vertices.len; ++i) {
+    radius = glm::max(radius, glm::length(mesh->vertices.data[i].position - center));
+  }
+  mesh->bounds = glm::vec4(center, radius);
+}
+
+// builds a simplification chain after LOD 0, each level targeting half the triangles of the
+// previous one. All levels share the mesh's index array and are addressed by index range.
+void umbvk_mesh_build_lods(umb_mesh mesh) {
+  const u32 n_base_indices = mesh->indices.len;
+  const f32 max_error      = mesh->bounds.w * 0.1f;
+
+  mesh->lods[0] = {.first_index = 0, .index_count = n_base_indices, .error = 0.0f};
+  mesh->n_lods  = 1;
+
+  u32* lod_indices = (u32*)malloc(sizeof(u32) * n_base_indices * 2);
+  u32  n_total     = 0;
+
+  const u32* src   = mesh->indices.data;
+  u32        n_src = n_base_indices;
+  while (mesh->n_lods < MAX_MESH_LODS) {
+    u32 target = (n_src / 2) / 3 * 3;
+    if (target < 3 * 32 || n_total + n_src > n_base_indices * 2) break;
+
+    f32 error = 0.0f;
+    u32 n_dst = umb_mesh_simplify(
+        lod_indices + n_total,
+        src,
+        n_src,
+        &mesh->vertices.data[0].position.x,
+        mesh->vertices.len,
+        sizeof(umb_mesh_vertex),
+        target,
+        max_error,
+        &error);
+    if (n_dst > n_src * 3 / 4) break;
+
+    const umb_mesh_lod* prev   = &mesh->lods[mesh->n_lods - 1];
+    mesh->lods[mesh->n_lods++] = {
+        .first_index = n_base_indices + n_total,
+        .index_count = n_dst,
+        .error       = prev->error + error,
+    };
+
+    src   = lod_indices + n_total;
+    n_src = n_dst;
+    n_total += n_dst;
+  }
+
+  if (n_total > 0) {
+    umb_array_u32 indices = UMB_ARRAY_CREATE(u32, &_vk.arena, n_base_indices + n_total);
+    memcpy(indices.data, mesh->indices.data, sizeof(u32) * n_base_indices);
+    memcpy(indices.data + n_base_indices, lod_indices, sizeof(u32) * n_total);
+    indices.len   = n_base_indices + n_total;
+    mesh->indices = indices;
+  }
+
+  free(lod_indices);
+}
+
+// clusters LOD 0 and rewrites its index range in cluster order. returns the meshlets, or NULL if
+// the mesh is too small to be worth culling per cluster.
+umb_meshlet* umbvk_mesh_build_meshlets(umb_mesh mesh) {
+  const umb_mesh_lod* lod0 = &mesh->lods[0];
+  if (lod0->index_count / 3 < MIN_CLUSTERED_TRIANGLES) return NULL;
+
+  u32 max_meshlets = umb_meshlet_count_bound(
+      lod0->index_count,
+      UMB_MESHLET_MAX_VERTICES,
+      UMB_MESHLET_MAX_TRIANGLES);
+  umb_meshlet* meshlets        = (umb_meshlet*)malloc(sizeof(umb_meshlet) * max_meshlets);
+  u32*         meshlet_indices = (u32*)malloc(sizeof(u32) * lod0->index_count);
+  mesh->meshlet_count          = umb_meshlets_build(
+      meshlets,
+      meshlet_indices,
+      mesh->indices.data + lod0->first_index,
+      lod0->index_count,
+      &mesh->vertices.data[0].position.x,
+      mesh->vertices.len,
+      sizeof(umb_mesh_vertex),
+      UMB_MESHLET_MAX_VERTICES,
+      UMB_MESHLET_MAX_TRIANGLES);
+
+  // same triangles, so LOD 0 draws unchanged and clusters address it directly
+  memcpy(mesh->indices.data + lod0->first_index, meshlet_indices, sizeof(u32) * lod0->index_count);
+  for (u32 i = 0; i < mesh->meshlet_count; ++i) meshlets[i].index_offset += lod0->first_index;
+  free(meshlet_indices);
+
+  return meshlets;
+}
+
+void umbvk_mesh_free_geometry(umb_mesh mesh) {
+  umb_offset_free(&_vk.geometry.vertex_allocator, mesh->vertex_alloc);
+  umb_offset_free(&_vk.geometry.index_allocator, mesh->index_alloc);
+  umb_offset_free(&_vk.geometry.meshlet_allocator, mesh->meshlet_alloc);
+}
+
+b32 umbvk_mesh_alloc_geometry(umb_mesh mesh) {
+  mesh->vertex_alloc  = umb_offset_alloc(&_vk.geometry.vertex_allocator, mesh->vertices.len);
+  mesh->index_alloc   = umb_offset_alloc(&_vk.geometry.index_allocator, mesh->indices.len);
+  mesh->meshlet_alloc = {UMB_OFFSET_ALLOC_NO_SPACE, UMB_OFFSET_ALLOC_NO_SPACE};
+  if (mesh->meshlet_count > 0) {
+    mesh->meshlet_alloc = umb_offset_alloc(&_vk.geometry.meshlet_allocator, mesh->meshlet_count);
+    if (mesh->meshlet_alloc.offset == UMB_OFFSET_ALLOC_NO_SPACE) {
+      UMBI_LOG_WARN("meshlet buffer full, drawing mesh without cluster culling");
+      mesh->meshlet_count = 0;
+    }
+  }
+
+  if (mesh->vertex_alloc.offset == UMB_OFFSET_ALLOC_NO_SPACE ||
+      mesh->index_alloc.offset == UMB_OFFSET_ALLOC_NO_SPACE) {
+    umbvk_mesh_free_geometry(mesh);
+    return false;
+  }
+  return true;
+}
+
+void umb_gfx_register_mesh(str name, umb_mesh mesh) {
+  // an empty mesh would take no geometry range and read as a full geometry buffer
+  if (mesh->vertices.len == 0) {
+    UMBI_LOG_ERROR("mesh '%s' has no vertices, not registering it", name);
+    return;
+  }
+  if (mesh->indices.len == 0) {
+    mesh->indices = UMB_ARRAY_CREATE(u32, &_vk.arena, mesh->vertices.len);
+    for (u32 i = 0; i < mesh->vertices.len; ++i) { UMB_ARRAY_PUSH(mesh->indices, i); }
+  }
+
+  umbvk_mesh_compute_bounds(mesh);
+  umbvk_mesh_build_lods(mesh);
+  umb_meshlet* meshlets = umbvk_mesh_build_meshlets(mesh);
+
+  if (!umbvk_mesh_alloc_geometry(mesh)) {
+    umb_gfx_defragment_geometry();
+    if (!umbvk_mesh_alloc_geometry(mesh)) {
+      UMBI_LOG_ERROR("geometry buffers full, could not register mesh '%s'", name);
+      UMB_ASSERT(false);
+    }
+  }
+  UMB_ASSERT(_vk.geometry.n_meshes < MAX_MESHES);
+  mesh->name                                   = name;
+  mesh->geometry_slot                          = _vk.geometry.n_meshes;
+  _vk.geometry.meshes[_vk.geometry.n_meshes++] = mesh;
+  _vk.instances.mesh_version++;
+
+  const u64 vertex_size  = mesh->vertices.len * sizeof(umb_mesh_vertex);
+  const u64 index_size   = mesh->indices.len * sizeof(u32);
+  const u64 meshlet_size = mesh->meshlet_count * sizeof(umb_meshlet);
+
+  umbvk_geometry* geometry = &_vk.geometry;
+  if (geometry->direct) {
+    // the ranges are fresh, no frame or upload in flight reads them
+    memcpy(
+        geometry->vertex_mapped + mesh->vertex_alloc.offset * sizeof(umb_mesh_vertex),
+        mesh->vertices.data,
+        vertex_size);
+    memcpy(
+        geometry->index_mapped + mesh->index_alloc.offset * sizeof(u32),
+        mesh->indices.data,
+        index_size);
+    if (meshlets) {
+      memcpy(
+          geometry->meshlet_mapped + mesh->meshlet_alloc.offset * sizeof(umb_meshlet),
+          meshlets,
+          meshlet_size);
+    }
+    free(meshlets);
+
+    mesh->upload_value = 0;
+    umb_hash_table_insert(&_vk.meshes, name, (byte*)mesh);
+    return;
+  }
+
+  umb_gfx_upload_batch_begin();
+
+  VkBuffer staging_buffer;
+  u64      staging_offset;
+  byte*    data = umbvk_upload_staging_alloc(
+      vertex_size + index_size + meshlet_size,
+      &staging_buffer,
+      &staging_offset);
+  memcpy(data, mesh->vertices.data, vertex_size);
+  memcpy(data + vertex_size, mesh->indices.data, index_size);
+  if (meshlets) memcpy(data + vertex_size + index_size, meshlets, meshlet_size);
+  free(meshlets);
+
+  umbvk_upload_push_op({
+      .type        = UMBVK_UPLOAD_COPY_BUFFER,
+      .src         = staging_buffer,
+      .dst_buffer  = _vk.geometry.vertex_buffer.buffer,
+      .buffer_copy = {
+          .srcOffset = staging_offset,
+          .dstOffset = mesh->vertex_alloc.offset * sizeof(umb_mesh_vertex),
+          .size      = vertex_size,
+      },
+  });
+  umbvk_upload_push_op({
+      .type        = UMBVK_UPLOAD_COPY_BUFFER,
+      .src         = staging_buffer,
+      .dst_buffer  = _vk.geometry.index_buffer.buffer,
+      .buffer_copy = {
+          .srcOffset = staging_offset + vertex_size,
+          .dstOffset = mesh->index_alloc.offset * sizeof(u32),
+          .size      = index_size,
+      },
+  });
+  if (meshlet_size > 0) {
+    umbvk_upload_push_op({
+        .type        = UMBVK_UPLOAD_COPY_BUFFER,
+        .src         = staging_buffer,
+        .dst_buffer  = _vk.geometry.meshlet_buffer.buffer,
+        .buffer_copy = {
+            .srcOffset = staging_offset + vertex_size + index_size,
+            .dstOffset = mesh->meshlet_alloc.offset * sizeof(umb_meshlet),
+            .size      = meshlet_size,
+        },
+    });
+  }
+
+  // frames skip the mesh until the batch holding its copies has executed
+  mesh->upload_value              = _vk.uploader.open.value;
+  _vk.instances.mesh_upload_value = mesh->upload_value;
+  umb_gfx_upload_batch_end();
+
+  umb_hash_table_insert(&_vk.meshes, name, (byte*)mesh);
+}
+
+void umb_gfx_unregister_mesh(str name) {
+  umb_mesh mesh = umb_gfx_get_mesh(name);
+  if (mesh == NULL) return;
+
+  umb_hash_table_insert(&_vk.meshes, name, NULL);
+
+  umb_mesh last                            = _vk.geometry.meshes[--_vk.geometry.n_meshes];
+  _vk.geometry.meshes[mesh->geometry_slot] = last;
+  last->geometry_slot                      = mesh->geometry_slot;
+
+  // instances of the moved mesh follow it to its new slot. anything still drawing the removed
+  // mesh would silently draw the moved one instead.
+  umbvk_instances* inst = &_vk.instances;
+  inst->mesh_version++;
+  for (u32 i = 0; i < _vk.statics.objects.len; ++i) {
+    UMB_ASSERT(_vk.statics.objects.data[i]->mesh != mesh);
+  }
+  for (u32 i = 0; i < inst->n_instances; ++i) {
+    UMB_ASSERT(inst->meshes[i] != mesh);
+    if (inst->meshes[i] != last) continue;
+    inst->data[i].mesh_index = last->geometry_slot;
+    umbvk_instance_mark_dirty(i, false);
+  }
+
+  // frames complete in order, so once the most recently submitted one has retired nothing can
+  // reference the ranges anymore
+  u32 last_frame = (_vk.frame_id + MAX_FRAMES_IN_FLIGHT - 1) % MAX_FRAMES_IN_FLIGHT;
+  _vk.frames[last_frame].deletion_queue.push([=]() { umbvk_mesh_free_geometry(mesh); });
+}
+
+void umb_gfx_defragment_geometry() {
+  // pending uploads may still target the old ranges
+  umb_gfx_upload_wait(UINT64_MAX);
+  {
+    std::lock_guard<std::mutex> lock(_vk.queue_mutex);
+    vkDeviceWaitIdle(_vk.device);
+  }
+  for (u32 i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i) _vk.frames[i].deletion_queue.flush();
+
+  // the old buffers' reservation is handed back first, so the packed copy can take its place in
+  // direct memory instead of falling back to staging
+  umbvk_geometry old = _vk.geometry;
+  if (old.direct) umbvk_direct_release(GEOMETRY_BUFFERS_SIZE);
+  old.direct = false;
+  umbvk_geometry_buffers_create(&_vk.geometry);
+  umb_offset_allocator_reset(&_vk.geometry.vertex_allocator);
+  umb_offset_allocator_reset(&_vk.geometry.index_allocator);
+  umb_offset_allocator_reset(&_vk.geometry.meshlet_allocator);
+  umbvk_geometry_reserve_cluster_ranges();
+
+  // an empty allocator hands out ranges back to back, so the live meshes end up packed
+  for (u32 i = 0; i < _vk.geometry.n_meshes; ++i) {
+    umb_mesh              mesh        = _vk.geometry.meshes[i];
+    umb_offset_allocation old_vertex  = mesh->vertex_alloc;
+    umb_offset_allocation old_index   = mesh->index_alloc;
+    umb_offset_allocation old_meshlet = mesh->meshlet_alloc;
+    b32                   packed      = umbvk_mesh_alloc_geometry(mesh);
+    UMB_ASSERT(packed);
+
+    umbvk_upload_push_op({
+        .type        = UMBVK_UPLOAD_COPY_BUFFER,
+        .src         = old.vertex_buffer.buffer,
+        .dst_buffer  = _vk.geometry.vertex_buffer.buffer,
+        .buffer_copy = {
+            .srcOffset = old_vertex.offset * sizeof(umb_mesh_vertex),
+            .dstOffset = mesh->vertex_alloc.offset * sizeof(umb_mesh_vertex),
+            .size      = mesh->vertices.len * sizeof(umb_mesh_vertex),
+        },
+    });
+    umbvk_upload_push_op({
+        .type        = UMBVK_UPLOAD_COPY_BUFFER,
+        .src         = old.index_buffer.buffer,
+        .dst_buffer  = _vk.geometry.index_buffer.buffer,
+        .buffer_copy = {
+            .srcOffset = old_index.offset * sizeof(u32),
+            .dstOffset = mesh->index_alloc.offset * sizeof(u32),
+            .size      = mesh->indices.len * sizeof(u32),
+        },
+    });
+    if (mesh->meshlet_count > 0) {
+      umbvk_upload_push_op({
+          .type        = UMBVK_UPLOAD_COPY_BUFFER,
+          .src         = old.meshlet_buffer.buffer,
+          .dst_buffer  = _vk.geometry.meshlet_buffer.buffer,
+          .buffer_copy = {
+              .srcOffset = old_meshlet.offset * sizeof(umb_meshlet),
+              .dstOffset = mesh->meshlet_alloc.offset * sizeof(umb_meshlet),
+              .size      = mesh->meshlet_count * sizeof(umb_meshlet),
+          },
+      });
+    }
+  }
+
+  // the old buffers are destroyed below, so this cannot wait for the end of a batch
+  umb_gfx_upload_wait(umbvk_upload_submit_open());
+
+  umbvk_geometry_buffers_destroy(&old);
+  umbvk_write_cluster_descriptors();
+  _vk.instances.mesh_version++;
+}
+
+// frames in flight only read the slots of materials registered before them, so the new slot is
+// written in place
+void umb_gfx_register_material(str name, umb_material* mat) {
+  UMB_ASSERT(_vk.bindless.n_materials < MAX_MATERIALS);
+  mat->index = _vk.bindless.n_materials++;
+
+  u32 pipeline_id = 0;
+  while (pipeline_id < _vk.n_sorted_pipelines &&
+         _vk.sorted_pipelines[pipeline_id] != mat->pipeline.pipeline) {
+    pipeline_id++;
+  }
+  if (pipeline_id == _vk.n_sorted_pipelines) {
+    UMB_ASSERT(_vk.n_sorted_pipelines < MAX_SORTED_PIPELINES);
+    _vk.sorted_pipelines[_vk.n_sorted_pipelines++] = mat->pipeline.pipeline;
+  }
+  _vk.material_pipeline_ids[mat->index] = (u8)pipeline_id;
+
+  umb_gpu_material_data data = {
+      .base_color     = mat->base_color,
+      .albedo_texture = mat->albedo ? mat->albedo->index : 0,
+      .sampler        = (u32)mat->sampler,
+  };
+
+  byte* materials = _vk.bindless.material_buffer.mapped;
+  memcpy(materials + sizeof(umb_gpu_material_data) * mat->index, &data, sizeof(data));
+
+  umb_hash_table_insert(&_vk.materials, name, (byte*)mat);
+  _vk.statics.version++;
+}
+
+umb_mesh umb_gfx_get_mesh(str name) {
+  return (umb_mesh)umb_hash_table_get(&_vk.meshes, name);
+}
+umb_material* umb_gfx_get_material(str name) {
+  return (umb_material*)umb_hash_table_get(&_vk.materials, name);
+}
+umb_texture umb_gfx_get_texture(str name) {
+  return (umb_texture)umb_hash_table_get(&_vk.textures, name);
+}
+
+umb_instance umb_gfx_add_instance(
+    umb_mesh         mesh,
+    umb_material*    material,
+    const glm::mat4& transform) {
+  umbvk_instances* inst = &_vk.instances;
+  UMB_ASSERT(inst->n_instances < MAX_INSTANCES);
+
+  u32 bucket = 0;
+  while (bucket < inst->n_buckets &&
+         inst->pipelines[bucket].pipeline != material->pipeline.pipeline) {
+    bucket++;
+  }
+  if (bucket == inst->n_buckets) {
+    UMB_ASSERT(inst->n_buckets < MAX_INSTANCE_PIPELINES);
+    inst->pipelines[inst->n_buckets++] = material->pipeline;
+  }
+  inst->bucket_sizes[bucket]++;
+
+  umb_instance handle =
+      inst->n_free_handles > 0 ? inst->free_handles[--inst->n_free_handles] : inst->n_handles++;
+  u32 slot                   = inst->n_instances++;
+  inst->handle_slots[handle] = slot;
+  inst->slot_handles[slot]   = handle;
+  inst->meshes[slot]         = mesh;
+
+  umb_gpu_instance_data data = {
+      .model_matrix   = transform,
+      .material_index = material->index,
+      .mesh_index     = mesh->geometry_slot,
+      .bucket         = bucket,
+  };
+  inst->data[slot] = data;
+  umbvk_instance_mark_dirty(slot, true);
+  return handle;
+}
+
+void umb_gfx_set_instance_transform(umb_instance instance, const glm::mat4& transform) {
+  u32 slot                              = _vk.instances.handle_slots[instance];
+  _vk.instances.data[slot].model_matrix = transform;
+  umbvk_instance_mark_dirty(slot, false);
+}
+
+// the last slot moves into the freed one, so the slots stay dense
+void umb_gfx_remove_instance(umb_instance instance) {
+  umbvk_instances* inst = &_vk.instances;
+  u32              slot = inst->handle_slots[instance];
+  u32              last = --inst->n_instances;
+  inst->bucket_sizes[inst->data[slot].bucket]--;
+
+  if (slot != last) {
+    u32 moved                 = inst->slot_handles[last];
+    inst->data[slot]          = inst->data[last];
+    inst->meshes[slot]        = inst->meshes[last];
+    inst->slot_handles[slot]  = moved;
+    inst->handle_slots[moved] = slot;
+    umbvk_instance_mark_dirty(slot, true);
+  }
+  inst->free_handles[inst->n_free_handles++] = instance;
+}
+
+void umb_gfx_set_lod_error_threshold(f32 pixels) {
+  _vk.lod_error_threshold = pixels;
+}
+
+void umb_gfx_set_direct_upload_budget(u64 bytes) {
+  _vk.direct.budget = bytes;
+}
+
+umb_mesh umb_mesh_create(u32 n_vertices) {
+  umb_mesh mesh  = umb_arena_push(&_vk.arena, umb_mesh_t);
+  mesh->vertices = UMB_ARRAY_CREATE(umb_mesh_vertex, &_vk.arena, n_vertices);
+  return mesh;
+}
+
+umb_mesh umb_mesh_create_indexed(u32 n_vertices, u32 n_indices) {
+  umb_mesh mesh = umb_mesh_create(n_vertices);
+  mesh->indices = UMB_ARRAY_CREATE(u32, &_vk.arena, n_indices);
+  return mesh;
+}
+
+void umb_mesh_push_vertex(umb_mesh mesh, umb_mesh_vertex vertex) {
+  UMB_ARRAY_PUSH(mesh->vertices, vertex);
+}
+
+void umb_mesh_push_index(umb_mesh mesh, u32 index) {
+  UMB_ARRAY_PUSH(mesh->indices, index);
+}
+
+// TODO(bryson): roll your own .obj parser?
+// Regretably we must include some C++
+#include <unordered_map>
+#include <vector>
+struct umbvk_obj_index_hash {
+  size_t operator()(const tinyobj::index_t& idx) const {
+    return ((size_t)idx.vertex_index * 73856093) ^ ((size_t)idx.normal_index * 19349663) ^
+           ((size_t)idx.texcoord_index * 83492791);
+  }
+};
+
+struct umbvk_obj_index_equal {
+  bool operator()(const tinyobj::index_t& a, const tinyobj::index_t& b) const {
+    return a.vertex_index == b.vertex_index && a.normal_index == b.normal_index &&
+           a.texcoord_index == b.texcoord_index;
+  }
+};
+
+umb_mesh umb_mesh_load_from_obj(str filename) {
+  tinyobj::attrib_t attrib;
+
+  std::vector<tinyobj::shape_t>    shapes;
+  std::vector<tinyobj::material_t> materials;
+
+  std::string warn;
+  std::string err;
+
+  tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, filename, nullptr);
+  if (!warn.empty()) { printf("tinobjloader: %s", warn.c_str()); }
+  if (!err.empty()) {
+    UMBI_LOG_ERROR("tinobjloader: %s", err.c_str());
+    return NULL;
+  }
+
+  const int fv = 3;
+
+  u64 n_indices = 0;
+  for (u64 s = 0; s < shapes.size(); ++s) {
+    n_indices += fv * shapes[s].mesh.num_face_vertices.size();
+  }
+
+  // weld identical position/normal/uv combinations so the mesh keeps shared vertices
+  std::unordered_map<tinyobj::index_t, u32, umbvk_obj_index_hash, umbvk_obj_index_equal> unique;
+  unique.reserve(n_indices);
+
+  umb_mesh mesh = umb_mesh_create_indexed(n_indices, n_indices);
+  for (u64 s = 0; s < shapes.size(); ++s) {
+    u64 index_offset = 0;
+    for (u64 f = 0; f < shapes[s].mesh.num_face_vertices.size(); ++f) {
+      // 3 for triangle!
+      for (u64 v = 0; v < fv; ++v) {
+        tinyobj::index_t idx = shapes[s].mesh.indices[index_offset + v];
+
+        auto existing = unique.find(idx);
+        if (existing != unique.end()) {
+          umb_mesh_push_index(mesh, existing->second);
+          continue;
+        }
+
+        // vertex position
+        tinyobj::real_t vx = attrib.vertices[3 * idx.vertex_index + 0];
+        tinyobj::real_t vy = attrib.vertices[3 * idx.vertex_index + 1];
+        tinyobj::real_t vz = attrib.vertices[3 * idx.vertex_index + 2];
+
+        // vertex normal
+        tinyobj::real_t nx = attrib.normals[3 * idx.normal_index + 0];
+        tinyobj::real_t ny = attrib.normals[3 * idx.normal_index + 1];
+        tinyobj::real_t nz = attrib.normals[3 * idx.normal_index + 2];
+
+        // vertex uv
+        tinyobj::real_t ux = attrib.texcoords[2 * idx.texcoord_index + 0];
+        tinyobj::real_t uy = attrib.texcoords[2 * idx.texcoord_index + 1];
+
+        // copy it into our vertex
+        umb_mesh_vertex new_vert;
+        new_vert.position.x = vx;
+        new_vert.position.y = vy;
+        new_vert.position.z = vz;
+
+        new_vert.normal.x = nx;
+        new_vert.normal.y = ny;
+        new_vert.normal.z = nz;
+
+        new_vert.uv.x = ux;
+        new_vert.uv.y = 1 - uy;
+
+        // we are setting the vertex color as the vertex normal. This is just for display purposes
+        new_vert.color = new_vert.normal;
+
+        unique[idx] = mesh->vertices.len;
+        umb_mesh_push_index(mesh, mesh->vertices.len);
+        umb_mesh_push_vertex(mesh, new_vert);
+      }
+      index_offset += fv;
+    }
+  }
+
+  return mesh;
+}
+
+// true when accessor `idx` is the float attribute `offset` bytes into `position`'s vertices
+b32 umbvk_gltf_is_interleaved(
+    const umb_gltf*          gltf,
+    i32                      idx,
+    const umb_gltf_accessor* position,
+    u64                      offset,
+    u32                      n_components) {
+  if (idx < 0) return false;
+  const umb_gltf_accessor* accessor = &gltf->accessors[idx];
+  return accessor->data == position->data + offset && accessor->stride == position->stride &&
+         accessor->count == position->count && accessor->component_type == UMB_GLTF_FLOAT &&
+         accessor->n_components == n_components && !accessor->normalized;
+}
+
+umb_mesh umbvk_gltf_build_mesh(umb_model model, const umb_gltf_primitive* prim) {
+  const umb_gltf*          gltf     = &model->gltf;
+  const umb_gltf_accessor* position = &gltf->accessors[prim->position];
+  umb_mesh                 mesh     = umb_arena_push(&_vk.arena, umb_mesh_t);
+
+  // a buffer view that already holds umb_mesh_vertex is used in place
+  b32 alias_vertices =
+      position->data && position->component_type == UMB_GLTF_FLOAT &&
+      position->n_components == 3 && position->stride == sizeof(umb_mesh_vertex) &&
+      (uintptr_t)position->data % alignof(umb_mesh_vertex) == 0 &&
+      offsetof(umb_mesh_vertex, position) == 0 &&
+      umbvk_gltf_is_interleaved(
+          gltf, prim->normal, position, offsetof(umb_mesh_vertex, normal), 3) &&
+      umbvk_gltf_is_interleaved(
+          gltf, prim->color, position, offsetof(umb_mesh_vertex, color), 3) &&
+      umbvk_gltf_is_interleaved(gltf, prim->uv, position, offsetof(umb_mesh_vertex, uv), 2);
+
+  if (alias_vertices) {
+    mesh->vertices = {
+        .data = (umb_mesh_vertex*)position->data,
+        .len  = position->count,
+        .cap  = position->count,
+    };
+  } else {
+    umb_mesh_vertex* vertices =
+        (umb_mesh_vertex*)malloc(sizeof(umb_mesh_vertex) * (position->count + 1));
+    model->converted[model->n_converted++] = vertices;
+
+    const umb_gltf_accessor* normal = prim->normal >= 0 ? &gltf->accessors[prim->normal] : NULL;
+    const umb_gltf_accessor* color  = prim->color >= 0 ? &gltf->accessors[prim->color] : NULL;
+    const umb_gltf_accessor* uv     = prim->uv >= 0 ? &gltf->accessors[prim->uv] : NULL;
+    for (u32 i = 0; i < position->count; ++i) {
+      umb_mesh_vertex* v = &vertices[i];
+      umb_gltf_read_floats(position, i, &v->position.x, 3);
+      v->normal = {0.f, 0.f, 1.f};
+      if (normal) umb_gltf_read_floats(normal, i, &v->normal.x, 3);
+      // like the .obj loader, meshes without vertex colors display their normals
+      v->color = v->normal;
+      if (color) umb_gltf_read_floats(color, i, &v->color.x, 3);
+      v->uv = {0.f, 0.f};
+      if (uv) umb_gltf_read_floats(uv, i, &v->uv.x, 2);
+    }
+    mesh->vertices = {.data = vertices, .len = position->count, .cap = position->count};
+  }
+
+  // without indices the mesh is a triangle list and register builds the trivial index buffer
+  if (prim->indices < 0) return mesh;
+
+  const umb_gltf_accessor* indices = &gltf->accessors[prim->indices];
+  b32 alias_indices = indices->data && indices->component_type == UMB_GLTF_UNSIGNED_INT &&
+                      indices->stride == sizeof(u32) &&
+                      (uintptr_t)indices->data % alignof(u32) == 0;
+  // indices from the file are only used in place when none of them is out of range
+  for (u32 i = 0; alias_indices && i < indices->count; ++i) {
+    alias_indices = ((const u32*)indices->data)[i] < position->count;
+  }
+
+  if (alias_indices) {
+    // the mapping is copy-on-write, so meshlet building may reorder these in place
+    mesh->indices = {.data = (u32*)indices->data, .len = indices->count, .cap = indices->count};
+  } else {
+    u32* data = (u32*)malloc(sizeof(u32) * (indices->count + 1));
+    model->converted[model->n_converted++] = data;
+    for (u32 i = 0; i < indices->count; ++i) {
+      data[i] = umb_gltf_read_index(indices, i);
+      if (data[i] >= position->count) data[i] = 0;
+    }
+    mesh->indices = {.data = data, .len = indices->count, .cap = indices->count};
+  }
+  return mesh;
+}
+
+umb_model umb_gfx_load_model(str filename, str name) {
+  umb_gltf loaded = {};
+  if (!umb_gltf_load(filename, &loaded)) return NULL;
+
+  umb_model model = umb_arena_push(&_vk.arena, umb_model_t);
+  model->gltf     = loaded;
+  umb_gltf* gltf  = &model->gltf;
+
+  model->mesh_names = umb_arena_push_array(&_vk.arena, str, gltf->n_primitives);
+  model->converted  = (void**)calloc(gltf->n_primitives * 2 + 1, sizeof(void*));
+
+  // registered mesh per primitive, NULL for primitives that are skipped
+  umb_mesh* meshes = (umb_mesh*)calloc(gltf->n_primitives + 1, sizeof(umb_mesh));
+
+  umb_gfx_upload_batch_begin();
+  for (u32 m = 0; m < gltf->n_meshes; ++m) {
+    const umb_gltf_mesh* gltf_mesh = &gltf->meshes[m];
+    for (u32 p = 0; p < gltf_mesh->n_primitives; ++p) {
+      u32                       prim_idx = gltf_mesh->first_primitive + p;
+      const umb_gltf_primitive* prim     = &gltf->primitives[prim_idx];
+      if (prim->mode != UMB_GLTF_MODE_TRIANGLES || prim->position < 0 ||
+          gltf->accessors[prim->position].count == 0) {
+        UMBI_LOG_WARN("gltf: skipped primitive %u of mesh %u, only triangle lists are drawn", p, m);
+        continue;
+      }
+
+      umb_mesh mesh  = umbvk_gltf_build_mesh(model, prim);
+      u64      len   = strlen(name) + strlen(gltf_mesh->name) + 24;
+      char*    label = umb_arena_push_array(&_vk.arena, char, len);
+      snprintf(label, len, "%s/%s/%u", name, gltf_mesh->name[0] ? gltf_mesh->name : "mesh", p);
+      if (umb_gfx_get_mesh(label)) snprintf(label, len, "%s/%u/%u", name, m, p);
+
+      umb_gfx_register_mesh(label, mesh);
+      model->mesh_names[model->n_meshes++] = label;
+      meshes[prim_idx]                     = mesh;
+    }
+  }
+  umb_gfx_upload_batch_end();
+
+  u32 n_objects = 0;
+  for (u32 n = 0; n < gltf->n_nodes; ++n) {
+    if (gltf->nodes[n].mesh < 0) continue;
+    const umb_gltf_mesh* gltf_mesh = &gltf->meshes[gltf->nodes[n].mesh];
+    for (u32 p = 0; p < gltf_mesh->n_primitives; ++p) {
+      n_objects += meshes[gltf_mesh->first_primitive + p] != NULL;
+    }
+  }
+
+  // parents precede their children, so one pass resolves every world transform
+  glm::mat4*    world    = (glm::mat4*)malloc(sizeof(glm::mat4) * (gltf->n_nodes + 1));
+  umb_material* material = umb_gfx_get_material("default");
+  model->objects         = umb_arena_push_array(&_vk.arena, umb_render_object, n_objects);
+  for (u32 n = 0; n < gltf->n_nodes; ++n) {
+    const umb_gltf_node* node = &gltf->nodes[n];
+
+    glm::mat4 local;
+    memcpy(&local, node->matrix, sizeof(local));
+    world[n] = node->parent >= 0 ? world[node->parent] * local : local;
+
+    if (node->mesh < 0) continue;
+    const umb_gltf_mesh* gltf_mesh = &gltf->meshes[node->mesh];
+    for (u32 p = 0; p < gltf_mesh->n_primitives; ++p) {
+      umb_mesh mesh = meshes[gltf_mesh->first_primitive + p];
+      if (mesh == NULL) continue;
+      model->objects[model->n_objects++] = {
+          .mesh      = mesh,
+          .material  = material,
+          .transform = world[n],
+      };
+    }
+  }
+
+  free(world);
+  free(meshes);
+  return model;
+}
+
+void umb_gfx_unload_model(umb_model model) {
+  for (u32 i = 0; i < model->n_meshes; ++i) umb_gfx_unregister_mesh(model->mesh_names[i]);
+
+  // register copied the data into the geometry buffers, nothing reads it past this point
+  for (u32 i = 0; i < model->n_converted; ++i) free(model->converted[i]);
+  free(model->converted);
+  umb_gltf_free(&model->gltf);
+  *model = {};
+}
+
+umb_slice_umb_render_object umb_model_get_objects(umb_model model) {
+  return UMB_SLICE(umb_render_object, model->objects, model->n_objects);
+}
+
+b32 umbvk_ktx2_supported(const umb_ktx2* ktx2, str file) {
+  VkFormatProperties props;
+  vkGetPhysicalDeviceFormatProperties(_vk.physical_device, (VkFormat)ktx2->vk_format, &props);
+
+  const VkFormatFeatureFlags needed =
+      VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT | VK_FORMAT_FEATURE_TRANSFER_DST_BIT;
+  if (!_vk.device_features.textureCompressionBC ||
+      (props.optimalTilingFeatures & needed) != needed) {
+    UMBI_LOG_ERROR("%s: the device cannot sample format %d", file, (i32)ktx2->vk_format);
+    return false;
+  }
+  return true;
+}
+
+u64 umbvk_ktx2_levels_size(const umb_ktx2* ktx2, u32 first_level) {
+  u64 size = 0;
+  for (u32 level = first_level; level < ktx2->n_levels; ++level) size += ktx2->levels[level].size;
+  return size;
+}
+
+// an image of the levels from `first_level` down, copied from the file without any decoding
+void umbvk_ktx2_image_create(const umb_ktx2* ktx2, u32 first_level, umb_image_t* out_image) {
+  VkFormat image_format = (VkFormat)ktx2->vk_format;
+  u32      n_levels     = ktx2->n_levels - first_level;
+  u32      width        = ktx2->width >> first_level ? ktx2->width >> first_level : 1;
+  u32      height       = ktx2->height >> first_level ? ktx2->height >> first_level : 1;
+
+  umb_gfx_upload_batch_begin();
+
+  // level sizes are whole blocks, so every level stays block aligned in the staging buffer
+  VkBuffer staging_buffer;
+  u64      staging_offset;
+  byte*    data = umbvk_upload_staging_alloc(
+      umbvk_ktx2_levels_size(ktx2, first_level),
+      &staging_buffer,
+      &staging_offset);
+
+  VkImageCreateInfo dimg_info = {
+      .sType       = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+      .imageType   = VK_IMAGE_TYPE_2D,
+      .format      = image_format,
+      .extent      = {.width = width, .height = height, .depth = 1},
+      .mipLevels   = n_levels,
+      .arrayLayers = 1,
+      .samples     = VK_SAMPLE_COUNT_1_BIT,
+      .tiling      = VK_IMAGE_TILING_OPTIMAL,
+      .usage       = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT,
+  };
+
+  VmaAllocationCreateInfo dimg_allocinfo = {
+      .usage = VMA_MEMORY_USAGE_GPU_ONLY,
+  };
+
+  umb_image_t image;
+  image.n_mips = n_levels;
+  image.format = image_format;
+  VK_CHECK(
+      vmaCreateImage(
+          _vk.allocator,
+          &dimg_info,
+          &dimg_allocinfo,
+          &image.image,
+          &image.allocation,
+          nullptr),
+      "Failed to create texture image!");
+
+  VkImageSubresourceRange range = {
+      .aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT,
+      .baseMipLevel   = 0,
+      .levelCount     = n_levels,
+      .baseArrayLayer = 0,
+      .layerCount     = 1,
+  };
+
+  umbvk_upload_push_op({
+      .type        = UMBVK_UPLOAD_IMAGE_BEGIN,
+      .dst_image   = image.image,
+      .image_range = range,
+  });
+
+  u64 level_offset = 0;
+  for (u32 level = 0; level < n_levels; ++level) {
+    const umb_ktx2_level* src = &ktx2->levels[first_level + level];
+    memcpy(data + level_offset, src->data, src->size);
+    umbvk_upload_push_op({
+        .type       = UMBVK_UPLOAD_COPY_IMAGE,
+        .src        = staging_buffer,
+        .dst_image  = image.image,
+        .image_copy = {
+            .bufferOffset      = staging_offset + level_offset,
+            .bufferRowLength   = 0,
+            .bufferImageHeight = 0,
+            .imageSubresource =
+                {
+                    .aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT,
+                    .mipLevel       = level,
+                    .baseArrayLayer = 0,
+                    .layerCount     = 1,
+                },
+            .imageExtent =
+                {
+                    .width  = width >> level ? width >> level : 1,
+                    .height = height >> level ? height >> level : 1,
+                    .depth  = 1,
+                },
+        },
+    });
+    level_offset += src->size;
+  }
+
+  umbvk_upload_push_op({
+      .type        = UMBVK_UPLOAD_IMAGE_END,
+      .dst_image   = image.image,
+      .image_range = range,
+  });
+
+  image.upload_value = _vk.uploader.open.value;
+  umb_gfx_upload_batch_end();
+
+  *out_image = image;
+}
+
+void umbvk_streaming_lru_unlink(umbvk_streamed_texture* stream) {
+  umbvk_texture_streaming* ts = &_vk.streaming;
+  if (stream->lru_prev) {
+    stream->lru_prev->lru_next = stream->lru_next;
+  } else {
+    ts->lru_head = stream->lru_next;
+  }
+  if (stream->lru_next) {
+    stream->lru_next->lru_prev = stream->lru_prev;
+  } else {
+    ts->lru_tail = stream->lru_prev;
+  }
+  stream->lru_prev = NULL;
+  stream->lru_next = NULL;
+}
+
+void umbvk_streaming_lru_push_front(umbvk_streamed_texture* stream) {
+  umbvk_texture_streaming* ts = &_vk.streaming;
+  stream->lru_next            = ts->lru_head;
+  if (ts->lru_head) ts->lru_head->lru_prev = stream;
+  ts->lru_head = stream;
+  if (!ts->lru_tail) ts->lru_tail = stream;
+}
+
+umb_texture umb_gfx_load_streamed_texture(str file) {
+  umbvk_streamed_texture* stream = umb_arena_push(&_vk.arena, umbvk_streamed_texture);
+  if (!umb_ktx2_load(file, &stream->ktx2)) return NULL;
+  if (!umbvk_ktx2_supported(&stream->ktx2, file)) {
+    umb_ktx2_free(&stream->ktx2);
+    return NULL;
+  }
+
+  umb_ktx2* ktx2     = &stream->ktx2;
+  u32       tail     = 0;
+  u32       max_size = ktx2->width > ktx2->height ? ktx2->width : ktx2->height;
+  while (tail + 1 < ktx2->n_levels && (max_size >> tail) > STREAMING_TAIL_SIZE) tail++;
+
+  stream->tail_level      = tail;
+  stream->resident_level  = tail;
+  stream->wanted_level    = tail;
+  stream->last_used_frame = _vk.streaming.frame;
+  umbvk_ktx2_image_create(ktx2, tail, &stream->image);
+
+  stream->texture.image      = &stream->image;
+  stream->texture.image_view = umbvk_image_view_create(&stream->image);
+  stream->texture.stream     = stream;
+  umbvk_bindless_add_texture(&stream->texture);
+
+  _vk.streaming.planned_size += umbvk_ktx2_levels_size(ktx2, tail);
+  umbvk_streaming_lru_push_front(stream);
+
+  _vk.deletion_queue.push([=]() {
+    vkDestroyImageView(_vk.device, stream->texture.image_view, nullptr);
+    vmaDestroyImage(_vk.allocator, stream->image.image, stream->image.allocation);
+    if (stream->pending) {
+      vmaDestroyImage(
+          _vk.allocator,
+          stream->pending_image.image,
+          stream->pending_image.allocation);
+    }
+    umb_ktx2_free(&stream->ktx2);
+  });
+
+  return &stream->texture;
+}
+
+void umb_gfx_report_texture_usage(umb_texture texture, f32 screen_size) {
+  umbvk_streamed_texture* stream = texture->stream;
+  if (!stream) return;
+
+  // the coarsest level that still has a texel for every pixel covered
+  const umb_ktx2* ktx2     = &stream->ktx2;
+  u32             max_size = ktx2->width > ktx2->height ? ktx2->width : ktx2->height;
+  u32             level    = 0;
+  while (level < stream->tail_level && (f32)(max_size >> (level + 1)) >= screen_size) level++;
+
+  u64 frame = _vk.streaming.frame;
+  if (stream->last_used_frame != frame || level < stream->wanted_level) {
+    stream->wanted_level = level;
+  }
+  stream->last_used_frame = frame;
+
+  umbvk_streaming_lru_unlink(stream);
+  umbvk_streaming_lru_push_front(stream);
+}
+
+void umb_gfx_set_texture_budget(u64 bytes) {
+  _vk.streaming.budget = bytes;
+}
+
+// the texture budget, or what the device local heaps have left once everything else is counted
+u64 umbvk_texture_streaming_limit() {
+  VmaBudget budgets[VK_MAX_MEMORY_HEAPS];
+  vmaGetHeapBudgets(_vk.allocator, budgets);
+
+  const VkPhysicalDeviceMemoryProperties* mem_props;
+  vmaGetMemoryProperties(_vk.allocator, &mem_props);
+
+  u64 budget = 0;
+  u64 usage  = 0;
+  for (u32 i = 0; i < mem_props->memoryHeapCount; ++i) {
+    if (!(mem_props->memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT)) continue;
+    budget += budgets[i].budget;
+    usage += budgets[i].usage;
+  }
+
+  // an eighth of the budget stays free for swapchain resizes and other allocations
+  u64 usable    = budget - budget / 8;
+  u64 available = usable > usage ? usable - usage : 0;
+  u64 limit     = _vk.streaming.planned_size + available;
+  return limit < _vk.streaming.budget ? limit : _vk.streaming.budget;
+}
+
+// builds the image holding the levels from `level` down, it replaces the resident one once its
+// upload is visible
+void umbvk_stream_texture(umbvk_streamed_texture* stream, u32 level) {
+  umbvk_texture_streaming* ts   = &_vk.streaming;
+  umb_ktx2*                ktx2 = &stream->ktx2;
+
+  u64 size = umbvk_ktx2_levels_size(ktx2, level);
+  ts->planned_size += size;
+  ts->planned_size -= umbvk_ktx2_levels_size(ktx2, stream->resident_level);
+  ts->frame_uploaded += size;
+
+  stream->pending       = true;
+  stream->pending_level = level;
+  umbvk_ktx2_image_create(ktx2, level, &stream->pending_image);
+}
+
+// shrinks textures holding finer levels than they want, least recently used first, until
+// `size` more bytes fit. textures used more recently than `keep` are left alone.
+b32 umbvk_streaming_reclaim(u64 size, u64 limit, umbvk_streamed_texture* keep) {
+  umbvk_texture_streaming* ts = &_vk.streaming;
+  for (umbvk_streamed_texture* s = ts->lru_tail; s && s != keep; s = s->lru_prev) {
+    if (ts->planned_size + size <= limit) break;
+    if (s->pending || s->resident_level >= s->wanted_level) continue;
+    umbvk_stream_texture(s, s->wanted_level);
+  }
+  return ts->planned_size + size <= limit;
+}
+
+// once per frame, after the uploads visible to it are known
+void umbvk_texture_streaming_update() {
+  umbvk_texture_streaming* ts    = &_vk.streaming;
+  umbvk_frame*             frame = &_vk.frames[_vk.frame_id];
+  if (!ts->lru_head) return;
+
+  ts->frame++;
+  ts->frame_uploaded = 0;
+
+  // the replaced image goes once the frames in flight have stopped sampling it
+  for (umbvk_streamed_texture* s = ts->lru_head; s; s = s->lru_next) {
+    if (ts->frame - s->last_used_frame > STREAMING_IDLE_FRAMES) s->wanted_level = s->tail_level;
+    if (!s->pending || s->pending_image.upload_value > _vk.uploader.visible_value) continue;
+
+    umb_image_t old_image = s->image;
+    VkImageView old_view  = s->texture.image_view;
+    frame->deletion_queue.push([=]() {
+      vkDestroyImageView(_vk.device, old_view, nullptr);
+      vmaDestroyImage(_vk.allocator, old_image.image, old_image.allocation);
+    });
+
+    s->image              = s->pending_image;
+    s->texture.image_view = umbvk_image_view_create(&s->image);
+    s->resident_level     = s->pending_level;
+    s->pending            = false;
+  }
+
+  umb_gfx_upload_batch_begin();
+
+  // over the limit, e.g. after another process took memory: the least recently used textures
+  // give up levels, idle ones down to their tail and the others one level at a time
+  u64 limit = umbvk_texture_streaming_limit();
+  for (umbvk_streamed_texture* s = ts->lru_tail; s && ts->planned_size > limit; s = s->lru_prev) {
+    if (s->pending || s->resident_level == s->tail_level) continue;
+    b32 idle = s->wanted_level == s->tail_level;
+    umbvk_stream_texture(s, idle ? s->tail_level : s->resident_level + 1);
+  }
 
-    umbvk_destroy_swapchain(&_vk.swapchain);
-    vkDestroySurfaceKHR(_vk.instance, _vk.surface, nullptr);
-    vkDestroyDevice(_vk.device, nullptr);
-    if (_vk.validation_layers_enabled) {
-      auto destroy_func = (PFN_vkDestroyDebugUtilsMessengerEXT)vkGetInstanceProcAddr(
-          _vk.instance,
-          "vkDestroyDebugUtilsMessengerEXT");
-      if (destroy_func != nullptr) destroy_func(_vk.instance, _vk.debug_messenger, nullptr);
+  // most recently used textures stream in first. the uploads of a frame are capped, past the
+  // first one, so that nothing spikes when the camera turns to a new area.
+  for (umbvk_streamed_texture* s = ts->lru_head; s; s = s->lru_next) {
+    if (s->pending || s->wanted_level >= s->resident_level) continue;
+
+    u64 frame_left = STREAMING_BYTES_PER_FRAME > ts->frame_uploaded
+                         ? STREAMING_BYTES_PER_FRAME - ts->frame_uploaded
+                         : 0;
+    u32 level      = s->wanted_level;
+    while (level + 1 < s->resident_level && umbvk_ktx2_levels_size(&s->ktx2, level) > frame_left) {
+      level++;
     }
-    vkDestroyInstance(_vk.instance, nullptr);
+    u64 size = umbvk_ktx2_levels_size(&s->ktx2, level);
+    if (ts->frame_uploaded > 0 && size > frame_left) break;
+
+    u64 growth = size - umbvk_ktx2_levels_size(&s->ktx2, s->resident_level);
+    if (!umbvk_streaming_reclaim(growth, limit, s)) continue;
+    umbvk_stream_texture(s, level);
   }
-}
 
-void umb_gfx_draw_object(umb_render_object* o) {
-  UMB_ARRAY_PUSH(_vk.render_objects, o);
+  umb_gfx_upload_batch_end();
 }
 
-void umb_gfx_register_mesh(str name, umb_mesh mesh) {
-  const u64    buffer_size    = mesh->vertices.len * sizeof(umb_mesh_vertex);
-  umbvk_buffer staging_buffer = umbvk_buffer_create_staging(buffer_size);
-
-  void* data;
-  vmaMapMemory(_vk.allocator, staging_buffer.alloc, &data);
-  memcpy(data, mesh->vertices.data, buffer_size);
-  vmaUnmapMemory(_vk.allocator, staging_buffer.alloc);
-
-  mesh->vertex_buffer =
-      umbvk_buffer_create_transfer(buffer_size, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT);
-
-  umbvk_cmd_immediate([=](VkCommandBuffer cmd) {
-    VkBufferCopy copy = {
-        .dstOffset = 0,
-        .srcOffset = 0,
-        .size      = buffer_size,
-    };
-    vkCmdCopyBuffer(cmd, staging_buffer.buffer, mesh->vertex_buffer.buffer, 1, &copy);
-  });
+// copies the instance slots changed since the last frame into the instance buffer and clears the
+// frame's draw counts. recorded before the cull pass.
+void umbvk_cmd_update_instances(umbvk_cmd_buffer* cmd) {
+  umbvk_instances* inst = &_vk.instances;
+  if (!inst->supported) return;
 
-  umb_hash_table_insert(&_vk.meshes, name, (byte*)mesh);
-}
+  umbvk_frame* frame = &_vk.frames[_vk.frame_id];
 
-void umb_gfx_register_material(str name, umb_material* mat) {
-  umb_hash_table_insert(&_vk.materials, name, (byte*)mat);
-}
+  // the previous frames' cull passes read the slots and counts about to be written
+  VkMemoryBarrier read_barrier = {
+      .sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+      .srcAccessMask = VK_ACCESS_SHADER_READ_BIT,
+      .dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+  };
+  vkCmdPipelineBarrier(
+      cmd->cmd_buff,
+      VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT,
+      VK_PIPELINE_STAGE_TRANSFER_BIT,
+      0,
+      1,
+      &read_barrier,
+      0,
+      nullptr,
+      0,
+      nullptr);
+  vkCmdFillBuffer(cmd->cmd_buff, frame->instance_count_buffer.buffer, 0, VK_WHOLE_SIZE, 0);
 
-umb_mesh umb_gfx_get_mesh(str name) {
-  return (umb_mesh)umb_hash_table_get(&_vk.meshes, name);
-}
-umb_material* umb_gfx_get_material(str name) {
-  return (umb_material*)umb_hash_table_get(&_vk.materials, name);
-}
+  // slots removed since they were marked are dropped, the rest are sorted so neighbouring slots
+  // are staged and copied as one range
+  umb_scope_arena scope(&_vk.arena);
+  u64*            slots   = umb_arena_push_array(&_vk.arena, u64, inst->n_dirty * 2);
+  u32*            order   = umb_arena_push_array(&_vk.arena, u32, inst->n_dirty * 2);
+  u32             n_slots = 0;
+  for (u32 i = 0; i < inst->n_dirty; ++i) {
+    u32 slot = inst->dirty_slots[i];
+    if (slot >= inst->n_instances) {
+      inst->dirty[slot]      = false;
+      inst->reassigned[slot] = false;
+      continue;
+    }
+    slots[n_slots] = slot;
+    order[n_slots] = n_slots;
+    n_slots++;
+  }
+  inst->n_dirty = 0;
+  umb_radix_sort_u64(slots, order, slots + n_slots, order + n_slots, n_slots);
+
+  // updates past the per-frame limit, or that do not fit the transient buffer, wait a frame
+  u32   n_updates  = n_slots;
+  u32   src_offset = 0;
+  byte* src        = NULL;
+  if (n_updates > MAX_INSTANCE_UPDATES_PER_FRAME) n_updates = MAX_INSTANCE_UPDATES_PER_FRAME;
+  if (n_updates > 0) {
+    src = umbvk_frame_push(frame, sizeof(umb_gpu_instance_data) * n_updates, &src_offset);
+  }
+  if (!src) n_updates = 0;
+
+  VkBufferCopy* regions   = umb_arena_push_array(&_vk.arena, VkBufferCopy, n_updates);
+  u32           n_regions = 0;
+  for (u32 i = 0; i < n_updates;) {
+    u32 first = (u32)slots[i];
+    u32 n_run = 1;
+    while (i + n_run < n_updates && slots[i + n_run] == first + n_run) n_run++;
+
+    memcpy(
+        src + sizeof(umb_gpu_instance_data) * i,
+        &inst->data[first],
+        sizeof(umb_gpu_instance_data) * n_run);
+    regions[n_regions++] = {
+        .srcOffset = src_offset + sizeof(umb_gpu_instance_data) * i,
+        .dstOffset = sizeof(umb_gpu_instance_data) * first,
+        .size      = sizeof(umb_gpu_instance_data) * n_run,
+    };
+    for (u32 r = i; r < i + n_run; ++r) {
+      inst->dirty[slots[r]]      = false;
+      inst->reassigned[slots[r]] = false;
+    }
+    i += n_run;
+  }
 
-umb_mesh umb_mesh_create(u32 n_vertices) {
-  umb_mesh mesh  = umb_arena_push(&_vk.arena, umb_mesh_t);
-  mesh->vertices = UMB_ARRAY_CREATE(umb_mesh_vertex, &_vk.arena, n_vertices);
-  return mesh;
+  // the GPU copy of a waiting reassigned slot still counts towards its old bucket, whose draw
+  // range may have shrunk. its bucket is invalidated once, inline, so it cannot spill into the
+  // next bucket's draws.
+  u32 invalid_bucket = INVALID_INSTANCE_BUCKET;
+  for (u32 i = n_updates; i < n_slots; ++i) {
+    u32 slot                           = (u32)slots[i];
+    inst->dirty_slots[inst->n_dirty++] = slot;
+    if (!inst->reassigned[slot]) continue;
+
+    vkCmdUpdateBuffer(
+        cmd->cmd_buff,
+        inst->buffer.buffer,
+        sizeof(umb_gpu_instance_data) * slot + offsetof(umb_gpu_instance_data, bucket),
+        sizeof(invalid_bucket),
+        &invalid_bucket);
+    inst->reassigned[slot] = false;
+  }
+
+  if (n_regions > 0) {
+    vkCmdCopyBuffer(
+        cmd->cmd_buff,
+        frame->transient.buffer.buffer,
+        inst->buffer.buffer,
+        n_regions,
+        regions);
+  }
+
+  VkMemoryBarrier write_barrier = {
+      .sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+      .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+      .dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+  };
+  vkCmdPipelineBarrier(
+      cmd->cmd_buff,
+      VK_PIPELINE_STAGE_TRANSFER_BIT,
+      VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+      0,
+      1,
+      &write_barrier,
+      0,
+      nullptr,
+      0,
+      nullptr);
 }
 
-void umb_mesh_push_vertex(umb_mesh mesh, umb_mesh_vertex vertex) {
-  UMB_ARRAY_PUSH(mesh->vertices, vertex);
+// the frame's table of every registered mesh's bounds and LOD ranges, meshes the frame cannot see
+// yet have no LODs
+void umbvk_write_mesh_table(umbvk_frame* frame) {
+  umbvk_instances* inst = &_vk.instances;
+
+  b32 pending = frame->mesh_visible_value < inst->mesh_upload_value &&
+                frame->mesh_visible_value != _vk.uploader.visible_value;
+  if (frame->mesh_version == inst->mesh_version && !pending) return;
+
+  umb_gpu_mesh_data* table = (umb_gpu_mesh_data*)frame->mesh_table_buffer.mapped;
+  for (u32 i = 0; i < _vk.geometry.n_meshes; ++i) {
+    umb_mesh           mesh = _vk.geometry.meshes[i];
+    umb_gpu_mesh_data* dst  = &table[i];
+    dst->bounds             = mesh->bounds;
+    dst->vertex_offset      = (i32)mesh->vertex_alloc.offset;
+    dst->n_lods = mesh->upload_value <= _vk.uploader.visible_value ? mesh->n_lods : 0;
+    for (u32 l = 0; l < mesh->n_lods; ++l) {
+      dst->lods[l] = {
+          .first_index = mesh->index_alloc.offset + mesh->lods[l].first_index,
+          .index_count = mesh->lods[l].index_count,
+          .error       = mesh->lods[l].error,
+      };
+    }
+  }
+  frame->mesh_version       = inst->mesh_version;
+  frame->mesh_visible_value = _vk.uploader.visible_value;
 }
 
-// TODO(bryson): roll your own .obj parser?
-// Regretably we must include some C++
-#include <vector>
-umb_mesh umb_mesh_load_from_obj(str filename) {
-  tinyobj::attrib_t attrib;
+// culls every instance against the frustum and selects its LOD, writing one draw command and the
+// object data per visible instance into its pipeline bucket
+void umbvk_cmd_cull_instances(umbvk_cmd_buffer* cmd) {
+  umbvk_instances* inst = &_vk.instances;
+  if (!inst->supported || inst->n_instances == 0) return;
 
-  std::vector<tinyobj::shape_t>    shapes;
-  std::vector<tinyobj::material_t> materials;
+  umbvk_frame* frame = &_vk.frames[_vk.frame_id];
+  umbvk_write_mesh_table(frame);
 
-  std::string warn;
-  std::string err;
+  umbvk_cmd_bind_compute_pipeline(cmd, &inst->cull_pipeline);
+  umbvk_cmd_bind_cmp_descriptor_sets(cmd, 0, &frame->global_descriptor, 2, frame->global_offsets);
+  umbvk_cmd_bind_cmp_descriptor_sets(cmd, 1, &frame->instance_descriptor, 0, nullptr);
 
-  tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, filename, nullptr);
-  if (!warn.empty()) { printf("tinobjloader: %s", warn.c_str()); }
-  if (!err.empty()) {
-    UMBI_LOG_ERROR("tinobjloader: %s", err.c_str());
-    return NULL;
+  umbvk_instance_cull_constants constants = {
+      .instance_count = inst->n_instances,
+      .proj_scale =
+          glm::abs(_vk.camera.proj[1][1]) * 0.5f * (f32)_vk.swapchain.extent.height,
+      .lod_error_threshold = _vk.lod_error_threshold,
+  };
+  u32 offset = 0;
+  for (u32 b = 0; b < inst->n_buckets; ++b) {
+    constants.bucket_offsets[b] = offset;
+    offset += inst->bucket_sizes[b];
   }
+  vkCmdPushConstants(
+      cmd->cmd_buff,
+      inst->cull_pipeline.pipeline_layout,
+      VK_SHADER_STAGE_COMPUTE_BIT,
+      0,
+      sizeof(umbvk_instance_cull_constants),
+      &constants);
+  umbvk_cmd_dispatch(cmd, (inst->n_instances + 63) / 64, 1, 1);
+
+  VkMemoryBarrier barrier = {
+      .sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+      .srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT,
+      .dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_SHADER_READ_BIT,
+  };
+  vkCmdPipelineBarrier(
+      cmd->cmd_buff,
+      VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+      VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT,
+      0,
+      1,
+      &barrier,
+      0,
+      nullptr,
+      0,
+      nullptr);
+}
 
-  const int fv = 3;
+// one indirect draw per pipeline bucket, as many commands as the cull pass counted
+void umbvk_cmd_draw_instances(umbvk_cmd_buffer* cmd) {
+  umbvk_instances* inst = &_vk.instances;
+  if (!inst->supported || inst->n_instances == 0) return;
 
-  u64 n_vertices = 0;
-  for (u64 s = 0; s < shapes.size(); ++s) {
-    n_vertices += fv * shapes[s].mesh.num_face_vertices.size();
-  }
+  umbvk_frame* frame = &_vk.frames[_vk.frame_id];
 
-  umb_mesh mesh = umb_mesh_create(n_vertices);
-  for (u64 s = 0; s < shapes.size(); ++s) {
-    u64 index_offset = 0;
-    for (u64 f = 0; f < shapes[s].mesh.num_face_vertices.size(); ++f) {
-      // 3 for triangle!
-      for (u64 v = 0; v < fv; ++v) {
-        tinyobj::index_t idx = shapes[s].mesh.indices[index_offset + v];
+  VkDeviceSize offset = 0;
+  umbvk_cmd_bind_vertex_buffer(cmd, 0, 1, &_vk.geometry.vertex_buffer.buffer, &offset);
+  umbvk_cmd_bind_index_buffer(cmd, _vk.geometry.index_buffer.buffer, 0);
 
-        // vertex position
-        tinyobj::real_t vx = attrib.vertices[3 * idx.vertex_index + 0];
-        tinyobj::real_t vy = attrib.vertices[3 * idx.vertex_index + 1];
-        tinyobj::real_t vz = attrib.vertices[3 * idx.vertex_index + 2];
+  u32 first_draw    = 0;
+  u32 object_offset = 0;
+  for (u32 b = 0; b < inst->n_buckets; ++b) {
+    u32 n_draws = inst->bucket_sizes[b];
+    if (n_draws == 0) continue;
 
-        // vertex normal
-        tinyobj::real_t nx = attrib.normals[3 * idx.normal_index + 0];
-        tinyobj::real_t ny = attrib.normals[3 * idx.normal_index + 1];
-        tinyobj::real_t nz = attrib.normals[3 * idx.normal_index + 2];
+    umbvk_cmd_bind_graphics_pipeline(cmd, &inst->pipelines[b]);
+    umbvk_cmd_bind_gfx_descriptor_sets_offset(
+        cmd,
+        0,
+        &frame->global_descriptor,
+        2,
+        frame->global_offsets);
+    umbvk_cmd_bind_gfx_descriptor_sets_offset(
+        cmd,
+        1,
+        &frame->instance_object_descriptor,
+        1,
+        &object_offset);
+    umbvk_cmd_bind_gfx_descriptor_sets(cmd, 2, &frame->bindless_descriptor);
+
+    vkCmdDrawIndexedIndirectCount(
+        cmd->cmd_buff,
+        frame->instance_draw_buffer.buffer,
+        sizeof(VkDrawIndexedIndirectCommand) * first_draw,
+        frame->instance_count_buffer.buffer,
+        sizeof(u32) * b,
+        n_draws,
+        sizeof(VkDrawIndexedIndirectCommand));
+    first_draw += n_draws;
+  }
+}
 
-        // vertex uv
-        tinyobj::real_t ux = attrib.texcoords[2 * idx.texcoord_index + 0];
-        tinyobj::real_t uy = attrib.texcoords[2 * idx.texcoord_index + 1];
+// sets the dynamic state a secondary does not inherit from the primary
+void umbvk_cmd_begin_draws(umbvk_cmd_buffer* cmd, VkFramebuffer framebuffer) {
+  umbvk_cmd_begin_secondary(cmd, framebuffer, VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+  umbvk_cmd_viewport(cmd, 0, 0, _vk.swapchain.extent.width, _vk.swapchain.extent.height);
+  umbvk_cmd_scissor(cmd, 0, 0, _vk.swapchain.extent.width, _vk.swapchain.extent.height);
+}
 
-        // copy it into our vertex
-        umb_mesh_vertex new_vert;
-        new_vert.position.x = vx;
-        new_vert.position.y = vy;
-        new_vert.position.z = vz;
+void umbvk_record_draws_job(void* data) {
+  umbvk_record_job* job = (umbvk_record_job*)data;
+  umbvk_cmd_begin_draws(job->cmd, job->framebuffer);
+  umbvk_cmd_draw_objects(job->cmd, job->first, job->end);
+  umbvk_cmd_end(job->cmd);
+}
 
-        new_vert.normal.x = nx;
-        new_vert.normal.y = ny;
-        new_vert.normal.z = nz;
+// splits the draw list into one slice per thread, at most, and starts recording the slices into
+// the frame's secondaries while the render thread records the primary
+void umbvk_record_draws_begin(umbvk_frame* frame, u32 image_idx) {
+  u32 n_threads = umb_job_system_worker_count() + 1;
+  u32 n_jobs    = (_vk.n_draws + RECORD_JOB_SIZE - 1) / RECORD_JOB_SIZE;
+  n_jobs        = n_jobs > n_threads ? n_threads : n_jobs;
+  n_jobs        = n_jobs > MAX_RECORD_JOBS ? MAX_RECORD_JOBS : n_jobs;
+  u32 job_size  = n_jobs ? (_vk.n_draws + n_jobs - 1) / n_jobs : 0;
+  n_jobs        = n_jobs ? (_vk.n_draws + job_size - 1) / job_size : 0;
+
+  frame->n_draw_cmds = n_jobs;
+  for (u32 j = 0; j < n_jobs; ++j) {
+    u32 first          = j * job_size;
+    _vk.record_jobs[j] = {
+        .cmd         = &frame->draw_cmds[j],
+        .framebuffer = _vk.swapchain.framebuffers[image_idx],
+        .first       = first,
+        .end         = _vk.n_draws - first < job_size ? _vk.n_draws : first + job_size,
+    };
+    umb_job_run(umbvk_record_draws_job, &_vk.record_jobs[j], &_vk.record_counter);
+  }
+}
 
-        new_vert.uv.x = ux;
-        new_vert.uv.y = 1 - uy;
+// records the instance draws, waits for the draw list slices and executes them all. must be inside
+// a render pass begun with VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS.
+void umbvk_cmd_execute_draws(umbvk_cmd_buffer* cmd, u32 image_idx) {
+  umbvk_frame* frame = &_vk.frames[_vk.frame_id];
 
-        // we are setting the vertex color as the vertex normal. This is just for display purposes
-        new_vert.color = new_vert.normal;
+  VkCommandBuffer secondaries[MAX_RECORD_JOBS + 2];
+  u32             n_secondaries = 0;
+  if (_vk.statics.supported && _vk.statics.n_draws > 0) {
+    secondaries[n_secondaries++] = frame->static_cmd.cmd_buff;
+  }
 
-        umb_mesh_push_vertex(mesh, new_vert);
-      }
-      index_offset += fv;
-    }
+  if (_vk.instances.supported && _vk.instances.n_instances > 0) {
+    umbvk_cmd_begin_draws(&frame->instance_cmd, _vk.swapchain.framebuffers[image_idx]);
+    umbvk_cmd_draw_instances(&frame->instance_cmd);
+    umbvk_cmd_end(&frame->instance_cmd);
   }
 
-  return mesh;
+  umb_job_wait(&_vk.record_counter);
+  for (u32 j = 0; j < frame->n_draw_cmds; ++j) {
+    secondaries[n_secondaries++] = frame->draw_cmds[j].cmd_buff;
+  }
+  if (_vk.instances.supported && _vk.instances.n_instances > 0) {
+    secondaries[n_secondaries++] = frame->instance_cmd.cmd_buff;
+  }
+
+  if (n_secondaries > 0) vkCmdExecuteCommands(cmd->cmd_buff, n_secondaries, secondaries);
 }
 
 void umb_gfx_draw_frame() {
@@ -1967,6 +6005,8 @@ void umb_gfx_draw_frame() {
   umbvk_cmd_buffer* cmd   = &frame->cmd;
 
   vkWaitForFences(_vk.device, 1, &frame->render_fence, VK_TRUE, UINT64_MAX);
+  frame->deletion_queue.flush();
+  frame->transient.head = 0;
 
   u32      image_index;
   VkResult result = vkAcquireNextImageKHR(
@@ -1988,32 +6028,56 @@ void umb_gfx_draw_frame() {
 
   // Record Command Buffer
   vkResetCommandBuffer(cmd->cmd_buff, 0);
+  for (u32 j = 0; j < frame->n_draw_cmds; ++j) {
+    vkResetCommandPool(_vk.device, frame->draw_cmds[j].cmd_pool, 0);
+  }
+  vkResetCommandBuffer(frame->instance_cmd.cmd_buff, 0);
 
-  umbvk_cmd_begin(cmd);
-  umbvk_cmd_render_pass_begin(cmd, image_index);
-
-  umbvk_cmd_viewport(cmd, 0, 0, _vk.swapchain.extent.width, _vk.swapchain.extent.height);
-  umbvk_cmd_scissor(cmd, 0, 0, _vk.swapchain.extent.width, _vk.swapchain.extent.height);
-
-  umbvk_cmd_draw_objects(cmd);
+  umbvk_upload_poll();
+  umbvk_texture_streaming_update();
+  umbvk_bindless_update(frame);
+  umbvk_update_frame_data();
+  umbvk_record_draws_begin(frame, image_index);
 
+  umbvk_cmd_begin(cmd);
+  umbvk_cmd_acquire_uploads(cmd);
+  umbvk_cmd_update_instances(cmd);
+  umbvk_cmd_cull_instances(cmd);
+  umbvk_cmd_cull_clusters(cmd);
+  umbvk_cmd_render_pass_begin(cmd, image_index, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+  umbvk_cmd_execute_draws(cmd, image_index);
   umbvk_cmd_render_pass_end(cmd);
   umbvk_cmd_end(cmd);
 
   // Present
   VkSemaphore wait_semaphores[] = {
       frame->image_available_semaphore,
+      _vk.uploader.timeline,
   };
   VkSemaphore signal_semaphores[] = {
       frame->render_finished_semaphore,
   };
   VkPipelineStageFlags wait_stages[] = {
       VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+      VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+  };
+
+  // the binary semaphores ignore their values
+  u64 wait_values[]   = {0, _vk.uploader.visible_value};
+  u64 signal_values[] = {0};
+
+  VkTimelineSemaphoreSubmitInfo timeline_info = {
+      .sType                     = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO,
+      .waitSemaphoreValueCount   = 2,
+      .pWaitSemaphoreValues      = wait_values,
+      .signalSemaphoreValueCount = 1,
+      .pSignalSemaphoreValues    = signal_values,
   };
 
   VkSubmitInfo submit_info {
       .sType                = VK_STRUCTURE_TYPE_SUBMIT_INFO,
-      .waitSemaphoreCount   = 1,
+      .pNext                = &timeline_info,
+      .waitSemaphoreCount   = 2,
       .pWaitSemaphores      = wait_semaphores,
       .pWaitDstStageMask    = wait_stages,
       .commandBufferCount   = 1,
@@ -2022,6 +6086,7 @@ void umb_gfx_draw_frame() {
       .pSignalSemaphores    = signal_semaphores,
   };
 
+  std::unique_lock<std::mutex> queue_lock(_vk.queue_mutex);
   VK_CHECK(
       vkQueueSubmit(_vk.graphics_queue, 1, &submit_info, frame->render_fence),
       "failed to submit draw command buffer!");
@@ -2038,6 +6103,7 @@ void umb_gfx_draw_frame() {
   };
 
   result = vkQueuePresentKHR(_vk.present_queue, &present_info);
+  queue_lock.unlock();
   if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR ||
       _vk.framebuffer_resized) {
     _vk.framebuffer_resized = false;
@@ -2056,71 +6122,80 @@ void umb_gfx_framebuffer_resized() {
 
 void umb_gfx_register_texture(str name, umb_image image) {
   umb_texture tex = umb_arena_push(&_vk.arena, umb_texture_t);
+  tex->image      = image;
+  tex->image_view = umbvk_image_view_create(image);
+  umbvk_bindless_add_texture(tex);
 
-  VkImageViewCreateInfo image_info {
-      .sType    = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
-      .image    = image->image,
-      .viewType = VK_IMAGE_VIEW_TYPE_2D,
-      .format   = VK_FORMAT_R8G8B8A8_SRGB,
-      .components =
-          {
-              .r = VK_COMPONENT_SWIZZLE_IDENTITY,
-              .g = VK_COMPONENT_SWIZZLE_IDENTITY,
-              .b = VK_COMPONENT_SWIZZLE_IDENTITY,
-              .a = VK_COMPONENT_SWIZZLE_IDENTITY,
-          },
-      .subresourceRange =
-          {
-              .aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT,
-              .baseMipLevel   = 0,
-              .levelCount     = 1,
-              .baseArrayLayer = 0,
-              .layerCount     = 1,
-          },
-  };
+  umb_texture_t* texture = tex;
+  _vk.deletion_queue.push([=]() { vkDestroyImageView(_vk.device, texture->image_view, nullptr); });
 
-  vkCreateImageView(_vk.device, &image_info, nullptr, &tex->image_view);
   umb_hash_table_insert(&_vk.textures, name, (byte*)tex);
 }
 
-b32 umb_gfx_load_image_from_file(str file, umb_image out_image) {
-  int      tex_width, tex_height, tex_channels;
-  stbi_uc* pixels = stbi_load(file, &tex_width, &tex_height, &tex_channels, STBI_rgb_alpha);
-  if (!pixels) {
-    printf("Failed to load texture from file: %s\n", file);
+// whether the GPU can build a mip chain of `format` by linearly filtered blits
+b32 umbvk_format_supports_linear_blit(VkFormat format) {
+  VkFormatProperties props;
+  vkGetPhysicalDeviceFormatProperties(_vk.physical_device, format, &props);
+
+  const VkFormatFeatureFlags needed = VK_FORMAT_FEATURE_BLIT_SRC_BIT |
+                                      VK_FORMAT_FEATURE_BLIT_DST_BIT |
+                                      VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+  return (props.optimalTilingFeatures & needed) == needed;
+}
+
+// block-compressed levels from umbral-texc, copied into the image without any decoding
+b32 umbvk_load_image_from_ktx2(str file, umb_image out_image) {
+  umb_ktx2 ktx2;
+  if (!umb_ktx2_load(file, &ktx2)) return false;
+  if (!umbvk_ktx2_supported(&ktx2, file)) {
+    umb_ktx2_free(&ktx2);
     return false;
   }
 
-  void*        pixel_ptr  = pixels;
-  VkDeviceSize image_size = tex_width * tex_height * 4;
+  umb_image_t image;
+  umbvk_ktx2_image_create(&ktx2, 0, &image);
+  umb_ktx2_free(&ktx2);
 
-  VkFormat image_format = VK_FORMAT_R8G8B8A8_SRGB;
+  _vk.deletion_queue.push([=]() { vmaDestroyImage(_vk.allocator, image.image, image.allocation); });
+
+  *out_image = image;
 
-  umbvk_buffer staging_buffer = umbvk_buffer_create_staging(image_size);
+  return true;
+}
 
-  void* data;
-  vmaMapMemory(_vk.allocator, staging_buffer.alloc, &data);
-  memcpy(data, pixel_ptr, (u64)image_size);
-  vmaUnmapMemory(_vk.allocator, staging_buffer.alloc);
+u64 umbvk_decoded_size(const umb_image_decode* decode) {
+  u64 size = 0;
+  for (u32 level = 0; level < decode->n_levels; ++level) {
+    size += umb_image_level_size(decode->width, decode->height, level);
+  }
+  return size;
+}
 
-  stbi_image_free(pixels);
+// creates the image for a decode that has landed in staging memory and queues its copies
+void umbvk_upload_decoded_image(
+    const umb_image_decode* decode,
+    VkBuffer                staging_buffer,
+    u64                     staging_offset,
+    umb_image               out_image) {
+  VkFormat image_format = VK_FORMAT_R8G8B8A8_SRGB;
+  u32      width        = decode->width;
+  u32      height       = decode->height;
+  u32      n_mips       = umb_image_mip_count(width, height);
+  b32      gpu_mips     = decode->n_levels < n_mips;
 
-  VkExtent3D image_extent = {
-      .width  = (u32)tex_width,
-      .height = (u32)tex_height,
-      .depth  = 1,
-  };
+  VkImageUsageFlags usage = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+  if (gpu_mips) usage |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
 
   VkImageCreateInfo dimg_info = {
       .sType       = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
       .imageType   = VK_IMAGE_TYPE_2D,
       .format      = image_format,
-      .extent      = image_extent,
-      .mipLevels   = 1,
+      .extent      = {.width = width, .height = height, .depth = 1},
+      .mipLevels   = n_mips,
       .arrayLayers = 1,
       .samples     = VK_SAMPLE_COUNT_1_BIT,
       .tiling      = VK_IMAGE_TILING_OPTIMAL,
-      .usage       = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT,
+      .usage       = usage,
   };
 
   VmaAllocationCreateInfo dimg_allocinfo = {
@@ -2128,6 +6203,8 @@ b32 umb_gfx_load_image_from_file(str file, umb_image out_image) {
   };
 
   umb_image_t image;
+  image.n_mips = n_mips;
+  image.format = image_format;
   vmaCreateImage(
       _vk.allocator,
       &dimg_info,
@@ -2136,85 +6213,132 @@ b32 umb_gfx_load_image_from_file(str file, umb_image out_image) {
       &image.allocation,
       nullptr);
 
-  umbvk_cmd_immediate([&](VkCommandBuffer cmd) {
-    VkImageSubresourceRange range = {
-        .aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT,
-        .baseMipLevel   = 0,
-        .levelCount     = 1,
-        .baseArrayLayer = 0,
-        .layerCount     = 1,
-    };
-
-    VkImageMemoryBarrier image_barrier_to_transfer = {
-        .sType            = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
-        .oldLayout        = VK_IMAGE_LAYOUT_UNDEFINED,
-        .newLayout        = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-        .image            = image.image,
-        .subresourceRange = range,
-        .srcAccessMask    = 0,
-        .dstAccessMask    = VK_ACCESS_TRANSFER_WRITE_BIT,
-    };
-
-    vkCmdPipelineBarrier(
-        cmd,
-        VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
-        VK_PIPELINE_STAGE_TRANSFER_BIT,
-        0,
-        0,
-        nullptr,
-        0,
-        nullptr,
-        1,
-        &image_barrier_to_transfer);
-
-    VkBufferImageCopy copy_region = {
-        .bufferOffset      = 0,
-        .bufferRowLength   = 0,
-        .bufferImageHeight = 0,
-        .imageSubresource =
-            {
-                .aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT,
-                .mipLevel       = 0,
-                .baseArrayLayer = 0,
-                .layerCount     = 1,
-            },
-        .imageExtent = image_extent,
-    };
+  VkImageSubresourceRange range = {
+      .aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT,
+      .baseMipLevel   = 0,
+      .levelCount     = n_mips,
+      .baseArrayLayer = 0,
+      .layerCount     = 1,
+  };
 
-    vkCmdCopyBufferToImage(
-        cmd,
-        staging_buffer.buffer,
-        image.image,
-        VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-        1,
-        &copy_region);
+  umbvk_upload_push_op({
+      .type        = UMBVK_UPLOAD_IMAGE_BEGIN,
+      .dst_image   = image.image,
+      .image_range = range,
+  });
 
-    VkImageMemoryBarrier image_barrier_to_readable = {
-        .sType            = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
-        .oldLayout        = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-        .newLayout        = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-        .image            = image.image,
-        .subresourceRange = range,
-        .srcAccessMask    = VK_ACCESS_TRANSFER_WRITE_BIT,
-        .dstAccessMask    = VK_ACCESS_SHADER_READ_BIT,
-    };
+  u64 level_offset = staging_offset;
+  for (u32 level = 0; level < decode->n_levels; ++level) {
+    umbvk_upload_push_op({
+        .type       = UMBVK_UPLOAD_COPY_IMAGE,
+        .src        = staging_buffer,
+        .dst_image  = image.image,
+        .image_copy = {
+            .bufferOffset      = level_offset,
+            .bufferRowLength   = 0,
+            .bufferImageHeight = 0,
+            .imageSubresource =
+                {
+                    .aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT,
+                    .mipLevel       = level,
+                    .baseArrayLayer = 0,
+                    .layerCount     = 1,
+                },
+            .imageExtent =
+                {
+                    .width  = width >> level ? width >> level : 1,
+                    .height = height >> level ? height >> level : 1,
+                    .depth  = 1,
+                },
+        },
+    });
+    level_offset += umb_image_level_size(width, height, level);
+  }
 
-    vkCmdPipelineBarrier(
-        cmd,
-        VK_PIPELINE_STAGE_TRANSFER_BIT,
-        VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
-        0,
-        0,
-        nullptr,
-        0,
-        nullptr,
-        1,
-        &image_barrier_to_readable);
+  umbvk_upload_push_op({
+      .type        = UMBVK_UPLOAD_IMAGE_END,
+      .dst_image   = image.image,
+      .blit_extent = gpu_mips ? VkExtent2D {width, height} : VkExtent2D {},
+      .image_range = range,
   });
 
+  image.upload_value = _vk.uploader.open.value;
+
   _vk.deletion_queue.push([=]() { vmaDestroyImage(_vk.allocator, image.image, image.allocation); });
 
   *out_image = image;
+}
 
-  return true;
+b32 umb_gfx_load_images_from_files(const str* files, umb_image* out_images, u32 n_images) {
+  umb_image_decode* decodes = (umb_image_decode*)calloc(n_images, sizeof(umb_image_decode));
+  umb_job_counter   counter = {};
+  b32               ok      = true;
+
+  // headers are read up front, they size the staging memory the pixels are decoded into
+  for (u32 i = 0; i < n_images; ++i) {
+    u64 name_len = strlen(files[i]);
+    if (name_len > 5 && strcmp(files[i] + name_len - 5, ".ktx2") == 0) {
+      ok = umbvk_load_image_from_ktx2(files[i], out_images[i]) && ok;
+      continue;
+    }
+    decodes[i].file = files[i];
+    umb_job_run(umb_image_info_job, &decodes[i], &counter);
+  }
+  umb_job_wait(&counter);
+
+  // the chain is blitted on the GPU from level 0. formats without linear blits get it built on
+  // the CPU and uploaded level by level.
+  b32 gpu_mips = umbvk_format_supports_linear_blit(VK_FORMAT_R8G8B8A8_SRGB);
+  for (u32 i = 0; i < n_images; ++i) {
+    if (!decodes[i].ok) continue;
+    u32 n_mips          = umb_image_mip_count(decodes[i].width, decodes[i].height);
+    decodes[i].n_levels = gpu_mips ? 1 : n_mips;
+  }
+
+  // images are decoded in waves that fit in half the staging ring, so the next wave decodes
+  // while the copies of the last one execute. an image bigger than that is a wave of its own.
+  for (u32 next = 0; next < n_images;) {
+    u32 first     = next;
+    u64 wave_size = 0;
+    for (; next < n_images; ++next) {
+      if (!decodes[next].ok) continue;
+      u64 size = umbvk_decoded_size(&decodes[next]);
+      if (wave_size > 0 && wave_size + size > MAX_DECODE_WAVE_SIZE) break;
+      wave_size += size;
+    }
+    if (wave_size == 0) continue;
+
+    umb_gfx_upload_batch_begin();
+
+    VkBuffer staging_buffer;
+    u64      staging_offset;
+    byte*    data = umbvk_upload_staging_alloc(wave_size, &staging_buffer, &staging_offset);
+
+    // workers write the pixels straight into the staging memory of their image
+    u64 offset = 0;
+    for (u32 i = first; i < next; ++i) {
+      if (!decodes[i].ok) continue;
+      decodes[i].dst = (u8*)data + offset;
+      offset += umbvk_decoded_size(&decodes[i]);
+      umb_job_run(umb_image_decode_job, &decodes[i], &counter);
+    }
+    umb_job_wait(&counter);
+
+    for (u32 i = first; i < next; ++i) {
+      if (!decodes[i].ok) continue;
+      u64 image_offset = staging_offset + (u64)(decodes[i].dst - (u8*)data);
+      umbvk_upload_decoded_image(&decodes[i], staging_buffer, image_offset, out_images[i]);
+    }
+
+    umb_gfx_upload_batch_end();
+  }
+
+  for (u32 i = 0; i < n_images; ++i) ok = ok && (!decodes[i].file || decodes[i].ok);
+  free(decodes);
+
+  return ok;
+}
+
+b32 umb_gfx_load_image_from_file(str file, umb_image out_image) {
+  return umb_gfx_load_images_from_files(&file, &out_image, 1);
 }
@@ -18,10 +18,13 @@ static umb_render_object triangle;
 
 static umb_mesh          monkey_mesh;
 static umb_render_object monkey;
+static umb_transform     monkey_node;
 
 void start(umb_app* app) {
   UMBI_LOG_INFO("Starting [umbral]...");
 
+  umb_gfx_upload_batch_begin();
+
   triangle_mesh = umb_mesh_create(3);
 
   umb_mesh_push_vertex(
@@ -51,9 +54,17 @@ void start(umb_app* app) {
   umb_mesh monk_mesh = umb_mesh_load_from_obj("res/models/monkey_smooth.obj");
   umb_gfx_register_mesh("monkey_mesh", monk_mesh);
 
-  monkey.mesh      = umb_gfx_get_mesh("monkey_mesh");
-  monkey.material  = umb_gfx_get_material("default");
-  monkey.transform = glm::translate(glm::mat4(1), glm::vec3(0.0f, 5.0f, 0.0f));
+  umb_gfx_upload_batch_end();
+
+  monkey.mesh     = umb_gfx_get_mesh("monkey_mesh");
+  monkey.material = umb_gfx_get_material("default");
+
+  umb_transform_hierarchy* transforms = umb_gfx_transforms();
+  monkey_node = umb_transform_create(transforms, UMB_TRANSFORM_NONE);
+  umb_transform_set_position(transforms, monkey_node, 0.0f, 5.0f, 0.0f);
+
+  // umb_gfx_draw_object(&triangle);
+  umb_gfx_attach_transform(umb_gfx_draw_object(&monkey), monkey_node);
 }
 
 void update(umb_app* app) {
@@ -70,9 +81,6 @@ int main(void) {
   umb_app app;
   umb_app_init(&app, "[umbral]", 640, 480, start, update, shutdown);
 
-  // umb_gfx_draw_object(&triangle);
-  umb_gfx_draw_object(&monkey);
-
   umb_app_run(&app);
 
   umb_shutdown();
@@ -1,5 +1,6 @@
 #include <SDL2/SDL.h>
 #include <core/umb_common.h>
+#include <core/umb_job.h>
 #include <gfx/umb_gfx.h>
 
 umb_error umb_init(umb_init_info* init_info) {
@@ -10,6 +11,7 @@ umb_error umb_init(umb_init_info* init_info) {
   }
 
   if (init_info) umbi_log_info.log_proc = init_info->log_proc;
+  umb_job_system_init(umb_job_system_default_worker_count());
 
   return err;
 }
@@ -71,5 +73,6 @@ void umb_app_run(umb_app* app) {
 
 void umb_shutdown() {
   umb_gfx_shutdown();
+  umb_job_system_shutdown();
   SDL_Quit();
 }
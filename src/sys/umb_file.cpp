@@ -1,6 +1,16 @@
 #include <stdio.h>
 #include <umbral.h>
 
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 umb_array_byte umb_read_file_binary(umb_arena arena, str filename) {
   FILE* fp = fopen(filename, "rb");
   UMB_ASSERT(fp);
@@ -15,3 +25,79 @@ umb_array_byte umb_read_file_binary(umb_arena arena, str filename) {
 
   return file_data;
 }
+
+b32 umb_map_file(str filename, umb_mapped_file* out_file) {
+  *out_file = {};
+
+#if defined(_WIN32)
+  HANDLE file = CreateFileA(
+      filename,
+      GENERIC_READ,
+      FILE_SHARE_READ,
+      NULL,
+      OPEN_EXISTING,
+      FILE_ATTRIBUTE_NORMAL,
+      NULL);
+  if (file == INVALID_HANDLE_VALUE) return false;
+
+  LARGE_INTEGER file_size;
+  if (!GetFileSizeEx(file, &file_size)) {
+    CloseHandle(file);
+    return false;
+  }
+
+  void* data = NULL;
+  if (file_size.QuadPart > 0) {
+    HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_WRITECOPY, 0, 0, NULL);
+    if (mapping) {
+      data = MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0);
+      // the view keeps the mapping alive
+      CloseHandle(mapping);
+    }
+    if (!data) {
+      CloseHandle(file);
+      return false;
+    }
+  }
+  CloseHandle(file);
+
+  out_file->data = (byte*)data;
+  out_file->size = (u64)file_size.QuadPart;
+#else
+  int fd = open(filename, O_RDONLY);
+  if (fd < 0) return false;
+
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    close(fd);
+    return false;
+  }
+
+  void* data = NULL;
+  if (st.st_size > 0) {
+    data = mmap(NULL, (size_t)st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    if (data == MAP_FAILED) {
+      close(fd);
+      return false;
+    }
+  }
+  // the mapping holds its own reference to the file
+  close(fd);
+
+  out_file->data = (byte*)data;
+  out_file->size = (u64)st.st_size;
+#endif
+
+  return true;
+}
+
+void umb_unmap_file(umb_mapped_file* file) {
+  if (file->data) {
+#if defined(_WIN32)
+    UnmapViewOfFile(file->data);
+#else
+    munmap(file->data, (size_t)file->size);
+#endif
+  }
+  *file = {};
+}
@@ -0,0 +1,745 @@
+#include <algorithm>
+#include <core/umb_ecs.h>
+#include <core/umb_job.h>
+#include <core/umb_math.h>
+#include <core/umb_offset_alloc.h>
+#include <core/umb_radix_sort.h>
+#include <core/umb_transform.h>
+#include <iterator>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <umbral.h>
+#include <vector>
+
+// Checks the CPU side algorithms against plain reference implementations on seeded random input.
+// Every failed check is printed, the exit code is the number of tests that failed.
+//
+//   umbral-tests
+
+static u32 test_failures;
+
+#define TEST_CHECK(x)                                                                            \
+  do {                                                                                           \
+    if (!(x)) {                                                                                  \
+      test_failures++;                                                                           \
+      printf("  %s:%d: check failed: %s\n", __FILE__, __LINE__, #x);                             \
+    }                                                                                            \
+  } while (0)
+
+static u64 test_rng_state;
+
+static u64 test_random() {
+  test_rng_state ^= test_rng_state << 13;
+  test_rng_state ^= test_rng_state >> 7;
+  test_rng_state ^= test_rng_state << 17;
+  return test_rng_state;
+}
+
+static u32 test_random_below(u32 n) {
+  return (u32)(test_random() % n);
+}
+
+static f32 test_random_f32(f32 lo, f32 hi) {
+  return lo + (f32)(test_random() >> 40) / (f32)(1 << 24) * (hi - lo);
+}
+
+static b32 test_close(f32 a, f32 b, f32 tolerance) {
+  f32 scale = fabsf(a) > fabsf(b) ? fabsf(a) : fabsf(b);
+  return fabsf(a - b) <= tolerance * (scale > 1.f ? scale : 1.f);
+}
+
+// radix sort
+
+static void test_radix_sort_keys(u64* keys, u32 n, u32 mode) {
+  for (u32 i = 0; i < n; ++i) {
+    switch (mode) {
+    case 0: keys[i] = test_random(); break;
+    // a single digit varies
+    case 1: keys[i] = test_random_below(256); break;
+    // high digits shared by every key, like the sort keys of the draws
+    case 2: keys[i] = 0xabcd000000000000ull | test_random_below(1 << 20); break;
+    // few distinct keys, order among equal keys must be kept
+    case 3: keys[i] = (u64)test_random_below(4) << 40; break;
+    default: keys[i] = 42; break;
+    }
+  }
+}
+
+static void test_radix_sort() {
+  const u32 sizes[] = {0, 1, 2, 17, 1000, 100000};
+  for (u32 s = 0; s < UMB_ARRAY_COUNT(sizes, u32); ++s) {
+    u32 n = sizes[s];
+    for (u32 mode = 0; mode < 5; ++mode) {
+      std::vector<u64> keys(n + 1), scratch_keys(n + 1);
+      std::vector<u32> values(n + 1), scratch_values(n + 1);
+      test_radix_sort_keys(keys.data(), n, mode);
+      for (u32 i = 0; i < n; ++i) values[i] = i;
+
+      std::vector<std::pair<u64, u32>> expected(n);
+      for (u32 i = 0; i < n; ++i) expected[i] = {keys[i], i};
+      std::stable_sort(expected.begin(), expected.end(), [](const auto& a, const auto& b) {
+        return a.first < b.first;
+      });
+
+      umb_radix_sort_u64(keys.data(), values.data(), scratch_keys.data(), scratch_values.data(), n);
+      b32 sorted = true;
+      for (u32 i = 0; i < n; ++i) {
+        sorted = sorted && keys[i] == expected[i].first && values[i] == expected[i].second;
+      }
+      TEST_CHECK(sorted);
+    }
+  }
+}
+
+// offset allocator
+
+struct test_range {
+  umb_offset_allocation alloc;
+  u32                   size;
+};
+
+static void test_offset_alloc() {
+  const u32            SIZE      = 1 << 20;
+  umb_offset_allocator allocator = umb_offset_allocator_create(SIZE, 1024);
+
+  umb_offset_allocation empty = umb_offset_alloc(&allocator, 0);
+  TEST_CHECK(empty.offset == UMB_OFFSET_ALLOC_NO_SPACE);
+  umb_offset_free(&allocator, empty);
+  TEST_CHECK(allocator.free_storage == SIZE);
+  TEST_CHECK(umb_offset_alloc(&allocator, SIZE + 1).offset == UMB_OFFSET_ALLOC_NO_SPACE);
+
+  std::vector<test_range> live;
+  for (u32 step = 0; step < 20000; ++step) {
+    if (live.empty() || test_random_below(3) != 0) {
+      u32                   size  = 1 + test_random_below(4096);
+      umb_offset_allocation alloc = umb_offset_alloc(&allocator, size);
+      if (alloc.offset == UMB_OFFSET_ALLOC_NO_SPACE) continue;
+      TEST_CHECK(alloc.offset + size <= SIZE);
+      TEST_CHECK(umb_offset_allocation_size(&allocator, alloc) >= size);
+      live.push_back({alloc, size});
+    } else {
+      u32 i = test_random_below((u32)live.size());
+      umb_offset_free(&allocator, live[i].alloc);
+      live[i] = live.back();
+      live.pop_back();
+    }
+  }
+
+  // the live ranges must not overlap
+  std::sort(live.begin(), live.end(), [](const test_range& a, const test_range& b) {
+    return a.alloc.offset < b.alloc.offset;
+  });
+  for (u32 i = 1; i < live.size(); ++i) {
+    TEST_CHECK(live[i - 1].alloc.offset + live[i - 1].size <= live[i].alloc.offset);
+  }
+
+  // freeing everything merges the ranges back into one
+  for (u32 i = 0; i < live.size(); ++i) umb_offset_free(&allocator, live[i].alloc);
+  TEST_CHECK(allocator.free_storage == SIZE);
+  umb_offset_allocation whole = umb_offset_alloc(&allocator, SIZE);
+  TEST_CHECK(whole.offset == 0);
+  TEST_CHECK(umb_offset_alloc(&allocator, 1).offset == UMB_OFFSET_ALLOC_NO_SPACE);
+  umb_offset_free(&allocator, whole);
+
+  umb_offset_allocator_reset(&allocator);
+  TEST_CHECK(umb_offset_alloc(&allocator, SIZE).offset == 0);
+  umb_offset_allocator_destroy(&allocator);
+}
+
+// transform hierarchy
+
+struct test_node {
+  umb_transform parent;
+  f32           trs[10];
+  b32           alive;
+};
+
+// translation * rotation * scale of a normalized quaternion, column-major
+static void test_trs_matrix(const f32* trs, f64* out) {
+  f64 px = trs[0], py = trs[1], pz = trs[2];
+  f64 x = trs[3], y = trs[4], z = trs[5], w = trs[6];
+  f64 sx = trs[7], sy = trs[8], sz = trs[9];
+  f64 m[16] = {
+      (1 - 2 * (y * y + z * z)) * sx,
+      2 * (x * y + w * z) * sx,
+      2 * (x * z - w * y) * sx,
+      0,
+      2 * (x * y - w * z) * sy,
+      (1 - 2 * (x * x + z * z)) * sy,
+      2 * (y * z + w * x) * sy,
+      0,
+      2 * (x * z + w * y) * sz,
+      2 * (y * z - w * x) * sz,
+      (1 - 2 * (x * x + y * y)) * sz,
+      0,
+      px,
+      py,
+      pz,
+      1,
+  };
+  memcpy(out, m, sizeof(m));
+}
+
+static void test_reference_world(const std::vector<test_node>& nodes, umb_transform t, f64* out) {
+  f64 local[16];
+  test_trs_matrix(nodes[t].trs, local);
+  if (nodes[t].parent == UMB_TRANSFORM_NONE) {
+    memcpy(out, local, sizeof(local));
+    return;
+  }
+  f64 parent[16];
+  test_reference_world(nodes, nodes[t].parent, parent);
+  for (u32 c = 0; c < 4; ++c) {
+    for (u32 r = 0; r < 4; ++r) {
+      f64 sum = 0;
+      for (u32 k = 0; k < 4; ++k) sum += parent[k * 4 + r] * local[c * 4 + k];
+      out[c * 4 + r] = sum;
+    }
+  }
+}
+
+static void test_transform_randomize(
+    umb_transform_hierarchy* h,
+    std::vector<test_node>&  nodes,
+    umb_transform            t) {
+  f32* trs = nodes[t].trs;
+  for (u32 k = 0; k < 3; ++k) trs[k] = test_random_f32(-2.f, 2.f);
+  f32 len = 0.f;
+  for (u32 k = 3; k < 7; ++k) {
+    trs[k] = test_random_f32(-1.f, 1.f);
+    len += trs[k] * trs[k];
+  }
+  len = sqrtf(len) > 1e-3f ? sqrtf(len) : 1.f;
+  for (u32 k = 3; k < 7; ++k) trs[k] /= len;
+  for (u32 k = 7; k < 10; ++k) trs[k] = test_random_f32(0.5f, 1.5f);
+
+  umb_transform_set_position(h, t, trs[0], trs[1], trs[2]);
+  umb_transform_set_rotation(h, t, trs[3], trs[4], trs[5], trs[6]);
+  umb_transform_set_scale(h, t, trs[7], trs[8], trs[9]);
+}
+
+static umb_transform test_transform_create(
+    umb_transform_hierarchy* h,
+    std::vector<test_node>&  nodes,
+    umb_transform            parent) {
+  umb_transform t = umb_transform_create(h, parent);
+  if (t >= nodes.size()) nodes.resize(t + 1);
+  nodes[t] = {.parent = parent, .alive = true};
+  test_transform_randomize(h, nodes, t);
+  return t;
+}
+
+static b32 test_is_below(const std::vector<test_node>& nodes, umb_transform t, umb_transform a) {
+  for (; t != UMB_TRANSFORM_NONE; t = nodes[t].parent) {
+    if (t == a) return true;
+  }
+  return false;
+}
+
+static void test_transform_check_worlds(
+    const umb_transform_hierarchy* h,
+    const std::vector<test_node>&  nodes) {
+  b32 close = true;
+  for (umb_transform t = 0; t < nodes.size(); ++t) {
+    if (!nodes[t].alive) continue;
+    f64 expected[16];
+    test_reference_world(nodes, t, expected);
+    const f32* world = umb_transform_world(h, t);
+    for (u32 k = 0; k < 16; ++k) close = close && test_close(world[k], (f32)expected[k], 1e-4f);
+  }
+  TEST_CHECK(close);
+}
+
+static void test_transform() {
+  umb_transform_hierarchy h = umb_transform_hierarchy_create(16);
+  std::vector<test_node>  nodes;
+
+  // wide enough that the lower levels are updated by several jobs
+  std::vector<umb_transform> created;
+  for (u32 i = 0; i < 8; ++i) {
+    created.push_back(test_transform_create(&h, nodes, UMB_TRANSFORM_NONE));
+  }
+  for (u32 i = 0; i < 6000; ++i) {
+    umb_transform parent = created[test_random_below((u32)created.size())];
+    if (h.nodes[parent].depth + 1 >= 12) continue;
+    created.push_back(test_transform_create(&h, nodes, parent));
+  }
+  umb_transform_hierarchy_update(&h);
+  TEST_CHECK(h.n_changed == created.size());
+  test_transform_check_worlds(&h, nodes);
+
+  umb_transform_hierarchy_update(&h);
+  TEST_CHECK(h.n_changed == 0);
+
+  for (u32 round = 0; round < 8; ++round) {
+    // move a few nodes, only they and their subtrees may be recomputed
+    std::vector<umb_transform> moved;
+    for (u32 i = 0; i < 1 + round * 4; ++i) {
+      umb_transform t = test_random_below((u32)nodes.size());
+      if (!nodes[t].alive) continue;
+      test_transform_randomize(&h, nodes, t);
+      moved.push_back(t);
+    }
+    umb_transform_hierarchy_update(&h);
+
+    std::vector<b32> expected(nodes.size(), false);
+    u32              n_expected = 0;
+    for (umb_transform t = 0; t < nodes.size(); ++t) {
+      if (!nodes[t].alive) continue;
+      for (u32 i = 0; i < moved.size() && !expected[t]; ++i) {
+        expected[t] = test_is_below(nodes, t, moved[i]);
+      }
+      n_expected += expected[t] ? 1 : 0;
+    }
+    std::vector<b32> seen(nodes.size(), false);
+    b32              exact = h.n_changed == n_expected;
+    for (u32 i = 0; i < h.n_changed; ++i) {
+      umb_transform t = h.changed[i];
+      exact           = exact && expected[t] && !seen[t];
+      seen[t]         = true;
+      if (i > 0) exact = exact && h.nodes[h.changed[i - 1]].depth <= h.nodes[t].depth;
+    }
+    TEST_CHECK(exact);
+    test_transform_check_worlds(&h, nodes);
+
+    // destroy some leaves, the freed handles are reused by the next nodes
+    for (u32 i = 0; i < 32; ++i) {
+      umb_transform t = test_random_below((u32)nodes.size());
+      if (!nodes[t].alive || h.nodes[t].first_child != UMB_TRANSFORM_NONE) continue;
+      umb_transform_destroy(&h, t);
+      nodes[t].alive = false;
+    }
+    for (u32 i = 0; i < 24; ++i) {
+      umb_transform parent = test_random_below((u32)nodes.size());
+      if (!nodes[parent].alive || h.nodes[parent].depth + 1 >= 12) continue;
+      test_transform_create(&h, nodes, parent);
+    }
+    umb_transform_hierarchy_update(&h);
+    test_transform_check_worlds(&h, nodes);
+  }
+
+  umb_transform_hierarchy_destroy(&h);
+}
+
+// math kernels
+
+static const u32 MATH_ELEMENTS = 1003;
+
+struct test_math_output {
+  std::vector<f32> products;
+  std::vector<f32> vecs[4];
+  std::vector<f32> aabbs[6];
+  std::vector<f32> spheres[4];
+};
+
+static void test_math_run(
+    const std::vector<f32>* matrices,
+    const std::vector<f32>* soa,
+    u32                     stride,
+    test_math_output*       out) {
+  u32 n = MATH_ELEMENTS;
+
+  // in place, out is b
+  out->products = matrices[1];
+  umb_mat4_mul_batch(matrices[0].data(), out->products.data(), out->products.data(), n);
+
+  for (u32 k = 0; k < 4; ++k) out->vecs[k] = soa[k];
+  umb_vec4_soa vecs = {
+      out->vecs[0].data(),
+      out->vecs[1].data(),
+      out->vecs[2].data(),
+      out->vecs[3].data(),
+  };
+  umb_mat4_transform_vec4(matrices[0].data(), stride, &vecs, &vecs, n);
+
+  for (u32 k = 0; k < 6; ++k) out->aabbs[k].resize(n);
+  umb_aabb_soa aabb_in  = {
+      (f32*)soa[0].data(),
+      (f32*)soa[1].data(),
+      (f32*)soa[2].data(),
+      (f32*)soa[4].data(),
+      (f32*)soa[5].data(),
+      (f32*)soa[6].data(),
+  };
+  umb_aabb_soa aabb_out = {
+      out->aabbs[0].data(),
+      out->aabbs[1].data(),
+      out->aabbs[2].data(),
+      out->aabbs[3].data(),
+      out->aabbs[4].data(),
+      out->aabbs[5].data(),
+  };
+  umb_mat4_transform_aabbs(matrices[0].data(), stride, &aabb_in, &aabb_out, n);
+
+  for (u32 k = 0; k < 4; ++k) out->spheres[k].resize(n);
+  umb_sphere_soa sphere_in  = {
+      (f32*)soa[0].data(),
+      (f32*)soa[1].data(),
+      (f32*)soa[2].data(),
+      (f32*)soa[7].data(),
+  };
+  umb_sphere_soa sphere_out = {
+      out->spheres[0].data(),
+      out->spheres[1].data(),
+      out->spheres[2].data(),
+      out->spheres[3].data(),
+  };
+  umb_mat4_transform_spheres(matrices[0].data(), stride, &sphere_in, &sphere_out, n);
+}
+
+static b32 test_math_match(const std::vector<f32>& a, const std::vector<f32>& b) {
+  if (a.size() != b.size()) return false;
+  for (u32 i = 0; i < a.size(); ++i) {
+    if (!test_close(a[i], b[i], 1e-5f)) return false;
+  }
+  return true;
+}
+
+static void test_math() {
+  u32 n = MATH_ELEMENTS;
+
+  // a is read with each stride, 20 floats leave a gap after every matrix like an array of structs
+  std::vector<f32> matrices[2];
+  matrices[0].resize(n * 20);
+  matrices[1].resize(n * 16);
+  for (u32 m = 0; m < 2; ++m) {
+    for (f32& v : matrices[m]) v = test_random_f32(-1.f, 1.f);
+  }
+  // x, y, z, w, then the max corner of the boxes and the radii
+  std::vector<f32> soa[8];
+  for (u32 k = 0; k < 8; ++k) {
+    soa[k].resize(n);
+    for (f32& v : soa[k]) v = test_random_f32(-1.f, 1.f);
+  }
+  for (u32 k = 0; k < 3; ++k) {
+    for (u32 i = 0; i < n; ++i) soa[k + 4][i] = soa[k][i] + test_random_f32(0.f, 1.f);
+  }
+  for (f32& r : soa[7]) r = fabsf(r);
+
+  // the scalar kernels against a plain product
+  umb_math_isa best = umb_math_get_isa();
+  umb_math_set_isa(UMB_MATH_SCALAR);
+  std::vector<f32> products(matrices[1]);
+  umb_mat4_mul_batch(matrices[0].data(), matrices[1].data(), products.data(), n);
+  b32 close = true;
+  for (u32 i = 0; i < n; ++i) {
+    const f32* a = matrices[0].data() + i * 16;
+    const f32* b = matrices[1].data() + i * 16;
+    for (u32 c = 0; c < 4; ++c) {
+      for (u32 r = 0; r < 4; ++r) {
+        f32 sum = 0.f;
+        for (u32 k = 0; k < 4; ++k) sum += a[k * 4 + r] * b[c * 4 + k];
+        close = close && test_close(products[i * 16 + c * 4 + r], sum, 1e-5f);
+      }
+    }
+  }
+  TEST_CHECK(close);
+
+  const u32 strides[] = {16, 0, 20};
+  for (u32 s = 0; s < UMB_ARRAY_COUNT(strides, u32); ++s) {
+    umb_math_set_isa(UMB_MATH_SCALAR);
+    test_math_output expected;
+    test_math_run(matrices, soa, strides[s], &expected);
+
+    for (u32 isa = UMB_MATH_SCALAR + 1; isa <= best; ++isa) {
+      if (umb_math_set_isa((umb_math_isa)isa) != isa) continue;
+      test_math_output out;
+      test_math_run(matrices, soa, strides[s], &out);
+
+      b32 match = test_math_match(out.products, expected.products);
+      for (u32 k = 0; k < 4; ++k) match = match && test_math_match(out.vecs[k], expected.vecs[k]);
+      for (u32 k = 0; k < 6; ++k) match = match && test_math_match(out.aabbs[k], expected.aabbs[k]);
+      for (u32 k = 0; k < 4; ++k) {
+        match = match && test_math_match(out.spheres[k], expected.spheres[k]);
+      }
+      if (!match) printf("  %s, stride %u\n", umb_math_isa_name((umb_math_isa)isa), strides[s]);
+      TEST_CHECK(match);
+    }
+  }
+  umb_math_set_isa(best);
+}
+
+// frustum cull
+
+static void test_cull() {
+  const u32 N = 1003;
+
+  // a box with tilted walls, planes pointing inwards
+  const f32 planes[UMB_FRUSTUM_PLANES][4] = {
+      {1.f, 0.1f, 0.f, 8.f},
+      {-1.f, 0.f, 0.1f, 6.f},
+      {0.f, 1.f, -0.1f, 7.f},
+      {0.1f, -1.f, 0.f, 5.f},
+      {0.f, 0.f, 1.f, 9.f},
+      {0.f, 0.1f, -1.f, 4.f},
+  };
+  umb_frustum_soa frustum;
+  for (u32 p = 0; p < UMB_FRUSTUM_PLANES; ++p) {
+    f32 len = sqrtf(
+        planes[p][0] * planes[p][0] + planes[p][1] * planes[p][1] + planes[p][2] * planes[p][2]);
+
+    frustum.nx[p] = planes[p][0] / len;
+    frustum.ny[p] = planes[p][1] / len;
+    frustum.nz[p] = planes[p][2] / len;
+    frustum.d[p]  = planes[p][3] / len;
+  }
+
+  std::vector<f32> x(N), y(N), z(N), r(N);
+  for (u32 i = 0; i < N; ++i) {
+    x[i] = test_random_f32(-12.f, 12.f);
+    y[i] = test_random_f32(-12.f, 12.f);
+    z[i] = test_random_f32(-12.f, 12.f);
+    r[i] = test_random_f32(0.f, 2.f);
+  }
+  umb_sphere_soa spheres = {x.data(), y.data(), z.data(), r.data()};
+
+  // ranges that start and end off the SIMD width
+  const u32    firsts[] = {0, 3};
+  umb_math_isa best     = umb_math_get_isa();
+  for (u32 f = 0; f < UMB_ARRAY_COUNT(firsts, u32); ++f) {
+    u32 first = firsts[f];
+    u32 n     = N - first - 2 * f;
+
+    // spheres within a hair of a plane may go either way
+    std::vector<u32> reference;
+    std::vector<b32> borderline(N, false);
+    for (u32 i = first; i < first + n; ++i) {
+      b32 visible = true;
+      for (u32 p = 0; p < UMB_FRUSTUM_PLANES; ++p) {
+        f64 dist = (f64)frustum.nx[p] * x[i] + (f64)frustum.ny[p] * y[i] +
+                   (f64)frustum.nz[p] * z[i] + frustum.d[p] + r[i];
+        visible       = visible && dist > 0.0;
+        borderline[i] = borderline[i] || fabs(dist) < 1e-4;
+      }
+      if (visible) reference.push_back(i);
+    }
+
+    umb_math_set_isa(UMB_MATH_SCALAR);
+    std::vector<u32> expected(n);
+    expected.resize(umb_spheres_cull_frustum(&frustum, &spheres, first, n, expected.data()));
+    std::vector<u32> diff;
+    std::set_symmetric_difference(
+        expected.begin(),
+        expected.end(),
+        reference.begin(),
+        reference.end(),
+        std::back_inserter(diff));
+    TEST_CHECK(std::all_of(diff.begin(), diff.end(), [&](u32 i) { return borderline[i]; }));
+    TEST_CHECK(std::is_sorted(expected.begin(), expected.end()));
+
+    for (u32 isa = UMB_MATH_SCALAR + 1; isa <= best; ++isa) {
+      if (umb_math_set_isa((umb_math_isa)isa) != isa) continue;
+      std::vector<u32> visible(n);
+      visible.resize(umb_spheres_cull_frustum(&frustum, &spheres, first, n, visible.data()));
+      if (visible != expected) {
+        printf("  %s, first %u\n", umb_math_isa_name((umb_math_isa)isa), first);
+      }
+      TEST_CHECK(visible == expected);
+    }
+  }
+  umb_math_set_isa(best);
+}
+
+// entity component storage
+
+struct test_entity {
+  umb_entity         entity;
+  umb_component_mask mask;
+  u32                a;
+  u64                b;
+};
+
+struct test_ecs_components {
+  umb_component a;
+  umb_component b;
+  umb_component tag;
+  umb_component big;
+};
+
+static const u32 BIG_SIZE = 200;
+
+static void test_ecs_write(umb_ecs_world* world, const test_ecs_components* c, test_entity* e) {
+  e->a = (u32)test_random();
+  e->b = test_random();
+  if (e->mask & UMB_COMPONENT_BIT(c->a)) umb_ecs_set(world, e->entity, c->a, &e->a);
+  if (e->mask & UMB_COMPONENT_BIT(c->b)) umb_ecs_set(world, e->entity, c->b, &e->b);
+}
+
+static void test_ecs_check_entities(
+    umb_ecs_world*                  world,
+    const test_ecs_components*      c,
+    const std::vector<test_entity>& live) {
+  b32 match = true;
+  for (const test_entity& e : live) {
+    match = match && umb_ecs_alive(world, e.entity);
+
+    u32* a = (u32*)umb_ecs_get(world, e.entity, c->a);
+    u64* b = (u64*)umb_ecs_get(world, e.entity, c->b);
+    match  = match && (a != NULL) == ((e.mask & UMB_COMPONENT_BIT(c->a)) != 0);
+    match  = match && (b != NULL) == ((e.mask & UMB_COMPONENT_BIT(c->b)) != 0);
+    match  = match && (!a || *a == e.a) && (!b || *b == e.b);
+    match  = match && (!b || (u64)b % alignof(u64) == 0);
+  }
+  TEST_CHECK(match);
+}
+
+struct test_ecs_visit {
+  const test_ecs_components* components;
+  std::vector<u32>*          visits;
+};
+
+// counts each entity at its position in the query, and checks the columns line up with the rows
+static void test_ecs_visit_chunk(const umb_ecs_chunk* chunk, void* data) {
+  test_ecs_visit* visit = (test_ecs_visit*)data;
+  u32*            a     = umb_ecs_column<u32>(chunk, visit->components->a);
+  for (u32 i = 0; i < chunk->n; ++i) {
+    (*visit->visits)[chunk->first + i]++;
+    if (a) a[i] = chunk->entities[i];
+  }
+}
+
+static void test_ecs_check_query(
+    umb_ecs_world*             world,
+    const test_ecs_components* c,
+    std::vector<test_entity>&  live,
+    umb_component_mask         all,
+    umb_component_mask         none) {
+  umb_ecs_query query = umb_ecs_query_create(all, none);
+
+  std::vector<umb_entity> expected;
+  for (const test_entity& e : live) {
+    if ((e.mask & all) == all && (e.mask & none) == 0) expected.push_back(e.entity);
+  }
+  std::sort(expected.begin(), expected.end());
+
+  std::vector<umb_entity> found;
+  umb_ecs_chunk           chunk;
+  u32                     n_chunks = 0;
+  b32                     ordered  = true;
+  for (umb_ecs_iter it = umb_ecs_query_iter(world, &query); umb_ecs_iter_next(&it, &chunk);) {
+    ordered = ordered && chunk.first == found.size() && chunk.index == n_chunks++ && chunk.n > 0;
+    for (u32 i = 0; i < chunk.n; ++i) found.push_back(chunk.entities[i]);
+  }
+  std::sort(found.begin(), found.end());
+  TEST_CHECK(ordered);
+  TEST_CHECK(found == expected);
+  TEST_CHECK(umb_ecs_query_count(world, &query) == expected.size());
+  TEST_CHECK(umb_ecs_query_chunk_count(world, &query) == n_chunks);
+
+  // every entity is visited once, whether the chunks run inline, one per job or batched
+  const u32 job_sizes[] = {0, 1, 100, 1000, ~0u};
+  for (u32 j = 0; j < UMB_ARRAY_COUNT(job_sizes, u32); ++j) {
+    std::vector<u32> visits(expected.size(), 0);
+    test_ecs_visit   visit = {c, &visits};
+    if (job_sizes[j] == 0) {
+      umb_ecs_query_run(world, &query, test_ecs_visit_chunk, &visit);
+    } else {
+      umb_ecs_query_run_parallel(world, &query, test_ecs_visit_chunk, &visit, job_sizes[j]);
+    }
+    TEST_CHECK(std::all_of(visits.begin(), visits.end(), [](u32 v) { return v == 1; }));
+  }
+
+  // the visits wrote each entity's own handle into its a column
+  if (all & UMB_COMPONENT_BIT(c->a)) {
+    b32 written = true;
+    for (test_entity& e : live) {
+      if ((e.mask & all) != all || (e.mask & none) != 0) continue;
+      written = written && *(u32*)umb_ecs_get(world, e.entity, c->a) == e.entity;
+      e.a     = e.entity;
+    }
+    TEST_CHECK(written);
+  }
+  umb_ecs_query_destroy(&query);
+}
+
+static void test_ecs() {
+  umb_ecs_world       world = umb_ecs_world_create();
+  test_ecs_components c     = {};
+  c.a                       = umb_ecs_register_component(&world, sizeof(u32), alignof(u32));
+  c.b                       = umb_ecs_register_component(&world, sizeof(u64), alignof(u64));
+  c.tag                     = umb_ecs_register_component(&world, 0, 1);
+  c.big                     = umb_ecs_register_component(&world, BIG_SIZE, 64);
+  const umb_component components[] = {c.a, c.b, c.tag, c.big};
+
+  std::vector<test_entity> live;
+  for (u32 round = 0; round < 6; ++round) {
+    for (u32 step = 0; step < 4000; ++step) {
+      u32 op = test_random_below(10);
+      if (live.empty() || op < 4) {
+        test_entity e = {};
+        for (u32 k = 0; k < UMB_ARRAY_COUNT(components, umb_component); ++k) {
+          if (test_random_below(2)) e.mask |= UMB_COMPONENT_BIT(components[k]);
+        }
+        e.entity = umb_ecs_create(&world, e.mask);
+        TEST_CHECK(!umb_ecs_get(&world, e.entity, c.a) ||
+                   *(u32*)umb_ecs_get(&world, e.entity, c.a) == 0);
+        test_ecs_write(&world, &c, &e);
+        live.push_back(e);
+        continue;
+      }
+
+      u32          i = test_random_below((u32)live.size());
+      test_entity* e = &live[i];
+      if (op < 6) {
+        umb_entity entity = e->entity;
+        umb_ecs_destroy(&world, entity);
+        TEST_CHECK(!umb_ecs_alive(&world, entity));
+        live[i] = live.back();
+        live.pop_back();
+      } else if (op < 8) {
+        umb_component component = components[test_random_below(4)];
+        umb_ecs_add(&world, e->entity, component);
+        e->mask |= UMB_COMPONENT_BIT(component);
+        test_ecs_write(&world, &c, e);
+      } else {
+        umb_component component = components[test_random_below(4)];
+        umb_ecs_remove(&world, e->entity, component);
+        e->mask &= ~UMB_COMPONENT_BIT(component);
+      }
+    }
+    test_ecs_check_entities(&world, &c, live);
+
+    umb_component_mask a   = UMB_COMPONENT_BIT(c.a);
+    umb_component_mask b   = UMB_COMPONENT_BIT(c.b);
+    umb_component_mask tag = UMB_COMPONENT_BIT(c.tag);
+    umb_component_mask big = UMB_COMPONENT_BIT(c.big);
+    test_ecs_check_query(&world, &c, live, a, 0);
+    test_ecs_check_query(&world, &c, live, a | b, tag);
+    test_ecs_check_query(&world, &c, live, big, a);
+    test_ecs_check_query(&world, &c, live, 0, a | b | tag | big);
+    test_ecs_check_entities(&world, &c, live);
+  }
+
+  for (const test_entity& e : live) umb_ecs_destroy(&world, e.entity);
+  umb_ecs_world_destroy(&world);
+}
+
+struct test_case {
+  str name;
+  void (*proc)();
+};
+
+int main() {
+  const test_case tests[] = {
+      {"radix sort", test_radix_sort},
+      {"offset allocator", test_offset_alloc},
+      {"transform hierarchy", test_transform},
+      {"math kernels", test_math},
+      {"frustum cull", test_cull},
+      {"ecs", test_ecs},
+  };
+
+  umb_job_system_init(umb_job_system_default_worker_count());
+  u32 failed = 0;
+  for (u32 i = 0; i < UMB_ARRAY_COUNT(tests, test_case); ++i) {
+    test_rng_state = 0x9e3779b97f4a7c15ull + i;
+    test_failures  = 0;
+    tests[i].proc();
+    printf("%-20s %s\n", tests[i].name, test_failures ? "FAILED" : "ok");
+    failed += test_failures ? 1 : 0;
+  }
+  umb_job_system_shutdown();
+  return (int)failed;
+}
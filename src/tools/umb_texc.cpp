@@ -0,0 +1,232 @@
+#include <atomic>
+#include <gfx/umb_bc.h>
+#include <gfx/umb_ktx2.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <thread>
+#include <umbral.h>
+#include <vulkan/vulkan_core.h>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include <gfx/stb_image.h>
+
+// Offline texture compiler: decodes an image, builds its mip chain and encodes every level into
+// block-compressed data in a KTX2 container that umb_gfx_load_image_from_file uploads as is.
+//
+//   umbral-texc [-f bc1|bc3|bc5|bc7] [--linear] [--no-mips] <input> <output.ktx2>
+
+static constexpr u32 MAX_WORKERS = 64;
+
+struct umb_texc_level {
+  u8* rgba;
+  u32 width;
+  u32 height;
+};
+
+struct umb_texc_job {
+  const umb_texc_level* level;
+  umb_bc_format         format;
+  u8*                   out;
+  u32                   blocks_x;
+  u32                   blocks_y;
+  std::atomic<u32>      next_row;
+};
+
+static f32 umb_srgb_to_linear(f32 c) {
+  return c <= 0.04045f ? c / 12.92f : powf((c + 0.055f) / 1.055f, 2.4f);
+}
+
+static f32 umb_linear_to_srgb(f32 c) {
+  return c <= 0.0031308f ? c * 12.92f : 1.055f * powf(c, 1.f / 2.4f) - 0.055f;
+}
+
+// 2x2 box filter, averaging color in linear space when the data is sRGB encoded
+static umb_texc_level umb_texc_downsample(const umb_texc_level* src, b32 srgb) {
+  umb_texc_level dst = {
+      .width  = src->width > 1 ? src->width / 2 : 1,
+      .height = src->height > 1 ? src->height / 2 : 1,
+  };
+  dst.rgba = (u8*)malloc((u64)dst.width * dst.height * 4);
+
+  for (u32 y = 0; y < dst.height; ++y) {
+    u32 y0 = y * 2 < src->height ? y * 2 : src->height - 1;
+    u32 y1 = y * 2 + 1 < src->height ? y * 2 + 1 : src->height - 1;
+    for (u32 x = 0; x < dst.width; ++x) {
+      u32 x0 = x * 2 < src->width ? x * 2 : src->width - 1;
+      u32 x1 = x * 2 + 1 < src->width ? x * 2 + 1 : src->width - 1;
+
+      const u8* texels[4] = {
+          src->rgba + ((u64)y0 * src->width + x0) * 4,
+          src->rgba + ((u64)y0 * src->width + x1) * 4,
+          src->rgba + ((u64)y1 * src->width + x0) * 4,
+          src->rgba + ((u64)y1 * src->width + x1) * 4,
+      };
+      for (u32 c = 0; c < 4; ++c) {
+        b32 decode = srgb && c < 3;
+        f32 sum    = 0.f;
+        for (u32 t = 0; t < 4; ++t) {
+          f32 v = texels[t][c] / 255.f;
+          sum += decode ? umb_srgb_to_linear(v) : v;
+        }
+        f32 v = sum * 0.25f;
+        v     = decode ? umb_linear_to_srgb(v) : v;
+
+        dst.rgba[((u64)y * dst.width + x) * 4 + c] = (u8)(v * 255.f + 0.5f);
+      }
+    }
+  }
+  return dst;
+}
+
+// workers take rows of blocks until none are left, partial blocks at the edges repeat the last
+// row and column
+static void umb_texc_encode_rows(umb_texc_job* job) {
+  const umb_texc_level* level      = job->level;
+  u32                   block_size = umb_bc_block_size(job->format);
+
+  for (u32 by = job->next_row++; by < job->blocks_y; by = job->next_row++) {
+    for (u32 bx = 0; bx < job->blocks_x; ++bx) {
+      u8 texels[UMB_BC_BLOCK_TEXELS * 4];
+      for (u32 ty = 0; ty < 4; ++ty) {
+        u32 y = by * 4 + ty < level->height ? by * 4 + ty : level->height - 1;
+        for (u32 tx = 0; tx < 4; ++tx) {
+          u32 x = bx * 4 + tx < level->width ? bx * 4 + tx : level->width - 1;
+          memcpy(&texels[(ty * 4 + tx) * 4], level->rgba + ((u64)y * level->width + x) * 4, 4);
+        }
+      }
+      umb_bc_encode_block(
+          job->format,
+          texels,
+          job->out + ((u64)by * job->blocks_x + bx) * block_size);
+    }
+  }
+}
+
+static void umb_texc_encode_level(const umb_texc_level* level, umb_bc_format format, u8* out) {
+  umb_texc_job job;
+  job.level    = level;
+  job.format   = format;
+  job.out      = out;
+  job.blocks_x = (level->width + 3) / 4;
+  job.blocks_y = (level->height + 3) / 4;
+  job.next_row = 0;
+
+  u32 n_threads = std::thread::hardware_concurrency();
+  n_threads     = n_threads < 1 ? 1 : n_threads > MAX_WORKERS ? MAX_WORKERS : n_threads;
+
+  std::thread workers[MAX_WORKERS];
+  for (u32 i = 1; i < n_threads; ++i) workers[i] = std::thread(umb_texc_encode_rows, &job);
+  umb_texc_encode_rows(&job);
+  for (u32 i = 1; i < n_threads; ++i) workers[i].join();
+}
+
+static void umb_texc_usage() {
+  fprintf(
+      stderr,
+      "usage: umbral-texc [-f bc1|bc3|bc5|bc7] [--linear] [--no-mips] <input> <output.ktx2>\n");
+}
+
+int main(int argc, char** argv) {
+  umb_bc_format format = UMB_BC7;
+  b32           srgb   = true;
+  b32           mips   = true;
+  str           input  = NULL;
+  str           output = NULL;
+
+  for (i32 i = 1; i < argc; ++i) {
+    if (strcmp(argv[i], "-f") == 0 && i + 1 < argc) {
+      str name = argv[++i];
+      if (strcmp(name, "bc1") == 0) {
+        format = UMB_BC1;
+      } else if (strcmp(name, "bc3") == 0) {
+        format = UMB_BC3;
+      } else if (strcmp(name, "bc5") == 0) {
+        format = UMB_BC5;
+      } else if (strcmp(name, "bc7") == 0) {
+        format = UMB_BC7;
+      } else {
+        umb_texc_usage();
+        return 1;
+      }
+    } else if (strcmp(argv[i], "--linear") == 0) {
+      srgb = false;
+    } else if (strcmp(argv[i], "--no-mips") == 0) {
+      mips = false;
+    } else if (!input) {
+      input = argv[i];
+    } else if (!output) {
+      output = argv[i];
+    } else {
+      umb_texc_usage();
+      return 1;
+    }
+  }
+  if (!input || !output) {
+    umb_texc_usage();
+    return 1;
+  }
+
+  // two channel data is never color
+  if (format == UMB_BC5) srgb = false;
+
+  u32 vk_format = 0;
+  switch (format) {
+  case UMB_BC1: {
+    vk_format = srgb ? VK_FORMAT_BC1_RGB_SRGB_BLOCK : VK_FORMAT_BC1_RGB_UNORM_BLOCK;
+  } break;
+  case UMB_BC3: {
+    vk_format = srgb ? VK_FORMAT_BC3_SRGB_BLOCK : VK_FORMAT_BC3_UNORM_BLOCK;
+  } break;
+  case UMB_BC5: {
+    vk_format = VK_FORMAT_BC5_UNORM_BLOCK;
+  } break;
+  case UMB_BC7: {
+    vk_format = srgb ? VK_FORMAT_BC7_SRGB_BLOCK : VK_FORMAT_BC7_UNORM_BLOCK;
+  } break;
+  }
+
+  int      width, height, channels;
+  stbi_uc* pixels = stbi_load(input, &width, &height, &channels, STBI_rgb_alpha);
+  if (!pixels) {
+    fprintf(stderr, "umbral-texc: could not load %s\n", input);
+    return 1;
+  }
+
+  umb_texc_level levels[UMB_KTX2_MAX_LEVELS];
+  u32            n_levels = 1;
+  levels[0]               = {.rgba = pixels, .width = (u32)width, .height = (u32)height};
+  while (mips && (levels[n_levels - 1].width > 1 || levels[n_levels - 1].height > 1)) {
+    levels[n_levels] = umb_texc_downsample(&levels[n_levels - 1], srgb);
+    n_levels++;
+  }
+
+  umb_ktx2_level encoded[UMB_KTX2_MAX_LEVELS];
+  u64            total_size = 0;
+  for (u32 l = 0; l < n_levels; ++l) {
+    u64 size   = umb_ktx2_level_size(vk_format, levels[l].width, levels[l].height);
+    u8* blocks = (u8*)malloc(size);
+    umb_texc_encode_level(&levels[l], format, blocks);
+    encoded[l] = {.data = (const byte*)blocks, .size = size};
+    total_size += size;
+  }
+
+  b32 ok = umb_ktx2_write(output, vk_format, (u32)width, (u32)height, encoded, n_levels);
+  if (ok) {
+    printf(
+        "%s: %ux%u, %u levels, %.2f MB -> %.2f MB\n",
+        output,
+        (u32)width,
+        (u32)height,
+        n_levels,
+        (f64)width * height * 4 * 4 / 3 / (1024.0 * 1024.0),
+        (f64)total_size / (1024.0 * 1024.0));
+  } else {
+    fprintf(stderr, "umbral-texc: could not write %s\n", output);
+  }
+
+  stbi_image_free(pixels);
+  for (u32 l = 1; l < n_levels; ++l) free(levels[l].rgba);
+  for (u32 l = 0; l < n_levels; ++l) free((void*)encoded[l].data);
+  return ok ? 0 : 1;
+}